@@ -0,0 +1,293 @@
+#include "bot.h"
+
+#include "sample_ccd.h"
+
+#include "shared/modules/human_sync.hpp"
+#include "shared/modules/mount_records.hpp"
+#include "shared/modules/spell_records.hpp"
+#include "shared/rpc/load_probe.h"
+#include "shared/rpc/script_event.h"
+#include "shared/rpc/set_appearance.h"
+#include "shared/rpc/set_weather.h"
+#include "shared/version.h"
+
+#include <networking/messages/client_handshake.h>
+#include <networking/replication/entity_registry.h>
+#include <networking/replication/replication_manager.h>
+#include <networking/rpc/chat_message.h>
+
+#include <mafianet/RakNetStatistics.h>
+
+#include <fmt/format.h>
+
+#include <glm/gtc/quaternion.hpp>
+
+#include <array>
+#include <cmath>
+#include <unordered_map>
+
+namespace HogwartsMP::Bots {
+    using Framework::Networking::Replication::EntityRegistry;
+    using Shared::Modules::HumanSync;
+
+    namespace {
+        // Connected bots by their peer GUID, so a constructed replica can find the bot that owns it.
+        std::unordered_map<uint64_t, Bot *> gBotsByGuid;
+
+        constexpr std::array kChatLines = {
+            "anyone up for a duel at the Clock Tower?",
+            "meet at the Three Broomsticks",
+            "how do I get to the Room of Requirement",
+            "Accio broom!",
+            "that troll nearly flattened me",
+            "brb, Herbology homework",
+        };
+
+        // Where the bots gather: a 50 m square around this point, so every bot is inside every other
+        // bot's interest range (500 m) — each client sees all the others, the worst case for replication.
+        constexpr float kSpreadCm = 5000.0f;
+
+        uint64_t MicrosNow(Clock::time_point now) {
+            return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(now.time_since_epoch()).count());
+        }
+
+        Clock::duration Seconds(float s) {
+            return std::chrono::duration_cast<Clock::duration>(std::chrono::duration<float>(s));
+        }
+    } // namespace
+
+    Bot::Bot(int index, const BotOptions &options)
+        : _index(index)
+        , _options(options)
+        , _nickname(fmt::format("Bot{:04}", index))
+        , _rng(static_cast<uint32_t>(index) * 2654435761u + 1u) {
+        std::uniform_real_distribution<float> spread(-kSpreadCm / 2, kSpreadCm / 2);
+        _originX = spread(_rng);
+        _originY = spread(_rng);
+        _radius  = std::uniform_real_distribution<float>(300.0f, 1500.0f)(_rng);
+        _angle   = std::uniform_real_distribution<float>(0.0f, 6.2832f)(_rng);
+    }
+
+    Bot::~Bot() {
+        Stop();
+    }
+
+    void Bot::RegisterTypes() {
+        EntityRegistry::Get().Register<BotHuman>(Shared::kHumanTypeName);
+    }
+
+    bool Bot::Start() {
+        _eventNames.Reset();
+        _net = std::make_unique<Framework::Networking::NetworkClient>();
+        if (!_net->Init()) {
+            _net.reset();
+            return false;
+        }
+
+        _net->RegisterRPC<Shared::RPC::LoadProbe>([this](const Shared::RPC::LoadProbe &msg, MafiaNet::Packet *) {
+            const uint64_t now = MicrosNow(Clock::now());
+            if (msg.sentUs <= now) {
+                _sample.rttMs.push_back(static_cast<float>(now - msg.sentUs) / 1000.0f);
+            }
+            _sample.tickMs    = msg.tickMs;
+            _sample.tickMaxMs = msg.tickMaxMs;
+        });
+        // What the server sends every client: received and dropped, as a real client's cost is in
+        // applying them to the game, which a bot doesn't have.
+        _net->RegisterRPC<Shared::RPC::SetWeather>([](const Shared::RPC::SetWeather &, MafiaNet::Packet *) {});
+        _net->RegisterRPC<Framework::Networking::RPC::ChatMessage>([](const Framework::Networking::RPC::ChatMessage &, MafiaNet::Packet *) {});
+        _net->RegisterRPC<Shared::RPC::ScriptEvent>([](const Shared::RPC::ScriptEvent &, MafiaNet::Packet *) {});
+        _net->RegisterRPC<Shared::RPC::AppearanceUpdate>([this](const Shared::RPC::AppearanceUpdate &msg, MafiaNet::Packet *) {
+            auto *repl  = _net->GetReplicationManager();
+            auto *human = repl ? repl->GetEntity<BotHuman>(msg.networkId) : nullptr;
+            if (human) {
+                human->ccd = msg.ccd;
+            }
+        });
+
+        if (!_net->Connect(_options.host, _options.port, "")) {
+            _net.reset();
+            return false;
+        }
+        _guid = MafiaNet::ToPeerGuid(_net->GetPeer()->GetMyGUID());
+        gBotsByGuid[static_cast<uint64_t>(_guid)] = this;
+        return true;
+    }
+
+    void Bot::Stop() {
+        if (!_net) {
+            return;
+        }
+        gBotsByGuid.erase(static_cast<uint64_t>(_guid));
+        _avatar = nullptr;
+        _net->Disconnect();
+        _net->Shutdown();
+        _net.reset();
+    }
+
+    bool Bot::IsConnected() const {
+        return _net && _net->GetConnectionState() == Framework::Networking::PeerState::CONNECTED;
+    }
+
+    void Bot::Update(Clock::time_point now) {
+        if (!_net) {
+            return;
+        }
+        _net->Update();
+        if (!IsConnected()) {
+            return;
+        }
+        if (!_handshakeSent) {
+            SendHandshake();
+            return;
+        }
+        if (!_avatar) {
+            return;
+        }
+        if (_spawnedAt == Clock::time_point {}) {
+            // First frame with an avatar: dress it, and stagger the periodic traffic so the bots don't
+            // all fire on the same tick.
+            _spawnedAt = now;
+            SendAppearance();
+            std::uniform_real_distribution<float> phase(0.0f, 1.0f);
+            _nextUpdate = now;
+            _nextChat   = now + Seconds(_options.chatEveryS * phase(_rng));
+            _nextEvent  = now + Seconds(_options.emitEveryS * phase(_rng));
+            _nextProbe  = now + Seconds(_options.probeEveryS * phase(_rng));
+        }
+        if (_options.updateHz > 0.0f && now >= _nextUpdate) {
+            Drive(now);
+            _nextUpdate += Seconds(1.0f / _options.updateHz);
+            if (_nextUpdate < now) {
+                _nextUpdate = now; // fell behind: don't burst to catch up
+            }
+        }
+        if (_options.chatEveryS > 0.0f && now >= _nextChat) {
+            SendChat();
+            _nextChat = now + Seconds(_options.chatEveryS);
+        }
+        if (_options.emitEveryS > 0.0f && now >= _nextEvent) {
+            SendEvent();
+            _nextEvent = now + Seconds(_options.emitEveryS);
+        }
+        if (_options.probeEveryS > 0.0f && now >= _nextProbe) {
+            SendProbe(now);
+            _nextProbe = now + Seconds(_options.probeEveryS);
+        }
+    }
+
+    // The handshake Integrations::Client::Instance sends once the transport is up. The server answers
+    // by creating our avatar (Server::OnPlayerConnect), owned by this peer — see OnAvatar. The hardware
+    // id is per bot, so each one gets its own player-data shard, as real players do.
+    void Bot::SendHandshake() {
+        Framework::Networking::Messages::ClientHandshake msg;
+        msg.FromParameters(_nickname, fmt::format("hogwartsmp-bot-{}", _index), "", HogwartsMP::Version::rel, "Hogwarts Legacy");
+        _net->Send(msg, MafiaNet::UNASSIGNED_RAKNET_GUID);
+        _handshakeSent = true;
+    }
+
+    void Bot::SendAppearance() {
+        Shared::RPC::SetAppearance payload;
+        payload.ccd = SampleCcd(_rng);
+        _net->BroadcastRPC(payload);
+    }
+
+    // Walk (or, for every tenth bot, fly) a circle around the bot's spot, jumping and casting now and
+    // then — the fields a real client's avatar writes every frame. The owned replica carries them to the
+    // server on the replication manager's next update.
+    void Bot::Drive(Clock::time_point now) {
+        const bool mounted = _index % 10 == 0;
+        const float speed  = mounted ? 1500.0f : 350.0f; // cm/s
+        const float dt     = _options.updateHz > 0.0f ? 1.0f / _options.updateHz : 0.0f;
+        _angle += speed * dt / _radius;
+
+        const glm::vec3 pos {_originX + _radius * std::cos(_angle), _originY + _radius * std::sin(_angle), mounted ? 3000.0f : 0.0f};
+        const float yaw   = _angle + 1.5708f; // facing along the circle
+        _avatar->position = pos;
+        _avatar->rotation = glm::angleAxis(yaw, glm::vec3 {0.0f, 0.0f, 1.0f});
+        _avatar->velocity = mounted ? glm::vec3 {-std::sin(_angle) * speed, std::cos(_angle) * speed, 0.0f} : glm::vec3 {0.0f};
+
+        std::uniform_real_distribution<float> roll(0.0f, 1.0f);
+        if (!mounted && now >= _jumpUntil && roll(_rng) < dt / 6.0f) {
+            _jumpUntil = now + Seconds(0.8f);
+        }
+        if (!mounted && now >= _castUntil && roll(_rng) < dt / 8.0f) {
+            _castUntil             = now + Seconds(0.5f);
+            _avatar->data.spellId  = static_cast<uint8_t>(1 + _rng() % Shared::Modules::kSpellRecords.size());
+            _avatar->data.aimPitch = static_cast<int8_t>(static_cast<int>(_rng() % 40) - 20);
+        }
+        const bool casting = now < _castUntil;
+        _avatar->SetFlag(HumanSync::Mounted, mounted);
+        _avatar->SetFlag(HumanSync::InAir, now < _jumpUntil);
+        _avatar->SetFlag(HumanSync::Cast, casting);
+        _avatar->data.mountId = mounted ? static_cast<uint8_t>(1 + _index / 10 % Shared::Modules::kMountClasses.size()) : 0;
+        if (!casting) {
+            _avatar->data.spellId  = 0;
+            _avatar->data.aimPitch = 0;
+        }
+    }
+
+    void Bot::SendChat() {
+        Framework::Networking::RPC::ChatMessage payload {kChatLines[_rng() % kChatLines.size()]};
+        _net->BroadcastRPC(payload);
+    }
+
+    void Bot::SendEvent() {
+        Shared::RPC::ScriptEvent ev;
+        ev.payload = fmt::format(R"({{"bot":{},"x":{:.0f},"y":{:.0f}}})", _index, _avatar->position.x, _avatar->position.y);
+        ev.SetName("botStatus", _eventNames);
+        _net->BroadcastRPC(ev);
+    }
+
+    void Bot::SendProbe(Clock::time_point now) {
+        Shared::RPC::LoadProbe probe;
+        probe.seq    = ++_probeSeq;
+        probe.sentUs = MicrosNow(now);
+        _net->BroadcastRPC(probe);
+    }
+
+    BotSample Bot::TakeSample() {
+        if (_net) {
+            MafiaNet::RakNetStatistics stats;
+            auto *peer = _net->GetPeer();
+            if (peer && peer->GetStatistics(peer->GetSystemAddressFromIndex(0), &stats)) {
+                const uint64_t sent = stats.runningTotal[MafiaNet::ACTUAL_BYTES_SENT];
+                const uint64_t recv = stats.runningTotal[MafiaNet::ACTUAL_BYTES_RECEIVED];
+                _sample.bytesSent   = sent - _lastBytesSent;
+                _sample.bytesRecv   = recv - _lastBytesRecv;
+                _lastBytesSent      = sent;
+                _lastBytesRecv      = recv;
+            }
+        }
+        // The tick timings are the latest known, not per-window: keep them for the next sample.
+        BotSample sample  = std::move(_sample);
+        _sample           = {};
+        _sample.tickMs    = sample.tickMs;
+        _sample.tickMaxMs = sample.tickMaxMs;
+        return sample;
+    }
+
+    void Bot::OnAvatar(BotHuman *human, bool alive) {
+        const auto it = gBotsByGuid.find(static_cast<uint64_t>(human->ownerGUID));
+        if (it == gBotsByGuid.end()) {
+            return;
+        }
+        if (alive) {
+            it->second->_avatar = human;
+        }
+        else if (it->second->_avatar == human) {
+            it->second->_avatar = nullptr;
+        }
+    }
+
+    BotHuman::~BotHuman() {
+        Bot::OnAvatar(this, false);
+    }
+
+    void BotHuman::OnConstructed() {
+        // As in ClientHuman: ownerGUID has been read off the construction snapshot by now.
+        if (IsOwner()) {
+            Bot::OnAvatar(this, true);
+        }
+    }
+} // namespace HogwartsMP::Bots
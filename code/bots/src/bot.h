@@ -0,0 +1,117 @@
+#pragma once
+
+#include "shared/event_names.h"
+#include "shared/game/human.h"
+
+#include <networking/network_client.h>
+
+#include <mafianet/types.h>
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace HogwartsMP::Bots {
+    using Clock = std::chrono::steady_clock;
+
+    struct BotOptions {
+        std::string host  = "127.0.0.1";
+        uint16_t port     = 27015;
+        float updateHz    = 30.0f; // transform / HumanSync upstream rate
+        float chatEveryS  = 20.0f; // 0 = never
+        float emitEveryS  = 5.0f;  // Game.emitServer-style client event; 0 = never
+        float probeEveryS = 1.0f;  // LoadProbe round trip; 0 = never
+    };
+
+    // What a bot measured since the last TakeSample.
+    struct BotSample {
+        std::vector<float> rttMs;  // LoadProbe round trips
+        float tickMs       = 0.0f; // from the latest probe reply (0 = none yet)
+        float tickMaxMs    = 0.0f;
+        uint64_t bytesSent = 0;
+        uint64_t bytesRecv = 0;
+    };
+
+    class BotHuman;
+
+    // One simulated player: its own NetworkClient (and so its own connection and replication manager),
+    // the framework handshake, then the traffic a real client makes — its avatar's transform and
+    // HumanSync state at updateHz, an appearance on spawn, chat lines, client events — plus LoadProbe
+    // round trips to measure the server.
+    class Bot final {
+      public:
+        Bot(int index, const BotOptions &options);
+        ~Bot();
+        Bot(const Bot &)            = delete;
+        Bot &operator=(const Bot &) = delete;
+
+        // Start connecting. False if the client couldn't be set up.
+        bool Start();
+        // Pump the network and, once the bot has its avatar, drive it. Call every loop iteration.
+        void Update(Clock::time_point now);
+        void Stop();
+
+        bool IsConnected() const;
+        // True once the server has handed the bot its own avatar (the handshake is complete).
+        bool IsReady() const {
+            return _avatar != nullptr;
+        }
+        const std::string &Nickname() const {
+            return _nickname;
+        }
+
+        BotSample TakeSample();
+
+        // Called by BotHuman when a replica owned by this peer is constructed / destroyed.
+        static void OnAvatar(BotHuman *human, bool alive);
+        // Register the BotHuman stand-in for the shared Human type. Call once, before any Start.
+        static void RegisterTypes();
+
+      private:
+        void SendHandshake();
+        void SendAppearance();
+        void Drive(Clock::time_point now);
+        void SendChat();
+        void SendEvent();
+        void SendProbe(Clock::time_point now);
+
+        int _index;
+        const BotOptions &_options;
+        std::string _nickname;
+        std::unique_ptr<Framework::Networking::NetworkClient> _net;
+        MafiaNet::PeerGuid _guid {};
+        bool _handshakeSent = false;
+        BotHuman *_avatar   = nullptr;
+
+        std::mt19937 _rng;
+        Clock::time_point _spawnedAt {};
+        Clock::time_point _nextUpdate {};
+        Clock::time_point _nextChat {};
+        Clock::time_point _nextEvent {};
+        Clock::time_point _nextProbe {};
+        Clock::time_point _jumpUntil {};
+        Clock::time_point _castUntil {};
+        float _angle   = 0.0f;
+        float _radius  = 0.0f;
+        float _originX = 0.0f;
+        float _originY = 0.0f;
+
+        uint32_t _probeSeq = 0;
+        // Script event names sent up on this connection (Shared::RPC::ScriptEvent).
+        Shared::EventNameEncoder _eventNames;
+        BotSample _sample;
+        uint64_t _lastBytesSent = 0;
+        uint64_t _lastBytesRecv = 0;
+    };
+
+    // Stand-in for the game client's ClientHuman: the same replicated type, with no game behind it. The
+    // bot's own avatar reports itself to its Bot; everyone else's replicas are just received and kept.
+    class BotHuman final: public Shared::HumanEntity {
+      public:
+        ~BotHuman() override;
+        void OnConstructed() override;
+    };
+} // namespace HogwartsMP::Bots
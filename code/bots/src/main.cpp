@@ -0,0 +1,157 @@
+#include "logging/logger.h"
+
+#include "bot.h"
+#include "report.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace HogwartsMP::Bots;
+
+// HogwartsMPBots [--host <addr>] [--port <port>] [--bots <n>] [--ramp <bots/s>] [--duration <s>]
+//                [--rate <hz>] [--chat-every <s>] [--emit-every <s>] [--probe-every <s>]
+//                [--report-every <s>] [--tick-budget-ms <ms>] [--json <out.json>]
+// Connects --bots simulated players to a running server (started with --load-test, so that it answers
+// the probes), --ramp per second, and prints the server's tick time, per-client bandwidth and RPC round
+// trips every --report-every seconds. At the end it names the first window whose server tick went over
+// --tick-budget-ms, and how many bots it took.
+// Exits 2 on a usage or I/O error.
+int main(int argc, char **argv) {
+    BotOptions options;
+    int botCount        = 64;
+    double rampPerS     = 16.0;
+    double durationS    = 120.0;
+    double reportEveryS = 5.0;
+    double tickBudgetMs = 50.0;
+    std::string jsonPath;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            std::fprintf(stderr, "Missing value for %s\n", arg.c_str());
+            return 2;
+        }
+        const char *value = argv[++i];
+        if (arg == "--host") {
+            options.host = value;
+        }
+        else if (arg == "--port") {
+            options.port = static_cast<uint16_t>(std::atoi(value));
+        }
+        else if (arg == "--bots") {
+            botCount = std::max(0, std::atoi(value));
+        }
+        else if (arg == "--ramp") {
+            rampPerS = std::atof(value);
+        }
+        else if (arg == "--duration") {
+            durationS = std::atof(value);
+        }
+        else if (arg == "--rate") {
+            options.updateHz = static_cast<float>(std::atof(value));
+        }
+        else if (arg == "--chat-every") {
+            options.chatEveryS = static_cast<float>(std::atof(value));
+        }
+        else if (arg == "--emit-every") {
+            options.emitEveryS = static_cast<float>(std::atof(value));
+        }
+        else if (arg == "--probe-every") {
+            options.probeEveryS = static_cast<float>(std::atof(value));
+        }
+        else if (arg == "--report-every") {
+            reportEveryS = std::max(0.1, std::atof(value));
+        }
+        else if (arg == "--tick-budget-ms") {
+            tickBudgetMs = std::atof(value);
+        }
+        else if (arg == "--json") {
+            jsonPath = value;
+        }
+        else {
+            std::fprintf(stderr, "Unknown option %s\n", arg.c_str());
+            return 2;
+        }
+    }
+
+    // Hundreds of clients' connection logs would drown the report.
+    Framework::Logging::GetInstance()->PauseLogging(true);
+    Bot::RegisterTypes();
+
+    std::vector<std::unique_ptr<Bot>> bots;
+    bots.reserve(static_cast<size_t>(botCount));
+    std::vector<WindowReport> windows;
+    ReportBuilder builder;
+
+    const auto start   = Clock::now();
+    const auto seconds = [&](Clock::time_point t) {
+        return std::chrono::duration<double>(t - start).count();
+    };
+    double nextReportS = reportEveryS;
+    double lastReportS = 0.0;
+
+    // Single-threaded, like the game client: every bot is pumped once per loop iteration.
+    for (auto now = start; seconds(now) < durationS; now = Clock::now()) {
+        // Everyone who should have started by now under the ramp (all at once for --ramp 0).
+        const auto due = rampPerS > 0.0 ? std::min<size_t>(static_cast<size_t>(seconds(now) * rampPerS) + 1, static_cast<size_t>(botCount)) : static_cast<size_t>(botCount);
+        while (bots.size() < due) {
+            auto bot = std::make_unique<Bot>(static_cast<int>(bots.size()), options);
+            if (!bot->Start()) {
+                std::fprintf(stderr, "%s: could not start a network client\n", bot->Nickname().c_str());
+            }
+            bots.push_back(std::move(bot));
+        }
+
+        for (auto &bot : bots) {
+            bot->Update(now);
+        }
+
+        if (seconds(now) >= nextReportS) {
+            size_t connected = 0;
+            size_t ready     = 0;
+            for (auto &bot : bots) {
+                connected += bot->IsConnected() ? 1 : 0;
+                ready += bot->IsReady() ? 1 : 0;
+                builder.Add(bot->TakeSample());
+            }
+            const double atS = seconds(now);
+            windows.push_back(builder.Finish(atS, atS - lastReportS, bots.size(), connected, ready));
+            std::printf("%s\n", FormatWindow(windows.back()).c_str());
+            std::fflush(stdout);
+            lastReportS = atS;
+            nextReportS += reportEveryS;
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    for (auto &bot : bots) {
+        bot->Stop();
+    }
+
+    const auto over = std::find_if(windows.begin(), windows.end(), [&](const WindowReport &r) {
+        return r.tickMaxMs > tickBudgetMs;
+    });
+    if (over != windows.end()) {
+        std::printf("Server tick first went over %.1f ms at %.1fs, with %zu bots ready.\n", tickBudgetMs, over->atS, over->ready);
+    }
+    else {
+        std::printf("Server tick stayed within %.1f ms for the whole run.\n", tickBudgetMs);
+    }
+
+    if (!jsonPath.empty()) {
+        std::ofstream out(jsonPath);
+        out << ToJson(windows) << '\n';
+        if (!out) {
+            std::fprintf(stderr, "Cannot write %s\n", jsonPath.c_str());
+            return 2;
+        }
+    }
+    return 0;
+}
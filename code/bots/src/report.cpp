@@ -0,0 +1,79 @@
+#include "report.h"
+
+#include <fmt/format.h>
+
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace HogwartsMP::Bots {
+    void ReportBuilder::Add(BotSample sample) {
+        _rtt.insert(_rtt.end(), sample.rttMs.begin(), sample.rttMs.end());
+        _tickMs    = std::max(_tickMs, sample.tickMs);
+        _tickMaxMs = std::max(_tickMaxMs, sample.tickMaxMs);
+        _bytesUp += sample.bytesSent;
+        _bytesDown += sample.bytesRecv;
+    }
+
+    WindowReport ReportBuilder::Finish(double atS, double windowS, size_t started, size_t connected, size_t ready) {
+        WindowReport report;
+        report.atS       = atS;
+        report.started   = started;
+        report.connected = connected;
+        report.ready     = ready;
+        report.tickMs    = _tickMs;
+        report.tickMaxMs = _tickMaxMs;
+        report.probes    = _rtt.size();
+        if (connected > 0 && windowS > 0.0) {
+            const double perClient = windowS * static_cast<double>(connected);
+            report.upKbps          = static_cast<double>(_bytesUp) * 8.0 / 1000.0 / perClient;
+            report.downKbps        = static_cast<double>(_bytesDown) * 8.0 / 1000.0 / perClient;
+        }
+        report.rttP50Ms = Percentile(_rtt, 50.0);
+        report.rttP90Ms = Percentile(_rtt, 90.0);
+        report.rttP99Ms = Percentile(_rtt, 99.0);
+        report.rttMaxMs = Percentile(_rtt, 100.0);
+
+        *this = {};
+        return report;
+    }
+
+    float ReportBuilder::Percentile(std::vector<float> &values, double p) {
+        if (values.empty()) {
+            return 0.0f;
+        }
+        const auto rank = static_cast<size_t>(std::ceil(std::clamp(p, 0.0, 100.0) / 100.0 * static_cast<double>(values.size())));
+        const auto nth  = values.begin() + static_cast<std::ptrdiff_t>(std::max<size_t>(rank, 1) - 1);
+        std::nth_element(values.begin(), nth, values.end());
+        return *nth;
+    }
+
+    std::string FormatWindow(const WindowReport &r) {
+        return fmt::format("[{:7.1f}s] bots {}/{}/{} (started/connected/ready) | tick {:.2f} ms, max {:.2f} ms | "
+                           "per client {:.1f} kbps up, {:.1f} kbps down | rtt p50 {:.1f} p90 {:.1f} p99 {:.1f} max {:.1f} ms ({} probes)",
+            r.atS, r.started, r.connected, r.ready, r.tickMs, r.tickMaxMs, r.upKbps, r.downKbps, r.rttP50Ms, r.rttP90Ms, r.rttP99Ms, r.rttMaxMs, r.probes);
+    }
+
+    std::string ToJson(const std::vector<WindowReport> &windows) {
+        auto list = nlohmann::json::array();
+        for (const auto &r : windows) {
+            list.push_back({
+                {"atS", r.atS},
+                {"started", r.started},
+                {"connected", r.connected},
+                {"ready", r.ready},
+                {"tickMs", r.tickMs},
+                {"tickMaxMs", r.tickMaxMs},
+                {"upKbps", r.upKbps},
+                {"downKbps", r.downKbps},
+                {"probes", r.probes},
+                {"rttP50Ms", r.rttP50Ms},
+                {"rttP90Ms", r.rttP90Ms},
+                {"rttP99Ms", r.rttP99Ms},
+                {"rttMaxMs", r.rttMaxMs},
+            });
+        }
+        return nlohmann::json {{"windows", list}}.dump(2);
+    }
+} // namespace HogwartsMP::Bots
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "bot.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace HogwartsMP::Bots {
+    // One reporting window, aggregated over every bot.
+    struct WindowReport {
+        double atS       = 0.0;  // since the run started
+        size_t started   = 0;    // bots launched so far
+        size_t connected = 0;    // transport up
+        size_t ready     = 0;    // handshake done, avatar owned
+        float tickMs     = 0.0f; // server tick interval, smoothed (latest probe reply)
+        float tickMaxMs  = 0.0f; // longest server tick in the last second (worst reply this window)
+        double upKbps    = 0.0;  // per connected client
+        double downKbps  = 0.0;
+        size_t probes    = 0;    // LoadProbe round trips completed this window
+        float rttP50Ms   = 0.0f;
+        float rttP90Ms   = 0.0f;
+        float rttP99Ms   = 0.0f;
+        float rttMaxMs   = 0.0f;
+    };
+
+    // Collects BotSamples over a window and folds them into a WindowReport.
+    class ReportBuilder final {
+      public:
+        void Add(BotSample sample);
+        WindowReport Finish(double atS, double windowS, size_t started, size_t connected, size_t ready);
+
+        // Nearest-rank percentile (p in [0, 100]) of values, which it reorders; 0 for none.
+        static float Percentile(std::vector<float> &values, double p);
+
+      private:
+        std::vector<float> _rtt;
+        float _tickMs       = 0.0f;
+        float _tickMaxMs    = 0.0f;
+        uint64_t _bytesUp   = 0;
+        uint64_t _bytesDown = 0;
+    };
+
+    std::string FormatWindow(const WindowReport &report);
+    // {"windows": [...]} for --json.
+    std::string ToJson(const std::vector<WindowReport> &windows);
+} // namespace HogwartsMP::Bots
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "shared/modules/appearance.hpp"
+
+#include <array>
+#include <random>
+#include <string>
+
+namespace HogwartsMP::Bots {
+    // A player-sized appearance with allowlisted paths, varied per bot: the four body slots with the
+    // identity overrides a real profile carries (tints, skin/eye textures, a few scalars) and one
+    // eight-piece outfit — about the size the game client sends.
+    inline Shared::Modules::CcdProfile SampleCcd(std::mt19937 &rng) {
+        using namespace Shared::Modules;
+        std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+        const auto piece = [&](const std::string &name, int scalars, int vectors, int textures) {
+            CcdPiece p;
+            p.characterPiece = "/Game/Data/CC/CharacterPieces/" + name + "/DA_" + name + ".DA_" + name;
+            for (int i = 0; i < scalars; ++i) {
+                p.scalars.emplace_back("Scalar_" + std::to_string(i), unit(rng));
+            }
+            for (int i = 0; i < vectors; ++i) {
+                p.vectors.emplace_back("Tint_" + std::to_string(i), std::array<float, 4> {unit(rng), unit(rng), unit(rng), 1.0f});
+            }
+            for (int i = 0; i < textures; ++i) {
+                p.textures.emplace_back("Texture_" + std::to_string(i), "/Game/RiggedObjects/Characters/Human/Textures/T_" + name + "_" + std::to_string(rng() % 8));
+            }
+            return p;
+        };
+
+        CcdProfile ccd;
+        ccd.gender = static_cast<uint8_t>(rng() % 2);
+        ccd.scale  = 0.95f + 0.1f * unit(rng);
+        for (int i = 0; i < 12; ++i) {
+            ccd.boneScales.emplace_back("bone_" + std::to_string(i), 0.9f + 0.2f * unit(rng));
+        }
+        for (const char *slot : {"Head", "Hair", "Arms", "Legs"}) {
+            ccd.characterItems.emplace_back(slot, piece(slot, 6, 5, 4));
+        }
+        CcdPieceMap outfit;
+        for (int i = 0; i < 8; ++i) {
+            outfit.emplace_back("Slot" + std::to_string(i), piece("Robe" + std::to_string(rng() % 4), 1, 2, 1));
+        }
+        ccd.outfits.emplace_back("Default", std::move(outfit));
+        return ccd;
+    }
+} // namespace HogwartsMP::Bots
@@ -26,6 +26,7 @@
 #include <networking/replication/replication_manager.h>
 #include <scripting/engine.h>
 
+#include "shared/rpc/script_event.h"
 #include "shared/rpc/set_appearance.h"
 #include "shared/rpc/set_weather.h"
 
@@ -281,6 +282,7 @@ namespace HogwartsMP::Core {
 
     void Application::OnConnectionFinalized(float serverTickRate) {
         _tickInterval = serverTickRate;
+        Scripting::ClientGame::ResetEventNames();
         _stateMachine->RequestNextState(States::StateIds::SessionConnected);
 
         Framework::Logging::GetLogger(FRAMEWORK_INNER_NETWORKING)->info("Connection established!");
@@ -288,6 +290,7 @@ namespace HogwartsMP::Core {
 
     void Application::OnConnectionClosed() {
         Framework::Logging::GetLogger(FRAMEWORK_INNER_NETWORKING)->info("Connection lost!");
+        Scripting::ClientGame::ResetEventNames();
         _stateMachine->RequestNextState(States::StateIds::SessionDisconnection);
     }
 
@@ -378,6 +381,12 @@ namespace HogwartsMP::Core {
             g_envApplied = false; // re-apply this (new) state once in-world
         });
 
+        // Script events from player.emit / World.emitAllClients (and their packed twins): straight into
+        // the client scripts' Core.Events.
+        net->RegisterRPC<Shared::RPC::ScriptEvent>([](const Shared::RPC::ScriptEvent &msg, MafiaNet::Packet *) {
+            Scripting::ClientGame::DispatchEvent(msg);
+        });
+
         // Live appearance change: store it on the replica and (re)dress the proxy.
         net->RegisterRPC<Shared::RPC::AppearanceUpdate>([](const Shared::RPC::AppearanceUpdate &msg, MafiaNet::Packet *) {
             auto *repl  = Framework::CoreModules::GetReplication();
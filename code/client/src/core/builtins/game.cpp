@@ -4,7 +4,13 @@
 #include "core/teleport.h"
 #include "sdk/reflection/ue4_reflection.h"
 
-#include <integrations/shared/rpc/emit_lua_event.h>
+#include "shared/rpc/script_event.h"
+#include "shared/script_payload_v8.h"
+
+#include <integrations/client/scripting/module.h>
+#include <logging/logger.h>
+#include <scripting/engine.h>
+#include <scripting/resource/resource_manager.h>
 
 #include <v8.h>
 #include <v8pp/convert.hpp>
@@ -14,6 +20,7 @@
 #include <type_traits>
 #include <utility>
 #include <variant>
+#include <vector>
 
 namespace HogwartsMP::Scripting {
     namespace {
@@ -28,25 +35,61 @@ namespace HogwartsMP::Scripting {
             }
         }
 
-        // Game.emitServer(name, payloadJson): send a named event up to the server's scripts. The
-        // client has a single peer (the server), so BroadcastRPC reaches it. Server scripts receive it
-        // as Core.Events.on(name, (player, payload) => ...); payloadJson is JSON.parsed there, so pass
-        // JSON text (e.g. JSON.stringify(obj)).
-        void EmitServer(std::string eventName, std::string payloadJson) {
-            auto *app = HogwartsMP::Core::gApplication.get();
-            if (!app) {
-                return;
-            }
-            auto *engine = app->GetNetworkingEngine();
+        // This connection's script event name tables (Shared::RPC::ScriptEvent): names sent up to the
+        // server, and names the server has defined coming down. Reset with the connection.
+        Shared::EventNameEncoder g_namesToServer;
+        Shared::EventNameDecoder g_namesFromServer;
+
+        // The client has a single peer (the server), so BroadcastRPC reaches it.
+        void SendToServer(const std::string &eventName, Shared::RPC::ScriptEvent &ev) {
+            auto *app    = HogwartsMP::Core::gApplication.get();
+            auto *engine = app ? app->GetNetworkingEngine() : nullptr;
             auto *net    = engine ? engine->GetNetworkClient() : nullptr;
             if (!net) {
                 return;
             }
-            Framework::Integrations::Shared::RPC::EmitLuaEvent ev;
-            ev.FromParameters(eventName, payloadJson);
+            ev.SetName(eventName, g_namesToServer);
             net->BroadcastRPC(ev);
         }
 
+        // Game.emitServer(name, payloadJson): send a named event up to the server's scripts. Server
+        // scripts receive it as Core.Events.on(name, (player, payload) => ...); payloadJson is
+        // JSON.parsed there, so pass JSON text (e.g. JSON.stringify(obj)).
+        void EmitServer(std::string eventName, std::string payloadJson) {
+            Shared::RPC::ScriptEvent ev;
+            ev.payload = std::move(payloadJson);
+            SendToServer(eventName, ev);
+        }
+
+        // Game.emitServerPacked(name, value): emitServer without the JSON text. value (plain data: objects,
+        // arrays, strings, numbers, booleans, null, ArrayBuffers) is packed natively and the server unpacks
+        // it straight into the handler's payload argument. For events sent every frame.
+        void JsEmitServerPacked(const v8::FunctionCallbackInfo<v8::Value> &info) {
+            auto *isolate = info.GetIsolate();
+            if (info.Length() < 2 || !info[0]->IsString()) {
+                isolate->ThrowException(v8::Exception::TypeError(v8pp::to_v8(isolate, "emitServerPacked(name, value) requires an event name")));
+                return;
+            }
+            const auto eventName = v8pp::from_v8<std::string>(isolate, info[0]);
+            Shared::RPC::ScriptEvent ev;
+            ev.encoding = Shared::RPC::ScriptEvent::Packed;
+            bool packed = false;
+            {
+                v8::TryCatch tryCatch(isolate);
+                packed = Shared::ScriptPayload::Pack(isolate, isolate->GetCurrentContext(), info[1], ev.payload);
+                if (tryCatch.HasCaught()) {
+                    tryCatch.ReThrow();
+                    return;
+                }
+            }
+            if (!packed || ev.payload.size() > Shared::ScriptPayload::kMaxBytes) {
+                isolate->ThrowException(v8::Exception::TypeError(
+                    v8pp::to_v8(isolate, "emitServerPacked: value must be plain data (no functions or symbols), under 64 KiB and 32 levels deep")));
+                return;
+            }
+            SendToServer(eventName, ev);
+        }
+
         // UFunction param blocks — layout must match the engine's K2_GetActor* signatures exactly.
         // float members match UE4's FVector/FRotator (Hogwarts Legacy is UE4.27);
         struct Vec3f {
@@ -201,7 +244,10 @@ namespace HogwartsMP::Scripting {
         v8pp::module gameModule(isolate);
         gameModule.function("notify", &Notify);
         gameModule.function("emitServer", &EmitServer);
-        global->Set(ctx, v8pp::to_v8(isolate, "Game"), gameModule.new_instance()).Check();
+        auto game = gameModule.new_instance();
+        game->Set(ctx, v8pp::to_v8(isolate, "emitServerPacked"), v8::FunctionTemplate::New(isolate, &JsEmitServerPacked)->GetFunction(ctx).ToLocalChecked())
+            .Check();
+        global->Set(ctx, v8pp::to_v8(isolate, "Game"), game).Check();
 
         // LocalPlayer: read-only access to the local pawn's live transform. getPosition/getRotation
         // need the isolate + return objects, so they're raw FunctionTemplates rather than v8pp funcs.
@@ -226,4 +272,50 @@ namespace HogwartsMP::Scripting {
             .Check();
         global->Set(ctx, v8pp::to_v8(isolate, "LocalPlayer"), localPlayer).Check();
     }
+
+    void ClientGame::ResetEventNames() {
+        g_namesToServer.Reset();
+        g_namesFromServer.Reset();
+    }
+
+    void ClientGame::DispatchEvent(const Shared::RPC::ScriptEvent &ev) {
+        const std::string *eventName = ev.ResolveName(g_namesFromServer);
+        if (!eventName) {
+            Framework::Logging::GetLogger("Scripting")->warn("Dropping server event with unknown name id {}", ev.nameId);
+            return;
+        }
+        auto *app       = HogwartsMP::Core::gApplication.get();
+        auto *scripting = app ? app->GetScriptingModule() : nullptr;
+        auto *engine    = scripting ? scripting->GetEngine() : nullptr;
+        auto *resources = scripting ? scripting->GetResourceManager() : nullptr;
+        if (!engine || !resources) {
+            return;
+        }
+        v8::Isolate *isolate = engine->GetIsolate();
+        v8::Locker locker(isolate);
+        v8::Isolate::Scope isolateScope(isolate);
+        v8::HandleScope handleScope(isolate);
+        v8::Local<v8::Context> context = engine->GetContext();
+        v8::Context::Scope contextScope(context);
+
+        // An empty JSON payload calls the handlers with no argument.
+        std::vector<v8::Local<v8::Value>> args;
+        v8::Local<v8::Value> value;
+        if (ev.encoding == Shared::RPC::ScriptEvent::Packed) {
+            if (!Shared::ScriptPayload::Unpack(isolate, context, ev.payload).ToLocal(&value)) {
+                Framework::Logging::GetLogger("Scripting")->warn("Dropping server event '{}': malformed packed payload", *eventName);
+                return;
+            }
+            args.push_back(value);
+        }
+        else if (!ev.payload.empty()) {
+            v8::TryCatch tryCatch(isolate);
+            if (!v8::JSON::Parse(context, v8pp::to_v8(isolate, ev.payload)).ToLocal(&value)) {
+                Framework::Logging::GetLogger("Scripting")->warn("Dropping server event '{}': malformed JSON payload", *eventName);
+                return;
+            }
+            args.push_back(value);
+        }
+        resources->GetEvents().EmitReserved(isolate, context, *eventName, args);
+    }
 } // namespace HogwartsMP::Scripting
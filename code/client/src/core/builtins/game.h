@@ -1,18 +1,27 @@
 #pragma once
 
+#include "shared/rpc/script_event.h"
+
 #include <v8.h>
 
 namespace HogwartsMP::Scripting {
     // Client-side game builtins, registered onto the V8 global by Application::ModuleRegister when a
     // connection's scripting engine comes up. This is the seam where client JS reaches the live game.
     // Currently exposes:
-    //   Game.notify(text)            - append a line to the local chat UI
-    //   Game.emitServer(name, json)  - send a named event up to the server's scripts
-    //   LocalPlayer.getPosition()    - { x, y, z } | null (the local pawn's world location)
-    //   LocalPlayer.getRotation()    - { pitch, yaw, roll } degrees | null
+    //   Game.notify(text)              - append a line to the local chat UI
+    //   Game.emitServer(name, json)    - send a named event up to the server's scripts
+    //   Game.emitServerPacked(name, v) - the same with a natively packed payload (no JSON text)
+    //   LocalPlayer.getPosition()      - { x, y, z } | null (the local pawn's world location)
+    //   LocalPlayer.getRotation()      - { pitch, yaw, roll } degrees | null
     // Future additions (more reads, HUD, and eventually a guarded reflection bridge) hang off here.
     class ClientGame final {
       public:
         static void Register(v8::Isolate *isolate, v8::Local<v8::Object> global);
+        // A server ScriptEvent (player.emit / emitPacked, World.emitAllClients / emitAllClientsPacked):
+        // resolve its interned name, parse or unpack the payload and dispatch it to Core.Events handlers as
+        // their single argument. Dropped when the name id is unknown or the payload does not decode.
+        static void DispatchEvent(const Shared::RPC::ScriptEvent &ev);
+        // Forget both directions' interned event names; on every (dis)connect, as the server does.
+        static void ResetEventNames();
     };
 } // namespace HogwartsMP::Scripting
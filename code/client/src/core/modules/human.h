@@ -1,6 +1,7 @@
 #pragma once
 
 #include "shared/game/human.h"
+#include "shared/game/human_pool.h"
 #include "core/proxy_locomotion.h"
 #include "core/snapshot_interpolator.h"
 
@@ -20,8 +21,26 @@ namespace HogwartsMP::Core::Modules {
     // same type id into a ClientHuman. On construction it binds the local player (when we own it) or
     // spawns a student proxy (remote players and server NPCs). Per frame it pushes the local player's
     // transform upstream, or interpolates the proxy toward the replicated transform.
+    // Instances are recycled through HumanPool (DeallocReplica's delete returns them), so NPCs streaming
+    // in and out reuse their memory.
     class ClientHuman final: public Shared::HumanEntity {
       public:
+        using Pool = Shared::HumanPool<ClientHuman>;
+
+        ClientHuman() {
+            Pool::Adopt(*this);
+        }
+        ~ClientHuman() override {
+            Pool::Retire(*this);
+        }
+
+        static void *operator new(size_t size) {
+            return Pool::Allocate(size);
+        }
+        static void operator delete(void *block, size_t size) {
+            Pool::Release(block, size);
+        }
+
         void OnConstructed() override;
         void DeallocReplica(MafiaNet::Connection_RM3 *sourceConnection) override;
 
@@ -5,6 +5,7 @@
 #include <scripting/builtins/entity.h>
 
 #include "human.h"
+#include "profiler.h"
 #include "storage.h"
 #include "world.h"
 
@@ -20,9 +21,10 @@ namespace HogwartsMP::Scripting {
             Framework::Scripting::Builtins::Entity::Register(isolate, frameworkObj);
             Scripting::Human::Register(isolate, frameworkObj);
 
-            // Register module singletons on global for direct access (World, Environment, Storage).
+            // Register module singletons on global for direct access (World, Environment, Storage, Profiler).
             Scripting::World::Register(isolate, global);
             Scripting::Storage::Register(isolate, global);
+            Scripting::Profiler::Register(isolate, global);
         }
     };
 } // namespace HogwartsMP::Scripting
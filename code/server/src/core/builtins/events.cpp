@@ -1,26 +1,96 @@
 #include "events.h"
+#include "human.h"
+#include "profiler.h"
 
+#include "core/metrics/tick_profiler.h"
 #include "core/server.h"
 
+#include "shared/script_payload_v8.h"
+
 #include <integrations/server/scripting/module.h>
+#include <logging/logger.h>
 #include <scripting/node_engine.h>
 #include <scripting/resource/resource_manager.h>
 
+#include <v8pp/class.hpp>
+#include <v8pp/convert.hpp>
+
 namespace HogwartsMP::Scripting {
+    namespace {
+        bool g_draining = false;
 
-    void EmitServerEvent(const std::string &eventName, const EventArgsBuilder &buildArgs) {
+        const char *ReservedName(Core::Events::Kind kind) {
+            switch (kind) {
+            case Core::Events::Kind::PlayerConnect: return "playerConnect";
+            case Core::Events::Kind::PlayerDied: return "playerDied";
+            case Core::Events::Kind::ChatMessage: return "chatMessage";
+            case Core::Events::Kind::ChatCommand: return "chatCommand";
+            case Core::Events::Kind::NpcArrived: return "npcArrived";
+            default: return nullptr;
+            }
+        }
+
+        // The handler arguments for queued event index, matching what the direct emitters used to pass.
+        // False when a client payload does not parse: the event is dropped rather than dispatched with a
+        // missing argument.
+        bool BuildArgs(v8::Isolate *isolate, v8::Local<v8::Context> context, const Core::Events::EventQueue &queue, size_t index,
+                       std::vector<v8::Local<v8::Value>> &args) {
+            const auto event = queue.At(index);
+            args.push_back(Human::Wrap(isolate, event.networkId));
+            switch (event.kind) {
+            case Core::Events::Kind::ChatMessage: args.push_back(v8pp::to_v8(isolate, event.text)); break;
+            case Core::Events::Kind::ChatCommand: {
+                v8::Local<v8::Array> argsArray = v8::Array::New(isolate, static_cast<int>(event.argCount));
+                for (size_t i = 0; i < event.argCount; ++i) {
+                    argsArray->Set(context, static_cast<uint32_t>(i), v8pp::to_v8(isolate, queue.Arg(index, i))).Check();
+                }
+                args.push_back(v8pp::to_v8(isolate, event.text));
+                args.push_back(v8pp::to_v8(isolate, event.name));
+                args.push_back(argsArray);
+                break;
+            }
+            case Core::Events::Kind::ClientEvent: {
+                // Empty payload: the handler gets just the player. The size and nesting were bounded when
+                // it was queued; this parse is the only one, and doubles as the validation.
+                if (event.text.empty()) {
+                    break;
+                }
+                v8::TryCatch tryCatch(isolate);
+                v8::Local<v8::String> jsonStr;
+                v8::Local<v8::Value> parsed;
+                if (!v8::String::NewFromUtf8(isolate, event.text.data(), v8::NewStringType::kNormal, static_cast<int>(event.text.size())).ToLocal(&jsonStr) ||
+                    !v8::JSON::Parse(context, jsonStr).ToLocal(&parsed)) {
+                    return false;
+                }
+                args.push_back(parsed);
+                break;
+            }
+            case Core::Events::Kind::PackedEvent: {
+                v8::Local<v8::Value> unpacked;
+                if (!Shared::ScriptPayload::Unpack(isolate, context, event.text).ToLocal(&unpacked)) {
+                    return false;
+                }
+                args.push_back(unpacked);
+                break;
+            }
+            default: break;
+            }
+            return true;
+        }
+    } // namespace
+
+    bool RunInServerContext(const ContextFn &fn) {
         const auto server = HogwartsMP::Server::_serverRef;
         if (!server)
-            return;
+            return false;
 
         const auto scriptingModule = server->GetScriptingModule();
         if (!scriptingModule)
-            return;
+            return false;
 
-        auto *engine          = scriptingModule->GetEngine();
-        auto *resourceManager = scriptingModule->GetResourceManager();
-        if (!engine || !resourceManager || !engine->IsInitialized())
-            return;
+        auto *engine = scriptingModule->GetEngine();
+        if (!engine || !engine->IsInitialized())
+            return false;
 
         v8::Isolate *isolate = engine->GetIsolate();
         v8::Locker locker(isolate);
@@ -29,10 +99,74 @@ namespace HogwartsMP::Scripting {
         v8::Local<v8::Context> context = engine->GetContext();
         v8::Context::Scope contextScope(context);
 
-        std::vector<v8::Local<v8::Value>> args;
-        buildArgs(isolate, context, args);
+        fn(isolate, context);
+        return true;
+    }
+
+    void EmitServerEvent(const std::string &eventName, const EventArgsBuilder &buildArgs) {
+        const auto server = HogwartsMP::Server::_serverRef;
+        if (!server)
+            return;
+
+        const auto scriptingModule = server->GetScriptingModule();
+        if (!scriptingModule)
+            return;
+
+        auto *resourceManager = scriptingModule->GetResourceManager();
+        if (!resourceManager)
+            return;
+
+        Core::Metrics::ScopedPhase phase(Core::Metrics::Phase::ScriptEvents);
+        RunInServerContext([&](v8::Isolate *isolate, v8::Local<v8::Context> context) {
+            std::vector<v8::Local<v8::Value>> args;
+            buildArgs(isolate, context, args);
+
+            Profiler::Dispatch dispatch(isolate, eventName);
+            resourceManager->GetEvents().EmitReserved(isolate, context, eventName, args);
+        });
+    }
+
+    Core::Events::EventQueue &ServerEventQueue() {
+        static Core::Events::EventQueue queue;
+        return queue;
+    }
+
+    void DrainServerEvents() {
+        auto &queue = ServerEventQueue();
+        if (queue.Empty() || g_draining) {
+            return;
+        }
+        const auto server          = HogwartsMP::Server::_serverRef;
+        const auto scriptingModule = server ? server->GetScriptingModule() : nullptr;
+        auto *resourceManager      = scriptingModule ? scriptingModule->GetResourceManager() : nullptr;
+        if (!resourceManager) {
+            queue.Clear();
+            return;
+        }
+
+        g_draining = true;
+        RunInServerContext([&](v8::Isolate *isolate, v8::Local<v8::Context> context) {
+            std::vector<v8::Local<v8::Value>> args;
+            // Size() is re-read each time: handlers may queue more events, which run in this drain.
+            for (size_t i = 0; i < queue.Size(); ++i) {
+                Core::Metrics::ScopedPhase phase(Core::Metrics::Phase::ScriptEvents);
+                v8::HandleScope handleScope(isolate);
+                const auto event     = queue.At(i);
+                const char *reserved = ReservedName(event.kind);
+                // Owned copy: a handler queueing events may grow the arena the view points into.
+                const std::string eventName = reserved ? std::string(reserved) : std::string(event.name);
+                args.clear();
+                if (!BuildArgs(isolate, context, queue, i, args)) {
+                    Framework::Logging::GetLogger("Scripting")->warn("Dropping client event '{}' from {}: malformed payload", eventName, event.networkId);
+                    continue;
+                }
 
-        resourceManager->GetEvents().EmitReserved(isolate, context, eventName, args);
+                Profiler::Dispatch dispatch(isolate, eventName);
+                resourceManager->GetEvents().EmitReserved(isolate, context, eventName, args);
+            }
+        });
+        queue.Clear();
+        g_draining = false;
     }
 
     size_t GetServerEventListenerCount(const std::string &eventName) {
@@ -2,12 +2,23 @@
 
 #include <v8.h>
 
+#include "core/events/event_queue.h"
+
 #include <functional>
 #include <string>
 #include <vector>
 
 namespace HogwartsMP::Scripting {
     using EventArgsBuilder = std::function<void(v8::Isolate *, v8::Local<v8::Context>, std::vector<v8::Local<v8::Value>> &)>;
+    using ContextFn        = std::function<void(v8::Isolate *, v8::Local<v8::Context>)>;
+
+    /**
+     * Run fn inside the server's isolate and context (locked, with a handle
+     * scope), for native code that calls into JS outside a JS callback.
+     * Returns false without calling fn when the scripting engine is not
+     * available or not initialized.
+     */
+    bool RunInServerContext(const ContextFn &fn);
 
     /**
      * Emit an event from native code into the server's JS resources.
@@ -17,6 +28,20 @@ namespace HogwartsMP::Scripting {
      */
     void EmitServerEvent(const std::string &eventName, const EventArgsBuilder &buildArgs);
 
+    /**
+     * The native events waiting for the next DrainServerEvents. Network handlers push here instead of
+     * emitting one by one, so a burst of joins or chat costs one isolate lock per tick, not one each.
+     */
+    Core::Events::EventQueue &ServerEventQueue();
+
+    /**
+     * Dispatch every queued event to the server's JS resources, in order, under one isolate lock and
+     * context entry, then clear the queue. Called from the server tick, and before a dispatch that
+     * must not overtake queued events (a disconnect). Events pushed by handlers meanwhile run in the
+     * same drain. The queue is dropped when the scripting engine is not available.
+     */
+    void DrainServerEvents();
+
     /**
      * Number of JS listeners currently registered for the given event,
      * or 0 when the scripting engine is unavailable.
@@ -2,14 +2,17 @@
 
 #include "events.h"
 #include "storage.h"
+#include "world.h"
 
+#include "core/events/script_events.h"
+#include "core/modules/human.h"
 #include "core/server.h"
 
 #include "shared/game/human.h"
+#include "shared/rpc/script_event.h"
 #include "shared/rpc/set_appearance.h"
 
 #include <core_modules.h>
-#include <integrations/shared/rpc/emit_lua_event.h>
 #include <networking/network_peer.h>
 #include <networking/replication/replication_manager.h>
 #include <networking/rpc/chat_message.h>
@@ -18,51 +21,57 @@
 
 #include <mafianet/types.h>
 
+#include <glm/glm.hpp>
+
 #include <algorithm>
 #include <cmath>
 #include <sstream>
+#include <vector>
 
 namespace HogwartsMP::Scripting {
 
     namespace {
         Shared::HumanEntity *ResolveHuman(uint64_t networkId) {
-            auto *repl = Framework::CoreModules::GetReplication();
-            return repl ? dynamic_cast<Shared::HumanEntity *>(repl->GetEntityByNetworkID(networkId)) : nullptr;
+            return Core::Modules::Human::Find(networkId);
         }
 
-        // Emit a player lifecycle event with a Human JS object argument.
+        // Emit a player lifecycle event with a Human JS object argument, now rather than on the next tick.
         void EmitHumanEvent(uint64_t networkId, const std::string &eventName) {
             EmitServerEvent(eventName, [networkId](v8::Isolate *isolate, v8::Local<v8::Context>, std::vector<v8::Local<v8::Value>> &args) {
-                args.push_back(v8pp::class_<Human>::create_object(isolate, networkId));
+                args.push_back(Human::Wrap(isolate, networkId));
             });
         }
 
-        // Storage key for a player's namespaced data, or "" when the entity has no stable identity
-        // (a server NPC, or identity not yet recorded). hwid-backed via the server map today; the
-        // identity source can change later without touching the script-facing API.
-        std::string PlayerDataKey(uint64_t networkId, const std::string &userKey) {
+        // The player's storage shard, or nullptr when the entity has no stable identity (a server NPC,
+        // or identity not yet recorded). hwid-backed via the server map today; the identity source can
+        // change later without touching the script-facing API.
+        std::string PlayerIdentity(uint64_t networkId) {
             auto *server = Server::_serverRef;
-            if (!server) {
-                return "";
-            }
-            const std::string id = server->GetPlayerIdentity(networkId);
-            return id.empty() ? std::string() : "player:" + id + ":" + userKey;
+            return server ? server->GetPlayerIdentity(networkId) : std::string {};
+        }
+
+        Core::Storage::KeyValueStore *PlayerData(uint64_t networkId) {
+            return Storage::PlayerStore(PlayerIdentity(networkId));
         }
     } // namespace
 
     void Human::EventPlayerConnected(uint64_t networkId) {
         Framework::Logging::GetLogger("Scripting")->debug("Player connected: {}", networkId);
-        EmitHumanEvent(networkId, "playerConnect");
+        ServerEventQueue().PushPlayerConnect(networkId);
     }
 
     void Human::EventPlayerDisconnected(uint64_t networkId) {
         Framework::Logging::GetLogger("Scripting")->debug("Player disconnected: {}", networkId);
+        // Immediately, while the avatar still resolves and the player's data is loaded; whatever this
+        // player (or anyone) has queued goes first, so handlers never see a disconnect before its connect.
+        DrainServerEvents();
         EmitHumanEvent(networkId, "playerDisconnect");
+        ForgetWrapper(networkId);
     }
 
     void Human::EventPlayerDied(uint64_t networkId) {
         Framework::Logging::GetLogger("Scripting")->debug("Player died: {}", networkId);
-        EmitHumanEvent(networkId, "playerDied");
+        ServerEventQueue().PushPlayerDied(networkId);
     }
 
     std::string Human::ToString() const {
@@ -94,42 +103,49 @@ namespace HogwartsMP::Scripting {
         if (!human) {
             return;
         }
-        auto *peer = Framework::CoreModules::GetNetworkPeer();
-        if (!peer) {
-            return;
-        }
         // Delivered to this player's client scripts as Core.Events.on(eventName, payload); the client
         // JSON.parses payloadJson into the single handler arg, so callers pass JSON text (e.g.
         // JSON.stringify(obj)). Empty payload -> the handler is called with no argument.
-        Framework::Integrations::Shared::RPC::EmitLuaEvent ev;
-        ev.FromParameters(eventName, payloadJson);
-        peer->SendRPC(ev, MafiaNet::ToGuid(human->ownerGUID));
+        Shared::RPC::ScriptEvent ev;
+        ev.payload = std::move(payloadJson);
+        Core::Events::ScriptEvents::Get().Send(static_cast<uint64_t>(human->ownerGUID), eventName, ev);
     }
 
-    void Human::SetData(std::string key, std::string value) {
-        const std::string storageKey = PlayerDataKey(GetId(), key);
-        if (storageKey.empty()) {
+    void Human::JsEmitPacked(const v8::FunctionCallbackInfo<v8::Value> &info) {
+        std::string eventName;
+        Shared::RPC::ScriptEvent ev;
+        if (!World::PackEventArgs(info, "emitPacked", eventName, ev)) {
             return;
         }
-        Storage::Store().Set(storageKey, std::move(value));
-        if (!Storage::Store().Save()) {
-            Framework::Logging::GetLogger("Scripting")->warn("player.setData('{}') failed to persist", key);
+        auto *self        = v8pp::class_<Human>::unwrap_object(info.GetIsolate(), info.This());
+        const auto *human = self ? ResolveHuman(self->GetId()) : nullptr;
+        if (human) {
+            Core::Events::ScriptEvents::Get().Send(static_cast<uint64_t>(human->ownerGUID), eventName, ev);
         }
     }
 
+    void Human::SetData(std::string key, std::string value) {
+        auto *store = PlayerData(GetId());
+        if (!store) {
+            return;
+        }
+        store->Set(key, std::move(value));
+        Storage::Persist(*store);
+    }
+
     bool Human::HasData(std::string key) {
-        const std::string storageKey = PlayerDataKey(GetId(), key);
-        return !storageKey.empty() && Storage::Store().Has(storageKey);
+        const auto *store = PlayerData(GetId());
+        return store && store->Has(key);
     }
 
     bool Human::DeleteData(std::string key) {
-        const std::string storageKey = PlayerDataKey(GetId(), key);
-        if (storageKey.empty()) {
+        auto *store = PlayerData(GetId());
+        if (!store) {
             return false;
         }
-        const bool erased = Storage::Store().Erase(storageKey);
-        if (erased && !Storage::Store().Save()) {
-            Framework::Logging::GetLogger("Scripting")->warn("player.deleteData('{}') failed to persist", key);
+        const bool erased = store->Erase(key);
+        if (erased) {
+            Storage::Persist(*store);
         }
         return erased;
     }
@@ -145,13 +161,12 @@ namespace HogwartsMP::Scripting {
             info.GetReturnValue().SetUndefined();
             return;
         }
-        const auto key               = v8pp::from_v8<std::string>(isolate, info[0]);
-        const std::string storageKey = PlayerDataKey(self->GetId(), key);
-        if (storageKey.empty()) {
+        const auto *store = PlayerData(self->GetId());
+        if (!store) {
             info.GetReturnValue().SetUndefined();
             return;
         }
-        const auto value = Storage::Store().Get(storageKey);
+        const auto value = store->Get(v8pp::from_v8<std::string>(isolate, info[0]));
         if (value) {
             info.GetReturnValue().Set(v8pp::to_v8(isolate, *value));
         }
@@ -160,6 +175,61 @@ namespace HogwartsMP::Scripting {
         }
     }
 
+    void Human::JsIncrData(const v8::FunctionCallbackInfo<v8::Value> &info) {
+        auto *isolate               = info.GetIsolate();
+        constexpr const char *usage = "incrData(key, delta?) requires a string key and a finite number";
+        const bool hasDelta         = info.Length() >= 2 && !info[1]->IsUndefined();
+        const double delta          = !hasDelta ? 1.0 : info[1]->IsNumber() ? info[1].As<v8::Number>()->Value() : std::nan("");
+        if (info.Length() < 1 || !info[0]->IsString() || !std::isfinite(delta)) {
+            isolate->ThrowException(v8::Exception::TypeError(v8pp::to_v8(isolate, usage)));
+            return;
+        }
+        auto *self  = v8pp::class_<Human>::unwrap_object(isolate, info.This());
+        auto *store = self ? PlayerData(self->GetId()) : nullptr;
+        if (!store) {
+            info.GetReturnValue().SetUndefined();
+            return;
+        }
+        if (const auto value = Storage::Increment(isolate, *store, v8pp::from_v8<std::string>(isolate, info[0]), delta)) {
+            info.GetReturnValue().Set(*value);
+        }
+    }
+
+    void Human::JsGetDataAsync(const v8::FunctionCallbackInfo<v8::Value> &info) {
+        auto *isolate = info.GetIsolate();
+        if (info.Length() < 1 || !info[0]->IsString()) {
+            isolate->ThrowException(v8::Exception::TypeError(v8pp::to_v8(isolate, "getDataAsync(key) requires a string key")));
+            return;
+        }
+        auto *self           = v8pp::class_<Human>::unwrap_object(isolate, info.This());
+        std::string identity = self ? PlayerIdentity(self->GetId()) : std::string {};
+        // Runs once the shard has loaded, so PlayerStore doesn't wait; resolves undefined if the player
+        // left in the meantime.
+        info.GetReturnValue().Set(Storage::Defer(isolate, identity, [identity, key = v8pp::from_v8<std::string>(isolate, info[0])](v8::Isolate *isolate) {
+            const auto *store = Storage::PlayerStore(identity);
+            const auto value  = store ? store->Get(key) : std::nullopt;
+            return value ? v8pp::to_v8(isolate, *value).As<v8::Value>() : v8::Undefined(isolate).As<v8::Value>();
+        }));
+    }
+
+    void Human::JsSetDataAsync(const v8::FunctionCallbackInfo<v8::Value> &info) {
+        auto *isolate = info.GetIsolate();
+        if (info.Length() < 2 || !info[0]->IsString() || !info[1]->IsString()) {
+            isolate->ThrowException(v8::Exception::TypeError(v8pp::to_v8(isolate, "setDataAsync(key, value) requires string key and value")));
+            return;
+        }
+        auto *self           = v8pp::class_<Human>::unwrap_object(isolate, info.This());
+        std::string identity = self ? PlayerIdentity(self->GetId()) : std::string {};
+        info.GetReturnValue().Set(Storage::Defer(isolate, identity,
+            [identity, key = v8pp::from_v8<std::string>(isolate, info[0]), value = v8pp::from_v8<std::string>(isolate, info[1])](v8::Isolate *) mutable {
+                if (auto *store = Storage::PlayerStore(identity)) {
+                    store->Set(std::move(key), std::move(value));
+                    Storage::Persist(*store);
+                }
+                return v8::Local<v8::Value>();
+            }));
+    }
+
     void Human::Destroy() {
         auto *human = ResolveHuman(GetId());
         auto *repl  = Framework::CoreModules::GetReplication();
@@ -170,6 +240,7 @@ namespace HogwartsMP::Scripting {
         // Server-owned entities (NPCs spawned via World.spawnHuman) must be removed explicitly;
         // DestroyEntity broadcasts the despawn to every client streaming them.
         if (human->ownerGUID == MafiaNet::UNASSIGNED_PEER_GUID) {
+            ForgetWrapper(GetId());
             repl->DestroyEntity(human);
         }
     }
@@ -235,6 +306,83 @@ namespace HogwartsMP::Scripting {
         }
     }
 
+    void Human::JsMoveAlong(const v8::FunctionCallbackInfo<v8::Value> &info) {
+        auto *isolate = info.GetIsolate();
+        auto context  = isolate->GetCurrentContext();
+        std::vector<glm::vec3> path;
+        const double speed    = info.Length() >= 2 && info[1]->IsNumber() ? info[1].As<v8::Number>()->Value() : std::nan("");
+        const bool hasOptions = info.Length() >= 3 && !info[2]->IsUndefined();
+        const bool badOptions = hasOptions && !info[2]->IsObject();
+        if (info.Length() < 2 || !World::ReadPoints(context, info[0], path, Core::Modules::NpcMovement::kMaxPathPoints) || !(speed > 0.0) || !std::isfinite(speed) || badOptions) {
+            isolate->ThrowException(v8::Exception::TypeError(
+                v8pp::to_v8(isolate, "moveAlong(points, speed, options?) requires 1-1024 finite {x, y, z} points (or a Float32Array of them) and a positive speed")));
+            return;
+        }
+
+        Core::Modules::NpcMovement::Options options;
+        if (hasOptions) {
+            const auto object = info[2].As<v8::Object>();
+            v8::Local<v8::Value> spline;
+            options.spline     = object->Get(context, v8pp::to_v8(isolate, "spline")).ToLocal(&spline) && spline->BooleanValue(isolate);
+            const double arc   = World::NumberProperty(context, object, "arc");
+            const double mount = World::NumberProperty(context, object, "mount");
+            options.arcHeight  = std::isfinite(arc) ? static_cast<float>(arc) : 0.0f;
+            options.mountId    = std::isfinite(mount) && mount >= 0.0 ? static_cast<int>(std::min(mount, 255.0)) : -1;
+        }
+
+        // Players are driven by their own client; only server-owned entities take a path.
+        auto *self  = v8pp::class_<Human>::unwrap_object(isolate, info.This());
+        auto *human = self ? ResolveHuman(self->GetId()) : nullptr;
+        if (!human || human->ownerGUID != MafiaNet::UNASSIGNED_PEER_GUID) {
+            info.GetReturnValue().Set(false);
+            return;
+        }
+        info.GetReturnValue().Set(Core::Modules::NpcMovement::Get().MoveAlong(self->GetId(), human, path, static_cast<float>(speed), options));
+    }
+
+    bool Human::StopMoving() {
+        return Core::Modules::NpcMovement::Get().Stop(GetId());
+    }
+
+    bool Human::IsMoving() const {
+        return Core::Modules::NpcMovement::Get().IsMoving(GetId());
+    }
+
+    v8::Local<v8::Object> Human::Wrap(v8::Isolate *isolate, uint64_t networkId) {
+        auto &cache = _wrappers[isolate];
+        if (const auto it = cache.find(networkId); it != cache.end()) {
+            return it->second->handle.Get(isolate);
+        }
+        v8::Local<v8::Object> object = v8pp::class_<Human>::create_object(isolate, networkId);
+        auto entry                   = std::make_unique<CachedWrapper>();
+        entry->isolate               = isolate;
+        entry->networkId             = networkId;
+        entry->handle.Reset(isolate, object);
+        // Collected: forget it. Erasing the entry resets the handle, as a first-pass callback must.
+        entry->handle.SetWeak(
+            entry.get(),
+            [](const v8::WeakCallbackInfo<CachedWrapper> &data) {
+                const auto *collected = data.GetParameter();
+                auto &entries         = _wrappers[collected->isolate];
+                if (const auto it = entries.find(collected->networkId); it != entries.end() && it->second.get() == collected) {
+                    entries.erase(it);
+                }
+            },
+            v8::WeakCallbackType::kParameter);
+        cache.emplace(networkId, std::move(entry));
+        return object;
+    }
+
+    void Human::ForgetWrapper(uint64_t networkId) {
+        for (auto &[isolate, cache] : _wrappers) {
+            cache.erase(networkId);
+        }
+    }
+
+    void Human::ForgetWrappers(v8::Isolate *isolate) {
+        _wrappers.erase(isolate);
+    }
+
     v8pp::class_<Human> &Human::GetClass(v8::Isolate *isolate) {
         auto it = _classes.find(isolate);
         if (it != _classes.end()) {
@@ -257,6 +405,8 @@ namespace HogwartsMP::Scripting {
             .function("setCasting", &Human::SetCasting)
             .function("setLumos", &Human::SetLumos)
             .function("setDodging", &Human::SetDodging)
+            .function("stopMoving", &Human::StopMoving)
+            .function("isMoving", &Human::IsMoving)
             .function("emit", &Human::Emit)
             .function("setData", &Human::SetData)
             .function("hasData", &Human::HasData)
@@ -274,11 +424,28 @@ namespace HogwartsMP::Scripting {
                 if (self) info.GetReturnValue().Set(v8pp::to_v8(info.GetIsolate(), self->GetNickname()));
             });
 
-        // getData returns undefined for a missing key, so it's a raw FunctionTemplate (like Storage.get)
-        // rather than a typed v8pp function.
+        // getData returns undefined for a missing key (and incrData for an NPC), so they're raw
+        // FunctionTemplates (like Storage.get) rather than typed v8pp functions.
         protoTemplate->Set(
             v8pp::to_v8(isolate, "getData").As<v8::Name>(),
             v8::FunctionTemplate::New(isolate, &Human::JsGetData));
+        protoTemplate->Set(
+            v8pp::to_v8(isolate, "incrData").As<v8::Name>(),
+            v8::FunctionTemplate::New(isolate, &Human::JsIncrData));
+        protoTemplate->Set(
+            v8pp::to_v8(isolate, "getDataAsync").As<v8::Name>(),
+            v8::FunctionTemplate::New(isolate, &Human::JsGetDataAsync));
+        protoTemplate->Set(
+            v8pp::to_v8(isolate, "setDataAsync").As<v8::Name>(),
+            v8::FunctionTemplate::New(isolate, &Human::JsSetDataAsync));
+        // Optional argument and an array of plain objects: raw, like getData.
+        protoTemplate->Set(
+            v8pp::to_v8(isolate, "moveAlong").As<v8::Name>(),
+            v8::FunctionTemplate::New(isolate, &Human::JsMoveAlong));
+        // Takes any plain JS value, which a typed v8pp function cannot.
+        protoTemplate->Set(
+            v8pp::to_v8(isolate, "emitPacked").As<v8::Name>(),
+            v8::FunctionTemplate::New(isolate, &Human::JsEmitPacked));
         return *cls;
     }
 
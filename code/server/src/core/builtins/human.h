@@ -44,17 +44,36 @@ namespace HogwartsMP::Scripting {
         // Set/clear the dodge-roll state (relayed so the proxy plays its roll montage). For /dodgenpcs.
         void SetDodging(bool on);
 
+        // moveAlong(points, speed, options?) -> bool: hand a server NPC a path to follow natively
+        // (Core::Modules::NpcMovement) at speed cm/s; npcArrived fires when it gets there. points is an
+        // array of {x, y, z} or a Float32Array of xyz triples; options {spline, arc, mount}. False for a
+        // player or an entity that is gone.
+        static void JsMoveAlong(const v8::FunctionCallbackInfo<v8::Value> &info);
+        // Halt a moveAlong where the NPC stands (no npcArrived); false if it was not moving.
+        bool StopMoving();
+        bool IsMoving() const;
+
         // Emit a named event to this player's client scripts (Core.Events). payloadJson is sent as-is
         // and JSON.parsed on the client into the handler's single argument; pass JSON text.
         void Emit(std::string eventName, std::string payloadJson);
+        // emitPacked(name, value): the same without JSON text; value is packed natively and unpacked on the
+        // client straight into the handler argument (see World.emitAllClientsPacked).
+        static void JsEmitPacked(const v8::FunctionCallbackInfo<v8::Value> &info);
 
         // Per-player persistent data, keyed to the player's stable identity (survives reconnect), not
-        // the network id. Backed by the Storage builtin's store, namespaced per player; values are
-        // strings (use JSON.stringify/parse). No-op / undefined for entities without an identity (NPCs).
+        // the network id. Backed by the player's own storage shard (Storage::PlayerStore), resident while
+        // they are online; values are strings (use JSON.stringify/parse). No-op / undefined for entities without an identity (NPCs).
         void SetData(std::string key, std::string value);
         bool HasData(std::string key);
         bool DeleteData(std::string key);
         static void JsGetData(const v8::FunctionCallbackInfo<v8::Value> &info);
+        // incrData(key, delta = 1) -> the new number (a missing key counts as 0); throws if the stored
+        // value isn't a number.
+        static void JsIncrData(const v8::FunctionCallbackInfo<v8::Value> &info);
+        // Promise variants (Storage::Defer): settle on a later tick, once the player's shard has loaded,
+        // instead of waiting for the load on the scripting thread.
+        static void JsGetDataAsync(const v8::FunctionCallbackInfo<v8::Value> &info);
+        static void JsSetDataAsync(const v8::FunctionCallbackInfo<v8::Value> &info);
 
         void Destroy();
 
@@ -68,7 +87,25 @@ namespace HogwartsMP::Scripting {
         static void Register(v8::Isolate *isolate, v8::Local<v8::Object> global);
         static v8pp::class_<Human> &GetClass(v8::Isolate *isolate);
 
+        // The JS object for networkId. Every lookup (World.getPlayers, event arguments, ...) gets the same
+        // one while scripts hold on to it; it is held weakly, so an unreferenced wrapper is still collected
+        // and the next lookup makes a new one.
+        static v8::Local<v8::Object> Wrap(v8::Isolate *isolate, uint64_t networkId);
+        // Stop handing out networkId's wrapper: network ids are reused, so a later entity under the same id
+        // gets a fresh object. On disconnect and destroy.
+        static void ForgetWrapper(uint64_t networkId);
+        // Drop every cached wrapper for isolate, before it goes away. Needs the isolate locked.
+        static void ForgetWrappers(v8::Isolate *isolate);
+
       private:
+        struct CachedWrapper {
+            v8::Global<v8::Object> handle;
+            v8::Isolate *isolate;
+            uint64_t networkId;
+        };
+        // Per isolate, NetworkID -> wrapper. Entries are boxed so the weak callback's parameter stays put.
+        inline static std::unordered_map<v8::Isolate *, std::unordered_map<uint64_t, std::unique_ptr<CachedWrapper>>> _wrappers;
+
         // Keyed by isolate (like the framework's Entity/Player) so a second isolate in the same
         // process gets its own class rather than reusing one bound to a destroyed isolate.
         inline static std::unordered_map<v8::Isolate *, std::unique_ptr<v8pp::class_<Human>>> _classes;
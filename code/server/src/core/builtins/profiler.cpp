@@ -0,0 +1,451 @@
+#include "profiler.h"
+
+#include "events.h"
+
+#include "core/metrics/tick_profiler.h"
+
+#include <logging/logger.h>
+#include <v8-profiler.h>
+#include <v8pp/convert.hpp>
+
+#include <fmt/format.h>
+
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace HogwartsMP::Scripting {
+    namespace {
+        constexpr int kSlowStackFrames = 8;
+
+        // The outermost dispatch in flight, as the watchdog sees it. seq is 0 when none is; it is
+        // published last, so a nonzero seq implies startNs and isolate belong to it.
+        std::atomic<uint64_t> g_inflightSeq {0};
+        std::atomic<int64_t> g_inflightStartNs {0};
+        std::atomic<v8::Isolate *> g_inflightIsolate {nullptr};
+        std::atomic<uint64_t> g_interruptedSeq {0};
+        std::atomic<int64_t> g_thresholdMs {0};
+
+        // Server thread only.
+        uint64_t g_nextSeq = 0;
+        int g_depth        = 0;
+        std::string g_inflightEvent;
+
+        struct Watchdog {
+            std::mutex mutex;
+            std::condition_variable wake;
+            std::thread thread;
+            bool stop = false;
+        };
+        Watchdog g_watchdog;
+
+        struct CpuCapture {
+            std::mutex mutex;
+            uint32_t pendingSeconds = 0;
+            std::string pendingPath;
+            std::string path; // of the running capture
+            v8::CpuProfiler *profiler = nullptr;
+            std::chrono::steady_clock::time_point deadline;
+            std::future<void> write; // of the last finished capture
+        };
+        CpuCapture g_cpu;
+
+        int64_t SteadyNs(std::chrono::steady_clock::time_point t) {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(t.time_since_epoch()).count();
+        }
+
+        size_t UsedHeap(v8::Isolate *isolate) {
+            v8::HeapStatistics stats;
+            isolate->GetHeapStatistics(&stats);
+            return stats.used_heap_size();
+        }
+
+        // Runs on the server thread at the handler's next interrupt check, i.e. inside its JS.
+        void OnSlowInterrupt(v8::Isolate *isolate, void *data) {
+            const auto seq = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(data));
+            if (g_inflightSeq.load(std::memory_order_acquire) != seq) {
+                return; // finished between the watchdog's look and the interrupt
+            }
+            v8::HandleScope handleScope(isolate);
+            const auto stack = v8::StackTrace::CurrentStackTrace(isolate, kSlowStackFrames);
+            std::string resource;
+            std::string frames;
+            for (int i = 0; i < stack->GetFrameCount(); ++i) {
+                const auto frame  = stack->GetFrame(isolate, i);
+                const auto fn     = v8pp::from_v8<std::string>(isolate, frame->GetFunctionName(), "");
+                const auto script = v8pp::from_v8<std::string>(isolate, frame->GetScriptName(), "");
+                frames += fmt::format("\n    at {} ({}:{}:{})", fn.empty() ? "<anonymous>" : fn, script, frame->GetLineNumber(), frame->GetColumn());
+                if (resource.empty()) {
+                    resource = Profiler::ResourceOf(script);
+                }
+            }
+            const auto elapsedMs = (SteadyNs(std::chrono::steady_clock::now()) - g_inflightStartNs.load(std::memory_order_relaxed)) / 1000000;
+            Core::Metrics::TickProfiler::Get().Events().RecordSlowResource(resource.empty() ? "(unknown)" : resource);
+            Framework::Logging::GetLogger("Scripting")
+                ->warn("Slow handler for '{}': still running after {} ms in resource '{}'{}", g_inflightEvent, elapsedMs, resource.empty() ? "(unknown)" : resource,
+                       frames);
+        }
+
+        void WatchdogLoop() {
+            std::unique_lock lock(g_watchdog.mutex);
+            while (!g_watchdog.stop) {
+                const auto thresholdMs = g_thresholdMs.load(std::memory_order_relaxed);
+                // A few looks per threshold: a handler is caught at most a quarter-threshold late.
+                const auto poll = std::chrono::milliseconds(std::clamp<int64_t>(thresholdMs / 4, 5, 50));
+                g_watchdog.wake.wait_for(lock, poll);
+                if (g_watchdog.stop || thresholdMs <= 0) {
+                    continue;
+                }
+                const auto seq = g_inflightSeq.load(std::memory_order_acquire);
+                if (seq == 0 || g_interruptedSeq.load(std::memory_order_relaxed) == seq) {
+                    continue;
+                }
+                const auto elapsedNs = SteadyNs(std::chrono::steady_clock::now()) - g_inflightStartNs.load(std::memory_order_relaxed);
+                if (elapsedNs < thresholdMs * 1000000) {
+                    continue;
+                }
+                g_interruptedSeq.store(seq, std::memory_order_relaxed);
+                if (auto *isolate = g_inflightIsolate.load(std::memory_order_relaxed)) {
+                    isolate->RequestInterrupt(&OnSlowInterrupt, reinterpret_cast<void *>(static_cast<uintptr_t>(seq)));
+                }
+            }
+        }
+
+        void StopWatchdog() {
+            {
+                std::lock_guard lock(g_watchdog.mutex);
+                g_watchdog.stop = true;
+            }
+            g_watchdog.wake.notify_all();
+            if (g_watchdog.thread.joinable()) {
+                g_watchdog.thread.join();
+            }
+        }
+
+        // A stopped profile copied out of V8, whose objects belong to the server thread, so that building
+        // and writing the .cpuprofile can happen on another one.
+        struct ProfileNode {
+            unsigned id = 0;
+            std::string functionName;
+            int scriptId = 0;
+            std::string url;
+            int lineNumber    = 0;
+            int columnNumber  = 0;
+            unsigned hitCount = 0;
+            std::vector<unsigned> children;
+        };
+        struct ProfileCopy {
+            std::string path;
+            std::vector<ProfileNode> nodes;
+            int64_t startTime = 0;
+            int64_t endTime   = 0;
+            std::vector<unsigned> samples;
+            std::vector<int64_t> timestamps;
+        };
+
+        ProfileCopy CopyProfile(const v8::CpuProfile *profile, std::string path) {
+            ProfileCopy copy;
+            copy.path      = std::move(path);
+            copy.startTime = profile->GetStartTime();
+            copy.endTime   = profile->GetEndTime();
+            std::vector<const v8::CpuProfileNode *> pending {profile->GetTopDownRoot()};
+            while (!pending.empty()) {
+                const auto *node = pending.back();
+                pending.pop_back();
+                auto &out        = copy.nodes.emplace_back();
+                out.id           = node->GetNodeId();
+                out.functionName = node->GetFunctionNameStr();
+                out.scriptId     = node->GetScriptId();
+                out.url          = node->GetScriptResourceNameStr();
+                out.lineNumber   = node->GetLineNumber();
+                out.columnNumber = node->GetColumnNumber();
+                out.hitCount     = node->GetHitCount();
+                out.children.reserve(static_cast<size_t>(node->GetChildrenCount()));
+                for (int i = 0; i < node->GetChildrenCount(); ++i) {
+                    const auto *child = node->GetChild(i);
+                    out.children.push_back(child->GetNodeId());
+                    pending.push_back(child);
+                }
+            }
+            copy.samples.reserve(static_cast<size_t>(profile->GetSamplesCount()));
+            copy.timestamps.reserve(static_cast<size_t>(profile->GetSamplesCount()));
+            for (int i = 0; i < profile->GetSamplesCount(); ++i) {
+                copy.samples.push_back(profile->GetSample(i)->GetNodeId());
+                copy.timestamps.push_back(profile->GetSampleTimestamp(i));
+            }
+            return copy;
+        }
+
+        // The Chrome DevTools .cpuprofile layout: a flat node list linked by child ids, plus the sample
+        // stream as node ids and microsecond deltas.
+        nlohmann::json ToCpuProfileJson(const ProfileCopy &profile) {
+            nlohmann::json nodes = nlohmann::json::array();
+            for (const auto &node : profile.nodes) {
+                nodes.push_back({
+                    {"id", node.id},
+                    {"callFrame",
+                     {
+                         {"functionName", node.functionName},
+                         {"scriptId", std::to_string(node.scriptId)},
+                         {"url", node.url},
+                         {"lineNumber", node.lineNumber - 1}, // V8 counts from 1, the format from 0
+                         {"columnNumber", node.columnNumber - 1},
+                     }},
+                    {"hitCount", node.hitCount},
+                    {"children", node.children},
+                });
+            }
+
+            nlohmann::json timeDeltas = nlohmann::json::array();
+            int64_t last              = profile.startTime;
+            for (const int64_t at : profile.timestamps) {
+                timeDeltas.push_back(at - last);
+                last = at;
+            }
+            return {
+                {"nodes", std::move(nodes)},
+                {"startTime", profile.startTime},
+                {"endTime", profile.endTime},
+                {"samples", profile.samples},
+                {"timeDeltas", std::move(timeDeltas)},
+            };
+        }
+
+        // Runs on g_cpu.write's thread.
+        void WriteCpuProfile(const ProfileCopy &profile) {
+            std::error_code ec;
+            std::filesystem::create_directories(Profiler::PROFILE_DIR, ec);
+            std::ofstream out(profile.path, std::ios::binary | std::ios::trunc);
+            out << ToCpuProfileJson(profile).dump();
+            if (out.good()) {
+                Framework::Logging::GetLogger("Scripting")->info("CPU profile written to {}", profile.path);
+            }
+            else {
+                Framework::Logging::GetLogger("Scripting")->error("Cannot write CPU profile {}", profile.path);
+            }
+        }
+
+        // Stops the running capture; unless discard, copies it out and writes it on another thread (a
+        // long capture is megabytes of JSON). Caller holds g_cpu.mutex.
+        void FinishCpuProfile(bool discard) {
+            std::optional<ProfileCopy> copy;
+            RunInServerContext([&](v8::Isolate *isolate, v8::Local<v8::Context>) {
+                auto *profile = g_cpu.profiler->StopProfiling(v8pp::to_v8(isolate, g_cpu.path));
+                if (profile && !discard) {
+                    copy = CopyProfile(profile, g_cpu.path);
+                }
+                if (profile) {
+                    profile->Delete();
+                }
+            });
+            g_cpu.profiler->Dispose();
+            g_cpu.profiler = nullptr;
+            g_cpu.path.clear();
+            if (copy) {
+                // Captures are at least a second long, so the previous write has long finished.
+                if (g_cpu.write.valid()) {
+                    g_cpu.write.wait();
+                }
+                g_cpu.write = std::async(std::launch::async, [profile = std::move(*copy)]() {
+                    WriteCpuProfile(profile);
+                });
+            }
+        }
+    } // namespace
+
+    Profiler::Dispatch::Dispatch(v8::Isolate *isolate, const std::string &eventName)
+        : _isolate(isolate)
+        , _eventName(eventName)
+        , _start(std::chrono::steady_clock::now())
+        , _heapBefore(UsedHeap(isolate))
+        , _outermost(g_depth++ == 0) {
+        if (_outermost) {
+            g_inflightEvent = eventName;
+            g_inflightStartNs.store(SteadyNs(_start), std::memory_order_relaxed);
+            g_inflightIsolate.store(isolate, std::memory_order_relaxed);
+            g_inflightSeq.store(++g_nextSeq, std::memory_order_release);
+        }
+    }
+
+    Profiler::Dispatch::~Dispatch() {
+        const auto elapsed   = std::chrono::steady_clock::now() - _start;
+        const size_t after   = UsedHeap(_isolate);
+        const auto threshold = g_thresholdMs.load(std::memory_order_relaxed);
+        const bool slow      = threshold > 0 && elapsed >= std::chrono::milliseconds(threshold);
+        --g_depth;
+        if (_outermost) {
+            g_inflightSeq.store(0, std::memory_order_release);
+        }
+
+        const auto ns = static_cast<uint64_t>(std::max<int64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count(), 0));
+        // A collection during the dispatch can shrink the heap; count that as no growth.
+        Core::Metrics::TickProfiler::Get().Events().Record(_eventName, ns, after > _heapBefore ? after - _heapBefore : 0, slow);
+        if (slow) {
+            Framework::Logging::GetLogger("Scripting")->warn("Slow handler for '{}': {:.1f} ms", _eventName, static_cast<double>(ns) / 1e6);
+        }
+    }
+
+    void Profiler::SetSlowThreshold(std::chrono::milliseconds threshold) {
+        const auto ms = std::max<int64_t>(threshold.count(), 0);
+        g_thresholdMs.store(ms, std::memory_order_relaxed);
+        if (ms == 0) {
+            StopWatchdog();
+            return;
+        }
+        std::lock_guard lock(g_watchdog.mutex);
+        if (!g_watchdog.thread.joinable()) {
+            g_watchdog.stop   = false;
+            g_watchdog.thread = std::thread(&WatchdogLoop);
+        }
+    }
+
+    std::chrono::milliseconds Profiler::SlowThreshold() {
+        return std::chrono::milliseconds(g_thresholdMs.load(std::memory_order_relaxed));
+    }
+
+    std::optional<std::string> Profiler::RequestCpuProfile(uint32_t seconds) {
+        std::lock_guard lock(g_cpu.mutex);
+        if (g_cpu.pendingSeconds != 0 || g_cpu.profiler) {
+            return std::nullopt;
+        }
+        const auto unixMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+        g_cpu.pendingSeconds = std::clamp<uint32_t>(seconds, 1, kMaxProfileSeconds);
+        g_cpu.pendingPath    = fmt::format("{}/cpu-{}.cpuprofile", PROFILE_DIR, unixMs);
+        return g_cpu.pendingPath;
+    }
+
+    void Profiler::Tick() {
+        std::lock_guard lock(g_cpu.mutex);
+        if (g_cpu.profiler) {
+            if (std::chrono::steady_clock::now() >= g_cpu.deadline) {
+                FinishCpuProfile(false);
+            }
+            return;
+        }
+        if (g_cpu.pendingSeconds == 0) {
+            return;
+        }
+        const auto seconds   = g_cpu.pendingSeconds;
+        g_cpu.pendingSeconds = 0;
+        RunInServerContext([&](v8::Isolate *isolate, v8::Local<v8::Context>) {
+            g_cpu.profiler = v8::CpuProfiler::New(isolate);
+            g_cpu.path     = std::move(g_cpu.pendingPath);
+            g_cpu.deadline = std::chrono::steady_clock::now() + std::chrono::seconds(seconds);
+            g_cpu.profiler->StartProfiling(v8pp::to_v8(isolate, g_cpu.path), true);
+        });
+        if (g_cpu.profiler) {
+            Framework::Logging::GetLogger("Scripting")->info("CPU profiling scripts for {} s into {}", seconds, g_cpu.path);
+        }
+    }
+
+    void Profiler::Shutdown() {
+        StopWatchdog();
+        std::lock_guard lock(g_cpu.mutex);
+        g_cpu.pendingSeconds = 0;
+        if (g_cpu.profiler) {
+            FinishCpuProfile(true);
+        }
+        if (g_cpu.write.valid()) {
+            g_cpu.write.wait();
+        }
+    }
+
+    std::string Profiler::ResourceOf(const std::string &scriptPath) {
+        // Resource scripts load from <cwd>/resources/<name>/...; paths may use either separator.
+        std::string path = scriptPath;
+        std::replace(path.begin(), path.end(), '\\', '/');
+        const std::string marker = "resources/";
+        size_t at                = std::string::npos;
+        for (size_t pos = path.find(marker); pos != std::string::npos; pos = path.find(marker, pos + 1)) {
+            if (pos == 0 || path[pos - 1] == '/') {
+                at = pos; // the innermost resources/ segment wins
+            }
+        }
+        if (at == std::string::npos) {
+            return "";
+        }
+        const size_t begin = at + marker.size();
+        const size_t end   = path.find('/', begin);
+        return end == std::string::npos ? "" : path.substr(begin, end - begin);
+    }
+
+    void Profiler::Register(v8::Isolate *isolate, v8::Local<v8::Object> global) {
+        if (!isolate || global.IsEmpty()) {
+            return;
+        }
+        auto ctx                  = isolate->GetCurrentContext();
+        v8::Local<v8::Object> obj = v8::Object::New(isolate);
+        const auto setRaw         = [&](const char *name, v8::FunctionCallback fn) {
+            obj->Set(ctx, v8pp::to_v8(isolate, name), v8::FunctionTemplate::New(isolate, fn)->GetFunction(ctx).ToLocalChecked()).Check();
+        };
+        setRaw("eventStats", &Profiler::JsEventStats);
+        setRaw("setSlowHandlerThreshold", &Profiler::JsSetSlowHandlerThreshold);
+        setRaw("captureCpuProfile", &Profiler::JsCaptureCpuProfile);
+        global->Set(ctx, v8pp::to_v8(isolate, "Profiler"), obj).Check();
+    }
+
+    // Profiler.eventStats(limit?) -> [{event, calls, totalMs, maxMs, allocatedBytes, slow}], costliest first
+    void Profiler::JsEventStats(const v8::FunctionCallbackInfo<v8::Value> &info) {
+        auto *isolate = info.GetIsolate();
+        auto ctx      = isolate->GetCurrentContext();
+        size_t limit  = 0;
+        if (info.Length() > 0 && !info[0]->IsUndefined()) {
+            if (!info[0]->IsNumber() || info[0].As<v8::Number>()->Value() < 0) {
+                isolate->ThrowException(v8::Exception::TypeError(v8pp::to_v8(isolate, "eventStats(limit?) requires a non-negative number")));
+                return;
+            }
+            limit = static_cast<size_t>(info[0].As<v8::Number>()->Value());
+        }
+        const auto events = Core::Metrics::TickProfiler::Get().Events().Top(limit);
+        auto out          = v8::Array::New(isolate, static_cast<int>(events.size()));
+        for (size_t i = 0; i < events.size(); ++i) {
+            const auto &[name, e] = events[i];
+            auto row              = v8::Object::New(isolate);
+            const auto set        = [&](const char *key, v8::Local<v8::Value> value) {
+                row->Set(ctx, v8pp::to_v8(isolate, key), value).Check();
+            };
+            set("event", v8pp::to_v8(isolate, name));
+            set("calls", v8::Number::New(isolate, static_cast<double>(e.calls)));
+            set("totalMs", v8::Number::New(isolate, static_cast<double>(e.totalNs) / 1e6));
+            set("maxMs", v8::Number::New(isolate, static_cast<double>(e.maxNs) / 1e6));
+            set("allocatedBytes", v8::Number::New(isolate, static_cast<double>(e.allocatedBytes)));
+            set("slow", v8::Number::New(isolate, static_cast<double>(e.slow)));
+            out->Set(ctx, static_cast<uint32_t>(i), row).Check();
+        }
+        info.GetReturnValue().Set(out);
+    }
+
+    // Profiler.setSlowHandlerThreshold(ms) — 0 turns slow-handler detection off
+    void Profiler::JsSetSlowHandlerThreshold(const v8::FunctionCallbackInfo<v8::Value> &info) {
+        auto *isolate = info.GetIsolate();
+        if (info.Length() < 1 || !info[0]->IsNumber() || !(info[0].As<v8::Number>()->Value() >= 0)) {
+            isolate->ThrowException(v8::Exception::TypeError(v8pp::to_v8(isolate, "setSlowHandlerThreshold(ms) requires a non-negative number")));
+            return;
+        }
+        SetSlowThreshold(std::chrono::milliseconds(static_cast<int64_t>(info[0].As<v8::Number>()->Value())));
+    }
+
+    // Profiler.captureCpuProfile(seconds) -> path of the .cpuprofile to be written, or null when busy
+    void Profiler::JsCaptureCpuProfile(const v8::FunctionCallbackInfo<v8::Value> &info) {
+        auto *isolate = info.GetIsolate();
+        if (info.Length() < 1 || !info[0]->IsNumber() || !(info[0].As<v8::Number>()->Value() >= 1)) {
+            isolate->ThrowException(v8::Exception::TypeError(v8pp::to_v8(isolate, "captureCpuProfile(seconds) requires a number of at least 1")));
+            return;
+        }
+        const auto seconds = static_cast<uint32_t>(std::min<double>(info[0].As<v8::Number>()->Value(), kMaxProfileSeconds));
+        const auto path    = RequestCpuProfile(seconds);
+        if (!path) {
+            info.GetReturnValue().SetNull();
+            return;
+        }
+        info.GetReturnValue().Set(v8pp::to_v8(isolate, *path));
+    }
+} // namespace HogwartsMP::Scripting
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <v8.h>
+
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <string>
+
+namespace HogwartsMP::Scripting {
+    /**
+     * Script-side profiling: per-event dispatch accounting (into TickProfiler's EventStats), slow-handler
+     * detection and on-demand V8 CPU profiles.
+     *
+     * A watchdog thread watches the dispatch in flight; once it runs past the slow-handler threshold the
+     * watchdog interrupts the isolate, and the interrupt logs the JS stack the handler is stuck in and
+     * charges the resource at its top. Only the outermost dispatch is watched: events emitted from inside
+     * a handler count toward their own stats but are part of their parent's time.
+     */
+    class Profiler final {
+      public:
+        static constexpr const char *PROFILE_DIR    = "profiles";
+        static constexpr uint32_t kMaxProfileSeconds = 60;
+
+        // Times one EmitServerEvent dispatch; construct inside the isolate's locked scope.
+        class Dispatch final {
+          public:
+            Dispatch(v8::Isolate *isolate, const std::string &eventName);
+            ~Dispatch();
+            Dispatch(const Dispatch &)            = delete;
+            Dispatch &operator=(const Dispatch &) = delete;
+
+          private:
+            v8::Isolate *_isolate;
+            const std::string &_eventName;
+            std::chrono::steady_clock::time_point _start;
+            size_t _heapBefore;
+            bool _outermost;
+        };
+
+        // 0 disables slow-handler detection (and stops the watchdog).
+        static void SetSlowThreshold(std::chrono::milliseconds threshold);
+        static std::chrono::milliseconds SlowThreshold();
+
+        // Ask for a CPU profile of the next seconds (clamped to 1..kMaxProfileSeconds) of script execution.
+        // Thread-safe; the profile is started and stopped by Tick(), and written on a background thread.
+        // Returns the file it will be written to, or nullopt while another capture is pending or running.
+        static std::optional<std::string> RequestCpuProfile(uint32_t seconds);
+        // Start or finish a requested CPU profile; called from the server tick.
+        static void Tick();
+        // Stop the watchdog, abandon a running profile and wait for a finished one to be written.
+        static void Shutdown();
+
+        // The resource a script belongs to, from its path (".../resources/<name>/..."); "" when none.
+        static std::string ResourceOf(const std::string &scriptPath);
+
+        static void Register(v8::Isolate *isolate, v8::Local<v8::Object> global);
+
+      private:
+        static void JsEventStats(const v8::FunctionCallbackInfo<v8::Value> &info);
+        static void JsSetSlowHandlerThreshold(const v8::FunctionCallbackInfo<v8::Value> &info);
+        static void JsCaptureCpuProfile(const v8::FunctionCallbackInfo<v8::Value> &info);
+    };
+} // namespace HogwartsMP::Scripting
@@ -4,43 +4,297 @@
 #include <v8pp/convert.hpp>
 #include <v8pp/module.hpp>
 
+#include "events.h"
+
+#include "core/storage/durability.h"
 #include "core/storage/key_value_store.h"
+#include "core/storage/player_shards.h"
+#include "core/storage/sorted_set.h"
 
 #include <logging/logger.h>
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <optional>
 #include <string>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace HogwartsMP::Scripting {
     // The `Storage` global: a persistent key/value store for gamemode scripts. Values are strings —
     // scripts wrap structured data with JSON.stringify / JSON.parse. Backed by a single process-wide
-    // KeyValueStore persisted to STORAGE_FILE next to the server's working directory; every write is
-    // flushed immediately so state survives a restart or crash.
+    // KeyValueStore persisted to STORAGE_FILE next to the server's working directory, in Journal mode:
+    // every write appends just the changed key to STORAGE_FILE.log (so a write costs O(value), not
+    // O(store)) and the log is folded back into the snapshot in the background. The snapshot is the
+    // binary format, mapped rather than parsed on startup; STORAGE_IMPORT_FILE is the JSON way in and
+    // Storage.exportJson the way out, for hand editing.
+    //
+    // Writes from JS never touch disk: they update the in-memory store and the store's flush thread
+    // commits them, as often as the configured Durability allows (Persist / Tick / Shutdown below).
     //
     // JS surface:
-    //   Storage.set(key, value)   persist a string value (overwrites)
+    //   Storage.set(key, value, { ttlMs }?)  persist a string value (overwrites); with ttlMs the key
+    //                                        expires that many ms from now
     //   Storage.get(key)          -> string | undefined
     //   Storage.has(key)          -> boolean
     //   Storage.delete(key)       -> boolean (true if a key was removed)
-    //   Storage.keys()            -> string[]
+    //   Storage.ttl(key)          -> ms until the key expires | undefined (no key, or no expiry)
+    //   Storage.keys(prefix?, limit?)        -> string[] (sorted; keys starting with prefix)
+    //   Storage.entries(prefix?, limit?)     -> [key, value][] (sorted; keys starting with prefix)
+    //   Storage.range(start, end?, limit?)   -> [key, value][] (sorted; start <= key < end)
+    //   Storage.exportJson(path)             -> boolean (write everything to a JSON file)
+    //   Storage.setMany({ key: value, ... })  set several keys as one change
+    //   Storage.getMany(keys)                -> (string | undefined)[] (aligned with keys)
+    //   Storage.deleteMany(keys)             -> number of keys removed, as one change
+    //   Storage.incr(key, delta = 1)         -> number (the new value; a missing key counts as 0)
+    //   Storage.transaction(fn)              -> fn's result; Storage writes made by fn apply together
+    //                                           when it returns, or not at all if it throws
+    //
+    // Sorted sets (leaderboards), kept in the same store as "zset:<set>:<member>" keys (Boards() below):
+    //   Storage.zadd(set, member, score)     -> boolean (true if the member is new)
+    //   Storage.zincr(set, member, delta = 1) -> number (the new score)
+    //   Storage.zscore(set, member)          -> number | undefined
+    //   Storage.zrem(set, member)            -> boolean
+    //   Storage.zcard(set)                   -> number of members
+    //   Storage.zrank / zrevrank(set, member) -> 0-based position ascending / descending, or undefined
+    //   Storage.zrange / zrevrange(set, start, stop = -1) -> [member, score][] by position, inclusive;
+    //                                           negative positions count from the end
+    //   Storage.zrangeByScore(set, min, max, limit?)     -> [member, score][] with min <= score <= max
+    //
+    // Promise-returning variants, run during the next server tick (Defer / RunDeferred below):
+    //   Storage.async.get(key) / set(key, value, options?) / delete(key) / keys(prefix?, limit?)
+    //
+    // A batch (setMany / deleteMany / transaction) crosses into C++ once, lands in the store as one
+    // KeyValueStore::Apply and is committed as one journal record.
     //
-    // v1 is a single global namespace. Per-player persistence is intentionally deferred: it needs a
-    // stable player identity that survives reconnect (no account system exists yet), so scripts that
-    // want per-player data should key by their own stable id for now (e.g. "house:" + accountId).
+    // Per-player data (Human.getData/setData) does not live here: each online player's data is its own
+    // shard under PLAYER_STORAGE_DIR, loaded on connect and evicted on disconnect (Players() below), so
+    // the resident set follows who is online rather than everyone who ever joined.
     class Storage final {
       public:
-        static constexpr const char *STORAGE_FILE = "storage.json";
+        static constexpr const char *STORAGE_FILE = "storage.kvs";
+        // Write-ahead log beside STORAGE_FILE (KeyValueStore appends ".log").
+        static constexpr const char *STORAGE_LOG_FILE = "storage.kvs.log";
+        // A JSON object found here at startup replaces the store's contents (together with its own
+        // journal, as older servers wrote it), then is renamed to *.imported.
+        static constexpr const char *STORAGE_IMPORT_FILE = "storage.json";
+        // One journaled <identity>.json per player (see PlayerShards).
+        static constexpr const char *PLAYER_STORAGE_DIR = "storage_players";
+        // Most expired keys erased per server tick; any beyond that wait for the next one (they already
+        // read as missing).
+        static constexpr size_t EXPIRY_REAP_BUDGET = 1024;
 
         // Process-wide store backing the JS global, lazily loaded from disk on first use.
         static Core::Storage::KeyValueStore &Store() {
-            static Core::Storage::KeyValueStore store = [] {
-                Core::Storage::KeyValueStore s(STORAGE_FILE);
-                s.Load(); // missing file is fine — starts empty
-                return s;
+            static Core::Storage::KeyValueStore store(STORAGE_FILE);
+            static const bool loaded = [] {
+                store.SetPersistMode(Core::Storage::PersistMode::Journal);
+                store.SetSnapshotFormat(Core::Storage::SnapshotFormat::Binary);
+                store.SetBackgroundFlush(true);
+                store.Load(); // missing file is fine — starts empty
+                ImportJson(store);
+                return true;
             }();
+            (void)loaded;
             return store;
         }
 
+        // Per-player shards. Older servers kept player data in the global store as
+        // "player:<identity>:<key>"; a shard that is handed out for the first time adopts any such keys
+        // (committed to the shard before they are dropped from the global store).
+        static Core::Storage::PlayerShards &Players() {
+            static Core::Storage::PlayerShards shards(PLAYER_STORAGE_DIR);
+            static const bool hooked = [] {
+                shards.SetOnLoaded([](const std::string &identity, Core::Storage::KeyValueStore &shard) {
+                    if (_clock) {
+                        shard.SetClock(_clock);
+                    }
+                    const std::string prefix = "player:" + identity + ":";
+                    const auto legacy        = Store().Entries(prefix);
+                    if (legacy.empty()) {
+                        return;
+                    }
+                    for (const auto &[key, value] : legacy) {
+                        const std::string userKey = key.substr(prefix.size());
+                        if (!shard.Has(userKey)) {
+                            shard.Set(userKey, value);
+                        }
+                    }
+                    if (!shard.Flush()) {
+                        return; // keep the global copy until the shard is safely on disk
+                    }
+                    for (const auto &[key, value] : legacy) {
+                        Store().Erase(key);
+                    }
+                    Persist();
+                });
+                return true;
+            }();
+            (void)hooked;
+            return shards;
+        }
+
+        // Player lifecycle (Server::OnPlayerConnect / OnPlayerDisconnect). Acquire starts loading the
+        // shard in the background; Release commits and evicts it. An empty identity is ignored.
+        static void AcquirePlayer(const std::string &identity) {
+            Players().Acquire(identity);
+        }
+        static void ReleasePlayer(const std::string &identity) {
+            Players().Release(identity);
+        }
+
+        // The online player's shard, or nullptr if the identity isn't connected. Waits for the shard's
+        // load if it is still in flight.
+        static Core::Storage::KeyValueStore *PlayerStore(const std::string &identity) {
+            return identity.empty() ? nullptr : Players().Find(identity);
+        }
+
+        // Sorted-set indexes over Store(). Every write to Store() made outside Boards() goes through
+        // Write / Remove / Commit / JsIncr below, which report it with Invalidate.
+        static Core::Storage::SortedSets &Boards() {
+            static Core::Storage::SortedSets boards(Store());
+            return boards;
+        }
+
+        // Set once at startup (Server::SetStorageDurability), before scripts run.
+        static void SetDurability(Core::Storage::Durability durability) {
+            _durability = durability;
+        }
+
+        // Replace the wall clock that key expiry runs on (the replay driver's virtual clock). Call before
+        // scripts run; player shards loaded afterwards pick it up too.
+        static void SetClock(Core::Storage::KeyValueStore::Clock clock) {
+            _clock = std::move(clock);
+            Store().SetClock(_clock);
+        }
+
+        // Call after every script-driven write to `store` (Storage.set, player.setData, ...). Immediate
+        // queues the commit right away; the other modes leave the change for Tick / Shutdown.
+        static void Persist(Core::Storage::KeyValueStore &store = Store()) {
+            if (_durability.mode == Core::Storage::Durability::Mode::Immediate) {
+                store.Save();
+            }
+        }
+
+        // Shared by Storage.incr and Human.incrData: add delta to `key` in `store` and return the new
+        // value, or throw a TypeError (returning nullopt) when the stored value isn't a number.
+        static std::optional<double> Increment(v8::Isolate *isolate, Core::Storage::KeyValueStore &store, const std::string &key, double delta) {
+            const auto value = store.Incr(key, delta);
+            if (!value) {
+                isolate->ThrowException(v8::Exception::TypeError(v8pp::to_v8(isolate, "can't increment '" + key + "': its value is not a number")));
+                return std::nullopt;
+            }
+            Persist(store);
+            return value;
+        }
+
+        // Work queued for a later tick, and the promise it settles. Most of it needs no waiting — the
+        // global store is in memory — but work for a player's shard waits until the shard's background
+        // load has finished, so script code never blocks on the disk.
+        using DeferredFn = std::function<v8::Local<v8::Value>(v8::Isolate *isolate)>;
+
+        // Queue fn to run on the scripting thread in a later Tick, once `identity`'s shard is loaded
+        // ("" = no shard to wait for), and return a promise of its result (rejected with whatever fn
+        // throws).
+        static v8::Local<v8::Promise> Defer(v8::Isolate *isolate, std::string identity, DeferredFn fn) {
+            auto resolver = v8::Promise::Resolver::New(isolate->GetCurrentContext()).ToLocalChecked();
+            _deferred.push_back({v8::Global<v8::Promise::Resolver>(isolate, resolver), std::move(identity), std::move(fn)});
+            return resolver->GetPromise();
+        }
+
+        // Run the deferred work that is ready, in the order it was queued, and settle its promises.
+        // Work for a shard still loading stays queued (behind it, the shard's later work too) unless
+        // `wait` says to block for the load instead.
+        static void RunDeferred(v8::Isolate *isolate, v8::Local<v8::Context> context, bool wait = false) {
+            if (_deferred.empty()) {
+                return;
+            }
+            v8::HandleScope handleScope(isolate);
+            std::vector<Deferred> queue;
+            queue.swap(_deferred);
+            // Decided once per identity per pass, so a shard finishing mid-pass can't reorder its work.
+            std::unordered_map<std::string, bool> ready;
+            for (auto &op : queue) {
+                if (!wait && !op.identity.empty()) {
+                    const auto [it, inserted] = ready.try_emplace(op.identity, false);
+                    if (inserted) {
+                        it->second = !Players().IsLoading(op.identity);
+                    }
+                    if (!it->second) {
+                        _deferred.push_back(std::move(op));
+                        continue;
+                    }
+                }
+                v8::TryCatch tryCatch(isolate);
+                const auto resolver = op.resolver.Get(isolate);
+                const auto result   = op.fn(isolate);
+                if (tryCatch.HasCaught()) {
+                    resolver->Reject(context, tryCatch.Exception()).Check();
+                }
+                else {
+                    resolver->Resolve(context, result.IsEmpty() ? v8::Undefined(isolate).As<v8::Value>() : result).Check();
+                }
+            }
+            isolate->PerformMicrotaskCheckpoint();
+        }
+
+        // Server tick: erase keys whose TTL has passed (a bounded number per tick), and under Interval
+        // group-commit everything changed since the last commit once the interval has elapsed. Also
+        // reports background write failures (the failed batch is retried) and maps a finished background
+        // snapshot in place of the overlay it covers.
+        static void Tick() {
+            if (!_deferred.empty()) {
+                RunInServerContext([](v8::Isolate *isolate, v8::Local<v8::Context> context) {
+                    RunDeferred(isolate, context);
+                });
+            }
+            const size_t reaped = Store().ReapExpired(EXPIRY_REAP_BUDGET, [](const std::string &key) {
+                Boards().Invalidate(key);
+            });
+            if (reaped > 0) {
+                Persist();
+            }
+            Store().PollSnapshot();
+            if (Store().TakeWriteError()) {
+                Framework::Logging::GetLogger("Scripting")->warn("Storage failed to persist to {}; retrying on the next commit", STORAGE_FILE);
+            }
+            if (Players().TakeWriteError()) {
+                Framework::Logging::GetLogger("Scripting")->warn("Storage failed to load or persist a player shard in {}", PLAYER_STORAGE_DIR);
+            }
+            if (_durability.mode != Core::Storage::Durability::Mode::Interval) {
+                return;
+            }
+            const auto now = std::chrono::steady_clock::now();
+            if (now - _lastCommit < _durability.interval) {
+                return;
+            }
+            _lastCommit = now;
+            if (Store().HasUnsavedChanges()) {
+                Store().Save();
+            }
+            Players().SaveAll();
+        }
+
+        // Server shutdown: finish deferred work, commit everything still in memory and wait until the
+        // flush thread has written it, whatever the durability mode.
+        static void Shutdown() {
+            RunInServerContext([](v8::Isolate *isolate, v8::Local<v8::Context> context) {
+                RunDeferred(isolate, context, true);
+            });
+            _deferred.clear();
+            if (!Store().Flush()) {
+                Framework::Logging::GetLogger("Scripting")->error("Storage failed to persist to {} on shutdown", STORAGE_FILE);
+            }
+            if (!Players().FlushAll()) {
+                Framework::Logging::GetLogger("Scripting")->error("Storage failed to persist player shards in {} on shutdown", PLAYER_STORAGE_DIR);
+            }
+        }
+
         static void Register(v8::Isolate *isolate, v8::Local<v8::Object> global) {
             if (!isolate || global.IsEmpty()) {
                 return;
@@ -48,25 +302,438 @@ namespace HogwartsMP::Scripting {
             auto ctx = isolate->GetCurrentContext();
 
             v8pp::module storageModule(isolate);
-            storageModule.function("set", &Storage::JsSet);
             storageModule.function("has", &Storage::Has);
             storageModule.function("delete", &Storage::Delete);
-            storageModule.function("keys", &Storage::Keys);
+            storageModule.function("exportJson", &Storage::ExportJson);
             auto storageObj = storageModule.new_instance();
-            // get returns undefined for a missing key, so it needs raw isolate access rather than a
-            // typed v8pp function (which can't express the optional return).
-            storageObj->Set(ctx, v8pp::to_v8(isolate, "get"),
-                            v8::FunctionTemplate::New(isolate, &Storage::JsGet)->GetFunction(ctx).ToLocalChecked())
-                .Check();
+            // get returns undefined for a missing key, and set and the scans take optional arguments, so they
+            // need raw isolate access rather than typed v8pp functions.
+            const auto setRaw = [&](const char *name, v8::FunctionCallback fn) {
+                storageObj->Set(ctx, v8pp::to_v8(isolate, name), v8::FunctionTemplate::New(isolate, fn)->GetFunction(ctx).ToLocalChecked()).Check();
+            };
+            setRaw("set", &Storage::JsSet);
+            setRaw("get", &Storage::JsGet);
+            setRaw("ttl", &Storage::JsTtl);
+            setRaw("keys", &Storage::JsKeys);
+            setRaw("entries", &Storage::JsEntries);
+            setRaw("range", &Storage::JsRange);
+            setRaw("setMany", &Storage::JsSetMany);
+            setRaw("getMany", &Storage::JsGetMany);
+            setRaw("deleteMany", &Storage::JsDeleteMany);
+            setRaw("transaction", &Storage::JsTransaction);
+            setRaw("incr", &Storage::JsIncr);
+            setRaw("zadd", &Storage::JsZAdd);
+            setRaw("zincr", &Storage::JsZIncr);
+            setRaw("zscore", &Storage::JsZScore);
+            setRaw("zrem", &Storage::JsZRem);
+            setRaw("zcard", &Storage::JsZCard);
+            setRaw("zrank", &Storage::JsZRank<false>);
+            setRaw("zrevrank", &Storage::JsZRank<true>);
+            setRaw("zrange", &Storage::JsZRange<false>);
+            setRaw("zrevrange", &Storage::JsZRange<true>);
+            setRaw("zrangeByScore", &Storage::JsZRangeByScore);
+
+            auto asyncObj = v8::Object::New(isolate);
+            const auto setAsync = [&](const char *name, v8::FunctionCallback fn) {
+                asyncObj->Set(ctx, v8pp::to_v8(isolate, name), v8::FunctionTemplate::New(isolate, fn)->GetFunction(ctx).ToLocalChecked()).Check();
+            };
+            setAsync("get", &Storage::JsAsyncGet);
+            setAsync("set", &Storage::JsAsyncSet);
+            setAsync("delete", &Storage::JsAsyncDelete);
+            setAsync("keys", &Storage::JsAsyncKeys);
+            storageObj->Set(ctx, v8pp::to_v8(isolate, "async"), asyncObj).Check();
             global->Set(ctx, v8pp::to_v8(isolate, "Storage"), storageObj).Check();
         }
 
       private:
-        static void JsSet(std::string key, std::string value) {
+        static void ImportJson(Core::Storage::KeyValueStore &store) {
+            std::error_code ec;
+            if (!std::filesystem::exists(STORAGE_IMPORT_FILE, ec)) {
+                return;
+            }
+            auto logger = Framework::Logging::GetLogger("Scripting");
+            Core::Storage::KeyValueStore imported(STORAGE_IMPORT_FILE);
+            imported.SetPersistMode(Core::Storage::PersistMode::Journal);
+            if (!imported.Load()) {
+                logger->error("Storage could not read {}; keeping {} as it is", STORAGE_IMPORT_FILE, STORAGE_FILE);
+                return;
+            }
+            store.Clear();
+            for (auto &[key, value] : imported.Entries()) {
+                store.Set(key, std::move(value));
+            }
+            if (!store.Compact()) {
+                logger->error("Storage failed to write {} while importing {}", STORAGE_FILE, STORAGE_IMPORT_FILE);
+                return;
+            }
+            const std::string importPath = STORAGE_IMPORT_FILE;
+            std::filesystem::rename(importPath, importPath + ".imported", ec);
+            std::filesystem::remove(importPath + ".log", ec);
+            std::filesystem::remove(importPath + ".log.old", ec);
+            logger->info("Storage imported {} keys from {}", store.Size(), STORAGE_IMPORT_FILE);
+        }
+
+        static bool ExportJson(std::string path) {
+            return Store().SaveTo(path);
+        }
+
+        // Reads and writes of the Storage global go through these, so that inside a transaction writes
+        // are staged in _transaction and reads see them.
+        static std::optional<std::string> Read(const std::string &key) {
+            if (const auto *staged = _transaction ? _transaction->Find(key) : nullptr) {
+                return *staged;
+            }
+            return Store().Get(key);
+        }
+
+        static bool Exists(const std::string &key) {
+            if (const auto *staged = _transaction ? _transaction->Find(key) : nullptr) {
+                return staged->has_value();
+            }
+            return Store().Has(key);
+        }
+
+        // A ttl can't be staged: callers refuse one inside a transaction.
+        static void Write(std::string key, std::string value, std::optional<uint64_t> ttlMs = std::nullopt) {
+            if (_transaction) {
+                _transaction->Set(std::move(key), std::move(value));
+                return;
+            }
             Store().Set(key, std::move(value));
-            if (!Store().Save()) {
-                Framework::Logging::GetLogger("Scripting")->warn("Storage.set('{}') failed to persist to {}", key, STORAGE_FILE);
+            if (ttlMs) {
+                Store().Expire(key, *ttlMs);
+            }
+            Boards().Invalidate(key);
+            Persist();
+        }
+
+        static bool Remove(const std::string &key) {
+            if (_transaction) {
+                const bool existed = Exists(key);
+                _transaction->Erase(key);
+                return existed;
+            }
+            const bool erased = Store().Erase(key);
+            if (erased) {
+                Boards().Invalidate(key);
+                Persist();
+            }
+            return erased;
+        }
+
+        static void Commit(const Core::Storage::WriteBatch &batch) {
+            if (batch.Empty()) {
+                return;
+            }
+            Store().Apply(batch);
+            for (const auto &change : batch.Changes()) {
+                Boards().Invalidate(change.first);
+            }
+            Persist();
+        }
+
+        // Run `stage` with writes going to a batch, then apply that batch as one change — or, inside a
+        // transaction, just stage into it.
+        template <typename Fn>
+        static void Batched(Fn &&stage) {
+            if (_transaction) {
+                stage();
+                return;
+            }
+            Core::Storage::WriteBatch batch;
+            _transaction = &batch;
+            stage();
+            _transaction = nullptr;
+            Commit(batch);
+        }
+
+        // Scans read the committed store only; rather than silently miss staged writes, they refuse.
+        static bool RejectInTransaction(const v8::FunctionCallbackInfo<v8::Value> &info, const char *name) {
+            if (!_transaction) {
+                return false;
+            }
+            auto *isolate = info.GetIsolate();
+            isolate->ThrowException(v8::Exception::Error(v8pp::to_v8(isolate, std::string(name) + " can't be used inside Storage.transaction")));
+            return true;
+        }
+
+        // A JS array of strings, or nullopt after throwing `usage`.
+        static std::optional<std::vector<std::string>> StringArray(const v8::FunctionCallbackInfo<v8::Value> &info, const char *usage) {
+            auto *isolate = info.GetIsolate();
+            auto ctx      = isolate->GetCurrentContext();
+            if (info.Length() < 1 || !info[0]->IsArray()) {
+                isolate->ThrowException(v8::Exception::TypeError(v8pp::to_v8(isolate, usage)));
+                return std::nullopt;
+            }
+            const auto arr = info[0].As<v8::Array>();
+            std::vector<std::string> keys;
+            keys.reserve(arr->Length());
+            for (uint32_t i = 0; i < arr->Length(); ++i) {
+                v8::Local<v8::Value> item;
+                if (!arr->Get(ctx, i).ToLocal(&item) || !item->IsString()) {
+                    isolate->ThrowException(v8::Exception::TypeError(v8pp::to_v8(isolate, usage)));
+                    return std::nullopt;
+                }
+                keys.push_back(v8pp::from_v8<std::string>(isolate, item));
+            }
+            return keys;
+        }
+
+        struct SetArgs {
+            std::string key;
+            std::string value;
+            std::optional<uint64_t> ttlMs;
+        };
+
+        // set(key, value, { ttlMs }?) arguments, or nullopt after throwing.
+        static std::optional<SetArgs> ParseSetArgs(const v8::FunctionCallbackInfo<v8::Value> &info) {
+            auto *isolate               = info.GetIsolate();
+            auto ctx                    = isolate->GetCurrentContext();
+            constexpr const char *usage = "set(key, value, options?) requires string key and value, and options.ttlMs a non-negative number";
+            if (info.Length() < 2 || !info[0]->IsString() || !info[1]->IsString()) {
+                isolate->ThrowException(v8::Exception::TypeError(v8pp::to_v8(isolate, usage)));
+                return std::nullopt;
+            }
+            SetArgs args {v8pp::from_v8<std::string>(isolate, info[0]), v8pp::from_v8<std::string>(isolate, info[1]), std::nullopt};
+            if (info.Length() > 2 && !info[2]->IsUndefined()) {
+                v8::Local<v8::Value> ttl;
+                if (!info[2]->IsObject() || !info[2].As<v8::Object>()->Get(ctx, v8pp::to_v8(isolate, "ttlMs")).ToLocal(&ttl)) {
+                    isolate->ThrowException(v8::Exception::TypeError(v8pp::to_v8(isolate, usage)));
+                    return std::nullopt;
+                }
+                if (!ttl->IsUndefined()) {
+                    const double ms = ttl->IsNumber() ? ttl.As<v8::Number>()->Value() : -1.0;
+                    if (!(ms >= 0.0) || !std::isfinite(ms)) {
+                        isolate->ThrowException(v8::Exception::TypeError(v8pp::to_v8(isolate, usage)));
+                        return std::nullopt;
+                    }
+                    args.ttlMs = static_cast<uint64_t>(ms);
+                }
+            }
+            return args;
+        }
+
+        static void JsSet(const v8::FunctionCallbackInfo<v8::Value> &info) {
+            auto args = ParseSetArgs(info);
+            if (!args) {
+                return;
+            }
+            if (args->ttlMs && _transaction) {
+                auto *isolate = info.GetIsolate();
+                isolate->ThrowException(v8::Exception::Error(v8pp::to_v8(isolate, "Storage.set with a ttlMs can't be used inside Storage.transaction")));
+                return;
+            }
+            Write(std::move(args->key), std::move(args->value), args->ttlMs);
+        }
+
+        // Storage.async: the same operations, deferred to the next tick. They run outside any
+        // Storage.transaction, whenever they were called.
+        static void JsAsyncGet(const v8::FunctionCallbackInfo<v8::Value> &info) {
+            auto *isolate = info.GetIsolate();
+            if (info.Length() < 1 || !info[0]->IsString()) {
+                isolate->ThrowException(v8::Exception::TypeError(v8pp::to_v8(isolate, "async.get(key) requires a string key")));
+                return;
+            }
+            info.GetReturnValue().Set(Defer(isolate, {}, [key = v8pp::from_v8<std::string>(isolate, info[0])](v8::Isolate *isolate) {
+                const auto value = Store().Get(key);
+                return value ? v8pp::to_v8(isolate, *value).As<v8::Value>() : v8::Undefined(isolate).As<v8::Value>();
+            }));
+        }
+
+        static void JsAsyncSet(const v8::FunctionCallbackInfo<v8::Value> &info) {
+            auto args = ParseSetArgs(info);
+            if (!args) {
+                return;
+            }
+            info.GetReturnValue().Set(Defer(info.GetIsolate(), {}, [args = std::move(*args)](v8::Isolate *) mutable {
+                Write(std::move(args.key), std::move(args.value), args.ttlMs);
+                return v8::Local<v8::Value>();
+            }));
+        }
+
+        static void JsAsyncDelete(const v8::FunctionCallbackInfo<v8::Value> &info) {
+            auto *isolate = info.GetIsolate();
+            if (info.Length() < 1 || !info[0]->IsString()) {
+                isolate->ThrowException(v8::Exception::TypeError(v8pp::to_v8(isolate, "async.delete(key) requires a string key")));
+                return;
+            }
+            info.GetReturnValue().Set(Defer(isolate, {}, [key = v8pp::from_v8<std::string>(isolate, info[0])](v8::Isolate *isolate) {
+                return v8::Boolean::New(isolate, Remove(key)).As<v8::Value>();
+            }));
+        }
+
+        static void JsAsyncKeys(const v8::FunctionCallbackInfo<v8::Value> &info) {
+            constexpr const char *usage = "async.keys(prefix?, limit?) requires a string prefix and a non-negative limit";
+            const auto prefix           = OptionalString(info, 0, usage);
+            const auto limit            = prefix ? OptionalLimit(info, 1, usage) : std::nullopt;
+            if (!prefix || !limit) {
+                return;
+            }
+            info.GetReturnValue().Set(Defer(info.GetIsolate(), {}, [prefix = *prefix, limit = *limit](v8::Isolate *isolate) {
+                return v8pp::to_v8(isolate, Store().Keys(prefix, limit)).As<v8::Value>();
+            }));
+        }
+
+        static void JsTtl(const v8::FunctionCallbackInfo<v8::Value> &info) {
+            auto *isolate = info.GetIsolate();
+            if (info.Length() < 1 || !info[0]->IsString()) {
+                isolate->ThrowException(v8::Exception::TypeError(v8pp::to_v8(isolate, "ttl(key) requires a string key")));
+                return;
+            }
+            const auto key = v8pp::from_v8<std::string>(isolate, info[0]);
+            if (_transaction && _transaction->Find(key)) {
+                return; // staged writes carry no ttl
+            }
+            if (const auto ms = Store().TimeToLive(key)) {
+                info.GetReturnValue().Set(static_cast<double>(*ms));
+            }
+        }
+
+        static void JsSetMany(const v8::FunctionCallbackInfo<v8::Value> &info) {
+            auto *isolate               = info.GetIsolate();
+            auto ctx                    = isolate->GetCurrentContext();
+            constexpr const char *usage = "setMany(values) requires an object of string values";
+            if (info.Length() < 1 || !info[0]->IsObject() || info[0]->IsArray()) {
+                isolate->ThrowException(v8::Exception::TypeError(v8pp::to_v8(isolate, usage)));
+                return;
+            }
+            const auto obj = info[0].As<v8::Object>();
+            v8::Local<v8::Array> names;
+            if (!obj->GetOwnPropertyNames(ctx, v8::ONLY_ENUMERABLE, v8::KeyConversionMode::kConvertToString).ToLocal(&names)) {
+                return;
+            }
+            // Convert everything before staging anything, so a bad value leaves the store untouched.
+            std::vector<std::pair<std::string, std::string>> values;
+            values.reserve(names->Length());
+            for (uint32_t i = 0; i < names->Length(); ++i) {
+                v8::Local<v8::Value> name;
+                v8::Local<v8::Value> value;
+                if (!names->Get(ctx, i).ToLocal(&name) || !obj->Get(ctx, name).ToLocal(&value)) {
+                    return;
+                }
+                if (!value->IsString()) {
+                    isolate->ThrowException(v8::Exception::TypeError(v8pp::to_v8(isolate, usage)));
+                    return;
+                }
+                values.emplace_back(v8pp::from_v8<std::string>(isolate, name), v8pp::from_v8<std::string>(isolate, value));
+            }
+            Batched([&] {
+                for (auto &[key, value] : values) {
+                    _transaction->Set(std::move(key), std::move(value));
+                }
+            });
+        }
+
+        static void JsGetMany(const v8::FunctionCallbackInfo<v8::Value> &info) {
+            auto *isolate   = info.GetIsolate();
+            const auto keys = StringArray(info, "getMany(keys) requires an array of string keys");
+            if (!keys) {
+                return;
+            }
+            auto ctx                 = isolate->GetCurrentContext();
+            v8::Local<v8::Array> arr = v8::Array::New(isolate, static_cast<int>(keys->size()));
+            for (size_t i = 0; i < keys->size(); ++i) {
+                const auto value = Read((*keys)[i]);
+                arr->Set(ctx, static_cast<uint32_t>(i), value ? v8pp::to_v8(isolate, *value).As<v8::Value>() : v8::Undefined(isolate).As<v8::Value>()).Check();
+            }
+            info.GetReturnValue().Set(arr);
+        }
+
+        static void JsDeleteMany(const v8::FunctionCallbackInfo<v8::Value> &info) {
+            const auto keys = StringArray(info, "deleteMany(keys) requires an array of string keys");
+            if (!keys) {
+                return;
+            }
+            uint32_t removed = 0;
+            Batched([&] {
+                for (const auto &key : *keys) {
+                    removed += Remove(key) ? 1 : 0;
+                }
+            });
+            info.GetReturnValue().Set(removed);
+        }
+
+        // Optional finite number at index i (fallback when absent); nullopt after throwing `usage`.
+        static std::optional<double> OptionalNumber(const v8::FunctionCallbackInfo<v8::Value> &info, int i, double fallback, const char *usage) {
+            auto *isolate = info.GetIsolate();
+            if (info.Length() <= i || info[i]->IsUndefined()) {
+                return fallback;
             }
+            const double value = info[i]->IsNumber() ? info[i].As<v8::Number>()->Value() : std::nan("");
+            if (!std::isfinite(value)) {
+                isolate->ThrowException(v8::Exception::TypeError(v8pp::to_v8(isolate, usage)));
+                return std::nullopt;
+            }
+            return value;
+        }
+
+        static void JsIncr(const v8::FunctionCallbackInfo<v8::Value> &info) {
+            auto *isolate               = info.GetIsolate();
+            constexpr const char *usage = "incr(key, delta?) requires a string key and a finite number";
+            if (info.Length() < 1 || !info[0]->IsString()) {
+                isolate->ThrowException(v8::Exception::TypeError(v8pp::to_v8(isolate, usage)));
+                return;
+            }
+            const auto delta = OptionalNumber(info, 1, 1.0, usage);
+            if (!delta) {
+                return;
+            }
+            const auto key = v8pp::from_v8<std::string>(isolate, info[0]);
+            if (!_transaction) {
+                if (const auto value = Increment(isolate, Store(), key, *delta)) {
+                    Boards().Invalidate(key);
+                    info.GetReturnValue().Set(*value);
+                }
+                return;
+            }
+            // Staged: same arithmetic, against what the transaction sees.
+            const auto current = Read(key);
+            const auto parsed  = current ? Core::Storage::KeyValueStore::ParseNumber(*current) : std::optional<double>(0.0);
+            const double value = parsed ? *parsed + *delta : 0.0;
+            if (!parsed || !std::isfinite(value)) {
+                isolate->ThrowException(v8::Exception::TypeError(v8pp::to_v8(isolate, "can't increment '" + key + "': its value is not a number")));
+                return;
+            }
+            Write(key, Core::Storage::KeyValueStore::FormatNumber(value));
+            info.GetReturnValue().Set(value);
+        }
+
+        static void JsTransaction(const v8::FunctionCallbackInfo<v8::Value> &info) {
+            auto *isolate = info.GetIsolate();
+            auto ctx      = isolate->GetCurrentContext();
+            if (info.Length() < 1 || !info[0]->IsFunction()) {
+                isolate->ThrowException(v8::Exception::TypeError(v8pp::to_v8(isolate, "transaction(fn) requires a function")));
+                return;
+            }
+            const auto fn = info[0].As<v8::Function>();
+            v8::Local<v8::Value> result;
+            if (_transaction) {
+                // Nested: joins the outer transaction, but a throw still undoes its own writes — the outer
+                // fn may catch it and commit the rest. Staging replaces changes in place, so keep a copy.
+                const Core::Storage::WriteBatch before = *_transaction;
+                if (fn->Call(ctx, v8::Undefined(isolate), 0, nullptr).ToLocal(&result)) {
+                    info.GetReturnValue().Set(result);
+                }
+                else {
+                    *_transaction = before;
+                }
+                return;
+            }
+
+            Core::Storage::WriteBatch batch;
+            _transaction      = &batch;
+            const bool called = fn->Call(ctx, v8::Undefined(isolate), 0, nullptr).ToLocal(&result);
+            _transaction      = nullptr;
+            if (!called) {
+                return; // fn threw: drop the staged writes and let the exception propagate
+            }
+            if (result->IsPromise()) {
+                // Writes after an await would escape the transaction; refuse the whole thing.
+                isolate->ThrowException(v8::Exception::TypeError(v8pp::to_v8(isolate, "transaction(fn) requires a synchronous function; nothing was written")));
+                return;
+            }
+            Commit(batch);
+            info.GetReturnValue().Set(result);
         }
 
         static void JsGet(const v8::FunctionCallbackInfo<v8::Value> &info) {
@@ -76,7 +743,7 @@ namespace HogwartsMP::Scripting {
                 return;
             }
             const auto key   = v8pp::from_v8<std::string>(isolate, info[0]);
-            const auto value = Store().Get(key);
+            const auto value = Read(key);
             if (value) {
                 info.GetReturnValue().Set(v8pp::to_v8(isolate, *value));
             }
@@ -86,19 +753,314 @@ namespace HogwartsMP::Scripting {
         }
 
         static bool Has(std::string key) {
-            return Store().Has(key);
+            return Exists(key);
         }
 
         static bool Delete(std::string key) {
-            const bool erased = Store().Erase(key);
-            if (erased && !Store().Save()) {
-                Framework::Logging::GetLogger("Scripting")->warn("Storage.delete('{}') failed to persist to {}", key, STORAGE_FILE);
+            return Remove(key);
+        }
+
+        // Optional string argument at index i: "" when absent/undefined, nullopt (after throwing) when it
+        // is present but not a string.
+        static std::optional<std::string> OptionalString(const v8::FunctionCallbackInfo<v8::Value> &info, int i, const char *usage) {
+            auto *isolate = info.GetIsolate();
+            if (info.Length() <= i || info[i]->IsUndefined()) {
+                return std::string();
             }
-            return erased;
+            if (!info[i]->IsString()) {
+                isolate->ThrowException(v8::Exception::TypeError(v8pp::to_v8(isolate, usage)));
+                return std::nullopt;
+            }
+            return v8pp::from_v8<std::string>(isolate, info[i]);
+        }
+
+        // Optional non-negative limit at index i (0 = unlimited); nullopt after throwing on a bad value.
+        static std::optional<size_t> OptionalLimit(const v8::FunctionCallbackInfo<v8::Value> &info, int i, const char *usage) {
+            auto *isolate = info.GetIsolate();
+            if (info.Length() <= i || info[i]->IsUndefined()) {
+                return size_t {0};
+            }
+            const double limit = info[i]->IsNumber() ? info[i]->NumberValue(isolate->GetCurrentContext()).FromMaybe(-1.0) : -1.0;
+            if (!(limit >= 0.0)) {
+                isolate->ThrowException(v8::Exception::TypeError(v8pp::to_v8(isolate, usage)));
+                return std::nullopt;
+            }
+            return static_cast<size_t>(limit);
+        }
+
+        static v8::Local<v8::Array> EntriesToJs(v8::Isolate *isolate, const std::vector<Core::Storage::KeyValueStore::Entry> &entries) {
+            auto ctx                 = isolate->GetCurrentContext();
+            v8::Local<v8::Array> arr = v8::Array::New(isolate, static_cast<int>(entries.size()));
+            for (size_t i = 0; i < entries.size(); ++i) {
+                v8::Local<v8::Value> pair[] = {v8pp::to_v8(isolate, entries[i].first), v8pp::to_v8(isolate, entries[i].second)};
+                arr->Set(ctx, static_cast<uint32_t>(i), v8::Array::New(isolate, pair, 2)).Check();
+            }
+            return arr;
         }
 
-        static std::vector<std::string> Keys() {
-            return Store().Keys();
+        static void JsKeys(const v8::FunctionCallbackInfo<v8::Value> &info) {
+            if (RejectInTransaction(info, "Storage.keys")) {
+                return;
+            }
+            constexpr const char *usage = "keys(prefix?, limit?) requires a string prefix and a non-negative limit";
+            const auto prefix           = OptionalString(info, 0, usage);
+            const auto limit            = prefix ? OptionalLimit(info, 1, usage) : std::nullopt;
+            if (!prefix || !limit) {
+                return;
+            }
+            info.GetReturnValue().Set(v8pp::to_v8(info.GetIsolate(), Store().Keys(*prefix, *limit)));
         }
+
+        static void JsEntries(const v8::FunctionCallbackInfo<v8::Value> &info) {
+            if (RejectInTransaction(info, "Storage.entries")) {
+                return;
+            }
+            constexpr const char *usage = "entries(prefix?, limit?) requires a string prefix and a non-negative limit";
+            const auto prefix           = OptionalString(info, 0, usage);
+            const auto limit            = prefix ? OptionalLimit(info, 1, usage) : std::nullopt;
+            if (!prefix || !limit) {
+                return;
+            }
+            info.GetReturnValue().Set(EntriesToJs(info.GetIsolate(), Store().Entries(*prefix, *limit)));
+        }
+
+        static void JsRange(const v8::FunctionCallbackInfo<v8::Value> &info) {
+            if (RejectInTransaction(info, "Storage.range")) {
+                return;
+            }
+            auto *isolate               = info.GetIsolate();
+            constexpr const char *usage = "range(start, end?, limit?) requires string bounds and a non-negative limit";
+            if (info.Length() < 1 || !info[0]->IsString()) {
+                isolate->ThrowException(v8::Exception::TypeError(v8pp::to_v8(isolate, usage)));
+                return;
+            }
+            const auto start = v8pp::from_v8<std::string>(isolate, info[0]);
+            const auto end   = OptionalString(info, 1, usage);
+            const auto limit = end ? OptionalLimit(info, 2, usage) : std::nullopt;
+            if (!end || !limit) {
+                return;
+            }
+            info.GetReturnValue().Set(EntriesToJs(isolate, Store().Range(start, *end, *limit)));
+        }
+
+        // The set name at index 0, or nullopt after throwing `usage` (or the name rule).
+        static std::optional<std::string> SetName(const v8::FunctionCallbackInfo<v8::Value> &info, const char *usage) {
+            auto *isolate = info.GetIsolate();
+            if (info.Length() < 1 || !info[0]->IsString()) {
+                isolate->ThrowException(v8::Exception::TypeError(v8pp::to_v8(isolate, usage)));
+                return std::nullopt;
+            }
+            auto set = v8pp::from_v8<std::string>(isolate, info[0]);
+            if (!Core::Storage::SortedSets::IsValidName(set)) {
+                isolate->ThrowException(v8::Exception::TypeError(v8pp::to_v8(isolate, "sorted set names must be non-empty and can't contain ':'")));
+                return std::nullopt;
+            }
+            return set;
+        }
+
+        // (set, member) from indexes 0 and 1, or nullopt after throwing.
+        static std::optional<std::pair<std::string, std::string>> SetAndMember(const v8::FunctionCallbackInfo<v8::Value> &info, const char *usage) {
+            auto *isolate  = info.GetIsolate();
+            const auto set = SetName(info, usage);
+            if (!set) {
+                return std::nullopt;
+            }
+            if (info.Length() < 2 || !info[1]->IsString()) {
+                isolate->ThrowException(v8::Exception::TypeError(v8pp::to_v8(isolate, usage)));
+                return std::nullopt;
+            }
+            return std::make_pair(*set, v8pp::from_v8<std::string>(isolate, info[1]));
+        }
+
+        static v8::Local<v8::Array> ItemsToJs(v8::Isolate *isolate, const std::vector<Core::Storage::SortedSet::Item> &items) {
+            auto ctx                 = isolate->GetCurrentContext();
+            v8::Local<v8::Array> arr = v8::Array::New(isolate, static_cast<int>(items.size()));
+            for (size_t i = 0; i < items.size(); ++i) {
+                v8::Local<v8::Value> pair[] = {v8pp::to_v8(isolate, items[i].first), v8::Number::New(isolate, items[i].second)};
+                arr->Set(ctx, static_cast<uint32_t>(i), v8::Array::New(isolate, pair, 2)).Check();
+            }
+            return arr;
+        }
+
+        static void JsZAdd(const v8::FunctionCallbackInfo<v8::Value> &info) {
+            if (RejectInTransaction(info, "Storage.zadd")) {
+                return;
+            }
+            constexpr const char *usage = "zadd(set, member, score) requires string names and a finite score";
+            const auto args             = SetAndMember(info, usage);
+            if (!args) {
+                return;
+            }
+            if (info.Length() < 3 || info[2]->IsUndefined()) {
+                info.GetIsolate()->ThrowException(v8::Exception::TypeError(v8pp::to_v8(info.GetIsolate(), usage)));
+                return;
+            }
+            const auto score = OptionalNumber(info, 2, 0.0, usage);
+            if (!score) {
+                return;
+            }
+            info.GetReturnValue().Set(Boards().Add(args->first, args->second, *score));
+            Persist();
+        }
+
+        static void JsZIncr(const v8::FunctionCallbackInfo<v8::Value> &info) {
+            if (RejectInTransaction(info, "Storage.zincr")) {
+                return;
+            }
+            auto *isolate               = info.GetIsolate();
+            constexpr const char *usage = "zincr(set, member, delta?) requires string names and a finite delta";
+            const auto args             = SetAndMember(info, usage);
+            const auto delta            = args ? OptionalNumber(info, 2, 1.0, usage) : std::nullopt;
+            if (!delta) {
+                return;
+            }
+            const auto score = Boards().IncrBy(args->first, args->second, *delta);
+            if (!score) {
+                isolate->ThrowException(v8::Exception::RangeError(v8pp::to_v8(isolate, "zincr would make the score of '" + args->second + "' infinite")));
+                return;
+            }
+            info.GetReturnValue().Set(*score);
+            Persist();
+        }
+
+        static void JsZScore(const v8::FunctionCallbackInfo<v8::Value> &info) {
+            if (RejectInTransaction(info, "Storage.zscore")) {
+                return;
+            }
+            const auto args = SetAndMember(info, "zscore(set, member) requires string names");
+            if (!args) {
+                return;
+            }
+            if (const auto score = Boards().Get(args->first).Score(args->second)) {
+                info.GetReturnValue().Set(*score);
+            }
+        }
+
+        static void JsZRem(const v8::FunctionCallbackInfo<v8::Value> &info) {
+            if (RejectInTransaction(info, "Storage.zrem")) {
+                return;
+            }
+            const auto args = SetAndMember(info, "zrem(set, member) requires string names");
+            if (!args) {
+                return;
+            }
+            const bool removed = Boards().Remove(args->first, args->second);
+            if (removed) {
+                Persist();
+            }
+            info.GetReturnValue().Set(removed);
+        }
+
+        static void JsZCard(const v8::FunctionCallbackInfo<v8::Value> &info) {
+            if (RejectInTransaction(info, "Storage.zcard")) {
+                return;
+            }
+            const auto set = SetName(info, "zcard(set) requires a string name");
+            if (!set) {
+                return;
+            }
+            info.GetReturnValue().Set(static_cast<double>(Boards().Get(*set).Size()));
+        }
+
+        template <bool Reverse>
+        static void JsZRank(const v8::FunctionCallbackInfo<v8::Value> &info) {
+            if (RejectInTransaction(info, Reverse ? "Storage.zrevrank" : "Storage.zrank")) {
+                return;
+            }
+            const auto args = SetAndMember(info, Reverse ? "zrevrank(set, member) requires string names" : "zrank(set, member) requires string names");
+            if (!args) {
+                return;
+            }
+            const auto &board = Boards().Get(args->first);
+            if (const auto rank = board.Rank(args->second)) {
+                info.GetReturnValue().Set(static_cast<double>(Reverse ? board.Size() - 1 - *rank : *rank));
+            }
+        }
+
+        // A position argument: an integer, negative counting back from `size`; nullopt after throwing.
+        static std::optional<double> Position(const v8::FunctionCallbackInfo<v8::Value> &info, int i, double fallback, size_t size, const char *usage) {
+            const auto value = OptionalNumber(info, i, fallback, usage);
+            if (!value) {
+                return std::nullopt;
+            }
+            if (std::trunc(*value) != *value) {
+                info.GetIsolate()->ThrowException(v8::Exception::TypeError(v8pp::to_v8(info.GetIsolate(), usage)));
+                return std::nullopt;
+            }
+            return *value < 0 ? *value + static_cast<double>(size) : *value;
+        }
+
+        template <bool Reverse>
+        static void JsZRange(const v8::FunctionCallbackInfo<v8::Value> &info) {
+            if (RejectInTransaction(info, Reverse ? "Storage.zrevrange" : "Storage.zrange")) {
+                return;
+            }
+            constexpr const char *usage = Reverse ? "zrevrange(set, start, stop?) requires a string name and integer positions"
+                                                  : "zrange(set, start, stop?) requires a string name and integer positions";
+            const auto set              = SetName(info, usage);
+            if (!set) {
+                return;
+            }
+            const auto &board = Boards().Get(*set);
+            const size_t size = board.Size();
+            if (info.Length() < 2 || info[1]->IsUndefined()) {
+                info.GetIsolate()->ThrowException(v8::Exception::TypeError(v8pp::to_v8(info.GetIsolate(), usage)));
+                return;
+            }
+            const auto start = Position(info, 1, 0.0, size, usage);
+            const auto stop  = start ? Position(info, 2, -1.0, size, usage) : std::nullopt;
+            if (!stop) {
+                return;
+            }
+            std::vector<Core::Storage::SortedSet::Item> items;
+            if (*stop >= 0 && *start <= *stop && *start < static_cast<double>(size)) {
+                // Positions from the top map onto ascending ones mirrored about the middle.
+                const size_t first = static_cast<size_t>(std::max(*start, 0.0));
+                const size_t last  = static_cast<size_t>(std::min(*stop, static_cast<double>(size - 1)));
+                items              = Reverse ? board.RangeByRank(size - 1 - last, size - 1 - first) : board.RangeByRank(first, last);
+                if (Reverse) {
+                    std::reverse(items.begin(), items.end());
+                }
+            }
+            info.GetReturnValue().Set(ItemsToJs(info.GetIsolate(), items));
+        }
+
+        static void JsZRangeByScore(const v8::FunctionCallbackInfo<v8::Value> &info) {
+            if (RejectInTransaction(info, "Storage.zrangeByScore")) {
+                return;
+            }
+            auto *isolate               = info.GetIsolate();
+            constexpr const char *usage = "zrangeByScore(set, min, max, limit?) requires a string name, numeric bounds and a non-negative limit";
+            const auto set              = SetName(info, usage);
+            if (!set) {
+                return;
+            }
+            // Bounds may be infinite (-Infinity / Infinity for an open end), but not NaN.
+            if (info.Length() < 3 || !info[1]->IsNumber() || !info[2]->IsNumber() || std::isnan(info[1].As<v8::Number>()->Value()) ||
+                std::isnan(info[2].As<v8::Number>()->Value())) {
+                isolate->ThrowException(v8::Exception::TypeError(v8pp::to_v8(isolate, usage)));
+                return;
+            }
+            const auto limit = OptionalLimit(info, 3, usage);
+            if (!limit) {
+                return;
+            }
+            const double min = info[1].As<v8::Number>()->Value();
+            const double max = info[2].As<v8::Number>()->Value();
+            info.GetReturnValue().Set(ItemsToJs(isolate, Boards().Get(*set).RangeByScore(min, max, *limit)));
+        }
+
+        inline static Core::Storage::Durability _durability;
+        // The open Storage.transaction's staged writes (nullptr outside one).
+        inline static Core::Storage::WriteBatch *_transaction = nullptr;
+        inline static std::chrono::steady_clock::time_point _lastCommit {};
+        inline static Core::Storage::KeyValueStore::Clock _clock;
+
+        struct Deferred {
+            v8::Global<v8::Promise::Resolver> resolver;
+            std::string identity; // shard to wait for ("" = none)
+            DeferredFn fn;
+        };
+        inline static std::vector<Deferred> _deferred;
     };
 } // namespace HogwartsMP::Scripting
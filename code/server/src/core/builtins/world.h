@@ -8,15 +8,19 @@
 #include "events.h"
 #include "human.h"
 
+#include "core/events/script_events.h"
+#include "core/modules/crowd.h"
 #include "core/modules/human.h"
 #include "core/server.h"
 
 #include "shared/game/human.h"
 #include "shared/game/weather.h"
+#include "shared/modules/appearance.hpp"
+#include "shared/rpc/script_event.h"
 #include "shared/rpc/set_weather.h"
+#include "shared/script_payload_v8.h"
 
 #include <core_modules.h>
-#include <integrations/shared/rpc/emit_lua_event.h>
 #include <logging/logger.h>
 #include <networking/network_peer.h>
 #include <networking/replication/replication_manager.h>
@@ -24,15 +28,66 @@
 
 #include <mafianet/types.h>
 
-#include <nlohmann/json.hpp>
+#include <glm/gtc/quaternion.hpp>
 
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
 #include <cstdint>
+#include <memory>
 #include <string>
 #include <vector>
 
 namespace HogwartsMP::Scripting {
     class World final {
       public:
+        // object[name] as a number, or NaN when it is missing or not a number.
+        static double NumberProperty(v8::Local<v8::Context> context, v8::Local<v8::Object> object, const char *name) {
+            v8::Local<v8::Value> value;
+            if (!object->Get(context, v8pp::to_v8(context->GetIsolate(), name)).ToLocal(&value) || !value->IsNumber()) {
+                return std::nan("");
+            }
+            return value.As<v8::Number>()->Value();
+        }
+
+        // A list of positions (moveAlong's path, spawnHumans' positions): an array of {x, y, z} (Vector3s
+        // included) or a Float32Array of xyz triples. False on anything else, a non-finite coordinate, or an
+        // empty list or one longer than maxPoints.
+        static bool ReadPoints(v8::Local<v8::Context> context, v8::Local<v8::Value> value, std::vector<glm::vec3> &points, size_t maxPoints) {
+            if (value->IsFloat32Array()) {
+                const auto floats = value.As<v8::Float32Array>();
+                const size_t size = floats->Length();
+                if (size % 3 != 0 || size / 3 > maxPoints) {
+                    return false;
+                }
+                points.resize(size / 3);
+                floats->CopyContents(points.data(), size * sizeof(float));
+            }
+            else if (value->IsArray()) {
+                const auto list = value.As<v8::Array>();
+                if (list->Length() > maxPoints) {
+                    return false;
+                }
+                points.reserve(list->Length());
+                for (uint32_t i = 0; i < list->Length(); ++i) {
+                    v8::Local<v8::Value> point;
+                    if (!list->Get(context, i).ToLocal(&point) || !point->IsObject()) {
+                        return false;
+                    }
+                    const auto object = point.As<v8::Object>();
+                    points.push_back({static_cast<float>(NumberProperty(context, object, "x")), static_cast<float>(NumberProperty(context, object, "y")),
+                                      static_cast<float>(NumberProperty(context, object, "z"))});
+                }
+            }
+            else {
+                return false;
+            }
+            const bool finite = std::all_of(points.begin(), points.end(), [](const glm::vec3 &p) {
+                return std::isfinite(p.x) && std::isfinite(p.y) && std::isfinite(p.z);
+            });
+            return finite && !points.empty();
+        }
+
         static void BroadcastMessage(std::string message) {
             auto *peer = Framework::CoreModules::GetNetworkPeer();
             if (!peer) {
@@ -52,13 +107,93 @@ namespace HogwartsMP::Scripting {
         // (Core.Events). payloadJson is JSON.parsed on the client into the handler's single argument,
         // so pass JSON text (e.g. JSON.stringify(obj)); empty -> handler called with no argument.
         static void EmitAllClients(std::string eventName, std::string payloadJson) {
-            auto *peer = Framework::CoreModules::GetNetworkPeer();
-            if (!peer) {
+            Shared::RPC::ScriptEvent ev;
+            ev.payload = std::move(payloadJson);
+            Core::Events::ScriptEvents::Get().Broadcast(eventName, ev);
+        }
+
+        // World.emitAllClientsPacked(name, value) — emitAllClients without the JSON text: value is packed
+        // natively (Shared::ScriptPayload) and unpacked on each client straight into the handler argument.
+        // For events sent many times a second. Throws on a value that cannot be packed, or over the size cap.
+        static void JsEmitAllClientsPacked(const v8::FunctionCallbackInfo<v8::Value> &info) {
+            std::string eventName;
+            Shared::RPC::ScriptEvent ev;
+            if (PackEventArgs(info, "emitAllClientsPacked", eventName, ev)) {
+                Core::Events::ScriptEvents::Get().Broadcast(eventName, ev);
+            }
+        }
+
+        // (name, value) from a *Packed emitter's arguments into eventName and a packed ev; throws and returns
+        // false when they are unusable.
+        static bool PackEventArgs(const v8::FunctionCallbackInfo<v8::Value> &info, const char *fn, std::string &eventName, Shared::RPC::ScriptEvent &ev) {
+            auto *isolate = info.GetIsolate();
+            if (info.Length() < 2 || !info[0]->IsString()) {
+                isolate->ThrowException(v8::Exception::TypeError(v8pp::to_v8(isolate, std::string(fn) + "(name, value) requires an event name")));
+                return false;
+            }
+            eventName   = v8pp::from_v8<std::string>(isolate, info[0]);
+            ev.encoding = Shared::RPC::ScriptEvent::Packed;
+            bool packed = false;
+            {
+                v8::TryCatch tryCatch(isolate);
+                packed = Shared::ScriptPayload::Pack(isolate, isolate->GetCurrentContext(), info[1], ev.payload);
+                if (tryCatch.HasCaught()) {
+                    tryCatch.ReThrow(); // a getter threw: that error, not ours
+                    return false;
+                }
+            }
+            if (!packed || ev.payload.size() > Shared::ScriptPayload::kMaxBytes) {
+                isolate->ThrowException(v8::Exception::TypeError(
+                    v8pp::to_v8(isolate, std::string(fn) + ": value must be plain data (no functions or symbols), under 64 KiB and 32 levels deep")));
+                return false;
+            }
+            return true;
+        }
+
+        // Floats per entity in World.setTransforms' transforms array: position xyz, rotation as Euler
+        // degrees xyz (like human.rotation), velocity xyz.
+        static constexpr size_t kTransformStride = 9;
+
+        // World.setTransforms(ids, transforms, flags?) -> number updated
+        // Move many humans in one call instead of position/rotation/setVelocity/setInAir per entity, each
+        // a native crossing and an entity lookup. ids is a Float64Array, Uint32Array or Int32Array of
+        // network ids; transforms a Float32Array of kTransformStride floats per id; flags, if given, a
+        // Uint8Array with each entity's whole state-flag byte (InAir, Mounted, ...). Unknown ids are skipped.
+        static void JsSetTransforms(const v8::FunctionCallbackInfo<v8::Value> &info) {
+            auto *isolate = info.GetIsolate();
+            const bool badFlags = info.Length() > 2 && !info[2]->IsUndefined() && !info[2]->IsUint8Array();
+            if (info.Length() < 2 || !info[0]->IsTypedArray() || !info[1]->IsFloat32Array() || badFlags) {
+                isolate->ThrowException(v8::Exception::TypeError(
+                    v8pp::to_v8(isolate, "setTransforms(ids, transforms, flags?) requires a typed array of ids, a Float32Array and an optional Uint8Array")));
                 return;
             }
-            Framework::Integrations::Shared::RPC::EmitLuaEvent ev;
-            ev.FromParameters(eventName, payloadJson);
-            peer->BroadcastRPC(ev);
+            const auto ids        = info[0].As<v8::TypedArray>();
+            const auto transforms = info[1].As<v8::Float32Array>();
+            const size_t count    = ids->Length();
+            const bool hasFlags   = info.Length() > 2 && info[2]->IsUint8Array();
+            if (transforms->Length() < count * kTransformStride || (hasFlags && info[2].As<v8::Uint8Array>()->Length() < count)) {
+                isolate->ThrowException(v8::Exception::RangeError(v8pp::to_v8(isolate, "setTransforms: transforms needs 9 floats and flags 1 byte per id")));
+                return;
+            }
+            const auto *floats = reinterpret_cast<const float *>(ViewData(transforms));
+            const auto *flags  = hasFlags ? ViewData(info[2].As<v8::Uint8Array>()) : nullptr;
+
+            const uint8_t *idData = ViewData(ids);
+            size_t updated        = 0;
+            if (ids->IsFloat64Array()) {
+                updated = ApplyTransforms(reinterpret_cast<const double *>(idData), count, floats, flags);
+            }
+            else if (ids->IsUint32Array()) {
+                updated = ApplyTransforms(reinterpret_cast<const uint32_t *>(idData), count, floats, flags);
+            }
+            else if (ids->IsInt32Array()) {
+                updated = ApplyTransforms(reinterpret_cast<const int32_t *>(idData), count, floats, flags);
+            }
+            else {
+                isolate->ThrowException(v8::Exception::TypeError(v8pp::to_v8(isolate, "setTransforms: ids must be a Float64Array, Uint32Array or Int32Array")));
+                return;
+            }
+            info.GetReturnValue().Set(static_cast<double>(updated));
         }
 
         // World.spawnHuman(x, y, z) -> Human
@@ -88,7 +223,126 @@ namespace HogwartsMP::Scripting {
             if (!human) {
                 return;
             }
-            info.GetReturnValue().Set(v8pp::class_<Human>::create_object(isolate, human->GetNetworkID()));
+            info.GetReturnValue().Set(Human::Wrap(isolate, human->GetNetworkID()));
+        }
+
+        // Most NPCs one World.spawnHumans call creates.
+        static constexpr size_t kMaxSpawnBatch = 4096;
+
+        // World.spawnHumans(positions, options?) -> Human[]
+        // spawnHuman for many NPCs at once: positions is an array of {x, y, z} or a Float32Array of xyz
+        // triples (at most kMaxSpawnBatch). All are created in one pass (Core::Modules::Human::SpawnMany),
+        // so their constructions reach each player in the same replication update. options:
+        // {appearanceFrom: id} — that human's current look, sanitized once and worn by every new NPC from
+        // its first snapshot, instead of a setAppearance (and an AppearanceUpdate broadcast) per NPC.
+        static void JsSpawnHumans(const v8::FunctionCallbackInfo<v8::Value> &info) {
+            auto *isolate = info.GetIsolate();
+            auto ctx      = isolate->GetCurrentContext();
+            std::vector<glm::vec3> positions;
+            const bool hasOptions = info.Length() >= 2 && !info[1]->IsUndefined();
+            if (info.Length() < 1 || !ReadPoints(ctx, info[0], positions, kMaxSpawnBatch) || (hasOptions && !info[1]->IsObject())) {
+                isolate->ThrowException(v8::Exception::TypeError(
+                    v8pp::to_v8(isolate, "spawnHumans(positions, options?) requires 1-4096 finite {x, y, z} points (or a Float32Array of xyz) and an optional object")));
+                return;
+            }
+
+            Shared::Modules::CcdProfile appearance;
+            bool hasAppearance = false;
+            if (hasOptions) {
+                v8::Local<v8::Value> value;
+                if (info[1].As<v8::Object>()->Get(ctx, v8pp::to_v8(isolate, "appearanceFrom")).ToLocal(&value) && value->IsNumber()) {
+                    if (const auto *source = Core::Modules::Human::Find(static_cast<uint64_t>(value.As<v8::Number>()->Value()))) {
+                        appearance = source->ccd;
+                        Shared::Modules::SanitizeCcd(appearance);
+                        hasAppearance = true;
+                    }
+                }
+            }
+
+            auto *server = Server::_serverRef;
+            if (!server) {
+                return;
+            }
+            auto *netEngine = server->GetNetworkingEngine();
+            if (!netEngine) {
+                return;
+            }
+            auto *repl        = netEngine->GetNetworkServer()->GetReplicationManager();
+            const auto humans = Core::Modules::Human::SpawnMany(repl, positions, hasAppearance ? &appearance : nullptr);
+
+            v8::Local<v8::Array> arr = v8::Array::New(isolate, static_cast<int>(humans.size()));
+            for (size_t i = 0; i < humans.size(); ++i) {
+                arr->Set(ctx, static_cast<uint32_t>(i), Human::Wrap(isolate, humans[i]->GetNetworkID())).Check();
+            }
+            info.GetReturnValue().Set(arr);
+        }
+
+        // World.spawnCrowd(count, minX, minY, maxX, maxY, z, options?) -> number added
+        // Adds an ambient crowd (Core::Modules::Crowd) wandering the rectangle at height z: simulated
+        // natively as plain data, and only turned into Human entities while a player is near enough to see
+        // them. options: {speed, separation, appearanceFrom: [ids]} — appearanceFrom copies those humans'
+        // current looks once, and the new agents share them in turn.
+        static void JsSpawnCrowd(const v8::FunctionCallbackInfo<v8::Value> &info) {
+            auto *isolate = info.GetIsolate();
+            auto ctx      = isolate->GetCurrentContext();
+            bool numbers  = info.Length() >= 6;
+            for (int i = 0; numbers && i < 6; ++i) {
+                numbers = info[i]->IsNumber() && std::isfinite(info[i].As<v8::Number>()->Value());
+            }
+            const bool hasOptions = info.Length() >= 7 && !info[6]->IsUndefined();
+            if (!numbers || (hasOptions && !info[6]->IsObject()) || info[0].As<v8::Number>()->Value() < 0.0) {
+                isolate->ThrowException(
+                    v8::Exception::TypeError(v8pp::to_v8(isolate, "spawnCrowd(count, minX, minY, maxX, maxY, z, options?) requires 6 finite numbers and an optional object")));
+                return;
+            }
+            const auto number = [&](int i) {
+                return static_cast<float>(info[i].As<v8::Number>()->Value());
+            };
+
+            Core::Modules::Crowd::Params params;
+            std::vector<std::shared_ptr<const Shared::Modules::CcdProfile>> profiles;
+            if (hasOptions) {
+                const auto options = info[6].As<v8::Object>();
+                v8::Local<v8::Value> value;
+                if (options->Get(ctx, v8pp::to_v8(isolate, "speed")).ToLocal(&value) && value->IsNumber() && value.As<v8::Number>()->Value() > 0.0) {
+                    params.maxSpeed = static_cast<float>(value.As<v8::Number>()->Value());
+                }
+                if (options->Get(ctx, v8pp::to_v8(isolate, "separation")).ToLocal(&value) && value->IsNumber() && value.As<v8::Number>()->Value() > 0.0) {
+                    params.separation = static_cast<float>(value.As<v8::Number>()->Value());
+                }
+                if (options->Get(ctx, v8pp::to_v8(isolate, "appearanceFrom")).ToLocal(&value) && value->IsArray()) {
+                    const auto ids = value.As<v8::Array>();
+                    for (uint32_t i = 0; i < ids->Length() && profiles.size() < Core::Modules::Crowd::kMaxProfiles; ++i) {
+                        v8::Local<v8::Value> id;
+                        if (!ids->Get(ctx, i).ToLocal(&id) || !id->IsNumber()) {
+                            continue;
+                        }
+                        if (const auto *source = Core::Modules::Human::Find(static_cast<uint64_t>(id.As<v8::Number>()->Value()))) {
+                            auto ccd = source->ccd;
+                            Shared::Modules::SanitizeCcd(ccd);
+                            profiles.push_back(std::make_shared<const Shared::Modules::CcdProfile>(std::move(ccd)));
+                        }
+                    }
+                }
+            }
+            const auto count = static_cast<size_t>(std::min(info[0].As<v8::Number>()->Value(), static_cast<double>(Core::Modules::Crowd::kMaxAgents)));
+            const auto added = Core::Modules::Crowd::Get().Spawn(count, {number(1), number(2)}, {number(3), number(4)}, number(5), profiles, params);
+            info.GetReturnValue().Set(static_cast<double>(added));
+        }
+
+        // World.clearCrowd() -> number of agents removed (their visible entities are despawned)
+        static double ClearCrowd() {
+            auto &crowd        = Core::Modules::Crowd::Get();
+            const size_t count = crowd.Size();
+            for (const uint64_t networkId : crowd.Clear()) {
+                Human(networkId).Destroy();
+            }
+            return static_cast<double>(count);
+        }
+
+        // World.getCrowdSize() -> number of crowd agents, promoted to entities or not
+        static double GetCrowdSize() {
+            return static_cast<double>(Core::Modules::Crowd::Get().Size());
         }
 
         // World.getPlayers() -> Human[]
@@ -98,17 +352,10 @@ namespace HogwartsMP::Scripting {
         static void JsGetPlayers(const v8::FunctionCallbackInfo<v8::Value> &info) {
             auto *isolate            = info.GetIsolate();
             auto ctx                 = isolate->GetCurrentContext();
-            v8::Local<v8::Array> arr = v8::Array::New(isolate);
-
-            auto *repl = Framework::CoreModules::GetReplication();
-            if (repl) {
-                uint32_t i = 0;
-                repl->ForEach<Shared::HumanEntity>([&](Shared::HumanEntity *human) {
-                    if (human->ownerGUID == MafiaNet::UNASSIGNED_PEER_GUID) {
-                        return; // server-owned NPC, not a player
-                    }
-                    arr->Set(ctx, i++, v8pp::class_<Human>::create_object(isolate, human->GetNetworkID())).Check();
-                });
+            const auto &players      = Core::Modules::HumanRegistry::Get().Players();
+            v8::Local<v8::Array> arr = v8::Array::New(isolate, static_cast<int>(players.size()));
+            for (uint32_t i = 0; i < players.size(); ++i) {
+                arr->Set(ctx, i, Human::Wrap(isolate, players[i]->GetNetworkID())).Check();
             }
             info.GetReturnValue().Set(arr);
         }
@@ -125,28 +372,16 @@ namespace HogwartsMP::Scripting {
             }
             const uint64_t id = static_cast<uint64_t>(info[0]->IntegerValue(ctx).FromMaybe(0));
 
-            auto *repl = Framework::CoreModules::GetReplication();
-            auto *human = repl ? repl->GetEntity<Shared::HumanEntity>(id) : nullptr;
-            if (!human || human->ownerGUID == MafiaNet::UNASSIGNED_PEER_GUID) {
+            if (!Core::Modules::Human::FindPlayer(id)) {
                 info.GetReturnValue().SetUndefined();
                 return;
             }
-            info.GetReturnValue().Set(v8pp::class_<Human>::create_object(isolate, human->GetNetworkID()));
+            info.GetReturnValue().Set(Human::Wrap(isolate, id));
         }
 
         // World.getPlayerCount() -> number of connected players (cheaper than getPlayers().length).
         static int GetPlayerCount() {
-            auto *repl = Framework::CoreModules::GetReplication();
-            if (!repl) {
-                return 0;
-            }
-            int count = 0;
-            repl->ForEach<Shared::HumanEntity>([&](Shared::HumanEntity *human) {
-                if (human->ownerGUID != MafiaNet::UNASSIGNED_PEER_GUID) {
-                    ++count;
-                }
-            });
-            return count;
+            return static_cast<int>(Core::Modules::HumanRegistry::Get().PlayerCount());
         }
 
         static void SetWeather(std::string weatherSetName) {
@@ -183,63 +418,46 @@ namespace HogwartsMP::Scripting {
         static void EventChatMessage(uint64_t senderNetworkId, std::string message) {
             Framework::Logging::GetLogger("Scripting")->debug("Chat message from {}: {}", senderNetworkId, message);
 
-            EmitServerEvent("chatMessage", [senderNetworkId, message](v8::Isolate *isolate, v8::Local<v8::Context>, std::vector<v8::Local<v8::Value>> &args) {
-                args.push_back(v8pp::class_<Human>::create_object(isolate, senderNetworkId));
-                args.push_back(v8pp::to_v8(isolate, message));
-            });
+            ServerEventQueue().PushChatMessage(senderNetworkId, message);
         }
 
         static void EventChatCommand(uint64_t senderNetworkId, std::string message, std::string command, std::vector<std::string> commandArgs) {
             Framework::Logging::GetLogger("Scripting")->debug("Chat command from {}: /{} ({})", senderNetworkId, command, message);
 
-            EmitServerEvent("chatCommand", [senderNetworkId, message, command, commandArgs](v8::Isolate *isolate, v8::Local<v8::Context> context, std::vector<v8::Local<v8::Value>> &args) {
-                v8::Local<v8::Array> argsArray = v8::Array::New(isolate, static_cast<int>(commandArgs.size()));
-                for (size_t i = 0; i < commandArgs.size(); ++i) {
-                    argsArray->Set(context, static_cast<uint32_t>(i), v8pp::to_v8(isolate, commandArgs[i])).Check();
-                }
-
-                args.push_back(v8pp::class_<Human>::create_object(isolate, senderNetworkId));
-                args.push_back(v8pp::to_v8(isolate, message));
-                args.push_back(v8pp::to_v8(isolate, command));
-                args.push_back(argsArray);
-            });
+            ServerEventQueue().PushChatCommand(senderNetworkId, message, command, commandArgs);
         }
 
-        // A client script sent a named event up to the server (via the client's Game.emitServer).
-        // Dispatched to server scripts as Core.Events.on(eventName, (player, payload) => ...). An empty
-        // payload omits the second arg (handler gets just `player`); a non-empty but malformed payload
-        // drops the event entirely — matching the down direction (OnEmitLuaEvent drops on parse
-        // failure), so a handler never sees a half-event with a missing `payload`.
+        // A client script sent a named event up to the server (via the client's Game.emitServer, or
+        // Game.emitServerPacked when packed). Dispatched to server scripts as Core.Events.on(eventName,
+        // (player, payload) => ...). An empty JSON payload omits the second arg (handler gets just
+        // `player`); a payload that is oversized, too deeply nested or malformed drops the event entirely
+        // — matching the down direction (the client drops a payload it cannot parse), so a handler never sees
+        // a half-event with a missing `payload`.
         //
         // TRUST CAVEAT: the event name + payload are attacker-controlled (they come from a client). A
         // malicious client can emit ANY name, including server-authoritative ones (e.g. "chatCommand").
         // Treat handlers as untrusted input: validate payloads and don't key security-sensitive logic
         // on client-emitted events sharing a reserved name. (Hardening — namespacing/allowlist — is
         // deferred to the reflection-bridge trust-model work.)
-        static void EventClientEvent(uint64_t senderNetworkId, std::string eventName, std::string payloadJson) {
+        static void EventClientEvent(uint64_t senderNetworkId, const std::string &eventName, const std::string &payload, bool packed = false) {
             Framework::Logging::GetLogger("Scripting")->debug("Client event '{}' from {}", eventName, senderNetworkId);
 
-            // Drop a non-empty but malformed payload instead of dispatching with a missing arg, so this
-            // matches the client's OnEmitLuaEvent (which drops on parse failure).
-            if (!payloadJson.empty() && !nlohmann::json::accept(payloadJson)) {
-                Framework::Logging::GetLogger("Scripting")->warn("Dropping client event '{}' from {}: malformed JSON payload", eventName, senderNetworkId);
+            // Only the cheap bounds here; the payload is parsed once, by V8, when the event is dispatched
+            // (DrainServerEvents), and a parse failure drops it there.
+            const bool tooDeep = !packed && !Shared::ScriptPayload::JsonDepthWithin(payload, Shared::ScriptPayload::kMaxDepth);
+            if (payload.size() > Shared::ScriptPayload::kMaxBytes || tooDeep) {
+                Framework::Logging::GetLogger("Scripting")->warn("Dropping client event '{}' from {}: payload over {} bytes or {} levels deep", eventName,
+                                                                 senderNetworkId, Shared::ScriptPayload::kMaxBytes, Shared::ScriptPayload::kMaxDepth);
                 return;
             }
+            ServerEventQueue().PushClientEvent(senderNetworkId, eventName, payload, packed);
+        }
 
-            EmitServerEvent(eventName, [senderNetworkId, payloadJson](v8::Isolate *isolate, v8::Local<v8::Context> context, std::vector<v8::Local<v8::Value>> &args) {
-                args.push_back(v8pp::class_<Human>::create_object(isolate, senderNetworkId));
-                if (payloadJson.empty()) {
-                    return;
-                }
-                v8::Local<v8::String> jsonStr;
-                if (!v8::String::NewFromUtf8(isolate, payloadJson.c_str()).ToLocal(&jsonStr)) {
-                    return;
-                }
-                v8::Local<v8::Value> parsed;
-                if (v8::JSON::Parse(context, jsonStr).ToLocal(&parsed)) {
-                    args.push_back(parsed);
-                }
-            });
+        // World.setClientEventCoalescing(eventName, enabled) — while a client event is queued for the next
+        // tick, a newer one of that name from the same player replaces its payload instead of queueing a
+        // second dispatch. For "latest value wins" events (aim, input state) that clients send every frame.
+        static void SetClientEventCoalescing(std::string eventName, bool enabled) {
+            ServerEventQueue().SetCoalesced(eventName, enabled);
         }
 
         static void Register(v8::Isolate *isolate, v8::Local<v8::Object> global) {
@@ -253,19 +471,34 @@ namespace HogwartsMP::Scripting {
             worldModule.function("broadcastMessage", &World::BroadcastMessage);
             worldModule.function("sendChatMessage", &World::SendChatMessage);
             worldModule.function("emitAllClients", &World::EmitAllClients);
+            worldModule.function("setClientEventCoalescing", &World::SetClientEventCoalescing);
             worldModule.function("getPlayerCount", &World::GetPlayerCount);
+            worldModule.function("clearCrowd", &World::ClearCrowd);
+            worldModule.function("getCrowdSize", &World::GetCrowdSize);
             auto worldObj = worldModule.new_instance();
             // spawnHuman / getPlayers / getPlayer need the isolate + return wrapped objects, so they're
             // raw FunctionTemplates set on the module object rather than typed v8pp functions.
             worldObj->Set(ctx, v8pp::to_v8(isolate, "spawnHuman"),
                           v8::FunctionTemplate::New(isolate, &World::JsSpawnHuman)->GetFunction(ctx).ToLocalChecked())
                 .Check();
+            worldObj->Set(ctx, v8pp::to_v8(isolate, "spawnHumans"),
+                          v8::FunctionTemplate::New(isolate, &World::JsSpawnHumans)->GetFunction(ctx).ToLocalChecked())
+                .Check();
             worldObj->Set(ctx, v8pp::to_v8(isolate, "getPlayers"),
                           v8::FunctionTemplate::New(isolate, &World::JsGetPlayers)->GetFunction(ctx).ToLocalChecked())
                 .Check();
+            worldObj->Set(ctx, v8pp::to_v8(isolate, "emitAllClientsPacked"),
+                          v8::FunctionTemplate::New(isolate, &World::JsEmitAllClientsPacked)->GetFunction(ctx).ToLocalChecked())
+                .Check();
             worldObj->Set(ctx, v8pp::to_v8(isolate, "getPlayer"),
                           v8::FunctionTemplate::New(isolate, &World::JsGetPlayer)->GetFunction(ctx).ToLocalChecked())
                 .Check();
+            worldObj->Set(ctx, v8pp::to_v8(isolate, "setTransforms"),
+                          v8::FunctionTemplate::New(isolate, &World::JsSetTransforms)->GetFunction(ctx).ToLocalChecked())
+                .Check();
+            worldObj->Set(ctx, v8pp::to_v8(isolate, "spawnCrowd"),
+                          v8::FunctionTemplate::New(isolate, &World::JsSpawnCrowd)->GetFunction(ctx).ToLocalChecked())
+                .Check();
             global->Set(ctx, v8pp::to_v8(isolate, "World"), worldObj).Check();
 
             v8pp::module envModule(isolate);
@@ -277,6 +510,34 @@ namespace HogwartsMP::Scripting {
         }
 
       private:
+        // A typed array's bytes, in place.
+        static const uint8_t *ViewData(v8::Local<v8::ArrayBufferView> view) {
+            return static_cast<const uint8_t *>(view->Buffer()->GetBackingStore()->Data()) + view->ByteOffset();
+        }
+
+        template <typename Id>
+        static size_t ApplyTransforms(const Id *ids, size_t count, const float *transforms, const uint8_t *flags) {
+            const auto &registry = Core::Modules::HumanRegistry::Get();
+            size_t updated       = 0;
+            for (size_t i = 0; i < count; ++i) {
+                // Out-of-range or NaN ids (from a Float64Array) resolve to nothing rather than overflow the cast.
+                const double id = static_cast<double>(ids[i]);
+                auto *human     = id >= 0.0 && id < 18446744073709551616.0 ? registry.Find(static_cast<uint64_t>(id)) : nullptr;
+                if (!human) {
+                    continue;
+                }
+                const float *t  = transforms + i * kTransformStride;
+                human->position = {t[0], t[1], t[2]};
+                human->rotation = glm::quat(glm::radians(glm::vec3 {t[3], t[4], t[5]}));
+                human->velocity = {t[6], t[7], t[8]};
+                if (flags) {
+                    human->stateFlags = flags[i];
+                }
+                ++updated;
+            }
+            return updated;
+        }
+
         // Push the server-authoritative environment state to every client.
         static void BroadcastWeather() {
             auto *server = Server::_serverRef;
@@ -0,0 +1,90 @@
+#include "event_queue.h"
+
+#include <algorithm>
+
+namespace HogwartsMP::Core::Events {
+    EventQueue::Span EventQueue::Store(std::string_view text) {
+        Span span {static_cast<uint32_t>(_arena.size()), static_cast<uint32_t>(text.size())};
+        _arena.append(text);
+        return span;
+    }
+
+    void EventQueue::Push(Kind kind, uint64_t networkId, std::string_view name, std::string_view text) {
+        const auto nameSpan = Store(name);
+        const auto textSpan = Store(text);
+        _records.push_back({kind, networkId, nameSpan, textSpan, static_cast<uint32_t>(_args.size()), 0});
+    }
+
+    void EventQueue::PushPlayerConnect(uint64_t networkId) {
+        Push(Kind::PlayerConnect, networkId, {}, {});
+    }
+
+    void EventQueue::PushPlayerDied(uint64_t networkId) {
+        Push(Kind::PlayerDied, networkId, {}, {});
+    }
+
+    void EventQueue::PushNpcArrived(uint64_t networkId) {
+        Push(Kind::NpcArrived, networkId, {}, {});
+    }
+
+    void EventQueue::PushChatMessage(uint64_t networkId, std::string_view message) {
+        Push(Kind::ChatMessage, networkId, {}, message);
+    }
+
+    void EventQueue::PushChatCommand(uint64_t networkId, std::string_view message, std::string_view command, const std::vector<std::string> &args) {
+        Push(Kind::ChatCommand, networkId, command, message);
+        for (const auto &arg : args) {
+            _args.push_back(Store(arg));
+        }
+        _records.back().argCount = static_cast<uint32_t>(args.size());
+    }
+
+    bool EventQueue::PushClientEvent(uint64_t networkId, std::string_view name, std::string_view payload, bool packed) {
+        const Kind kind = packed ? Kind::PackedEvent : Kind::ClientEvent;
+        if (!IsCoalesced(name)) {
+            Push(kind, networkId, name, payload);
+            return true;
+        }
+        _keyScratch.assign(reinterpret_cast<const char *>(&networkId), sizeof(networkId));
+        _keyScratch.append(name);
+        const auto [it, added] = _pending.try_emplace(_keyScratch, _records.size());
+        if (added) {
+            Push(kind, networkId, name, payload);
+            return true;
+        }
+        // The superseded payload stays in the arena until Clear; it is reclaimed with the rest.
+        _records[it->second].kind = kind;
+        _records[it->second].text = Store(payload);
+        return false;
+    }
+
+    void EventQueue::SetCoalesced(const std::string &clientEventName, bool coalesced) {
+        const auto it = std::find(_coalesced.begin(), _coalesced.end(), clientEventName);
+        if (coalesced && it == _coalesced.end()) {
+            _coalesced.push_back(clientEventName);
+        }
+        else if (!coalesced && it != _coalesced.end()) {
+            _coalesced.erase(it);
+        }
+    }
+
+    bool EventQueue::IsCoalesced(std::string_view clientEventName) const {
+        return std::find(_coalesced.begin(), _coalesced.end(), clientEventName) != _coalesced.end();
+    }
+
+    EventQueue::Event EventQueue::At(size_t index) const {
+        const auto &record = _records[index];
+        return {record.kind, record.networkId, View(record.name), View(record.text), record.argCount};
+    }
+
+    std::string_view EventQueue::Arg(size_t index, size_t arg) const {
+        return View(_args[_records[index].firstArg + arg]);
+    }
+
+    void EventQueue::Clear() {
+        _arena.clear();
+        _records.clear();
+        _args.clear();
+        _pending.clear();
+    }
+} // namespace HogwartsMP::Core::Events
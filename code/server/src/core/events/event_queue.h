@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace HogwartsMP::Core::Events {
+    enum class Kind : uint8_t {
+        PlayerConnect,
+        PlayerDied,
+        ChatMessage, // text = message
+        ChatCommand, // text = message, name = command, args
+        ClientEvent, // name = event name, text = JSON payload ("" = none)
+        PackedEvent, // name = event name, text = packed payload (Shared::ScriptPayload)
+        NpcArrived,  // an NPC finished its Core::Modules::NpcMovement path
+    };
+
+    /**
+     * Native server events waiting for the next script dispatch. Network handlers push flat records whose
+     * strings are copied into one per-tick arena; the server tick drains them all under a single isolate
+     * lock and context entry. Draining clears the queue but keeps its capacity, so a steady tick allocates
+     * nothing.
+     *
+     * Client events can be marked coalescing: a newer one from the same sender replaces the payload of the
+     * one still queued, keeping its place. Only for events a handler treats as "latest value wins".
+     */
+    class EventQueue final {
+      public:
+        // A queued event; the views point into the queue and stay valid until the next Clear.
+        struct Event {
+            Kind kind;
+            uint64_t networkId;
+            std::string_view name;
+            std::string_view text;
+            size_t argCount;
+        };
+
+        void PushPlayerConnect(uint64_t networkId);
+        void PushPlayerDied(uint64_t networkId);
+        void PushNpcArrived(uint64_t networkId);
+        void PushChatMessage(uint64_t networkId, std::string_view message);
+        void PushChatCommand(uint64_t networkId, std::string_view message, std::string_view command, const std::vector<std::string> &args);
+        // Returns false when it replaced a queued event rather than adding one.
+        bool PushClientEvent(uint64_t networkId, std::string_view name, std::string_view payload, bool packed = false);
+
+        void SetCoalesced(const std::string &clientEventName, bool coalesced);
+        bool IsCoalesced(std::string_view clientEventName) const;
+
+        size_t Size() const {
+            return _records.size();
+        }
+        bool Empty() const {
+            return _records.empty();
+        }
+        Event At(size_t index) const;
+        // The i-th argument of a ChatCommand event.
+        std::string_view Arg(size_t index, size_t arg) const;
+
+        // Drop every queued event (after a drain); capacity is kept for the next tick.
+        void Clear();
+
+      private:
+        struct Span {
+            uint32_t offset = 0;
+            uint32_t length = 0;
+        };
+        struct Record {
+            Kind kind;
+            uint64_t networkId;
+            Span name;
+            Span text;
+            uint32_t firstArg;
+            uint32_t argCount;
+        };
+
+        Span Store(std::string_view text);
+        std::string_view View(Span span) const {
+            return std::string_view(_arena).substr(span.offset, span.length);
+        }
+        void Push(Kind kind, uint64_t networkId, std::string_view name, std::string_view text);
+
+        std::string _arena;
+        std::vector<Record> _records;
+        std::vector<Span> _args;
+        std::vector<std::string> _coalesced;
+        // Queued coalescing client events: sender + name -> record index.
+        std::unordered_map<std::string, size_t> _pending;
+        std::string _keyScratch;
+    };
+} // namespace HogwartsMP::Core::Events
@@ -0,0 +1,48 @@
+#include "script_events.h"
+
+#include <core_modules.h>
+#include <networking/network_peer.h>
+
+#include <mafianet/types.h>
+
+namespace HogwartsMP::Core::Events {
+    ScriptEvents &ScriptEvents::Get() {
+        static ScriptEvents events;
+        return events;
+    }
+
+    void ScriptEvents::AddPeer(uint64_t guid) {
+        _peers[guid] = {};
+    }
+
+    void ScriptEvents::RemovePeer(uint64_t guid) {
+        _peers.erase(guid);
+    }
+
+    const std::string *ScriptEvents::Resolve(uint64_t guid, const Shared::RPC::ScriptEvent &ev) {
+        const auto names = _peers.find(guid);
+        return names != _peers.end() ? ev.ResolveName(names->second.in) : nullptr;
+    }
+
+    void ScriptEvents::Send(uint64_t guid, const std::string &eventName, Shared::RPC::ScriptEvent &ev) {
+        const auto names = _peers.find(guid);
+        auto *peer       = Framework::CoreModules::GetNetworkPeer();
+        if (names == _peers.end() || !peer) {
+            return;
+        }
+        ev.SetName(eventName, names->second.out);
+        peer->SendRPC(ev, MafiaNet::ToGuid(guid));
+    }
+
+    // One send per peer, since each has its own name ids; after the first, only the id differs in size.
+    void ScriptEvents::Broadcast(const std::string &eventName, Shared::RPC::ScriptEvent &ev) {
+        auto *peer = Framework::CoreModules::GetNetworkPeer();
+        if (!peer) {
+            return;
+        }
+        for (auto &[guid, names] : _peers) {
+            ev.SetName(eventName, names.out);
+            peer->SendRPC(ev, MafiaNet::ToGuid(guid));
+        }
+    }
+} // namespace HogwartsMP::Core::Events
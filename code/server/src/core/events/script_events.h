@@ -0,0 +1,39 @@
+#pragma once
+
+#include "shared/event_names.h"
+#include "shared/rpc/script_event.h"
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+namespace HogwartsMP::Core::Events {
+    /**
+     * Each connected peer's script event name tables (Shared::RPC::ScriptEvent): the names it has been
+     * sent and the ones it has defined. The server opens a peer's tables on connect and drops them on
+     * disconnect; the scripting builtins send through Send / Broadcast so every name is interned per peer.
+     *
+     * Server thread only.
+     */
+    class ScriptEvents final {
+      public:
+        static ScriptEvents &Get();
+
+        void AddPeer(uint64_t guid);
+        void RemovePeer(uint64_t guid);
+
+        // The name of an event a peer sent, or nullptr for an unknown peer or a name id it never defined.
+        const std::string *Resolve(uint64_t guid, const Shared::RPC::ScriptEvent &ev);
+
+        // Send ev to one peer / every connected peer, with eventName interned in each peer's table.
+        void Send(uint64_t guid, const std::string &eventName, Shared::RPC::ScriptEvent &ev);
+        void Broadcast(const std::string &eventName, Shared::RPC::ScriptEvent &ev);
+
+      private:
+        struct PeerEventNames {
+            Shared::EventNameEncoder out;
+            Shared::EventNameDecoder in;
+        };
+        std::unordered_map<uint64_t, PeerEventNames> _peers;
+    };
+} // namespace HogwartsMP::Core::Events
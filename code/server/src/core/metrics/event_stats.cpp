@@ -0,0 +1,109 @@
+#include "event_stats.h"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+
+namespace HogwartsMP::Core::Metrics {
+    namespace {
+        // Label values are quoted; a client-chosen event name must not break out of the quotes.
+        std::string EscapeLabel(const std::string &value) {
+            std::string out;
+            out.reserve(value.size());
+            for (const char c : value) {
+                switch (c) {
+                case '\\': out += "\\\\"; break;
+                case '"': out += "\\\""; break;
+                case '\n': out += "\\n"; break;
+                default: out += c; break;
+                }
+            }
+            return out;
+        }
+    } // namespace
+
+    void EventStats::Record(const std::string &event, uint64_t ns, uint64_t allocatedBytes, bool slow) {
+        std::lock_guard lock(_mutex);
+        auto it = _events.find(event);
+        if (it == _events.end()) {
+            it = _events.size() < kMaxEvents ? _events.emplace(event, Entry {}).first : _events.try_emplace(kOtherEvent).first;
+        }
+        auto &entry = it->second;
+        ++entry.calls;
+        entry.totalNs += ns;
+        entry.maxNs = std::max(entry.maxNs, ns);
+        entry.allocatedBytes += allocatedBytes;
+        entry.slow += slow ? 1 : 0;
+    }
+
+    void EventStats::RecordSlowResource(const std::string &resource) {
+        std::lock_guard lock(_mutex);
+        auto it = _slowByResource.find(resource);
+        if (it == _slowByResource.end()) {
+            it = _slowByResource.size() < kMaxEvents ? _slowByResource.emplace(resource, 0).first : _slowByResource.try_emplace(kOtherEvent, 0).first;
+        }
+        ++it->second;
+    }
+
+    std::vector<std::pair<std::string, EventStats::Entry>> EventStats::Top(size_t limit) const {
+        std::vector<std::pair<std::string, Entry>> events;
+        {
+            std::lock_guard lock(_mutex);
+            events.assign(_events.begin(), _events.end());
+        }
+        std::sort(events.begin(), events.end(), [](const auto &a, const auto &b) {
+            return a.second.totalNs != b.second.totalNs ? a.second.totalNs > b.second.totalNs : a.first < b.first;
+        });
+        if (limit != 0 && events.size() > limit) {
+            events.resize(limit);
+        }
+        return events;
+    }
+
+    std::vector<std::pair<std::string, uint64_t>> EventStats::SlowByResource() const {
+        std::vector<std::pair<std::string, uint64_t>> resources;
+        {
+            std::lock_guard lock(_mutex);
+            resources.assign(_slowByResource.begin(), _slowByResource.end());
+        }
+        std::sort(resources.begin(), resources.end());
+        return resources;
+    }
+
+    void EventStats::RenderPrometheus(std::string &out) const {
+        const auto events    = Top();
+        const auto resources = SlowByResource();
+
+        out += "# HELP hogwartsmp_script_event_calls_total Script event dispatches, by event name.\n";
+        out += "# TYPE hogwartsmp_script_event_calls_total counter\n";
+        for (const auto &[name, e] : events) {
+            out += fmt::format("hogwartsmp_script_event_calls_total{{event=\"{}\"}} {}\n", EscapeLabel(name), e.calls);
+        }
+        out += "# HELP hogwartsmp_script_event_seconds_total Wall time spent in script event handlers, by event name.\n";
+        out += "# TYPE hogwartsmp_script_event_seconds_total counter\n";
+        for (const auto &[name, e] : events) {
+            out += fmt::format("hogwartsmp_script_event_seconds_total{{event=\"{}\"}} {}\n", EscapeLabel(name), static_cast<double>(e.totalNs) / 1e9);
+        }
+        out += "# HELP hogwartsmp_script_event_allocated_bytes_total JS heap growth across script event dispatches, by event name.\n";
+        out += "# TYPE hogwartsmp_script_event_allocated_bytes_total counter\n";
+        for (const auto &[name, e] : events) {
+            out += fmt::format("hogwartsmp_script_event_allocated_bytes_total{{event=\"{}\"}} {}\n", EscapeLabel(name), e.allocatedBytes);
+        }
+        out += "# HELP hogwartsmp_script_event_slow_total Script event dispatches over the slow-handler threshold, by event name.\n";
+        out += "# TYPE hogwartsmp_script_event_slow_total counter\n";
+        for (const auto &[name, e] : events) {
+            out += fmt::format("hogwartsmp_script_event_slow_total{{event=\"{}\"}} {}\n", EscapeLabel(name), e.slow);
+        }
+        out += "# HELP hogwartsmp_script_resource_slow_total Slow script event dispatches, by the resource caught running.\n";
+        out += "# TYPE hogwartsmp_script_resource_slow_total counter\n";
+        for (const auto &[name, count] : resources) {
+            out += fmt::format("hogwartsmp_script_resource_slow_total{{resource=\"{}\"}} {}\n", EscapeLabel(name), count);
+        }
+    }
+
+    void EventStats::Reset() {
+        std::lock_guard lock(_mutex);
+        _events.clear();
+        _slowByResource.clear();
+    }
+} // namespace HogwartsMP::Core::Metrics
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace HogwartsMP::Core::Metrics {
+    // Per-event-name accounting of script event dispatches: calls, wall time, heap growth and how many
+    // ran over the slow-handler threshold, plus slow dispatches per resource. Client events carry
+    // arbitrary names, so only the first kMaxEvents distinct names get their own entry; the rest share
+    // kOtherEvent. Recorded on the server thread and read from the web server's, under one mutex that
+    // is only ever held for a map update or a copy.
+    class EventStats final {
+      public:
+        static constexpr size_t kMaxEvents      = 256;
+        static constexpr const char *kOtherEvent = "(other)";
+
+        struct Entry {
+            uint64_t calls          = 0;
+            uint64_t totalNs        = 0;
+            uint64_t maxNs          = 0;
+            uint64_t allocatedBytes = 0; // JS heap growth across the dispatch, summed (GC'd bytes excluded)
+            uint64_t slow           = 0;
+        };
+
+        void Record(const std::string &event, uint64_t ns, uint64_t allocatedBytes, bool slow);
+        // A slow dispatch was caught running in resource's code.
+        void RecordSlowResource(const std::string &resource);
+
+        // Events by total wall time, most expensive first; at most limit of them (0 = all).
+        std::vector<std::pair<std::string, Entry>> Top(size_t limit = 0) const;
+        std::vector<std::pair<std::string, uint64_t>> SlowByResource() const;
+
+        // Append the Prometheus text for these counters to out.
+        void RenderPrometheus(std::string &out) const;
+
+        void Reset();
+
+      private:
+        mutable std::mutex _mutex;
+        std::unordered_map<std::string, Entry> _events;
+        std::unordered_map<std::string, uint64_t> _slowByResource;
+    };
+} // namespace HogwartsMP::Core::Metrics
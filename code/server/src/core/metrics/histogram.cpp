@@ -0,0 +1,65 @@
+#include "histogram.h"
+
+#include <cmath>
+
+namespace HogwartsMP::Core::Metrics {
+    uint64_t LatencyHistogram::BucketLow(size_t bucket) {
+        if (bucket < 2 * kSubCount) {
+            return bucket;
+        }
+        const int bit      = static_cast<int>(bucket >> kSubBits) + kSubBits - 1;
+        const uint64_t sub = bucket & (kSubCount - 1);
+        return (kSubCount + sub) << (bit - kSubBits);
+    }
+
+    uint64_t LatencyHistogram::BucketHigh(size_t bucket) {
+        if (bucket + 1 >= kBuckets) {
+            return UINT64_MAX;
+        }
+        return BucketLow(bucket + 1) - 1;
+    }
+
+    LatencyHistogram::Snapshot LatencyHistogram::Take() const {
+        Snapshot snap;
+        snap.counts.resize(kBuckets);
+        for (size_t i = 0; i < kBuckets; ++i) {
+            snap.counts[i] = _counts[i].load(std::memory_order_relaxed);
+            snap.count += snap.counts[i];
+        }
+        snap.sumNs = _sumNs.load(std::memory_order_relaxed);
+        snap.maxNs = _maxNs.load(std::memory_order_relaxed);
+        return snap;
+    }
+
+    void LatencyHistogram::Reset() {
+        for (auto &c : _counts) {
+            c.store(0, std::memory_order_relaxed);
+        }
+        _sumNs.store(0, std::memory_order_relaxed);
+        _maxNs.store(0, std::memory_order_relaxed);
+    }
+
+    uint64_t LatencyHistogram::Snapshot::Percentile(double p) const {
+        if (count == 0) {
+            return 0;
+        }
+        const double clamped = std::clamp(p, 0.0, 100.0);
+        const auto target    = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(clamped / 100.0 * static_cast<double>(count))));
+        uint64_t seen        = 0;
+        for (size_t i = 0; i < counts.size(); ++i) {
+            seen += counts[i];
+            if (seen >= target) {
+                return std::min(BucketHigh(i), maxNs);
+            }
+        }
+        return maxNs;
+    }
+
+    uint64_t LatencyHistogram::Snapshot::CountAtOrBelow(uint64_t ns) const {
+        uint64_t total = 0;
+        for (size_t i = 0; i < counts.size() && BucketHigh(i) <= ns; ++i) {
+            total += counts[i];
+        }
+        return total;
+    }
+} // namespace HogwartsMP::Core::Metrics
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace HogwartsMP::Core::Metrics {
+    // Latency histogram in nanoseconds with HDR-style log-linear buckets: exact below 32 ns, then 16
+    // buckets per power of two, so any recorded value is reported within 1/16 (6.25%) of itself. Covers
+    // up to ~36 minutes; longer values land in the last bucket.
+    //
+    // Record is lock-free (relaxed atomics) and may run on any thread while another takes a
+    // Snapshot; a snapshot taken mid-Record can be off by that one sample, never torn.
+    class LatencyHistogram final {
+      public:
+        static constexpr int kSubBits       = 4;
+        static constexpr uint64_t kSubCount = 1u << kSubBits;
+        static constexpr int kMaxBit        = 40; // highest set bit tracked: 2^41 ns ~ 36 min
+        static constexpr size_t kBuckets    = ((kMaxBit - kSubBits + 1) << kSubBits) + kSubCount;
+
+        struct Snapshot {
+            std::vector<uint64_t> counts; // per bucket
+            uint64_t count = 0;
+            uint64_t sumNs = 0;
+            uint64_t maxNs = 0;
+
+            // Value at or below which p percent (0..100) of the samples fall, as the upper edge of its
+            // bucket (capped at the largest sample); 0 when empty.
+            uint64_t Percentile(double p) const;
+            // Samples at or below ns, counting whole buckets only.
+            uint64_t CountAtOrBelow(uint64_t ns) const;
+        };
+
+        void Record(uint64_t ns) {
+            _counts[BucketOf(ns)].fetch_add(1, std::memory_order_relaxed);
+            _sumNs.fetch_add(ns, std::memory_order_relaxed);
+            uint64_t max = _maxNs.load(std::memory_order_relaxed);
+            while (ns > max && !_maxNs.compare_exchange_weak(max, ns, std::memory_order_relaxed)) {
+            }
+        }
+
+        Snapshot Take() const;
+        void Reset();
+
+        static size_t BucketOf(uint64_t ns) {
+            if (ns < 2 * kSubCount) {
+                return static_cast<size_t>(ns);
+            }
+            const int bit = std::min(63 - std::countl_zero(ns), kMaxBit);
+            if (bit == kMaxBit && (ns >> (kMaxBit + 1)) != 0) {
+                return kBuckets - 1;
+            }
+            const uint64_t sub = (ns >> (bit - kSubBits)) & (kSubCount - 1);
+            return (static_cast<size_t>(bit - kSubBits + 1) << kSubBits) + static_cast<size_t>(sub);
+        }
+        // Smallest and largest value that land in bucket.
+        static uint64_t BucketLow(size_t bucket);
+        static uint64_t BucketHigh(size_t bucket);
+
+      private:
+        std::array<std::atomic<uint64_t>, kBuckets> _counts {};
+        std::atomic<uint64_t> _sumNs {0};
+        std::atomic<uint64_t> _maxNs {0};
+    };
+} // namespace HogwartsMP::Core::Metrics
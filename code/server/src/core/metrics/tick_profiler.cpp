@@ -0,0 +1,129 @@
+#include "tick_profiler.h"
+
+#include <fmt/format.h>
+
+#include <nlohmann/json.hpp>
+
+namespace HogwartsMP::Core::Metrics {
+    namespace {
+        // Prometheus bucket edges (seconds): fine around a 30 Hz tick budget, coarse beyond it.
+        constexpr std::array kBucketEdges = {0.0001, 0.00025, 0.0005, 0.001, 0.0025, 0.005, 0.01, 0.016, 0.025, 0.033, 0.05, 0.075, 0.1, 0.25, 0.5, 1.0, 2.5};
+
+        double Seconds(uint64_t ns) {
+            return static_cast<double>(ns) / 1e9;
+        }
+
+        double Millis(uint64_t ns) {
+            return static_cast<double>(ns) / 1e6;
+        }
+    } // namespace
+
+    const char *PhaseName(Phase phase) {
+        switch (phase) {
+        case Phase::Tick: return "tick";
+        case Phase::PostUpdate: return "post_update";
+        case Phase::Rpc: return "rpc";
+        case Phase::ScriptEvents: return "script_events";
+        case Phase::Storage: return "storage";
+        default: return "unknown";
+        }
+    }
+
+    TickProfiler &TickProfiler::Get() {
+        static TickProfiler profiler;
+        return profiler;
+    }
+
+    std::string TickProfiler::RenderPrometheus() const {
+        std::array<LatencyHistogram::Snapshot, static_cast<size_t>(Phase::Count)> snaps;
+        for (size_t i = 0; i < _phases.size(); ++i) {
+            snaps[i] = _phases[i].Take();
+        }
+
+        std::string out;
+        out += "# HELP hogwartsmp_phase_seconds Time spent in each server tick phase.\n";
+        out += "# TYPE hogwartsmp_phase_seconds histogram\n";
+        for (size_t i = 0; i < snaps.size(); ++i) {
+            const char *name = PhaseName(static_cast<Phase>(i));
+            const auto &snap = snaps[i];
+            for (const double edge : kBucketEdges) {
+                const auto count = snap.CountAtOrBelow(static_cast<uint64_t>(edge * 1e9));
+                out += fmt::format("hogwartsmp_phase_seconds_bucket{{phase=\"{}\",le=\"{}\"}} {}\n", name, edge, count);
+            }
+            out += fmt::format("hogwartsmp_phase_seconds_bucket{{phase=\"{}\",le=\"+Inf\"}} {}\n", name, snap.count);
+            out += fmt::format("hogwartsmp_phase_seconds_sum{{phase=\"{}\"}} {}\n", name, Seconds(snap.sumNs));
+            out += fmt::format("hogwartsmp_phase_seconds_count{{phase=\"{}\"}} {}\n", name, snap.count);
+        }
+        out += "# HELP hogwartsmp_phase_max_seconds Longest time seen in each phase since start.\n";
+        out += "# TYPE hogwartsmp_phase_max_seconds gauge\n";
+        for (size_t i = 0; i < snaps.size(); ++i) {
+            out += fmt::format("hogwartsmp_phase_max_seconds{{phase=\"{}\"}} {}\n", PhaseName(static_cast<Phase>(i)), Seconds(snaps[i].maxNs));
+        }
+        out += "# HELP hogwartsmp_players Connected players.\n";
+        out += "# TYPE hogwartsmp_players gauge\n";
+        out += fmt::format("hogwartsmp_players {}\n", _players.load(std::memory_order_relaxed));
+        out += "# HELP hogwartsmp_entities Replicated entities (players and NPCs).\n";
+        out += "# TYPE hogwartsmp_entities gauge\n";
+        out += fmt::format("hogwartsmp_entities {}\n", _entities.load(std::memory_order_relaxed));
+        out += "# HELP hogwartsmp_network_received_bytes_total Bytes received from all connections.\n";
+        out += "# TYPE hogwartsmp_network_received_bytes_total counter\n";
+        out += fmt::format("hogwartsmp_network_received_bytes_total {}\n", _bytesIn.load(std::memory_order_relaxed));
+        out += "# HELP hogwartsmp_network_sent_bytes_total Bytes sent to all connections.\n";
+        out += "# TYPE hogwartsmp_network_sent_bytes_total counter\n";
+        out += fmt::format("hogwartsmp_network_sent_bytes_total {}\n", _bytesOut.load(std::memory_order_relaxed));
+        _events.RenderPrometheus(out);
+        return out;
+    }
+
+    std::string TickProfiler::RenderJson() const {
+        nlohmann::json phases = nlohmann::json::object();
+        for (size_t i = 0; i < _phases.size(); ++i) {
+            const auto snap = _phases[i].Take();
+            phases[PhaseName(static_cast<Phase>(i))] = {
+                {"count", snap.count},
+                {"sumMs", Millis(snap.sumNs)},
+                {"maxMs", Millis(snap.maxNs)},
+                {"p50Ms", Millis(snap.Percentile(50.0))},
+                {"p90Ms", Millis(snap.Percentile(90.0))},
+                {"p99Ms", Millis(snap.Percentile(99.0))},
+                {"p999Ms", Millis(snap.Percentile(99.9))},
+            };
+        }
+        nlohmann::json events = nlohmann::json::array();
+        for (const auto &[name, e] : _events.Top(50)) {
+            events.push_back({
+                {"event", name},
+                {"calls", e.calls},
+                {"totalMs", Millis(e.totalNs)},
+                {"maxMs", Millis(e.maxNs)},
+                {"allocatedBytes", e.allocatedBytes},
+                {"slow", e.slow},
+            });
+        }
+        nlohmann::json slowResources = nlohmann::json::object();
+        for (const auto &[resource, count] : _events.SlowByResource()) {
+            slowResources[resource] = count;
+        }
+        const nlohmann::json doc = {
+            {"phases", phases},
+            {"events", events},
+            {"slowByResource", slowResources},
+            {"players", _players.load(std::memory_order_relaxed)},
+            {"entities", _entities.load(std::memory_order_relaxed)},
+            {"bytesIn", _bytesIn.load(std::memory_order_relaxed)},
+            {"bytesOut", _bytesOut.load(std::memory_order_relaxed)},
+        };
+        return doc.dump();
+    }
+
+    void TickProfiler::Reset() {
+        for (auto &phase : _phases) {
+            phase.Reset();
+        }
+        _players.store(0, std::memory_order_relaxed);
+        _entities.store(0, std::memory_order_relaxed);
+        _bytesIn.store(0, std::memory_order_relaxed);
+        _bytesOut.store(0, std::memory_order_relaxed);
+        _events.Reset();
+    }
+} // namespace HogwartsMP::Core::Metrics
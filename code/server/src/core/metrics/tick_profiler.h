@@ -0,0 +1,84 @@
+#pragma once
+
+#include "event_stats.h"
+#include "histogram.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace HogwartsMP::Core::Metrics {
+    // The parts of a server tick timed separately. Rpc, ScriptEvents and Storage run inside Tick, and
+    // ScriptEvents usually inside Rpc too (a client event dispatches into scripts).
+    enum class Phase : uint8_t {
+        Tick,         // PostUpdate to PostUpdate: the whole tick, framework work and tick-rate sleep included
+        PostUpdate,   // the mod's own per-tick work
+        Rpc,          // one inbound RPC or connection event, handler to handler
+        ScriptEvents, // one EmitServerEvent dispatch into V8
+        Storage,      // Storage::Tick: expiry reaping, deferred storage ops, group commit
+        Count,
+    };
+
+    const char *PhaseName(Phase phase);
+
+    // Process-wide per-phase latency histograms and server gauges, rendered for the web port's /metrics
+    // (Prometheus text) and /metrics.json. Phases are recorded on the server thread and rendered from the
+    // web server's; everything here is atomic, so neither waits on the other.
+    class TickProfiler final {
+      public:
+        static TickProfiler &Get();
+
+        void Record(Phase phase, std::chrono::nanoseconds elapsed) {
+            _phases[static_cast<size_t>(phase)].Record(static_cast<uint64_t>(std::max<int64_t>(elapsed.count(), 0)));
+        }
+
+        // Refreshed by the server about once a second.
+        void SetPlayers(uint64_t players) {
+            _players.store(players, std::memory_order_relaxed);
+        }
+        void SetEntities(uint64_t entities) {
+            _entities.store(entities, std::memory_order_relaxed);
+        }
+        // Running totals over all connections.
+        void SetNetworkBytes(uint64_t received, uint64_t sent) {
+            _bytesIn.store(received, std::memory_order_relaxed);
+            _bytesOut.store(sent, std::memory_order_relaxed);
+        }
+
+        // Per-event-name script dispatch counters, rendered alongside the phases.
+        EventStats &Events() {
+            return _events;
+        }
+
+        std::string RenderPrometheus() const;
+        std::string RenderJson() const;
+
+        void Reset();
+
+      private:
+        std::array<LatencyHistogram, static_cast<size_t>(Phase::Count)> _phases;
+        std::atomic<uint64_t> _players {0};
+        std::atomic<uint64_t> _entities {0};
+        std::atomic<uint64_t> _bytesIn {0};
+        std::atomic<uint64_t> _bytesOut {0};
+        EventStats _events;
+    };
+
+    // Times its own lifetime into phase.
+    class ScopedPhase final {
+      public:
+        explicit ScopedPhase(Phase phase): _phase(phase), _start(std::chrono::steady_clock::now()) {}
+        ~ScopedPhase() {
+            TickProfiler::Get().Record(_phase, std::chrono::steady_clock::now() - _start);
+        }
+        ScopedPhase(const ScopedPhase &)            = delete;
+        ScopedPhase &operator=(const ScopedPhase &) = delete;
+
+      private:
+        Phase _phase;
+        std::chrono::steady_clock::time_point _start;
+    };
+} // namespace HogwartsMP::Core::Metrics
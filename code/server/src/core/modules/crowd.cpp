@@ -0,0 +1,311 @@
+#include "crowd.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace HogwartsMP::Core::Modules {
+    namespace {
+        constexpr uint32_t kNoSlot = UINT32_MAX;
+        // Largest wander turn per step, in radians (small-angle rotation, renormalized).
+        constexpr float kWanderJitter = 0.3f;
+
+        int32_t CellCoord(float v, float cellSize) {
+            return static_cast<int32_t>(std::floor(v / cellSize));
+        }
+
+        uint32_t CellHash(int32_t cx, int32_t cy, uint32_t mask) {
+            return (static_cast<uint32_t>(cx) * 73856093u ^ static_cast<uint32_t>(cy) * 19349663u) & mask;
+        }
+    } // namespace
+
+    Crowd &Crowd::Get() {
+        static Crowd crowd;
+        return crowd;
+    }
+
+    size_t Crowd::Spawn(size_t count, glm::vec2 min, glm::vec2 max, float z, const std::vector<std::shared_ptr<const Shared::Modules::CcdProfile>> &profiles,
+                        const Params &params) {
+        _params  = params;
+        _areaMin = glm::min(min, max);
+        _areaMax = glm::max(min, max);
+
+        const auto firstProfile = static_cast<uint32_t>(_profiles.size());
+        for (const auto &profile : profiles) {
+            if (profile && _profiles.size() < kMaxProfiles) {
+                _profiles.push_back(profile);
+            }
+        }
+        const auto profileCount = static_cast<uint32_t>(_profiles.size()) - firstProfile;
+
+        const size_t first = Size();
+        count              = std::min(count, kMaxAgents - first);
+        for (auto *column : {&_px, &_py, &_pz, &_vx, &_vy, &_gx, &_gy, &_wx, &_wy, &_sx, &_sy}) {
+            column->resize(first + count, 0.0f);
+        }
+        _profileOf.resize(first + count, kNoProfile);
+        _networkIds.resize(first + count, kNotPromoted);
+        _promotedSlot.resize(first + count, kNoSlot);
+
+        const glm::vec2 extent = _areaMax - _areaMin;
+        for (size_t i = first; i < first + count; ++i) {
+            _px[i]              = _areaMin.x + Random() * extent.x;
+            _py[i]              = _areaMin.y + Random() * extent.y;
+            _pz[i]              = z;
+            _gx[i]              = _areaMin.x + Random() * extent.x;
+            _gy[i]              = _areaMin.y + Random() * extent.y;
+            const float heading = Random() * 6.2831853f;
+            _wx[i]              = std::cos(heading);
+            _wy[i]              = std::sin(heading);
+            if (profileCount) {
+                _profileOf[i] = firstProfile + static_cast<uint32_t>((i - first) % profileCount);
+            }
+        }
+        return count;
+    }
+
+    void Crowd::Advance(float seconds) {
+        if (_px.empty()) {
+            _pending = 0.0f;
+            return;
+        }
+        _pending += seconds;
+        uint32_t steps = 0;
+        while (_pending >= kStepSeconds && steps < kMaxSteps) {
+            Step(kStepSeconds);
+            _pending -= kStepSeconds;
+            ++steps;
+        }
+        if (steps == kMaxSteps) {
+            _pending = std::min(_pending, kStepSeconds);
+        }
+    }
+
+    void Crowd::Tick(std::chrono::steady_clock::time_point now) {
+        if (_lastTick != std::chrono::steady_clock::time_point {}) {
+            Advance(std::chrono::duration<float>(now - _lastTick).count());
+        }
+        _lastTick = now;
+    }
+
+    void Crowd::Step(float dt) {
+        Retarget();
+        BuildGrid();
+        Separate();
+        Steer(dt);
+    }
+
+    void Crowd::Retarget() {
+        const glm::vec2 extent = _areaMax - _areaMin;
+        const float arrive2    = _params.arriveRadius * _params.arriveRadius;
+        for (size_t i = 0; i < _px.size(); ++i) {
+            const float dx = _gx[i] - _px[i];
+            const float dy = _gy[i] - _py[i];
+            if (dx * dx + dy * dy < arrive2) {
+                _gx[i] = _areaMin.x + Random() * extent.x;
+                _gy[i] = _areaMin.y + Random() * extent.y;
+            }
+            const float turn = (Random() * 2.0f - 1.0f) * kWanderJitter;
+            const float wx   = _wx[i] - turn * _wy[i];
+            const float wy   = _wy[i] + turn * _wx[i];
+            const float norm = 1.0f / std::sqrt(wx * wx + wy * wy);
+            _wx[i]           = wx * norm;
+            _wy[i]           = wy * norm;
+        }
+    }
+
+    void Crowd::BuildGrid() {
+        const size_t count = _px.size();
+        uint32_t cells     = 16;
+        while (cells < count * 2) {
+            cells <<= 1;
+        }
+        const uint32_t mask = cells - 1;
+        const float size    = std::max(_params.separation, 1.0f);
+
+        _cellOf.resize(count);
+        _cellAgents.resize(count);
+        _cellStart.assign(cells + 1, 0);
+        for (size_t i = 0; i < count; ++i) {
+            _cellOf[i] = CellHash(CellCoord(_px[i], size), CellCoord(_py[i], size), mask);
+            ++_cellStart[_cellOf[i]];
+        }
+        // Counting sort: turn the counts into end offsets, then fill each cell back to front, which leaves
+        // _cellStart[c] at the cell's first agent.
+        uint32_t end = 0;
+        for (uint32_t c = 0; c < cells; ++c) {
+            end += _cellStart[c];
+            _cellStart[c] = end;
+        }
+        _cellStart[cells] = static_cast<uint32_t>(count);
+        for (size_t i = count; i-- > 0;) {
+            _cellAgents[--_cellStart[_cellOf[i]]] = static_cast<uint32_t>(i);
+        }
+    }
+
+    void Crowd::Separate() {
+        const float size    = std::max(_params.separation, 1.0f);
+        const float radius2 = _params.separation * _params.separation;
+        const auto mask     = static_cast<uint32_t>(_cellStart.size() - 2);
+        for (size_t i = 0; i < _px.size(); ++i) {
+            const int32_t cx = CellCoord(_px[i], size);
+            const int32_t cy = CellCoord(_py[i], size);
+            // Two neighbouring cells can hash to one bucket; visit each bucket once.
+            uint32_t visited[9];
+            uint32_t visitedCount = 0;
+            float sx              = 0.0f;
+            float sy              = 0.0f;
+            for (int32_t oy = -1; oy <= 1; ++oy) {
+                for (int32_t ox = -1; ox <= 1; ++ox) {
+                    const uint32_t cell = CellHash(cx + ox, cy + oy, mask);
+                    if (std::find(visited, visited + visitedCount, cell) != visited + visitedCount) {
+                        continue;
+                    }
+                    visited[visitedCount++] = cell;
+                    for (uint32_t k = _cellStart[cell]; k < _cellStart[cell + 1]; ++k) {
+                        const uint32_t j = _cellAgents[k];
+                        const float dx   = _px[i] - _px[j];
+                        const float dy   = _py[i] - _py[j];
+                        const float d2   = dx * dx + dy * dy;
+                        if (j == i || d2 >= radius2 || d2 <= 0.0f) {
+                            continue;
+                        }
+                        // Away from the neighbour, harder the closer it is (1 on contact, 0 at the radius).
+                        const float d    = std::sqrt(d2);
+                        const float push = (1.0f - d / _params.separation) / d;
+                        sx += dx * push;
+                        sy += dy * push;
+                    }
+                }
+            }
+            _sx[i] = sx;
+            _sy[i] = sy;
+        }
+    }
+
+    void Crowd::Steer(float dt) {
+        const Params p  = _params;
+        const size_t n  = _px.size();
+        float *px       = _px.data();
+        float *py       = _py.data();
+        float *vx       = _vx.data();
+        float *vy       = _vy.data();
+        const float *gx = _gx.data();
+        const float *gy = _gy.data();
+        const float *wx = _wx.data();
+        const float *wy = _wy.data();
+        const float *sx = _sx.data();
+        const float *sy = _sy.data();
+        // Straight-line arithmetic over the columns, min/max instead of branches: vectorizable.
+        for (size_t i = 0; i < n; ++i) {
+            const float dx     = gx[i] - px[i];
+            const float dy     = gy[i] - py[i];
+            const float toGoal = p.maxSpeed / (std::sqrt(dx * dx + dy * dy) + 1e-3f);
+
+            const float desiredX = dx * toGoal * p.seekWeight + wx[i] * p.maxSpeed * p.wanderWeight + sx[i] * p.maxSpeed * p.separateWeight;
+            const float desiredY = dy * toGoal * p.seekWeight + wy[i] * p.maxSpeed * p.wanderWeight + sy[i] * p.maxSpeed * p.separateWeight;
+
+            float steerX       = desiredX - vx[i];
+            float steerY       = desiredY - vy[i];
+            const float force  = std::sqrt(steerX * steerX + steerY * steerY);
+            const float fScale = std::min(1.0f, p.maxForce * dt / (force + 1e-6f));
+            steerX *= fScale;
+            steerY *= fScale;
+
+            float nvx          = vx[i] + steerX;
+            float nvy          = vy[i] + steerY;
+            const float speed  = std::sqrt(nvx * nvx + nvy * nvy);
+            const float vScale = std::min(1.0f, p.maxSpeed / (speed + 1e-6f));
+            nvx *= vScale;
+            nvy *= vScale;
+
+            vx[i] = nvx;
+            vy[i] = nvy;
+            px[i] += nvx * dt;
+            py[i] += nvy * dt;
+        }
+    }
+
+    void Crowd::UpdateStreaming(const std::vector<Viewer> &viewers, std::vector<uint32_t> &promote, std::vector<uint32_t> &demote) {
+        const float slack2 = kStreamSlack * kStreamSlack;
+        for (size_t i = 0; i < _px.size(); ++i) {
+            const bool promoted = _networkIds[i] != kNotPromoted;
+            if (!promoted && _promoted.size() + promote.size() >= kMaxPromoted) {
+                continue;
+            }
+            bool inRange = false;
+            bool nearby  = false;
+            for (const auto &viewer : viewers) {
+                const float dx     = _px[i] - viewer.position.x;
+                const float dy     = _py[i] - viewer.position.y;
+                const float dz     = _pz[i] - viewer.position.z;
+                const float d2     = dx * dx + dy * dy + dz * dz;
+                const float range2 = viewer.range * viewer.range;
+                inRange |= d2 < range2;
+                nearby |= d2 < range2 * slack2;
+            }
+            if (!promoted && inRange) {
+                promote.push_back(static_cast<uint32_t>(i));
+            }
+            else if (promoted && !nearby) {
+                demote.push_back(static_cast<uint32_t>(i));
+            }
+        }
+    }
+
+    void Crowd::Bind(uint32_t agent, uint64_t networkId) {
+        if (_networkIds[agent] != kNotPromoted) {
+            Unbind(agent);
+        }
+        _networkIds[agent]   = networkId;
+        _promotedSlot[agent] = static_cast<uint32_t>(_promoted.size());
+        _promoted.push_back(agent);
+    }
+
+    void Crowd::Unbind(uint32_t agent) {
+        const uint32_t slot = _promotedSlot[agent];
+        if (slot == kNoSlot) {
+            return;
+        }
+        const uint32_t moved = _promoted.back();
+        _promoted[slot]      = moved;
+        _promotedSlot[moved] = slot;
+        _promoted.pop_back();
+        _promotedSlot[agent] = kNoSlot;
+        _networkIds[agent]   = kNotPromoted;
+    }
+
+    void Crowd::UnbindEntity(uint64_t networkId) {
+        for (const uint32_t agent : _promoted) {
+            if (_networkIds[agent] == networkId) {
+                Unbind(agent);
+                return;
+            }
+        }
+    }
+
+    std::vector<uint64_t> Crowd::Clear() {
+        std::vector<uint64_t> ids;
+        ids.reserve(_promoted.size());
+        for (const uint32_t agent : _promoted) {
+            ids.push_back(_networkIds[agent]);
+        }
+        for (auto *column : {&_px, &_py, &_pz, &_vx, &_vy, &_gx, &_gy, &_wx, &_wy, &_sx, &_sy}) {
+            column->clear();
+        }
+        _profileOf.clear();
+        _networkIds.clear();
+        _promotedSlot.clear();
+        _promoted.clear();
+        _profiles.clear();
+        _pending = 0.0f;
+        return ids;
+    }
+
+    float Crowd::Random() {
+        // xorshift32: cheap, and deterministic for a given spawn order.
+        _rng ^= _rng << 13;
+        _rng ^= _rng >> 17;
+        _rng ^= _rng << 5;
+        return static_cast<float>(_rng >> 8) * (1.0f / 16777216.0f);
+    }
+} // namespace HogwartsMP::Core::Modules
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace HogwartsMP::Shared::Modules {
+    struct CcdProfile;
+} // namespace HogwartsMP::Shared::Modules
+
+namespace HogwartsMP::Core::Modules {
+    /**
+     * Ambient crowd: thousands of lightweight NPCs simulated as plain arrays, not entities. An agent is a
+     * row across the columns below (position, velocity, goal, wander direction, appearance) and steers by
+     * seeking its goal, wandering, and keeping apart from the agents around it (found through a grid
+     * rebuilt each step). The passes run over whole columns with no per-agent branching on entity state,
+     * so the compiler can vectorize them.
+     *
+     * Agents only become replicated Human entities while a viewer (a connected player) has them in range:
+     * UpdateStreaming reports which agents to promote and which to demote, and the owner (Server) creates
+     * or destroys the entity and Binds / Unbinds its network id (a ServerHuman unbinds itself as it is
+     * destroyed, whoever destroys it). Appearances are shared profiles, referenced
+     * by index; a promoted entity gets a copy of its agent's. Ground height is the agent's spawn height:
+     * the server has no navigation data.
+     *
+     * Server thread only.
+     */
+    class Crowd final {
+      public:
+        static constexpr float kStepSeconds    = 1.0f / 20.0f;
+        static constexpr uint32_t kMaxSteps    = 4;
+        static constexpr size_t kMaxAgents     = 16384;
+        static constexpr size_t kMaxPromoted   = 256;
+        static constexpr size_t kMaxProfiles   = 256;
+        static constexpr float kStreamSlack    = 1.1f;
+        static constexpr uint32_t kNoProfile   = UINT32_MAX;
+        static constexpr uint64_t kNotPromoted = 0;
+
+        struct Params {
+            // Walking speed (cm/s) and how hard agents turn towards where they want to go.
+            float maxSpeed       = 140.0f;
+            float maxForce       = 400.0f;
+            // Agents closer than this (cm) push each other apart.
+            float separation     = 120.0f;
+            float seekWeight     = 1.0f;
+            float wanderWeight   = 0.4f;
+            float separateWeight = 2.0f;
+            // An agent picks a new goal in the area once within this distance (cm) of its current one.
+            float arriveRadius   = 150.0f;
+        };
+
+        // Something that makes agents visible: a connected player's avatar and its streaming range.
+        struct Viewer {
+            glm::vec3 position;
+            float range;
+        };
+
+        static Crowd &Get();
+
+        // Scatter count agents over the rectangle [min, max] (x/y) at height z, with goals inside it,
+        // wearing the given profiles in turn (none = the default look). Returns how many were added
+        // (bounded by kMaxAgents). Params and area apply to the whole crowd; a later Spawn replaces them.
+        size_t Spawn(size_t count, glm::vec2 min, glm::vec2 max, float z, const std::vector<std::shared_ptr<const Shared::Modules::CcdProfile>> &profiles,
+                     const Params &params);
+
+        // Run the fixed steps due seconds after the previous call.
+        void Advance(float seconds);
+        void Tick(std::chrono::steady_clock::time_point now);
+
+        // Agents that came into some viewer's range and should be promoted (nearest first is not
+        // guaranteed; at most kMaxPromoted are promoted at once), and promoted agents that every viewer has
+        // left (with kStreamSlack of hysteresis) and should be demoted.
+        void UpdateStreaming(const std::vector<Viewer> &viewers, std::vector<uint32_t> &promote, std::vector<uint32_t> &demote);
+        void Bind(uint32_t agent, uint64_t networkId);
+        void Unbind(uint32_t agent);
+        // Unbind whichever agent is promoted as networkId, if any: its entity is being destroyed, perhaps by
+        // a script, and the id may be handed to an unrelated entity next. Scans the promoted agents.
+        void UnbindEntity(uint64_t networkId);
+
+        // Promoted agents, for writing their transforms to their entities.
+        const std::vector<uint32_t> &Promoted() const {
+            return _promoted;
+        }
+        uint64_t NetworkId(uint32_t agent) const {
+            return _networkIds[agent];
+        }
+        glm::vec3 Position(uint32_t agent) const {
+            return {_px[agent], _py[agent], _pz[agent]};
+        }
+        glm::vec3 Velocity(uint32_t agent) const {
+            return {_vx[agent], _vy[agent], 0.0f};
+        }
+        // The agent's shared appearance, or nullptr for the default look.
+        const Shared::Modules::CcdProfile *Profile(uint32_t agent) const {
+            return _profileOf[agent] == kNoProfile ? nullptr : _profiles[_profileOf[agent]].get();
+        }
+
+        size_t Size() const {
+            return _px.size();
+        }
+        size_t PromotedCount() const {
+            return _promoted.size();
+        }
+
+        // Drop every agent and profile; the ids of the agents that were promoted are returned so their
+        // entities can be destroyed.
+        std::vector<uint64_t> Clear();
+
+      private:
+        void Step(float dt);
+        void BuildGrid();
+        void Separate();
+        void Steer(float dt);
+        void Retarget();
+        float Random();
+
+        Params _params;
+        glm::vec2 _areaMin {};
+        glm::vec2 _areaMax {};
+
+        std::vector<float> _px, _py, _pz;
+        std::vector<float> _vx, _vy;
+        std::vector<float> _gx, _gy;
+        // Unit wander direction, jittered each step.
+        std::vector<float> _wx, _wy;
+        // Separation force, recomputed each step.
+        std::vector<float> _sx, _sy;
+        std::vector<uint32_t> _profileOf;
+        std::vector<uint64_t> _networkIds;
+        // Index into _promoted of each promoted agent.
+        std::vector<uint32_t> _promotedSlot;
+        std::vector<uint32_t> _promoted;
+        std::vector<std::shared_ptr<const Shared::Modules::CcdProfile>> _profiles;
+
+        // Uniform grid (cell = separation distance), hashed into a power-of-two table and counting-sorted:
+        // the agents of cell c are _cellAgents[_cellStart[c] .. _cellStart[c + 1]).
+        std::vector<uint32_t> _cellOf;
+        std::vector<uint32_t> _cellStart;
+        std::vector<uint32_t> _cellAgents;
+
+        uint32_t _rng  = 0x9E3779B9u;
+        float _pending = 0.0f;
+        std::chrono::steady_clock::time_point _lastTick {};
+    };
+} // namespace HogwartsMP::Core::Modules
@@ -13,12 +13,12 @@ namespace HogwartsMP::Core::Modules {
         // model the proxy path already knows how to build.
         constexpr uint64_t kDefaultSpawnProfile = 335218123840277515ULL;
 
-        Shared::HumanEntity *CreateHuman(ReplicationManager *repl) {
+        ServerHuman *CreateHuman(ReplicationManager *repl) {
             if (!repl) {
                 return nullptr;
             }
             const auto typeId = EntityRegistry::Get().TypeId(Shared::kHumanTypeName);
-            auto *human       = static_cast<Shared::HumanEntity *>(repl->CreateEntity(typeId));
+            auto *human       = static_cast<ServerHuman *>(repl->CreateEntity(typeId));
             if (!human) {
                 Framework::Logging::GetLogger("Human")->error("Failed to create Human entity (type not registered?)");
                 return nullptr;
@@ -29,7 +29,7 @@ namespace HogwartsMP::Core::Modules {
     } // namespace
 
     void Human::Register() {
-        EntityRegistry::Get().Register<Shared::HumanEntity>(Shared::kHumanTypeName);
+        EntityRegistry::Get().Register<ServerHuman>(Shared::kHumanTypeName);
     }
 
     Shared::HumanEntity *Human::CreatePlayer(ReplicationManager *repl, const Framework::Integrations::Server::PlayerConnectionData &data) {
@@ -44,6 +44,7 @@ namespace HogwartsMP::Core::Modules {
         human->streaming.range = 50000.f;
         repl->SetOwner(human, data.guid);
         repl->SetViewer(data.guid, human);
+        HumanRegistry::Get().Add(human->GetNetworkID(), human, true);
         return human;
     }
 
@@ -55,7 +56,29 @@ namespace HogwartsMP::Core::Modules {
         human->position = {x, y, z};
         // Left unowned (ownerGUID stays UNASSIGNED): the server keeps authority, so it won't get
         // handed to a client that would then echo a stale transform back every tick.
+        HumanRegistry::Get().Add(human->GetNetworkID(), human, false);
         Framework::Logging::GetLogger("Human")->debug("Spawned NPC entity {} at ({}, {}, {})", human->GetNetworkID(), x, y, z);
         return human;
     }
+
+    std::vector<Shared::HumanEntity *> Human::SpawnMany(ReplicationManager *repl, const std::vector<glm::vec3> &positions, const Shared::Modules::CcdProfile *appearance) {
+        std::vector<Shared::HumanEntity *> spawned;
+        spawned.reserve(positions.size());
+        auto &registry = HumanRegistry::Get();
+        registry.Reserve(positions.size());
+        for (const auto &position : positions) {
+            auto *human = CreateHuman(repl);
+            if (!human) {
+                break;
+            }
+            human->position = position;
+            if (appearance) {
+                human->ccd = *appearance;
+            }
+            registry.Add(human->GetNetworkID(), human, false);
+            spawned.push_back(human);
+        }
+        Framework::Logging::GetLogger("Human")->debug("Spawned {} NPC entities", spawned.size());
+        return spawned;
+    }
 } // namespace HogwartsMP::Core::Modules
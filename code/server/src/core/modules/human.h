@@ -3,9 +3,43 @@
 #include <integrations/server/instance.h>
 #include <networking/replication/replication_manager.h>
 
+#include "crowd.h"
+#include "human_registry.h"
+#include "npc_movement.h"
+
 #include "shared/game/human.h"
+#include "shared/game/human_pool.h"
+
+#include <glm/glm.hpp>
+
+#include <vector>
 
 namespace HogwartsMP::Core::Modules {
+    // The server's Human entity type: a HumanEntity that leaves the HumanRegistry (and stops any native
+    // movement, and hands a crowd agent it stood in for back to the crowd) as it is destroyed, however that happens (DestroyEntity, or the framework tearing down a
+    // disconnected player). Instances are recycled through HumanPool, so NPC churn reuses their memory.
+    class ServerHuman final: public Shared::HumanEntity {
+      public:
+        using Pool = Shared::HumanPool<ServerHuman>;
+
+        ServerHuman() {
+            Pool::Adopt(*this);
+        }
+        ~ServerHuman() override {
+            HumanRegistry::Get().Remove(GetNetworkID(), this);
+            NpcMovement::Get().Remove(GetNetworkID(), this);
+            Crowd::Get().UnbindEntity(GetNetworkID());
+            Pool::Retire(*this);
+        }
+
+        static void *operator new(size_t size) {
+            return Pool::Allocate(size);
+        }
+        static void operator delete(void *block, size_t size) {
+            Pool::Release(block, size);
+        }
+    };
+
     class Human {
       public:
         // Register the Human network type (server-side constructor) with the EntityRegistry. Call once
@@ -20,5 +54,19 @@ namespace HogwartsMP::Core::Modules {
         // the remote-avatar path single-client. Stays server-owned (the server is authoritative over
         // its transform). Tear down with ReplicationManager::DestroyEntity.
         static Shared::HumanEntity *Spawn(Framework::Networking::Replication::ReplicationManager *repl, float x, float y, float z);
+        // Spawn one NPC per position in a single pass, all wearing appearance (already sanitized; nullptr =
+        // the default look), which rides each construction snapshot — no AppearanceUpdate per NPC. Created
+        // in the same tick, their constructions leave in the same replication update. Stops at the first
+        // failure; returns the entities created.
+        static std::vector<Shared::HumanEntity *> SpawnMany(Framework::Networking::Replication::ReplicationManager *repl, const std::vector<glm::vec3> &positions,
+                                                            const Shared::Modules::CcdProfile *appearance);
+
+        // The live human (player or NPC) / connected player with this NetworkID, or nullptr.
+        static Shared::HumanEntity *Find(uint64_t networkId) {
+            return HumanRegistry::Get().Find(networkId);
+        }
+        static Shared::HumanEntity *FindPlayer(uint64_t networkId) {
+            return HumanRegistry::Get().FindPlayer(networkId);
+        }
     };
 } // namespace HogwartsMP::Core::Modules
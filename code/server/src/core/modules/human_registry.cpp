@@ -0,0 +1,73 @@
+#include "human_registry.h"
+
+namespace HogwartsMP::Core::Modules {
+    HumanRegistry &HumanRegistry::Get() {
+        static HumanRegistry registry;
+        return registry;
+    }
+
+    void HumanRegistry::Add(uint64_t networkId, Shared::HumanEntity *human, bool player) {
+        if (const auto it = _slots.find(networkId); it != _slots.end()) {
+            Remove(networkId, _humans[it->second.human]);
+        }
+        Slot slot;
+        slot.human = static_cast<uint32_t>(_humans.size());
+        _humans.push_back(human);
+        _humanIds.push_back(networkId);
+        if (player) {
+            slot.player = static_cast<uint32_t>(_players.size());
+            _players.push_back(human);
+            _playerIds.push_back(networkId);
+        }
+        _slots.emplace(networkId, slot);
+    }
+
+    void HumanRegistry::Remove(uint64_t networkId, const Shared::HumanEntity *human) {
+        const auto it = _slots.find(networkId);
+        if (it == _slots.end() || _humans[it->second.human] != human) {
+            return;
+        }
+        const Slot slot = it->second;
+        _slots.erase(it);
+        Erase(_humans, _humanIds, slot.human, &Slot::human);
+        if (slot.player != kNoSlot) {
+            Erase(_players, _playerIds, slot.player, &Slot::player);
+        }
+    }
+
+    void HumanRegistry::Erase(std::vector<Shared::HumanEntity *> &entities, std::vector<uint64_t> &ids, uint32_t index, uint32_t Slot::*field) {
+        const auto last = static_cast<uint32_t>(entities.size() - 1);
+        if (index != last) {
+            entities[index] = entities[last];
+            ids[index]      = ids[last];
+
+            _slots.find(ids[index])->second.*field = index;
+        }
+        entities.pop_back();
+        ids.pop_back();
+    }
+
+    void HumanRegistry::Reserve(size_t count) {
+        _humans.reserve(_humans.size() + count);
+        _humanIds.reserve(_humanIds.size() + count);
+        _slots.reserve(_slots.size() + count);
+    }
+
+    Shared::HumanEntity *HumanRegistry::Find(uint64_t networkId) const {
+        const auto it = _slots.find(networkId);
+        return it != _slots.end() ? _humans[it->second.human] : nullptr;
+    }
+
+    Shared::HumanEntity *HumanRegistry::FindPlayer(uint64_t networkId) const {
+        const auto it = _slots.find(networkId);
+        return it != _slots.end() && it->second.player != kNoSlot ? _players[it->second.player] : nullptr;
+    }
+
+    void HumanRegistry::Clear() {
+        _humans.clear();
+        _humanIds.clear();
+        _players.clear();
+        _playerIds.clear();
+        _slots.clear();
+    }
+} // namespace HogwartsMP::Core::Modules
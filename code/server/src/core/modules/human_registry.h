@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace HogwartsMP::Shared {
+    class HumanEntity;
+} // namespace HogwartsMP::Shared
+
+namespace HogwartsMP::Core::Modules {
+    /**
+     * Every live Human entity on the server, by NetworkID, without going through the replication
+     * manager's generic lookup and a dynamic_cast. Entities sit in a dense array (and players also in
+     * their own), so enumerating or counting players costs O(players), not a walk over every replicated
+     * entity. Removal swaps the last entry into the hole: order is not stable.
+     *
+     * Core::Modules::Human adds entities as it creates them; a ServerHuman removes itself when it is
+     * destroyed, whichever path destroys it. Server thread only.
+     */
+    class HumanRegistry final {
+      public:
+        static HumanRegistry &Get();
+
+        // Register human under networkId (replacing whatever was there); player = a connected player's
+        // avatar rather than a server NPC.
+        void Add(uint64_t networkId, Shared::HumanEntity *human, bool player);
+        // Unregister networkId if it is still registered to human: a stale pointer never evicts the
+        // entity that took the id over.
+        void Remove(uint64_t networkId, const Shared::HumanEntity *human);
+
+        // Make room for count more entities (NPCs), so a batch spawn adds them without regrowing.
+        void Reserve(size_t count);
+
+        Shared::HumanEntity *Find(uint64_t networkId) const;
+        // As Find, but nullptr for an NPC.
+        Shared::HumanEntity *FindPlayer(uint64_t networkId) const;
+
+        const std::vector<Shared::HumanEntity *> &All() const {
+            return _humans;
+        }
+        const std::vector<Shared::HumanEntity *> &Players() const {
+            return _players;
+        }
+        size_t Size() const {
+            return _humans.size();
+        }
+        size_t PlayerCount() const {
+            return _players.size();
+        }
+
+        void Clear();
+
+      private:
+        static constexpr uint32_t kNoSlot = UINT32_MAX;
+
+        struct Slot {
+            uint32_t human  = kNoSlot;
+            uint32_t player = kNoSlot;
+        };
+
+        // Swap-remove index from one dense array and its parallel ids, fixing up the moved entry's slot.
+        void Erase(std::vector<Shared::HumanEntity *> &entities, std::vector<uint64_t> &ids, uint32_t index, uint32_t Slot::*field);
+
+        std::vector<Shared::HumanEntity *> _humans;
+        std::vector<uint64_t> _humanIds;
+        std::vector<Shared::HumanEntity *> _players;
+        std::vector<uint64_t> _playerIds;
+        std::unordered_map<uint64_t, Slot> _slots;
+    };
+} // namespace HogwartsMP::Core::Modules
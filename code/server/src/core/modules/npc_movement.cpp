@@ -0,0 +1,220 @@
+#include "npc_movement.h"
+
+#include "shared/game/human.h"
+
+#include <glm/gtc/quaternion.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace HogwartsMP::Core::Modules {
+    namespace {
+        using HumanSync = Shared::Modules::HumanSync;
+
+        // A Catmull-Rom curve through path, kSplineSamples points per segment; the ends are held by
+        // repeating the first and last point.
+        std::vector<glm::vec3> SampleSpline(const std::vector<glm::vec3> &path) {
+            std::vector<glm::vec3> out;
+            out.reserve((path.size() - 1) * NpcMovement::kSplineSamples + 1);
+            for (size_t i = 0; i + 1 < path.size(); ++i) {
+                const glm::vec3 &p0 = path[i > 0 ? i - 1 : i];
+                const glm::vec3 &p1 = path[i];
+                const glm::vec3 &p2 = path[i + 1];
+                const glm::vec3 &p3 = path[i + 2 < path.size() ? i + 2 : i + 1];
+                for (uint32_t s = 0; s < NpcMovement::kSplineSamples; ++s) {
+                    const float t  = static_cast<float>(s) / NpcMovement::kSplineSamples;
+                    const float t2 = t * t;
+                    const float t3 = t2 * t;
+                    out.push_back(0.5f * (2.0f * p1 + (p2 - p0) * t + (2.0f * p0 - 5.0f * p1 + 4.0f * p2 - p3) * t2 + (3.0f * p1 - p0 - 3.0f * p2 + p3) * t3));
+                }
+            }
+            out.push_back(path.back());
+            return out;
+        }
+    } // namespace
+
+    NpcMovement &NpcMovement::Get() {
+        static NpcMovement movement;
+        return movement;
+    }
+
+    bool NpcMovement::MoveAlong(uint64_t networkId, Shared::HumanEntity *human, const std::vector<glm::vec3> &points, float speed, const Options &options) {
+        if (!human || points.empty() || points.size() > kMaxPathPoints || !(speed > 0.0f) || !std::isfinite(speed)) {
+            return false;
+        }
+        Stop(networkId);
+
+        std::vector<glm::vec3> path;
+        path.reserve(points.size() + 1);
+        path.push_back(human->position);
+        path.insert(path.end(), points.begin(), points.end());
+        if (options.spline && path.size() > 2) {
+            path = SampleSpline(path);
+        }
+
+        uint8_t tripFlags    = 0;
+        int16_t savedMountId = kKeepMount;
+        if (options.arcHeight > 0.0f) {
+            tripFlags |= HumanSync::InAir;
+        }
+        if (options.mountId >= 0) {
+            tripFlags |= HumanSync::Mounted;
+            savedMountId        = human->data.mountId;
+            human->data.mountId = static_cast<uint8_t>(options.mountId);
+        }
+        // Only what the trip turns on is its to turn off: an NPC already mounted (or in the air) stays so.
+        tripFlags &= static_cast<uint8_t>(~human->stateFlags);
+        human->stateFlags |= tripFlags;
+
+        _slots.emplace(networkId, static_cast<uint32_t>(_ids.size()));
+        _ids.push_back(networkId);
+        _humans.push_back(human);
+        _paths.push_back(std::move(path));
+        _segments.push_back(0);
+        _along.push_back(0.0f);
+        _speeds.push_back(speed);
+        _arcs.push_back(std::max(options.arcHeight, 0.0f));
+        _tripFlags.push_back(tripFlags);
+        _savedMountIds.push_back(savedMountId);
+        return true;
+    }
+
+    bool NpcMovement::Stop(uint64_t networkId) {
+        const auto it = _slots.find(networkId);
+        if (it == _slots.end()) {
+            return false;
+        }
+        const size_t index = it->second;
+        Settle(index);
+        Erase(index);
+        return true;
+    }
+
+    void NpcMovement::Remove(uint64_t networkId, const Shared::HumanEntity *human) {
+        const auto it = _slots.find(networkId);
+        if (it != _slots.end() && _humans[it->second] == human) {
+            Erase(it->second);
+        }
+    }
+
+    void NpcMovement::Advance(float seconds, std::vector<uint64_t> &arrived) {
+        if (_ids.empty()) {
+            _pending = 0.0f;
+            return;
+        }
+        _pending += seconds;
+        uint32_t steps = 0;
+        while (_pending >= kStepSeconds && steps < kMaxStepsPerAdvance) {
+            Step(kStepSeconds, arrived);
+            _pending -= kStepSeconds;
+            ++steps;
+        }
+        if (steps == kMaxStepsPerAdvance) {
+            _pending = std::min(_pending, kStepSeconds);
+        }
+    }
+
+    void NpcMovement::Tick(std::chrono::steady_clock::time_point now, std::vector<uint64_t> &arrived) {
+        if (_lastTick != std::chrono::steady_clock::time_point {}) {
+            Advance(std::chrono::duration<float>(now - _lastTick).count(), arrived);
+        }
+        _lastTick = now;
+    }
+
+    void NpcMovement::Step(float dt, std::vector<uint64_t> &arrived) {
+        // Backwards, so an arrival swapping the last mover into its slot never skips one.
+        for (size_t i = _ids.size(); i-- > 0;) {
+            const auto &path = _paths[i];
+            auto &segment    = _segments[i];
+            auto &along      = _along[i];
+            float remaining  = _speeds[i] * dt;
+
+            float length = 0.0f;
+            while (segment + 1 < path.size()) {
+                length          = glm::distance(path[segment], path[segment + 1]);
+                const float left = length - along;
+                if (remaining < left) {
+                    along += remaining;
+                    break;
+                }
+                remaining -= left;
+                along = 0.0f;
+                ++segment;
+            }
+
+            auto *human = _humans[i];
+            if (segment + 1 >= path.size()) {
+                human->position = path.back();
+                Settle(i);
+                arrived.push_back(_ids[i]);
+                Erase(i);
+                continue;
+            }
+
+            const glm::vec3 dir = (path[segment + 1] - path[segment]) / length;
+            human->position     = path[segment] + dir * along;
+            human->velocity     = dir * _speeds[i];
+            if (_arcs[i] > 0.0f) {
+                // Parabola peaking mid-segment; its slope goes into the vertical velocity.
+                const float t = along / length;
+                human->position.z += 4.0f * _arcs[i] * t * (1.0f - t);
+                human->velocity.z += 4.0f * _arcs[i] * (1.0f - 2.0f * t) * _speeds[i] / length;
+            }
+            // Face the direction of travel (yaw about Z), unless it is straight up or down.
+            if (dir.x != 0.0f || dir.y != 0.0f) {
+                human->rotation = glm::quat(glm::vec3 {0.0f, 0.0f, std::atan2(dir.y, dir.x)});
+            }
+        }
+    }
+
+    void NpcMovement::Settle(size_t index) {
+        auto *human     = _humans[index];
+        human->velocity = {0.0f, 0.0f, 0.0f};
+        human->stateFlags &= static_cast<uint8_t>(~_tripFlags[index]);
+        if (_savedMountIds[index] != kKeepMount) {
+            human->data.mountId = static_cast<uint8_t>(_savedMountIds[index]);
+        }
+    }
+
+    void NpcMovement::Erase(size_t index) {
+        _slots.erase(_ids[index]);
+        const size_t last = _ids.size() - 1;
+        if (index != last) {
+            _ids[index]           = _ids[last];
+            _humans[index]        = _humans[last];
+            _paths[index]         = std::move(_paths[last]);
+            _segments[index]      = _segments[last];
+            _along[index]         = _along[last];
+            _speeds[index]        = _speeds[last];
+            _arcs[index]          = _arcs[last];
+            _tripFlags[index]     = _tripFlags[last];
+            _savedMountIds[index] = _savedMountIds[last];
+
+            _slots[_ids[index]] = static_cast<uint32_t>(index);
+        }
+        _ids.pop_back();
+        _humans.pop_back();
+        _paths.pop_back();
+        _segments.pop_back();
+        _along.pop_back();
+        _speeds.pop_back();
+        _arcs.pop_back();
+        _tripFlags.pop_back();
+        _savedMountIds.pop_back();
+    }
+
+    void NpcMovement::Clear() {
+        _ids.clear();
+        _humans.clear();
+        _paths.clear();
+        _segments.clear();
+        _along.clear();
+        _speeds.clear();
+        _arcs.clear();
+        _tripFlags.clear();
+        _savedMountIds.clear();
+        _slots.clear();
+        _pending  = 0.0f;
+        _lastTick = {};
+    }
+} // namespace HogwartsMP::Core::Modules
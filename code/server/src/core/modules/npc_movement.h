@@ -0,0 +1,98 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace HogwartsMP::Shared {
+    class HumanEntity;
+} // namespace HogwartsMP::Shared
+
+namespace HogwartsMP::Core::Modules {
+    /**
+     * Moves server-owned humans along paths natively, so a script hands over a path once and hears back on
+     * arrival instead of pushing a position every tick. Active movers sit in parallel arrays (one column per
+     * field), stepped at a fixed rate whatever the server tick rate: each step moves an entity along its path
+     * at its speed, faces it along the direction of travel and keeps its velocity current for the clients'
+     * dead reckoning. Finishing a path snaps the entity onto the last point and reports its id.
+     *
+     * Removal swaps the last mover into the hole. A ServerHuman drops its mover as it is destroyed. Server
+     * thread only.
+     */
+    class NpcMovement final {
+      public:
+        static constexpr float kStepSeconds = 1.0f / 30.0f;
+        // Steps run per Advance at most; time past that is dropped rather than caught up in a burst.
+        static constexpr uint32_t kMaxStepsPerAdvance = 8;
+        static constexpr size_t kMaxPathPoints        = 1024;
+        // Points a spline segment is sampled into.
+        static constexpr uint32_t kSplineSamples = 8;
+
+        struct Options {
+            // Pass smoothly through the points (Catmull-Rom) instead of in straight lines.
+            bool spline = false;
+            // Hop over each segment in a parabola this high (cm), in the air (InAir) while travelling.
+            float arcHeight = 0.0f;
+            // Ride this broom (mount id) for the trip; on arrival the entity's own mount state comes back.
+            // Negative = as it is.
+            int mountId = -1;
+        };
+
+        static NpcMovement &Get();
+
+        // Start human (registered under networkId) along points at speed cm/s, replacing any path it was on;
+        // it first heads from where it stands to points[0]. False, changing nothing, for an empty or
+        // oversized path or a non-positive speed.
+        bool MoveAlong(uint64_t networkId, Shared::HumanEntity *human, const std::vector<glm::vec3> &points, float speed, const Options &options);
+        // Leave networkId where it is; false if it was not moving. Velocity and the trip's state flags are
+        // cleared.
+        bool Stop(uint64_t networkId);
+        // Forget networkId's mover if it still belongs to human, without touching the entity (it is being
+        // destroyed).
+        void Remove(uint64_t networkId, const Shared::HumanEntity *human);
+
+        bool IsMoving(uint64_t networkId) const {
+            return _slots.count(networkId) != 0;
+        }
+        size_t Size() const {
+            return _ids.size();
+        }
+
+        // Run the fixed steps due seconds after the previous call and append the ids of the movers that
+        // arrived to arrived.
+        void Advance(float seconds, std::vector<uint64_t> &arrived);
+        // Advance by the time since the last Tick (nothing on the first).
+        void Tick(std::chrono::steady_clock::time_point now, std::vector<uint64_t> &arrived);
+
+        void Clear();
+
+      private:
+        static constexpr int16_t kKeepMount = -1;
+
+        void Step(float dt, std::vector<uint64_t> &arrived);
+        // Clear index's velocity and the state flags its trip set, and give back the mount it replaced.
+        void Settle(size_t index);
+        void Erase(size_t index);
+
+        std::vector<uint64_t> _ids;
+        std::vector<Shared::HumanEntity *> _humans;
+        std::vector<std::vector<glm::vec3>> _paths;
+        // Current segment (from _paths[i][segment] to the next point) and the distance covered on it.
+        std::vector<uint32_t> _segments;
+        std::vector<float> _along;
+        std::vector<float> _speeds;
+        std::vector<float> _arcs;
+        // The state flags the trip set (InAir, Mounted) that were not already on, cleared again when it
+        // ends, and the mount id it replaced (kKeepMount = it did not touch the mount).
+        std::vector<uint8_t> _tripFlags;
+        std::vector<int16_t> _savedMountIds;
+        std::unordered_map<uint64_t, uint32_t> _slots;
+
+        float _pending = 0.0f;
+        std::chrono::steady_clock::time_point _lastTick {};
+    };
+} // namespace HogwartsMP::Core::Modules
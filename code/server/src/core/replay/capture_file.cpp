@@ -0,0 +1,292 @@
+#include "capture_file.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+
+namespace HogwartsMP::Core::Replay {
+    namespace {
+        constexpr std::string_view kMagic = "HMPCAP1\n";
+        constexpr size_t kHeaderBytes     = 16; // magic + startUnixMs
+
+        void PutVarint(std::string &out, uint64_t v) {
+            while (v >= 0x80u) {
+                out.push_back(static_cast<char>((v & 0x7Fu) | 0x80u));
+                v >>= 7;
+            }
+            out.push_back(static_cast<char>(v));
+        }
+
+        bool GetVarint(std::string_view &in, uint64_t &v) {
+            v = 0;
+            for (int shift = 0; shift < 64; shift += 7) {
+                if (in.empty()) {
+                    return false;
+                }
+                const auto byte = static_cast<uint8_t>(in.front());
+                in.remove_prefix(1);
+                v |= static_cast<uint64_t>(byte & 0x7Fu) << shift;
+                if ((byte & 0x80u) == 0) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        void PutU64(std::string &out, uint64_t v) {
+            for (int i = 0; i < 8; ++i) {
+                out.push_back(static_cast<char>((v >> (8 * i)) & 0xFFu));
+            }
+        }
+
+        uint64_t GetU64(const char *p) {
+            uint64_t v = 0;
+            for (int i = 0; i < 8; ++i) {
+                v |= static_cast<uint64_t>(static_cast<uint8_t>(p[i])) << (8 * i);
+            }
+            return v;
+        }
+
+        void PutString(std::string &out, std::string_view s) {
+            PutVarint(out, s.size());
+            out.append(s);
+        }
+
+        bool GetString(std::string_view &in, std::string &s) {
+            uint64_t len = 0;
+            if (!GetVarint(in, len) || len > in.size()) {
+                return false;
+            }
+            s.assign(in.substr(0, static_cast<size_t>(len)));
+            in.remove_prefix(static_cast<size_t>(len));
+            return true;
+        }
+
+        void PutFloats(std::string &out, const float *v, size_t n) {
+            static_assert(sizeof(float) == 4);
+            for (size_t i = 0; i < n; ++i) {
+                uint32_t bits = 0;
+                std::memcpy(&bits, &v[i], sizeof bits);
+                for (int b = 0; b < 4; ++b) {
+                    out.push_back(static_cast<char>((bits >> (8 * b)) & 0xFFu));
+                }
+            }
+        }
+
+        bool GetFloats(std::string_view &in, float *v, size_t n) {
+            if (in.size() < n * 4) {
+                return false;
+            }
+            for (size_t i = 0; i < n; ++i) {
+                uint32_t bits = 0;
+                for (int b = 0; b < 4; ++b) {
+                    bits |= static_cast<uint32_t>(static_cast<uint8_t>(in[i * 4 + b])) << (8 * b);
+                }
+                std::memcpy(&v[i], &bits, sizeof bits);
+            }
+            in.remove_prefix(n * 4);
+            return true;
+        }
+
+        void EncodeBody(std::string &out, const Record &r) {
+            if (r.kind == RecordKind::Tick) {
+                return;
+            }
+            PutVarint(out, r.peer);
+            switch (r.kind) {
+            case RecordKind::Connect:
+                PutVarint(out, r.networkId);
+                PutString(out, r.name);
+                PutString(out, r.text);
+                break;
+            case RecordKind::ClientEvent:
+            case RecordKind::PackedEvent:
+                PutString(out, r.name);
+                PutString(out, r.text);
+                break;
+            case RecordKind::Appearance:
+            case RecordKind::Chat:
+                PutString(out, r.text);
+                break;
+            case RecordKind::ChatCommand:
+                PutString(out, r.text);
+                PutString(out, r.name);
+                PutVarint(out, r.args.size());
+                for (const auto &arg : r.args) {
+                    PutString(out, arg);
+                }
+                break;
+            case RecordKind::State:
+                PutFloats(out, r.state.position.data(), 3);
+                PutFloats(out, r.state.rotation.data(), 4);
+                PutFloats(out, r.state.velocity.data(), 3);
+                out.push_back(static_cast<char>(r.state.stateFlags));
+                out.push_back(static_cast<char>(r.state.data.mountId));
+                out.push_back(static_cast<char>(r.state.data.spellId));
+                out.push_back(static_cast<char>(r.state.data.aimPitch));
+                break;
+            default:
+                break;
+            }
+        }
+
+        bool DecodeBody(std::string_view body, Record &r) {
+            if (r.kind == RecordKind::Tick) {
+                return body.empty();
+            }
+            if (!GetVarint(body, r.peer)) {
+                return false;
+            }
+            switch (r.kind) {
+            case RecordKind::Disconnect:
+                return true;
+            case RecordKind::Connect:
+                return GetVarint(body, r.networkId) && GetString(body, r.name) && GetString(body, r.text);
+            case RecordKind::ClientEvent:
+            case RecordKind::PackedEvent:
+                return GetString(body, r.name) && GetString(body, r.text);
+            case RecordKind::Appearance:
+            case RecordKind::Chat:
+                return GetString(body, r.text);
+            case RecordKind::ChatCommand: {
+                uint64_t argc = 0;
+                if (!GetString(body, r.text) || !GetString(body, r.name) || !GetVarint(body, argc) || argc > body.size()) {
+                    return false;
+                }
+                r.args.resize(static_cast<size_t>(argc));
+                for (auto &arg : r.args) {
+                    if (!GetString(body, arg)) {
+                        return false;
+                    }
+                }
+                return true;
+            }
+            case RecordKind::State:
+                if (!GetFloats(body, r.state.position.data(), 3) || !GetFloats(body, r.state.rotation.data(), 4) ||
+                    !GetFloats(body, r.state.velocity.data(), 3) || body.size() < 4) {
+                    return false;
+                }
+                r.state.stateFlags    = static_cast<uint8_t>(body[0]);
+                r.state.data.mountId  = static_cast<uint8_t>(body[1]);
+                r.state.data.spellId  = static_cast<uint8_t>(body[2]);
+                r.state.data.aimPitch = static_cast<int8_t>(body[3]);
+                return true;
+            default:
+                return true; // a newer kind: skipped by the caller
+            }
+        }
+    } // namespace
+
+    bool CaptureWriter::Open(const std::string &path, uint64_t startUnixMs) {
+        Close();
+        _out.open(path, std::ios::binary | std::ios::trunc);
+        if (!_out) {
+            return false;
+        }
+        _buffer.assign(kMagic);
+        PutU64(_buffer, startUnixMs);
+        _lastUs  = 0;
+        _written = 0;
+        _failed  = false;
+        return true;
+    }
+
+    void CaptureWriter::Write(const Record &record) {
+        if (!_out.is_open()) {
+            return;
+        }
+        Encode(_buffer, record, _lastUs);
+        _lastUs = std::max(_lastUs, record.atUs);
+        if (_buffer.size() >= kChunkBytes) {
+            _out.write(_buffer.data(), static_cast<std::streamsize>(_buffer.size()));
+            _written += _buffer.size();
+            _buffer.clear();
+            _failed = _failed || !_out;
+        }
+    }
+
+    bool CaptureWriter::Flush() {
+        if (!_out.is_open()) {
+            return !_failed;
+        }
+        _out.write(_buffer.data(), static_cast<std::streamsize>(_buffer.size()));
+        _out.flush();
+        _written += _buffer.size();
+        _buffer.clear();
+        _failed = _failed || !_out;
+        return !_failed;
+    }
+
+    void CaptureWriter::Close() {
+        if (!_out.is_open()) {
+            return;
+        }
+        Flush();
+        _out.close();
+    }
+
+    void CaptureWriter::Encode(std::string &out, const Record &record, uint64_t lastUs) {
+        thread_local std::string body;
+        body.clear();
+        EncodeBody(body, record);
+        out.push_back(static_cast<char>(record.kind));
+        PutVarint(out, record.atUs > lastUs ? record.atUs - lastUs : 0);
+        PutVarint(out, body.size());
+        out.append(body);
+    }
+
+    bool CaptureReader::Open(const std::string &path) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in) {
+            return false;
+        }
+        _data.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        if (_data.size() < kHeaderBytes || std::string_view(_data).substr(0, kMagic.size()) != kMagic) {
+            _data.clear();
+            return false;
+        }
+        _startUnixMs = GetU64(_data.data() + kMagic.size());
+        _rest        = std::string_view(_data).substr(kHeaderBytes);
+        _lastUs      = 0;
+        _clean       = true;
+        return true;
+    }
+
+    bool CaptureReader::Next(Record &out) {
+        while (!_rest.empty()) {
+            if (!Decode(_rest, out, _lastUs)) {
+                _clean = false;
+                _rest  = {};
+                return false;
+            }
+            _lastUs = out.atUs;
+            if (out.kind >= RecordKind::Tick && out.kind <= RecordKind::PackedEvent) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool CaptureReader::Decode(std::string_view &in, Record &out, uint64_t lastUs) {
+        std::string_view rest = in;
+        uint64_t dtUs         = 0;
+        uint64_t bodyLen      = 0;
+        if (rest.empty()) {
+            return false;
+        }
+        const auto kind = static_cast<RecordKind>(static_cast<uint8_t>(rest.front()));
+        rest.remove_prefix(1);
+        if (!GetVarint(rest, dtUs) || !GetVarint(rest, bodyLen) || bodyLen > rest.size()) {
+            return false;
+        }
+        out      = Record {};
+        out.kind = kind;
+        out.atUs = lastUs + dtUs;
+        if (!DecodeBody(rest.substr(0, static_cast<size_t>(bodyLen)), out)) {
+            return false;
+        }
+        rest.remove_prefix(static_cast<size_t>(bodyLen));
+        in = rest;
+        return true;
+    }
+} // namespace HogwartsMP::Core::Replay
@@ -0,0 +1,131 @@
+#pragma once
+
+#include "shared/modules/human_sync.hpp"
+
+#include <array>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace HogwartsMP::Core::Replay {
+    // A server session's inputs, as recorded by Recorder and fed back by Replayer. The file is
+    //
+    //   header:  "HMPCAP1\n" | u64 startUnixMs
+    //   records: u8 kind | varint dtUs | varint bodyLen | body
+    //
+    // (integers little-endian, varints LEB128). dtUs is the time since the previous record, so a busy
+    // tick costs a byte or two per record for its timestamp. bodyLen lets a reader skip kinds it doesn't
+    // know. Reading stops at the first short record, so a capture cut off by a crash still replays up
+    // to its last complete record.
+    enum class RecordKind : uint8_t {
+        Tick        = 1, // end of a server tick; empty body
+        Connect     = 2, // peer | networkId | nickname | hardwareId
+        Disconnect  = 3, // peer
+        ClientEvent = 4, // peer | name | payload
+        Appearance  = 5, // peer | SetAppearance RPC body, as received
+        Chat        = 6, // peer | text
+        ChatCommand = 7, // peer | text | command | argc | args...
+        State       = 8, // peer | StateSample
+        PackedEvent = 9, // peer | name | packed payload (ScriptEvent RPC)
+    };
+
+    // The fields an owning client replicates for its avatar, as the server had applied them at the end
+    // of a tick. Rotation is w, x, y, z.
+    struct StateSample {
+        std::array<float, 3> position {};
+        std::array<float, 4> rotation {1.0f, 0.0f, 0.0f, 0.0f};
+        std::array<float, 3> velocity {};
+        uint8_t stateFlags = 0;
+        Shared::Modules::HumanSync::UpdateData data {};
+
+        bool operator==(const StateSample &other) const {
+            return position == other.position && rotation == other.rotation && velocity == other.velocity && stateFlags == other.stateFlags &&
+                   data.mountId == other.data.mountId && data.spellId == other.data.spellId && data.aimPitch == other.data.aimPitch;
+        }
+        bool operator!=(const StateSample &other) const {
+            return !(*this == other);
+        }
+    };
+
+    // One decoded record. Which fields are meaningful depends on kind (see RecordKind).
+    struct Record {
+        RecordKind kind    = RecordKind::Tick;
+        uint64_t atUs      = 0; // since the capture started
+        uint64_t peer      = 0; // sender's peer GUID
+        uint64_t networkId = 0; // Connect: the avatar's id in the captured session
+        std::string name;       // Connect: nickname; ClientEvent: event name; ChatCommand: command
+        std::string text;       // Connect: hardware id; ClientEvent: payload; Chat / ChatCommand: the line;
+                                // Appearance: the RPC body
+        std::vector<std::string> args; // ChatCommand
+        StateSample state;             // State
+    };
+
+    class CaptureWriter final {
+      public:
+        // Encoded records are handed to the stream in chunks of about this size.
+        static constexpr size_t kChunkBytes = 64 * 1024;
+
+        CaptureWriter() = default;
+        ~CaptureWriter() {
+            Close();
+        }
+        CaptureWriter(const CaptureWriter &)            = delete;
+        CaptureWriter &operator=(const CaptureWriter &) = delete;
+
+        // Create (truncate) path and write the header. False on an I/O error.
+        bool Open(const std::string &path, uint64_t startUnixMs);
+        // Append one record. Records must come in time order; an earlier atUs is clamped to the last one.
+        void Write(const Record &record);
+        // Push everything written so far to the OS. False once any write has failed.
+        bool Flush();
+        void Close();
+
+        bool IsOpen() const {
+            return _out.is_open();
+        }
+        // Bytes in the file, including those still buffered.
+        uint64_t Bytes() const {
+            return _written + _buffer.size();
+        }
+
+        // Append the encoding of record to out, timed relative to lastUs.
+        static void Encode(std::string &out, const Record &record, uint64_t lastUs);
+
+      private:
+        std::ofstream _out;
+        std::string _buffer;
+        uint64_t _lastUs  = 0;
+        uint64_t _written = 0;
+        bool _failed      = false;
+    };
+
+    class CaptureReader final {
+      public:
+        // Read the whole capture into memory. False if it is missing or not a capture.
+        bool Open(const std::string &path);
+        // Decode the next record into out; false at the end of the file or at a truncated or corrupt
+        // record (Clean() tells which).
+        bool Next(Record &out);
+
+        uint64_t StartUnixMs() const {
+            return _startUnixMs;
+        }
+        // True when every byte read so far decoded (the capture wasn't cut off mid-record).
+        bool Clean() const {
+            return _clean;
+        }
+
+        // Decode one record from the front of in (advanced past it), timed relative to lastUs. False if in
+        // doesn't start with a complete record. Unknown kinds decode with only kind and atUs set.
+        static bool Decode(std::string_view &in, Record &out, uint64_t lastUs);
+
+      private:
+        std::string _data;
+        std::string_view _rest;
+        uint64_t _startUnixMs = 0;
+        uint64_t _lastUs      = 0;
+        bool _clean           = true;
+    };
+} // namespace HogwartsMP::Core::Replay
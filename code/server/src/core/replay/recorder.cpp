@@ -0,0 +1,132 @@
+#include "recorder.h"
+
+namespace HogwartsMP::Core::Replay {
+    namespace {
+        constexpr uint64_t kFlushEveryUs = 1000000;
+    } // namespace
+
+    uint64_t Recorder::Now() const {
+        if (_clock) {
+            return _clock();
+        }
+        const auto sinceEpoch = std::chrono::steady_clock::now().time_since_epoch();
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(sinceEpoch).count());
+    }
+
+    bool Recorder::Start(const std::string &path) {
+        Stop();
+        const auto unixMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+        if (!_writer.Open(path, static_cast<uint64_t>(unixMs))) {
+            return false;
+        }
+        _startUs     = Now();
+        _lastFlushUs = _startUs;
+        _healthy     = true;
+        _states.clear();
+        return true;
+    }
+
+    void Recorder::Stop() {
+        if (!_writer.IsOpen()) {
+            return;
+        }
+        _healthy = _writer.Flush() && _healthy;
+        _writer.Close();
+        _states.clear();
+    }
+
+    void Recorder::Write(Record &&record) {
+        if (!_writer.IsOpen()) {
+            return;
+        }
+        const uint64_t now = Now();
+        record.atUs        = now - _startUs;
+        _writer.Write(record);
+    }
+
+    void Recorder::Connect(uint64_t peer, uint64_t networkId, const std::string &nickname, const std::string &hardwareId) {
+        Record r;
+        r.kind      = RecordKind::Connect;
+        r.peer      = peer;
+        r.networkId = networkId;
+        r.name      = nickname;
+        r.text      = hardwareId;
+        Write(std::move(r));
+    }
+
+    void Recorder::Disconnect(uint64_t peer) {
+        Record r;
+        r.kind = RecordKind::Disconnect;
+        r.peer = peer;
+        Write(std::move(r));
+        _states.erase(peer);
+    }
+
+    void Recorder::ClientEvent(uint64_t peer, const std::string &name, const std::string &payload, bool packed) {
+        Record r;
+        r.kind = packed ? RecordKind::PackedEvent : RecordKind::ClientEvent;
+        r.peer = peer;
+        r.name = name;
+        r.text = payload;
+        Write(std::move(r));
+    }
+
+    void Recorder::Appearance(uint64_t peer, std::string body) {
+        Record r;
+        r.kind = RecordKind::Appearance;
+        r.peer = peer;
+        r.text = std::move(body);
+        Write(std::move(r));
+    }
+
+    void Recorder::Chat(uint64_t peer, const std::string &text) {
+        Record r;
+        r.kind = RecordKind::Chat;
+        r.peer = peer;
+        r.text = text;
+        Write(std::move(r));
+    }
+
+    void Recorder::ChatCommand(uint64_t peer, const std::string &text, const std::string &command, const std::vector<std::string> &args) {
+        Record r;
+        r.kind = RecordKind::ChatCommand;
+        r.peer = peer;
+        r.text = text;
+        r.name = command;
+        r.args = args;
+        Write(std::move(r));
+    }
+
+    void Recorder::State(uint64_t peer, const StateSample &state) {
+        if (!_writer.IsOpen()) {
+            return;
+        }
+        const auto [it, inserted] = _states.try_emplace(peer, state);
+        if (!inserted) {
+            if (it->second == state) {
+                return;
+            }
+            it->second = state;
+        }
+        Record r;
+        r.kind  = RecordKind::State;
+        r.peer  = peer;
+        r.state = state;
+        Write(std::move(r));
+    }
+
+    uint64_t Recorder::Tick() {
+        if (!_writer.IsOpen()) {
+            return 0;
+        }
+        Record r;
+        r.kind = RecordKind::Tick;
+        Write(std::move(r));
+        const uint64_t now = Now();
+        if (now - _lastFlushUs >= kFlushEveryUs) {
+            _lastFlushUs = now;
+            _healthy     = _writer.Flush() && _healthy;
+        }
+        return _startUs + r.atUs;
+    }
+} // namespace HogwartsMP::Core::Replay
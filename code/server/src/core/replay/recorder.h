@@ -0,0 +1,66 @@
+#pragma once
+
+#include "capture_file.h"
+
+#include <chrono>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace HogwartsMP::Core::Replay {
+    // Timestamps the server's inputs into a capture file (see capture_file.h): connects, disconnects,
+    // client events, appearances, chat, and each player's replicated avatar state once per tick when it
+    // changed. Costs nothing while inactive; while active, a record is an append to a memory buffer that
+    // reaches the file in 64 KiB chunks, plus a flush about once a second so a crash loses at most that.
+    // Server thread only.
+    class Recorder final {
+      public:
+        // Microseconds on a monotonic clock; tests substitute their own.
+        using Clock = std::function<uint64_t()>;
+
+        // Start capturing to path (truncated). False if it can't be created.
+        bool Start(const std::string &path);
+        void Stop();
+        bool IsActive() const {
+            return _writer.IsOpen();
+        }
+
+        void Connect(uint64_t peer, uint64_t networkId, const std::string &nickname, const std::string &hardwareId);
+        void Disconnect(uint64_t peer);
+        void ClientEvent(uint64_t peer, const std::string &name, const std::string &payload, bool packed = false);
+        // body: the SetAppearance RPC as it arrived, so a replay sanitizes it the same way.
+        void Appearance(uint64_t peer, std::string body);
+        void Chat(uint64_t peer, const std::string &text);
+        void ChatCommand(uint64_t peer, const std::string &text, const std::string &command, const std::vector<std::string> &args);
+        // The avatar's state at the end of this tick; recorded only when it differs from the last one.
+        void State(uint64_t peer, const StateSample &state);
+        // Close the current tick. Returns the time it was stamped with, in µs on the recorder's clock (0 when
+        // inactive), so the server can step its simulation by exactly the time a replay will.
+        uint64_t Tick();
+
+        uint64_t Bytes() const {
+            return _writer.Bytes();
+        }
+        // False once a write to the capture file has failed.
+        bool Healthy() const {
+            return _healthy;
+        }
+
+        void SetClock(Clock clock) {
+            _clock = std::move(clock);
+        }
+
+      private:
+        uint64_t Now() const;
+        void Write(Record &&record);
+
+        CaptureWriter _writer;
+        Clock _clock;
+        uint64_t _startUs     = 0;
+        uint64_t _lastFlushUs = 0;
+        bool _healthy         = true;
+        // Last recorded state per peer, so an idle avatar costs nothing.
+        std::unordered_map<uint64_t, StateSample> _states;
+    };
+} // namespace HogwartsMP::Core::Replay
@@ -0,0 +1,156 @@
+#include "replayer.h"
+
+#include "core/builtins/storage.h"
+#include "core/server.h"
+
+#include "shared/game/human.h"
+#include "shared/rpc/set_appearance.h"
+
+#include <networking/replication/replication_manager.h>
+
+#include <mafianet/BitStream.h>
+
+#include <logging/logger.h>
+
+#include <algorithm>
+#include <chrono>
+
+namespace HogwartsMP::Core::Replay {
+    namespace {
+        MafiaNet::PeerGuid ToGuid(uint64_t peer) {
+            return static_cast<MafiaNet::PeerGuid>(peer);
+        }
+
+        double Percentile(std::vector<double> sorted, double p) {
+            if (sorted.empty()) {
+                return 0.0;
+            }
+            const auto rank = static_cast<size_t>(p / 100.0 * static_cast<double>(sorted.size() - 1) + 0.5);
+            return sorted[std::min(rank, sorted.size() - 1)];
+        }
+    } // namespace
+
+    bool Replayer::Run(const std::string &path, uint64_t untilTick, size_t slowest, ReplayReport &report) {
+        CaptureReader reader;
+        if (!reader.Open(path)) {
+            Framework::Logging::GetLogger("Replay")->error("Cannot read capture {}", path);
+            return false;
+        }
+        _startUnixMs = reader.StartUnixMs();
+        _nowUs       = 0;
+        Scripting::Storage::SetClock([this] {
+            return _startUnixMs + _nowUs.load(std::memory_order_relaxed) / 1000;
+        });
+        // Any fixed origin will do: only the time between ticks moves NPCs and the crowd.
+        _startSteady = std::chrono::steady_clock::now();
+        _server.SetTickClock([this] {
+            return _startSteady + std::chrono::microseconds(_nowUs.load(std::memory_order_relaxed));
+        });
+
+        report = {};
+        std::vector<double> tickMs;
+        const auto runStart = std::chrono::steady_clock::now();
+        Record record;
+        while (reader.Next(record)) {
+            ++report.records;
+            _nowUs.store(record.atUs, std::memory_order_relaxed);
+            if (record.kind != RecordKind::Tick) {
+                Apply(record);
+                continue;
+            }
+
+            const auto tickStart = std::chrono::steady_clock::now();
+            _server.Update();
+            const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - tickStart).count();
+            tickMs.push_back(ms);
+            report.slowest.push_back({report.ticks, record.atUs, ms});
+            ++report.ticks;
+            // Keep only the slowest few: a partial sort once the list doubles.
+            if (report.slowest.size() >= 2 * std::max<size_t>(slowest, 1)) {
+                std::nth_element(report.slowest.begin(), report.slowest.begin() + static_cast<std::ptrdiff_t>(slowest), report.slowest.end(), [](const auto &a, const auto &b) {
+                    return a.ms > b.ms;
+                });
+                report.slowest.resize(slowest);
+            }
+            if (untilTick != 0 && report.ticks > untilTick) {
+                break;
+            }
+        }
+        report.wallMs    = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - runStart).count();
+        report.sessionMs = static_cast<double>(record.atUs) / 1000.0;
+        report.clean     = reader.Clean();
+
+        std::sort(report.slowest.begin(), report.slowest.end(), [](const auto &a, const auto &b) {
+            return a.ms > b.ms;
+        });
+        if (report.slowest.size() > slowest) {
+            report.slowest.resize(slowest);
+        }
+        std::sort(tickMs.begin(), tickMs.end());
+        report.tickP50Ms = Percentile(tickMs, 50.0);
+        report.tickP99Ms = Percentile(tickMs, 99.0);
+        report.tickMaxMs = tickMs.empty() ? 0.0 : tickMs.back();
+        return true;
+    }
+
+    // The stand-in for the network: each record goes to the entry point its packet reached live. Peers
+    // keep their captured GUIDs, which only ever name a viewer here.
+    void Replayer::Apply(const Record &record) {
+        auto *repl = _server.GetNetworkingEngine()->GetNetworkServer()->GetReplicationManager();
+        if (!repl) {
+            return;
+        }
+        const auto guid = ToGuid(record.peer);
+        auto *human     = record.kind == RecordKind::Connect ? nullptr : repl->GetViewerAs<Shared::HumanEntity>(guid);
+
+        switch (record.kind) {
+        case RecordKind::Connect: {
+            Framework::Integrations::Server::PlayerConnectionData data;
+            data.guid       = guid;
+            data.nickname   = record.name;
+            data.hardwareID = record.text;
+            _server.OnPlayerConnect(data);
+            break;
+        }
+        case RecordKind::Disconnect:
+            _server.OnPlayerDisconnect(guid);
+            if (human) {
+                repl->DestroyEntity(human);
+            }
+            break;
+        case RecordKind::ClientEvent:
+        case RecordKind::PackedEvent:
+            _server.OnClientEvent(guid, record.name, record.text, record.kind == RecordKind::PackedEvent);
+            break;
+        case RecordKind::Appearance: {
+            Shared::RPC::SetAppearance msg;
+            MafiaNet::BitStream bs(reinterpret_cast<unsigned char *>(const_cast<char *>(record.text.data())), static_cast<unsigned int>(record.text.size()), false);
+            msg.Serialize(&bs, false);
+            _server.OnAppearance(guid, msg.ccd);
+            break;
+        }
+        case RecordKind::Chat:
+            if (human) {
+                _server.OnChatMessage(human->GetNetworkID(), record.text);
+            }
+            break;
+        case RecordKind::ChatCommand:
+            if (human) {
+                _server.OnChatCommand(human->GetNetworkID(), record.text, record.name, record.args);
+            }
+            break;
+        case RecordKind::State:
+            if (human) {
+                const auto &s     = record.state;
+                human->position   = {s.position[0], s.position[1], s.position[2]};
+                human->rotation   = {s.rotation[0], s.rotation[1], s.rotation[2], s.rotation[3]};
+                human->velocity   = {s.velocity[0], s.velocity[1], s.velocity[2]};
+                human->stateFlags = s.stateFlags;
+                human->data       = s.data;
+            }
+            break;
+        default:
+            break;
+        }
+    }
+} // namespace HogwartsMP::Core::Replay
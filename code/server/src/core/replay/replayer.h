@@ -0,0 +1,56 @@
+#pragma once
+
+#include "capture_file.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace HogwartsMP {
+    class Server;
+} // namespace HogwartsMP
+
+namespace HogwartsMP::Core::Replay {
+    struct ReplayReport {
+        struct SlowTick {
+            uint64_t tick = 0;
+            uint64_t atUs = 0; // when it happened in the captured session
+            double ms     = 0.0;
+        };
+
+        uint64_t ticks   = 0;
+        uint64_t records = 0;
+        bool clean       = true; // the capture wasn't cut off mid-record
+        double wallMs    = 0.0;  // whole replay
+        double sessionMs = 0.0;  // captured session length replayed
+        double tickP50Ms = 0.0;
+        double tickP99Ms = 0.0;
+        double tickMaxMs = 0.0;
+        std::vector<SlowTick> slowest; // slowest first
+    };
+
+    // Feeds a capture back into an initialized server, as fast as it will go: each record is handed to
+    // the same Server entry point the network would have called, each captured tick becomes one
+    // Server::Update, and script storage, native NPC movement and the crowd see the captured session's
+    // time rather than the wall clock.
+    // Captured peers get stand-in peer ids and avatars; no client is ever connected, so whatever the
+    // server sends them goes nowhere. Tick times are measured around each Update for the report.
+    class Replayer final {
+      public:
+        explicit Replayer(Server &server): _server(server) {}
+
+        // Replay path up to and including tick untilTick (0 = to the end), keeping the `slowest` slowest
+        // ticks for the report. False if the capture can't be opened.
+        bool Run(const std::string &path, uint64_t untilTick, size_t slowest, ReplayReport &report);
+
+      private:
+        void Apply(const Record &record);
+
+        Server &_server;
+        uint64_t _startUnixMs = 0;
+        std::chrono::steady_clock::time_point _startSteady {};
+        std::atomic<uint64_t> _nowUs {0};
+    };
+} // namespace HogwartsMP::Core::Replay
@@ -4,23 +4,40 @@
 
 #include "builtins/builtins.h"
 #include "builtins/events.h"
+#include "builtins/human.h"
+#include "builtins/profiler.h"
+#include "events/script_events.h"
+#include "metrics/tick_profiler.h"
 
 #include "shared/game/human.h"
+#include "shared/rpc/load_probe.h"
+#include "shared/rpc/script_event.h"
 #include "shared/rpc/set_appearance.h"
 #include "shared/rpc/set_weather.h"
 
 #include <core_modules.h>
+#include <http/webserver.h>
 #include <integrations/shared/rpc/emit_lua_event.h>
 #include <networking/replication/replication_manager.h>
 #include <networking/rpc/chat_message.h>
 
+#include <mafianet/RakNetStatistics.h>
 #include <mafianet/types.h>
 
 #include <fmt/format.h>
 
+#include <nlohmann/json.hpp>
+
 #include <scripting/node_engine.h>
 #include <v8pp/convert.hpp>
 
+#include <glm/gtc/quaternion.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+
 namespace HogwartsMP {
     void Server::PostInit() {
         _serverRef = this;
@@ -28,57 +45,292 @@ namespace HogwartsMP {
         // Register the networked entity types before any connection is accepted.
         Core::Modules::Human::Register();
 
-        // Client -> server scripted events: a client's Game.emitServer sends EmitLuaEvent up; resolve
-        // the sender to its avatar and dispatch into the server event bus as (player, payload).
+        // Client -> server scripted events: a client's Game.emitServer / emitServerPacked sends a
+        // ScriptEvent up; resolve its interned name and the sender's avatar and dispatch into the server
+        // event bus as (player, payload). A name id the peer never defined drops the event.
         auto *net = GetNetworkingEngine()->GetNetworkServer();
+        net->RegisterRPC<Shared::RPC::ScriptEvent>([this](const Shared::RPC::ScriptEvent &msg, MafiaNet::Packet *packet) {
+            const auto guid  = MafiaNet::ToPeerGuid(packet->guid);
+            const auto *name = Core::Events::ScriptEvents::Get().Resolve(static_cast<uint64_t>(guid), msg);
+            if (name) {
+                OnClientEvent(guid, *name, msg.payload, msg.encoding == Shared::RPC::ScriptEvent::Packed);
+            }
+        });
+        // The framework's own EmitLuaEvent is still accepted, with the name spelled out in every message.
         net->RegisterRPC<Framework::Integrations::Shared::RPC::EmitLuaEvent>(
             [this](const Framework::Integrations::Shared::RPC::EmitLuaEvent &payload, MafiaNet::Packet *packet) {
-                const std::string name = payload.GetEventName();
-                if (name.empty()) {
-                    return;
-                }
-                auto *repl   = GetNetworkingEngine()->GetNetworkServer()->GetReplicationManager();
-                auto *sender = repl ? repl->GetViewer(MafiaNet::ToPeerGuid(packet->guid)) : nullptr;
-                if (!sender) {
-                    return;
-                }
-                Scripting::World::EventClientEvent(sender->GetNetworkID(), name, payload.GetPayload());
+                OnClientEvent(MafiaNet::ToPeerGuid(packet->guid), payload.GetEventName(), payload.GetPayload());
             });
 
         // Owner appearance: sanitize, store (rides the construction snapshot), re-broadcast.
         net->RegisterRPC<Shared::RPC::SetAppearance>([this](const Shared::RPC::SetAppearance &msg, MafiaNet::Packet *packet) {
-            auto *server = GetNetworkingEngine()->GetNetworkServer();
-            auto *repl   = server ? server->GetReplicationManager() : nullptr;
-            if (!repl) {
-                return;
+            OnAppearance(MafiaNet::ToPeerGuid(packet->guid), msg.ccd);
+        });
+
+        // Load-test round trip (--load-test only): echo the probe to its sender with the current tick timings.
+        if (_loadTest) {
+            net->RegisterRPC<Shared::RPC::LoadProbe>([this](const Shared::RPC::LoadProbe &msg, MafiaNet::Packet *packet) {
+                Shared::RPC::LoadProbe reply = msg;
+                reply.tickMs                 = _tickStats.averageMs;
+                reply.tickMaxMs              = _tickStats.maxLastSecondMs;
+                GetNetworkingEngine()->GetNetworkServer()->SendRPC(reply, packet->guid);
+            });
+        }
+
+        Framework::Logging::GetLogger(FRAMEWORK_INNER_NETWORKING)->info("Networking messages registered!");
+
+        // Tick phase histograms and server gauges on the web port, for scraping and alerting.
+        if (auto *web = GetWebServer()) {
+            web->RegisterRequest("/metrics", [](const httplib::Request &, httplib::Response &res) {
+                res.set_content(Core::Metrics::TickProfiler::Get().RenderPrometheus(), "text/plain; version=0.0.4");
+            });
+            web->RegisterRequest("/metrics.json", [](const httplib::Request &, httplib::Response &res) {
+                res.set_content(Core::Metrics::TickProfiler::Get().RenderJson(), "application/json");
+            });
+            // /profile/cpu?seconds=N: CPU-profile the scripts for N seconds into a .cpuprofile file.
+            web->RegisterRequest("/profile/cpu", [](const httplib::Request &req, httplib::Response &res) {
+                const auto seconds = req.has_param("seconds") ? std::strtoul(req.get_param_value("seconds").c_str(), nullptr, 10) : 10;
+                const auto path    = Scripting::Profiler::RequestCpuProfile(static_cast<uint32_t>(seconds));
+                if (!path) {
+                    res.status = 409;
+                    res.set_content(R"({"error":"a CPU profile is already being captured"})", "application/json");
+                    return;
+                }
+                res.set_content(nlohmann::json {{"path", *path}}.dump(), "application/json");
+            });
+        }
+    }
+
+    void Server::OnClientEvent(MafiaNet::PeerGuid guid, const std::string &name, const std::string &payload, bool packed) {
+        Core::Metrics::ScopedPhase phase(Core::Metrics::Phase::Rpc);
+        if (name.empty()) {
+            return;
+        }
+        auto *repl   = GetNetworkingEngine()->GetNetworkServer()->GetReplicationManager();
+        auto *sender = repl ? repl->GetViewer(guid) : nullptr;
+        if (!sender) {
+            return;
+        }
+        _recorder.ClientEvent(static_cast<uint64_t>(guid), name, payload, packed);
+        Scripting::World::EventClientEvent(sender->GetNetworkID(), name, payload, packed);
+    }
+
+    void Server::OnAppearance(MafiaNet::PeerGuid guid, const Shared::Modules::CcdProfile &ccd) {
+        Core::Metrics::ScopedPhase phase(Core::Metrics::Phase::Rpc);
+        auto *server = GetNetworkingEngine()->GetNetworkServer();
+        auto *repl   = server ? server->GetReplicationManager() : nullptr;
+        if (!repl) {
+            return;
+        }
+        auto *human = repl->GetViewerAs<Shared::HumanEntity>(guid);
+        if (!human) {
+            return;
+        }
+        if (_recorder.IsActive()) {
+            // As received, so the replay goes through the same sanitizing.
+            Shared::RPC::SetAppearance msg {ccd};
+            MafiaNet::BitStream bs;
+            msg.Serialize(&bs, true);
+            _recorder.Appearance(static_cast<uint64_t>(guid), std::string(reinterpret_cast<const char *>(bs.GetData()), bs.GetNumberOfBytesUsed()));
+        }
+        auto sanitized = ccd;
+        Shared::Modules::SanitizeCcd(sanitized);
+        human->ccd = sanitized;
+
+        Shared::RPC::AppearanceUpdate upd;
+        upd.networkId = human->GetNetworkID();
+        upd.ccd       = std::move(sanitized);
+        server->BroadcastRPC(upd);
+        Framework::Logging::GetLogger("Scripting")->info("Appearance from {}: items={} outfits={}", human->nickname,
+                                                         static_cast<int>(human->ccd.characterItems.size()),
+                                                         static_cast<int>(human->ccd.outfits.size()));
+    }
+
+    bool Server::TickStats::Record(std::chrono::steady_clock::time_point now) {
+        if (last != std::chrono::steady_clock::time_point {}) {
+            Core::Metrics::TickProfiler::Get().Record(Core::Metrics::Phase::Tick, now - last);
+            const float ms = std::chrono::duration<float, std::milli>(now - last).count();
+            averageMs      = averageMs == 0.0f ? ms : averageMs + (ms - averageMs) * 0.05f;
+            windowMaxMs    = std::max(windowMaxMs, ms);
+        }
+        last = now;
+        if (now - windowStart < std::chrono::seconds(1)) {
+            return false;
+        }
+        maxLastSecondMs = windowMaxMs;
+        windowMaxMs     = 0.0f;
+        windowStart     = now;
+        return true;
+    }
+
+    void Server::PostUpdate() {
+        Core::Metrics::ScopedPhase phase(Core::Metrics::Phase::PostUpdate);
+        if (_tickStats.Record(std::chrono::steady_clock::now())) {
+            UpdateMetricGauges();
+        }
+
+        // The time NPC movement and the crowd step to: when capturing, the time this tick was recorded at
+        // (on the same steady clock), so a replay of the capture steps them identically; in a replay, the
+        // captured one (SetTickClock).
+        auto now = std::chrono::steady_clock::now();
+        if (_recorder.IsActive()) {
+            CapturePlayerStates();
+            now = std::chrono::steady_clock::time_point(std::chrono::microseconds(_recorder.Tick()));
+        }
+        if (_tickClock) {
+            now = _tickClock();
+        }
+
+        // Native NPC movement; arrivals reach scripts with the rest of this tick's events.
+        _arrivedNpcs.clear();
+        Core::Modules::NpcMovement::Get().Tick(now, _arrivedNpcs);
+        for (const auto networkId : _arrivedNpcs) {
+            Scripting::ServerEventQueue().PushNpcArrived(networkId);
+        }
+
+        UpdateCrowd(now);
+
+        // Native events queued since the last tick, in one isolate entry.
+        Scripting::DrainServerEvents();
+
+        // Start or stop a requested CPU profile.
+        Scripting::Profiler::Tick();
+
+        // Group-commit script storage writes (Interval durability) on the flush thread.
+        Core::Metrics::ScopedPhase storage(Core::Metrics::Phase::Storage);
+        Scripting::Storage::Tick();
+    }
+
+    void Server::UpdateCrowd(std::chrono::steady_clock::time_point now) {
+        // Promote / demote passes look at every agent against every player; a few times a second is plenty.
+        constexpr uint32_t kStreamEveryTicks = 5;
+
+        auto &crowd = Core::Modules::Crowd::Get();
+        crowd.Tick(now);
+        auto *repl = Framework::CoreModules::GetReplication();
+        if (crowd.Size() == 0 || !repl) {
+            return;
+        }
+        auto &registry = Core::Modules::HumanRegistry::Get();
+
+        // An entity a script destroyed has already unbound its agent (~ServerHuman), which is promoted
+        // again on the next pass if still in view.
+        for (const uint32_t agent : crowd.Promoted()) {
+            auto *human = registry.Find(crowd.NetworkId(agent));
+            if (!human) {
+                continue;
+            }
+            human->position = crowd.Position(agent);
+            human->velocity = crowd.Velocity(agent);
+            if (human->velocity.x != 0.0f || human->velocity.y != 0.0f) {
+                human->rotation = glm::quat(glm::vec3 {0.0f, 0.0f, std::atan2(human->velocity.y, human->velocity.x)});
             }
-            auto *human = repl->GetViewerAs<Shared::HumanEntity>(MafiaNet::ToPeerGuid(packet->guid));
+        }
+
+        if (_crowdStreamCountdown-- > 0) {
+            return;
+        }
+        _crowdStreamCountdown = kStreamEveryTicks - 1;
+
+        _crowdViewers.clear();
+        for (const auto *player : registry.Players()) {
+            _crowdViewers.push_back({player->position, player->streaming.range});
+        }
+        _crowdPromote.clear();
+        _crowdDemote.clear();
+        crowd.UpdateStreaming(_crowdViewers, _crowdPromote, _crowdDemote);
+        for (const uint32_t agent : _crowdDemote) {
+            const uint64_t networkId = crowd.NetworkId(agent);
+            crowd.Unbind(agent);
+            Scripting::Human(networkId).Destroy();
+        }
+        for (const uint32_t agent : _crowdPromote) {
+            const auto position = crowd.Position(agent);
+            auto *human         = Core::Modules::Human::Spawn(repl, position.x, position.y, position.z);
             if (!human) {
-                return;
+                break;
             }
-            auto ccd = msg.ccd;
-            Shared::Modules::SanitizeCcd(ccd);
-            human->ccd = ccd;
-
-            Shared::RPC::AppearanceUpdate upd;
-            upd.networkId = human->GetNetworkID();
-            upd.ccd       = std::move(ccd);
-            server->BroadcastRPC(upd);
-            Framework::Logging::GetLogger("Scripting")->info("Appearance from {}: items={} outfits={}", human->nickname,
-                                                             static_cast<int>(human->ccd.characterItems.size()),
-                                                             static_cast<int>(human->ccd.outfits.size()));
+            human->velocity = crowd.Velocity(agent);
+            if (const auto *profile = crowd.Profile(agent)) {
+                human->ccd = *profile;
+            }
+            crowd.Bind(agent, human->GetNetworkID());
+        }
+    }
+
+    void Server::UpdateMetricGauges() {
+        auto &profiler = Core::Metrics::TickProfiler::Get();
+        profiler.SetPlayers(_playerIdentities.size());
+
+        auto *net  = GetNetworkingEngine()->GetNetworkServer();
+        profiler.SetEntities(Core::Modules::HumanRegistry::Get().Size());
+        // Statistics for UNASSIGNED_SYSTEM_ADDRESS are the totals over every connection.
+        MafiaNet::RakNetStatistics stats;
+        auto *peer = net ? net->GetPeer() : nullptr;
+        if (peer && peer->GetStatistics(MafiaNet::UNASSIGNED_SYSTEM_ADDRESS, &stats)) {
+            profiler.SetNetworkBytes(stats.runningTotal[MafiaNet::ACTUAL_BYTES_RECEIVED], stats.runningTotal[MafiaNet::ACTUAL_BYTES_SENT]);
+        }
+    }
+
+    void Server::PreShutdown() {
+        StopCapture();
+        // Drain the storage flush thread so nothing written by scripts is lost on a clean stop.
+        Scripting::Storage::Shutdown();
+        Scripting::Profiler::Shutdown();
+        Scripting::RunInServerContext([](v8::Isolate *isolate, v8::Local<v8::Context>) {
+            Scripting::Human::ForgetWrappers(isolate);
         });
+    }
 
-        Framework::Logging::GetLogger(FRAMEWORK_INNER_NETWORKING)->info("Networking messages registered!");
+    bool Server::StartCapture(const std::string &path) {
+        if (!_recorder.Start(path)) {
+            Framework::Logging::GetLogger("Replay")->error("Cannot create capture file {}", path);
+            return false;
+        }
+        Framework::Logging::GetLogger("Replay")->info("Capturing the session to {}", path);
+        return true;
     }
 
-    void Server::PostUpdate() {}
+    void Server::StopCapture() {
+        if (!_recorder.IsActive()) {
+            return;
+        }
+        const uint64_t bytes = _recorder.Bytes();
+        _recorder.Stop();
+        if (!_recorder.Healthy()) {
+            Framework::Logging::GetLogger("Replay")->error("Capture file write failed; the capture is incomplete");
+            return;
+        }
+        Framework::Logging::GetLogger("Replay")->info("Capture closed ({} bytes)", bytes);
+    }
+
+    uint64_t Server::PeerOf(uint64_t networkId) {
+        auto *human = Core::Modules::Human::Find(networkId);
+        return human ? static_cast<uint64_t>(human->ownerGUID) : 0;
+    }
 
-    void Server::PreShutdown() {}
+    // The owner-written fields of every player's avatar, as replication left them this tick. Only
+    // changes reach the file (Recorder::State).
+    void Server::CapturePlayerStates() {
+        for (const auto *human : Core::Modules::HumanRegistry::Get().Players()) {
+            Core::Replay::StateSample state;
+            state.position   = {human->position.x, human->position.y, human->position.z};
+            state.rotation   = {human->rotation.w, human->rotation.x, human->rotation.y, human->rotation.z};
+            state.velocity   = {human->velocity.x, human->velocity.y, human->velocity.z};
+            state.stateFlags = human->stateFlags;
+            state.data       = human->data;
+            _recorder.State(static_cast<uint64_t>(human->ownerGUID), state);
+        }
+    }
+
+    void Server::SetStorageDurability(Core::Storage::Durability durability) {
+        Scripting::Storage::SetDurability(durability);
+    }
 
     // A player joined: build its avatar (owned + viewer), announce it, and notify scripting. The
     // framework resolves nickname/hwid/slot and hands them in via PlayerConnectionData.
     void Server::OnPlayerConnect(const Framework::Integrations::Server::PlayerConnectionData &data) {
+        Core::Metrics::ScopedPhase phase(Core::Metrics::Phase::Rpc);
         auto *repl  = GetNetworkingEngine()->GetNetworkServer()->GetReplicationManager();
         auto *human = Core::Modules::Human::CreatePlayer(repl, data);
         if (!human) {
@@ -89,6 +341,11 @@ namespace HogwartsMP {
         // data via Human.getData/setData. Eventually swap for a verified account id later
         // without touching the script API.
         SetPlayerIdentity(human->GetNetworkID(), data.hardwareID);
+        Core::Events::ScriptEvents::Get().AddPeer(static_cast<uint64_t>(data.guid));
+        _recorder.Connect(static_cast<uint64_t>(data.guid), human->GetNetworkID(), data.nickname, data.hardwareID);
+        // Page the player's storage shard in off-thread while the join is announced; getData/setData
+        // only wait on it if a script gets there first.
+        Scripting::Storage::AcquirePlayer(data.hardwareID);
 
         BroadcastChatMessage(fmt::format("Player {} has joined the session!", data.nickname));
 
@@ -107,13 +364,18 @@ namespace HogwartsMP {
     // A player left: the framework fires this while the avatar is still resolvable, just before
     // replication tears it down.
     void Server::OnPlayerDisconnect(MafiaNet::PeerGuid guid) {
+        Core::Metrics::ScopedPhase phase(Core::Metrics::Phase::Rpc);
         auto *repl  = GetNetworkingEngine()->GetNetworkServer()->GetReplicationManager();
         auto *human = repl ? dynamic_cast<Shared::HumanEntity *>(repl->GetViewer(guid)) : nullptr;
         const std::string nickname = human ? human->nickname : "Player";
+        _recorder.Disconnect(static_cast<uint64_t>(guid));
+        Core::Events::ScriptEvents::Get().RemovePeer(static_cast<uint64_t>(guid));
 
         BroadcastChatMessage(fmt::format("Player {} has left the session!", nickname));
         if (human) {
             Scripting::Human::EventPlayerDisconnected(human->GetNetworkID());
+            // After the event, so disconnect handlers can still write the player's data.
+            Scripting::Storage::ReleasePlayer(GetPlayerIdentity(human->GetNetworkID()));
             ClearPlayerIdentity(human->GetNetworkID());
         }
     }
@@ -121,17 +383,24 @@ namespace HogwartsMP {
     // Plain chat: dispatch to the JS gamemode if it's listening, otherwise echo "nick: text" so
     // chat still works without a gamemode. The sender is already resolved to its NetworkID.
     void Server::OnChatMessage(uint64_t senderNetworkId, const std::string &text) {
+        Core::Metrics::ScopedPhase phase(Core::Metrics::Phase::Rpc);
+        if (_recorder.IsActive()) {
+            _recorder.Chat(PeerOf(senderNetworkId), text);
+        }
         if (Scripting::GetServerEventListenerCount("chatMessage") > 0) {
             Scripting::World::EventChatMessage(senderNetworkId, text);
             return;
         }
-        auto *repl  = GetNetworkingEngine()->GetNetworkServer()->GetReplicationManager();
-        auto *human = repl ? dynamic_cast<Shared::HumanEntity *>(repl->GetEntityByNetworkID(senderNetworkId)) : nullptr;
+        auto *human = Core::Modules::Human::Find(senderNetworkId);
         BroadcastChatMessage(fmt::format("{}: {}", human ? human->nickname : "Player", text));
     }
 
     // Slash commands are pre-parsed by the framework; forward them to the JS gamemode.
     void Server::OnChatCommand(uint64_t senderNetworkId, const std::string &text, const std::string &command, const std::vector<std::string> &args) {
+        Core::Metrics::ScopedPhase phase(Core::Metrics::Phase::Rpc);
+        if (_recorder.IsActive()) {
+            _recorder.ChatCommand(PeerOf(senderNetworkId), text, command, args);
+        }
         Scripting::World::EventChatCommand(senderNetworkId, text, command, args);
     }
 
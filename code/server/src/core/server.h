@@ -2,14 +2,25 @@
 
 #include <integrations/server/instance.h>
 
+#include "core/modules/crowd.h"
+#include "core/replay/recorder.h"
+#include "core/storage/durability.h"
+
 #include "shared/game/weather.h"
+#include "shared/modules/appearance.hpp"
 
+#include <chrono>
 #include <cstdint>
+#include <functional>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 namespace HogwartsMP {
     class Server: public Framework::Integrations::Server::Instance {
+      public:
+        using TickClock = std::function<std::chrono::steady_clock::time_point()>;
+
       private:
         static inline Framework::Scripting::Engine *_scriptingEngine;
 
@@ -21,6 +32,44 @@ namespace HogwartsMP {
         // to other clients. Backs the per-player Storage exposed via Human.getData/setData.
         std::unordered_map<uint64_t, std::string> _playerIdentities;
 
+        // Answer LoadProbe RPCs (SetLoadTest); off unless the server was started for a load test.
+        bool _loadTest = false;
+
+        // Time between consecutive PostUpdate calls — the full tick, including the framework's work —
+        // reported to load-test clients through the LoadProbe RPC.
+        struct TickStats {
+            std::chrono::steady_clock::time_point last {};
+            std::chrono::steady_clock::time_point windowStart {};
+            float averageMs       = 0.0f;
+            float windowMaxMs     = 0.0f;
+            float maxLastSecondMs = 0.0f;
+
+            // True when this call closed a one-second window.
+            bool Record(std::chrono::steady_clock::time_point now);
+        } _tickStats;
+
+        // Session capture for offline replay (--capture); inactive unless started.
+        Core::Replay::Recorder _recorder;
+        // Overrides the time the simulation steps to each tick (see SetTickClock).
+        TickClock _tickClock;
+
+        // NPCs that finished their native movement path this tick (scratch, reused).
+        std::vector<uint64_t> _arrivedNpcs;
+
+        // Crowd streaming scratch (reused) and the ticks until the next promote / demote pass.
+        std::vector<Core::Modules::Crowd::Viewer> _crowdViewers;
+        std::vector<uint32_t> _crowdPromote;
+        std::vector<uint32_t> _crowdDemote;
+        uint32_t _crowdStreamCountdown = 0;
+
+        uint64_t PeerOf(uint64_t networkId);
+        void CapturePlayerStates();
+        // Step the ambient crowd to now, copy it onto its promoted entities and, every few ticks, promote
+        // the agents the players can now see and demote the ones they can't.
+        void UpdateCrowd(std::chrono::steady_clock::time_point now);
+        // Player / entity counts and network byte totals for the /metrics endpoint.
+        void UpdateMetricGauges();
+
       public:
         void PostInit() override;
 
@@ -34,6 +83,22 @@ namespace HogwartsMP {
         void OnChatMessage(uint64_t senderNetworkId, const std::string &text) override;
         void OnChatCommand(uint64_t senderNetworkId, const std::string &text, const std::string &command, const std::vector<std::string> &args) override;
 
+        // Client RPCs, resolved to the sending peer. The replay driver calls these directly.
+        void OnClientEvent(MafiaNet::PeerGuid guid, const std::string &name, const std::string &payload, bool packed = false);
+        void OnAppearance(MafiaNet::PeerGuid guid, const Shared::Modules::CcdProfile &ccd);
+
+        // Record every inbound RPC, connect/disconnect and avatar state change to path until
+        // StopCapture (or shutdown); see Core::Replay::Recorder. False if the file can't be created.
+        bool StartCapture(const std::string &path);
+        void StopCapture();
+
+        // The time native NPC movement and the crowd step to each tick. Live it is the steady clock (while capturing, the
+        // time the tick was recorded at); the replay driver sets it from the captured tick's time, so a
+        // replay run as fast as it goes moves them exactly as the session did.
+        void SetTickClock(TickClock clock) {
+            _tickClock = std::move(clock);
+        }
+
         // Broadcast a chat line to every connected client (framework ChatMessage RPC).
         void BroadcastChatMessage(const std::string &msg);
 
@@ -41,6 +106,15 @@ namespace HogwartsMP {
             return _weather;
         }
 
+        // How quickly script Storage / player-data writes reach disk. Call before Init().
+        void SetStorageDurability(Core::Storage::Durability durability);
+
+        // Register the LoadProbe RPC, which echoes a probe back with the server's tick timings to whoever
+        // sends one. Load-test bots only: it hands any client an unthrottled reply. Call before Init().
+        void SetLoadTest(bool enabled) {
+            _loadTest = enabled;
+        }
+
         // Stable per-player identity, keyed by NetworkID. Set on connect, cleared
         // on disconnect. Returns "" for an unknown id (e.g. a server NPC, or not yet connected).
         void SetPlayerIdentity(uint64_t networkId, std::string identity) {
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+namespace HogwartsMP::Core::Storage {
+    // When a script's Storage / player-data write is committed to disk. Scripts never wait on disk in
+    // any mode — the flush thread does the writing — this only sets how long a change may sit in memory
+    // (and so how much a crash can lose) versus how many writes get grouped into one commit.
+    struct Durability {
+        enum class Mode : uint8_t {
+            Immediate,  // queue a commit on every write
+            Interval,   // group-commit everything changed in the last `interval`, from the server tick
+            OnShutdown, // commit only when the server shuts down (a crash loses every change since boot)
+        };
+
+        Mode mode                          = Mode::Interval;
+        std::chrono::milliseconds interval = std::chrono::milliseconds(250);
+    };
+} // namespace HogwartsMP::Core::Storage
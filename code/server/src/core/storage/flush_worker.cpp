@@ -0,0 +1,73 @@
+#include "flush_worker.h"
+
+namespace HogwartsMP::Core::Storage {
+
+    FlushWorker::FlushWorker() {
+        // Started last, once every member it touches is constructed.
+        _thread = std::thread(&FlushWorker::Run, this);
+    }
+
+    FlushWorker::~FlushWorker() {
+        {
+            std::lock_guard lock(_mutex);
+            _stop = true;
+        }
+        _wake.notify_one();
+        if (_thread.joinable()) {
+            _thread.join();
+        }
+    }
+
+    void FlushWorker::Post(Task task) {
+        {
+            std::lock_guard lock(_mutex);
+            _queue.push_back(std::move(task));
+        }
+        _wake.notify_one();
+    }
+
+    bool FlushWorker::Drain() {
+        std::unique_lock lock(_mutex);
+        _idle.wait(lock, [this] {
+            return _queue.empty() && !_busy;
+        });
+        const bool ok = !_failed;
+        _failed       = false;
+        return ok;
+    }
+
+    bool FlushWorker::TakeFailure() {
+        std::lock_guard lock(_mutex);
+        const bool failed = _failed;
+        _failed           = false;
+        return failed;
+    }
+
+    void FlushWorker::Run() {
+        std::unique_lock lock(_mutex);
+        for (;;) {
+            _wake.wait(lock, [this] {
+                return _stop || !_queue.empty();
+            });
+            if (_queue.empty()) {
+                return; // stopping, and nothing left to write
+            }
+            Task task = std::move(_queue.front());
+            _queue.pop_front();
+            _busy = true;
+
+            lock.unlock();
+            const bool ok = task();
+            lock.lock();
+
+            _busy = false;
+            if (!ok) {
+                _failed = true;
+            }
+            if (_queue.empty()) {
+                _idle.notify_all();
+            }
+        }
+    }
+
+} // namespace HogwartsMP::Core::Storage
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace HogwartsMP::Core::Storage {
+    // A single background thread that runs storage write tasks one at a time, in the order they were
+    // posted. Lets KeyValueStore hand its disk I/O off the scripting thread while keeping appends and
+    // compactions strictly ordered (a compaction posted after an append always sees it on disk). Several
+    // stores may share one worker (see PlayerShards); their tasks then interleave in posting order.
+    class FlushWorker final {
+      public:
+        // A unit of disk work; returns false on an I/O failure (reported by the next Drain).
+        using Task = std::function<bool()>;
+
+        FlushWorker();
+        // Runs every task still queued, then joins the thread.
+        ~FlushWorker();
+
+        FlushWorker(const FlushWorker &)            = delete;
+        FlushWorker &operator=(const FlushWorker &) = delete;
+
+        void Post(Task task);
+
+        // Block until every task posted so far has run. Returns false if any task failed since the
+        // previous Drain / TakeFailure.
+        bool Drain();
+
+        // Non-blocking: true (once) if a task failed since the previous Drain / TakeFailure.
+        bool TakeFailure();
+
+        // True when called from inside a task (where Drain would wait on itself).
+        bool IsWorkerThread() const {
+            return std::this_thread::get_id() == _thread.get_id();
+        }
+
+      private:
+        void Run();
+
+        std::mutex _mutex;
+        std::condition_variable _wake;
+        std::condition_variable _idle;
+        std::deque<Task> _queue;
+        bool _busy   = false;
+        bool _stop   = false;
+        bool _failed = false;
+        std::thread _thread;
+    };
+} // namespace HogwartsMP::Core::Storage
@@ -0,0 +1,204 @@
+#include "journal.h"
+
+#include <array>
+#include <filesystem>
+#include <iterator>
+#include <tuple>
+#include <vector>
+
+namespace HogwartsMP::Core::Storage {
+
+    namespace {
+        constexpr size_t kHeaderBytes = 8;  // payloadLen + crc
+        constexpr size_t kPayloadMin  = 5;  // op + keyLen
+
+        constexpr std::array<uint32_t, 256> MakeCrcTable() {
+            std::array<uint32_t, 256> table {};
+            for (uint32_t i = 0; i < 256; ++i) {
+                uint32_t c = i;
+                for (int k = 0; k < 8; ++k) {
+                    c = (c & 1u) ? (0xEDB88320u ^ (c >> 1)) : (c >> 1);
+                }
+                table[i] = c;
+            }
+            return table;
+        }
+        constexpr auto kCrcTable = MakeCrcTable();
+
+        // CRC-32 (IEEE, as zlib) — catches torn writes and bit rot, not tampering.
+        uint32_t Crc32(std::string_view data) {
+            uint32_t c = 0xFFFFFFFFu;
+            for (unsigned char ch : data) {
+                c = kCrcTable[(c ^ ch) & 0xFFu] ^ (c >> 8);
+            }
+            return c ^ 0xFFFFFFFFu;
+        }
+
+        void PutU32(std::string &out, uint32_t v) {
+            out.push_back(static_cast<char>(v & 0xFFu));
+            out.push_back(static_cast<char>((v >> 8) & 0xFFu));
+            out.push_back(static_cast<char>((v >> 16) & 0xFFu));
+            out.push_back(static_cast<char>((v >> 24) & 0xFFu));
+        }
+
+        uint32_t GetU32(const char *p) {
+            const auto *u = reinterpret_cast<const unsigned char *>(p);
+            return static_cast<uint32_t>(u[0]) | (static_cast<uint32_t>(u[1]) << 8) | (static_cast<uint32_t>(u[2]) << 16) |
+                   (static_cast<uint32_t>(u[3]) << 24);
+        }
+
+        // Hand every intact record at the front of buf to fn(op, key, value) until one is short, corrupt,
+        // or rejected by fn (returns false). Returns the length of the records accepted.
+        template <typename Fn>
+        size_t ForEachRecord(std::string_view buf, Fn &&fn) {
+            size_t pos = 0;
+            while (buf.size() - pos >= kHeaderBytes) {
+                const uint32_t payloadLen = GetU32(buf.data() + pos);
+                const uint32_t crc        = GetU32(buf.data() + pos + 4);
+                if (payloadLen < kPayloadMin || payloadLen > Journal::kMaxPayload || buf.size() - pos - kHeaderBytes < payloadLen) {
+                    break;
+                }
+                const std::string_view payload = buf.substr(pos + kHeaderBytes, payloadLen);
+                if (Crc32(payload) != crc) {
+                    break;
+                }
+                const auto op         = static_cast<Journal::Op>(static_cast<uint8_t>(payload[0]));
+                const uint32_t keyLen = GetU32(payload.data() + 1);
+                if (keyLen > payloadLen - kPayloadMin || op < Journal::Op::Set || op > Journal::Op::Expire) {
+                    break;
+                }
+                if (!fn(op, payload.substr(kPayloadMin, keyLen), payload.substr(kPayloadMin + keyLen))) {
+                    break;
+                }
+                pos += kHeaderBytes + payloadLen;
+            }
+            return pos;
+        }
+    } // namespace
+
+    void Journal::Encode(std::string &out, Op op, std::string_view key, std::string_view value) {
+        const size_t payloadLen = kPayloadMin + key.size() + value.size();
+        const size_t start      = out.size();
+        out.reserve(start + kHeaderBytes + payloadLen);
+
+        PutU32(out, static_cast<uint32_t>(payloadLen));
+        PutU32(out, 0); // crc, patched below once the payload is in place
+        out.push_back(static_cast<char>(op));
+        PutU32(out, static_cast<uint32_t>(key.size()));
+        out.append(key);
+        out.append(value);
+
+        const uint32_t crc = Crc32(std::string_view(out).substr(start + kHeaderBytes, payloadLen));
+        for (int i = 0; i < 4; ++i) {
+            out[start + 4 + i] = static_cast<char>((crc >> (8 * i)) & 0xFFu);
+        }
+    }
+
+    Journal::ReplayResult Journal::Replay(const std::string &path, const ApplyFn &fn) {
+        ReplayResult result;
+        std::ifstream in(path, std::ios::binary);
+        if (!in.is_open()) {
+            return result;
+        }
+        result.found = true;
+
+        const std::string buf((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        result.validBytes = ForEachRecord(buf, [&](Op op, std::string_view key, std::string_view value) {
+            if (op != Op::Batch) {
+                fn(op, std::string(key), std::string(value));
+                ++result.records;
+                return true;
+            }
+            // Check every record in the batch before applying any of them.
+            std::vector<std::tuple<Op, std::string_view, std::string_view>> inner;
+            const size_t innerBytes = ForEachRecord(value, [&](Op innerOp, std::string_view innerKey, std::string_view innerValue) {
+                if (innerOp == Op::Batch) {
+                    return false; // batches don't nest
+                }
+                inner.emplace_back(innerOp, innerKey, innerValue);
+                return true;
+            });
+            if (innerBytes != value.size()) {
+                return false;
+            }
+            for (const auto &[innerOp, innerKey, innerValue] : inner) {
+                fn(innerOp, std::string(innerKey), std::string(innerValue));
+            }
+            result.records += inner.size();
+            return true;
+        });
+        result.clean = result.validBytes == buf.size();
+        return result;
+    }
+
+    bool Journal::Open() {
+        if (_out.is_open()) {
+            return true;
+        }
+        if (_path.empty()) {
+            return false;
+        }
+        _out.open(_path, std::ios::binary | std::ios::app);
+        if (!_out.is_open()) {
+            return false;
+        }
+        std::error_code ec;
+        const auto existing = std::filesystem::file_size(_path, ec);
+        _size               = ec ? 0 : static_cast<uint64_t>(existing);
+        return true;
+    }
+
+    bool Journal::Append(std::string_view bytes) {
+        if (bytes.empty()) {
+            return true;
+        }
+        if (!Open()) {
+            return false;
+        }
+        _out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+        _out.flush();
+        if (!_out.good()) {
+            // Cut any partial write back off so later records don't land behind a torn one (replay stops
+            // there), and reopen on the next Append rather than staying stuck on a failbit.
+            Close();
+            std::error_code ec;
+            std::filesystem::resize_file(_path, _size, ec);
+            return false;
+        }
+        _size += bytes.size();
+        return true;
+    }
+
+    bool Journal::Rotate() {
+        Close();
+        std::error_code ec;
+        if (std::filesystem::exists(RotatedPath(), ec)) {
+            return false;
+        }
+        if (!std::filesystem::exists(_path, ec)) {
+            return true; // nothing logged yet; nothing to fold
+        }
+        std::filesystem::rename(_path, RotatedPath(), ec);
+        if (ec) {
+            return false;
+        }
+        _size = 0;
+        return true;
+    }
+
+    void Journal::Remove() {
+        Close();
+        std::error_code ec;
+        std::filesystem::remove(_path, ec);
+        std::filesystem::remove(RotatedPath(), ec);
+        _size = 0;
+    }
+
+    void Journal::Close() {
+        if (_out.is_open()) {
+            _out.close();
+        }
+        _out.clear();
+    }
+
+} // namespace HogwartsMP::Core::Storage
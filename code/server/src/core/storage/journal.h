@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <string_view>
+
+namespace HogwartsMP::Core::Storage {
+    // Append-only write-ahead log for KeyValueStore. Each mutation is one framed record:
+    //
+    //   [u32 payloadLen][u32 crc32(payload)][payload = u8 op | u32 keyLen | key | value]
+    //
+    // (all integers little-endian). A write costs O(key + value) instead of re-serializing the whole
+    // store. Replay stops at the first short or checksum-failing record, so a crash mid-append loses at
+    // most that one record and never yields a half-applied value. A Batch record carries several
+    // records as its value under one checksum, so a group of changes replays entirely or not at all.
+    // Not thread-safe; one writer per file.
+    class Journal final {
+      public:
+        enum class Op : uint8_t {
+            Set    = 1,
+            Erase  = 2,
+            Clear  = 3,
+            Batch  = 4, // value = encoded Set/Erase/Clear/Expire records; key empty
+            Expire = 5, // value = deadline, decimal ms since the epoch; empty = no deadline
+        };
+
+        // Largest payload replay accepts (a sanity cap so a corrupt length can't allocate gigabytes).
+        static constexpr uint32_t kMaxPayload = 256u * 1024u * 1024u;
+
+        // Outcome of a Replay: how many records were applied, and whether the file ended cleanly (false
+        // when a torn or corrupt tail was skipped — the caller should truncate the log to validBytes
+        // before appending again so new records don't land behind the garbage).
+        struct ReplayResult {
+            bool found          = false;
+            bool clean          = true;
+            size_t records      = 0;
+            uint64_t validBytes = 0; // length of the intact prefix (truncate a torn log back to this)
+        };
+
+        using ApplyFn = std::function<void(Op, std::string &&key, std::string &&value)>;
+
+        Journal() = default;
+        explicit Journal(std::string path): _path(std::move(path)) {}
+
+        // Append one encoded record to `out` (batch several, then Append the buffer once).
+        static void Encode(std::string &out, Op op, std::string_view key, std::string_view value = {});
+        // Append one Batch record wrapping `records` (the output of earlier Encode calls). The caller
+        // keeps the wrapped size under kMaxPayload.
+        static void EncodeBatch(std::string &out, std::string_view records) {
+            Encode(out, Op::Batch, {}, records);
+        }
+
+        // Feed every intact record in `path` to fn, in order. A missing file is not an error (found=false).
+        static ReplayResult Replay(const std::string &path, const ApplyFn &fn);
+
+        // Write pre-encoded records to the end of the log (opened lazily) and flush. Returns false on
+        // any I/O error; the log is left as it was before the call as far as replay is concerned.
+        bool Append(std::string_view bytes);
+
+        // Close the log and move it aside to RotatedPath() so a compaction can fold it into a snapshot
+        // while new records go to a fresh file. Fails if a previous rotated log is still present.
+        bool Rotate();
+
+        // Close and delete both the live and the rotated log.
+        void Remove();
+        void Close();
+
+        // Bytes in the live log (including any written before this process opened it).
+        uint64_t Size() const {
+            return _size;
+        }
+
+        const std::string &Path() const {
+            return _path;
+        }
+        std::string RotatedPath() const {
+            return _path + ".old";
+        }
+        void SetPath(std::string path) {
+            Close();
+            _path = std::move(path);
+        }
+
+      private:
+        bool Open();
+
+        std::string _path;
+        std::ofstream _out;
+        uint64_t _size = 0;
+    };
+} // namespace HogwartsMP::Core::Storage
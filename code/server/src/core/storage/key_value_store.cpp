@@ -2,54 +2,932 @@
 
 #include <nlohmann/json.hpp>
 
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cmath>
 #include <filesystem>
 #include <fstream>
 
 namespace HogwartsMP::Core::Storage {
 
+    namespace {
+        // Write `data` as a JSON object to a temp file, then atomically rename it over `path`. A crash,
+        // full disk, or power loss mid-write then leaves the previous file fully intact instead of a
+        // truncated or empty one — the old open-with-trunc approach could wipe the whole store on a
+        // failed write. Free function so a background compaction can run it on a copy of the entries.
+        bool WriteJsonFile(const std::vector<KeyValueStore::Entry> &data, const std::string &path, uint64_t *bytesOut = nullptr) {
+            nlohmann::json doc = nlohmann::json::object();
+            for (const auto &[key, value] : data) {
+                doc[key] = value;
+            }
+            const std::string text = doc.dump(2);
+
+            const std::string tmpPath = path + ".tmp";
+            {
+                std::ofstream out(tmpPath, std::ios::trunc | std::ios::binary);
+                if (!out.is_open()) {
+                    return false;
+                }
+                out << text;
+                out.flush();
+                if (!out.good()) {
+                    return false;
+                }
+            } // close the stream before renaming
+
+            std::error_code ec;
+            std::filesystem::rename(tmpPath, path, ec); // atomic on the same filesystem; replaces target
+            if (ec) {
+                std::filesystem::remove(tmpPath, ec); // best-effort cleanup; ignore failure
+                return false;
+            }
+            if (bytesOut) {
+                *bytesOut = text.size();
+            }
+            return true;
+        }
+
+        bool WriteSnapshotFile(const std::vector<KeyValueStore::Entry> &data, const std::string &path, SnapshotFormat format, uint64_t *bytesOut = nullptr) {
+            return format == SnapshotFormat::Binary ? SnapshotFile::Write(path, data, bytesOut) : WriteJsonFile(data, path, bytesOut);
+        }
+
+        // Where background snapshots go: straight over the live file where a mapped file may be replaced
+        // (the old mapping keeps reading the unlinked one), else beside it until the store's own thread
+        // has unmapped the old file and can rename the new one in (KeyValueStore::PollSnapshot).
+        std::string StagedPath(const std::string &path) {
+            return SnapshotFile::kReplaceableWhileMapped ? path : path + ".next";
+        }
+    } // namespace
+
+    KeyValueStore::~KeyValueStore() {
+        // Run queued writes while the members they use still exist. A shared worker outlives us, so wait
+        // for it explicitly — unless we are being destroyed by one of its tasks, which runs after ours.
+        if (_worker && !_worker->IsWorkerThread()) {
+            _worker->Drain();
+        }
+        _worker.reset();
+        WaitForCompaction();
+    }
+
     void KeyValueStore::Set(const std::string &key, std::string value) {
-        _data[key] = std::move(value);
+        DropExpiry(key);
+        Write(key, std::move(value));
+    }
+
+    void KeyValueStore::Write(const std::string &key, std::string value) {
+        _unsaved = true;
+        if (_mode == PersistMode::Journal) {
+            MarkDirty(key, value);
+        }
+        SetEntry(key, std::move(value));
     }
 
     std::optional<std::string> KeyValueStore::Get(const std::string &key) const {
-        const auto it = _data.find(key);
-        if (it == _data.end()) {
-            return std::nullopt;
+        if (const auto value = Peek(key)) {
+            return std::string(*value);
         }
-        return it->second;
+        return std::nullopt;
     }
 
     bool KeyValueStore::Has(const std::string &key) const {
-        return _data.find(key) != _data.end();
+        return (_data.find(key) != _data.end() || FindInBase(key).has_value()) && !IsExpired(key);
     }
 
     bool KeyValueStore::Erase(const std::string &key) {
-        return _data.erase(key) > 0;
+        DropExpiry(key);
+        const bool erased = EraseEntry(key);
+        _unsaved |= erased;
+        if (erased && _mode == PersistMode::Journal) {
+            MarkDirty(key, std::nullopt);
+        }
+        return erased;
     }
 
     void KeyValueStore::Clear() {
-        _data.clear();
+        ClearEntries();
+        _unsaved = true;
+        if (_mode == PersistMode::Journal) {
+            // A Clear supersedes every pending change before it.
+            _dirty.clear();
+            _dirtyExpiry.clear();
+            _dirtyClear = true;
+        }
     }
 
-    std::vector<std::string> KeyValueStore::Keys() const {
+    size_t KeyValueStore::Size() const {
+        return _size;
+    }
+
+    std::vector<std::string> KeyValueStore::Keys(std::string_view prefix, size_t limit) const {
         std::vector<std::string> keys;
-        keys.reserve(_data.size());
-        for (const auto &[key, _] : _data) {
-            keys.push_back(key);
+        if (prefix.empty() && limit == 0) {
+            keys.reserve(_size);
         }
+        Scan(prefix, [&](std::string_view key, std::string_view) {
+            if (key.substr(0, prefix.size()) != prefix || (limit != 0 && keys.size() >= limit)) {
+                return false;
+            }
+            keys.emplace_back(key);
+            return true;
+        });
         return keys;
     }
 
-    size_t KeyValueStore::Size() const {
-        return _data.size();
+    std::vector<KeyValueStore::Entry> KeyValueStore::Entries(std::string_view prefix, size_t limit) const {
+        std::vector<Entry> entries;
+        if (prefix.empty() && limit == 0) {
+            entries.reserve(_size);
+        }
+        Scan(prefix, [&](std::string_view key, std::string_view value) {
+            if (key.substr(0, prefix.size()) != prefix || (limit != 0 && entries.size() >= limit)) {
+                return false;
+            }
+            entries.emplace_back(key, value);
+            return true;
+        });
+        return entries;
+    }
+
+    std::vector<KeyValueStore::Entry> KeyValueStore::Range(std::string_view start, std::string_view end, size_t limit) const {
+        std::vector<Entry> entries;
+        Scan(start, [&](std::string_view key, std::string_view value) {
+            if ((!end.empty() && key >= end) || (limit != 0 && entries.size() >= limit)) {
+                return false;
+            }
+            entries.emplace_back(key, value);
+            return true;
+        });
+        return entries;
+    }
+
+    void KeyValueStore::Apply(const WriteBatch &batch) {
+        for (const auto &[key, value] : batch.Changes()) {
+            if (value) {
+                Set(key, *value);
+            }
+            else {
+                Erase(key);
+            }
+        }
+    }
+
+    std::optional<double> KeyValueStore::Incr(const std::string &key, double delta) {
+        if (IsExpired(key)) {
+            Erase(key); // counts from 0 again, without the old deadline
+        }
+        double value = 0.0;
+        if (const auto current = Peek(key)) {
+            const auto parsed = ParseNumber(*current);
+            if (!parsed) {
+                return std::nullopt;
+            }
+            value = *parsed;
+        }
+        value += delta;
+        if (!std::isfinite(value)) {
+            return std::nullopt;
+        }
+        Write(key, FormatNumber(value));
+        return value;
+    }
+
+    std::optional<double> KeyValueStore::ParseNumber(std::string_view text) {
+        double value      = 0.0;
+        const char *end   = text.data() + text.size();
+        const auto result = std::from_chars(text.data(), end, value);
+        if (text.empty() || result.ec != std::errc() || result.ptr != end || !std::isfinite(value)) {
+            return std::nullopt;
+        }
+        return value;
+    }
+
+    std::string KeyValueStore::FormatNumber(double value) {
+        if (value == 0.0) {
+            return "0"; // not "-0"
+        }
+        char buf[32];
+        const auto result = std::to_chars(buf, buf + sizeof(buf), value);
+        return std::string(buf, result.ptr);
+    }
+
+    bool KeyValueStore::Expire(const std::string &key, uint64_t ttlMs) {
+        if (!Has(key)) {
+            return false;
+        }
+        const uint64_t deadline = Now() + ttlMs;
+        SetDeadline(key, deadline);
+        _unsaved = true;
+        if (_mode == PersistMode::Journal) {
+            _dirtyExpiry[key] = deadline;
+        }
+        return true;
+    }
+
+    bool KeyValueStore::ClearExpiry(const std::string &key) {
+        if (!Has(key) || !DropExpiry(key)) {
+            return false;
+        }
+        _unsaved = true;
+        return true;
+    }
+
+    std::optional<uint64_t> KeyValueStore::TimeToLive(const std::string &key) const {
+        const auto it = _expiry.find(key);
+        if (it == _expiry.end() || !Has(key)) {
+            return std::nullopt;
+        }
+        return it->second - Now();
+    }
+
+    size_t KeyValueStore::ReapExpired(size_t budget, const std::function<void(const std::string &key)> &onReaped) {
+        if (_expiry.empty()) {
+            // Whatever is still scheduled is stale.
+            _timers.Clear();
+            _due.clear();
+            _dueNext = 0;
+            return 0;
+        }
+        if (_dueNext == _due.size()) {
+            _due.clear();
+            _dueNext = 0;
+        }
+        _timers.Advance(Now(), _due);
+
+        size_t reaped = 0;
+        while (_dueNext < _due.size() && reaped < budget) {
+            const TimerWheel::Timer &timer = _due[_dueNext++];
+            const auto it                  = _expiry.find(timer.key);
+            if (it == _expiry.end() || it->second != timer.deadlineMs) {
+                continue; // re-set, given a new deadline or erased since it was scheduled
+            }
+            if (!Erase(timer.key)) {
+                continue; // already dropped from the store by a snapshot rewrite
+            }
+            if (onReaped) {
+                onReaped(timer.key);
+            }
+            ++reaped;
+        }
+        return reaped;
+    }
+
+    uint64_t KeyValueStore::Now() const {
+        if (_clock) {
+            return _clock();
+        }
+        const auto sinceEpoch = std::chrono::system_clock::now().time_since_epoch();
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(sinceEpoch).count());
+    }
+
+    void KeyValueStore::SetDeadline(const std::string &key, uint64_t deadlineMs) {
+        _expiry[key] = deadlineMs;
+        _timers.Schedule(key, deadlineMs, Now());
+    }
+
+    bool KeyValueStore::DropExpiry(const std::string &key) {
+        if (_expiry.empty() || _expiry.erase(key) == 0) {
+            return false;
+        }
+        if (_mode == PersistMode::Journal) {
+            _dirtyExpiry[key] = 0;
+        }
+        return true;
+    }
+
+    bool KeyValueStore::IsExpired(std::string_view key) const {
+        if (_expiry.empty()) {
+            return false;
+        }
+        const auto it = _expiry.find(key);
+        return it != _expiry.end() && it->second <= Now();
+    }
+
+    std::optional<std::string_view> KeyValueStore::Peek(std::string_view key) const {
+        if (IsExpired(key)) {
+            return std::nullopt;
+        }
+        const auto it = _data.find(key);
+        if (it != _data.end()) {
+            return std::string_view(it->second);
+        }
+        if (const auto row = FindInBase(key)) {
+            return _base.ValueAt(*row);
+        }
+        return std::nullopt;
+    }
+
+    void WriteBatch::Set(std::string key, std::string value) {
+        Stage(std::move(key), std::move(value));
+    }
+
+    void WriteBatch::Erase(std::string key) {
+        Stage(std::move(key), std::nullopt);
+    }
+
+    void WriteBatch::Stage(std::string key, std::optional<std::string> value) {
+        const auto it = _slots.find(key);
+        if (it != _slots.end()) {
+            _changes[it->second].second = std::move(value);
+            return;
+        }
+        _slots.emplace(key, _changes.size());
+        _changes.emplace_back(std::move(key), std::move(value));
+    }
+
+    const std::optional<std::string> *WriteBatch::Find(std::string_view key) const {
+        const auto it = _slots.find(key);
+        return it != _slots.end() ? &_changes[it->second].second : nullptr;
+    }
+
+    void WriteBatch::Clear() {
+        _changes.clear();
+        _slots.clear();
+    }
+
+    void KeyValueStore::SetEntry(const std::string &key, std::string value) {
+        if (_snapshotQueued != _snapshotApplied) {
+            _changedSinceCopy.insert(key);
+        }
+        const auto [it, inserted] = _data.insert_or_assign(key, std::move(value));
+        if (!inserted) {
+            return;
+        }
+        _index.insert(it->first);
+        if (!FindInBase(key)) {
+            ++_size; // new key, not just an overlay over a mapped one
+        }
+        _erased.erase(key);
+    }
+
+    bool KeyValueStore::EraseEntry(const std::string &key) {
+        if (_snapshotQueued != _snapshotApplied) {
+            _changedSinceCopy.insert(key);
+        }
+        bool erased   = false;
+        const auto it = _data.find(key);
+        if (it != _data.end()) {
+            _index.erase(std::string_view(it->first));
+            _data.erase(it);
+            erased = true;
+        }
+        // A mapped copy underneath would show through again; hide it.
+        if (FindInBase(key)) {
+            _erased.insert(key);
+            erased = true;
+        }
+        _size -= erased ? 1 : 0;
+        if (!_expiry.empty()) {
+            _expiry.erase(key);
+        }
+        return erased;
+    }
+
+    void KeyValueStore::ClearEntries() {
+        _data.clear();
+        _index.clear();
+        _erased.clear();
+        _base.Close();
+        _size = 0;
+        _expiry.clear();
+        _timers.Clear();
+        _due.clear();
+        _dueNext = 0;
+        if (_snapshotQueued != _snapshotApplied) {
+            _changedSinceCopy.clear();
+            _clearedSinceCopy = true;
+        }
+    }
+
+    std::optional<size_t> KeyValueStore::FindInBase(std::string_view key) const {
+        if (!_base.IsOpen() || _erased.find(key) != _erased.end()) {
+            return std::nullopt;
+        }
+        return _base.Find(key);
+    }
+
+    template <typename Fn>
+    void KeyValueStore::Scan(std::string_view from, Fn &&fn) const {
+        // Merge the overlay's index with the mapped table, both sorted by key bytes. An overlay entry
+        // shadows the mapped one with the same key; erased mapped keys are skipped.
+        auto over         = _index.lower_bound(from);
+        size_t row        = _base.IsOpen() ? _base.LowerBound(from) : 0;
+        const size_t rows = _base.Count();
+        for (;;) {
+            while (row < rows) {
+                const auto key = _base.KeyAt(row);
+                if (_erased.find(key) == _erased.end() && _data.find(key) == _data.end()) {
+                    break;
+                }
+                ++row;
+            }
+            const bool haveOver = over != _index.end();
+            if (!haveOver && row >= rows) {
+                return;
+            }
+            if (haveOver && (row >= rows || *over < _base.KeyAt(row))) {
+                if (!IsExpired(*over) && !fn(*over, std::string_view(_data.find(*over)->second))) {
+                    return;
+                }
+                ++over;
+            }
+            else {
+                if (!IsExpired(_base.KeyAt(row)) && !fn(_base.KeyAt(row), _base.ValueAt(row))) {
+                    return;
+                }
+                ++row;
+            }
+        }
+    }
+
+    void KeyValueStore::RebuildIndex() {
+        _index.clear();
+        _size = _base.Count() - _erased.size();
+        for (const auto &[key, _] : _data) {
+            _index.insert(key);
+            if (!_base.IsOpen() || !_base.Find(key)) {
+                ++_size;
+            }
+        }
+    }
+
+    void KeyValueStore::PromoteBase() {
+        if (!_base.IsOpen()) {
+            return;
+        }
+        for (size_t row = 0; row < _base.Count(); ++row) {
+            const auto key = _base.KeyAt(row);
+            if (_erased.find(key) == _erased.end() && _data.find(key) == _data.end()) {
+                const auto it = _data.emplace(std::string(key), std::string(_base.ValueAt(row))).first;
+                _index.insert(it->first);
+            }
+        }
+        _erased.clear();
+        _base.Close();
+    }
+
+    bool KeyValueStore::Rebase() {
+        SnapshotFile fresh;
+        if (!fresh.Open(_filePath)) {
+            return false;
+        }
+        _base = std::move(fresh);
+        _data.clear();
+        _index.clear();
+        _erased.clear();
+        _size = _base.Count();
+        return true;
+    }
+
+    uint64_t KeyValueStore::QueueSnapshot() {
+        // A newer copy covers everything recorded for an older one still in flight.
+        _changedSinceCopy.clear();
+        _clearedSinceCopy = false;
+        return ++_snapshotQueued;
+    }
+
+    bool KeyValueStore::WriteQueuedSnapshot(const std::vector<Entry> &data, const std::string &path, SnapshotFormat format, uint64_t seq, uint64_t *bytesOut) {
+        const bool written = WriteSnapshotFile(data, StagedPath(path), format, bytesOut);
+        if (written) {
+            _snapshotWritten = seq;
+        }
+        _snapshotDone = seq;
+        return written;
+    }
+
+    void KeyValueStore::PollSnapshot() {
+        if (_snapshotApplied == _snapshotQueued) {
+            return;
+        }
+        if (_compaction.valid()) {
+            if (_compaction.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+                return;
+            }
+            WaitForCompaction();
+        }
+        if (_snapshotDone != _snapshotQueued) {
+            return; // an older one may be done, but the newest will replace it on disk anyway
+        }
+        // After a Clear or reload since the copy, what we have is newer than all of it: keep that.
+        const bool rebase  = _format == SnapshotFormat::Binary && !_clearedSinceCopy;
+        const auto changed = std::move(_changedSinceCopy);
+        _changedSinceCopy.clear();
+        _clearedSinceCopy = false;
+        _snapshotApplied  = _snapshotQueued;
+        if (_snapshotWritten != _snapshotQueued) {
+            return; // failed; the next snapshot or compaction tries again
+        }
+
+        const std::string staged = StagedPath(_filePath);
+        if (staged != _filePath) {
+            // The mapped file can't be replaced while mapped: unmap it only now, for the rename.
+            if (!rebase) {
+                PromoteBase(); // a JSON snapshot over a mapped binary one (the format was switched)
+            }
+            _base.Close();
+            std::error_code ec;
+            std::filesystem::rename(staged, _filePath, ec);
+            if (ec) {
+                _base.Open(_filePath); // still the file the overlay sits on; the next snapshot retries
+                return;
+            }
+            // The compaction left its rotated log for us, as the old snapshot still needed it until now.
+            // No compaction can be in flight (this was the newest snapshot queued) to rotate again.
+            std::filesystem::remove(_journal.RotatedPath(), ec);
+        }
+        if (!rebase) {
+            return;
+        }
+
+        // The new file holds the copy; what changed after it is still only in the overlay.
+        std::vector<std::pair<std::string, std::optional<std::string>>> carried;
+        carried.reserve(changed.size());
+        for (const auto &key : changed) {
+            const auto it = _data.find(key);
+            carried.emplace_back(key, it != _data.end() ? std::optional<std::string>(it->second) : std::nullopt);
+        }
+        if (!Rebase()) {
+            return;
+        }
+        for (auto &[key, value] : carried) {
+            if (value) {
+                SetEntry(key, std::move(*value));
+            }
+            else {
+                EraseEntry(key);
+            }
+        }
+    }
+
+    void KeyValueStore::AdoptStagedSnapshot() {
+        const std::string staged = StagedPath(_filePath);
+        std::error_code ec;
+        if (staged == _filePath || _base.IsOpen() || !std::filesystem::exists(staged, ec)) {
+            return;
+        }
+        // Written from a complete copy, so it is at least as new as the file; any log still beside it
+        // replays on top either way.
+        std::filesystem::rename(staged, _filePath, ec);
+    }
+
+    bool KeyValueStore::WriteSnapshot(std::vector<Entry> entries, uint64_t *bytesOut) {
+        if (_base.IsOpen() && !SnapshotFile::kReplaceableWhileMapped) {
+            PromoteBase(); // the mapped file is about to be replaced
+        }
+        if (!WriteSnapshotFile(entries, _filePath, _format, bytesOut)) {
+            return false;
+        }
+        if (_format == SnapshotFormat::Binary) {
+            Rebase(); // everything is in the new file now; serve from it and drop the heap copies
+        }
+        return true;
     }
 
     bool KeyValueStore::Load() {
-        return _filePath.empty() ? false : LoadFrom(_filePath);
+        if (_filePath.empty()) {
+            return false;
+        }
+        if (_mode == PersistMode::Journal) {
+            return LoadJournaled();
+        }
+        WaitForIdle(); // a queued snapshot write must not land after (and clobber) what we read
+        AdoptStagedSnapshot();
+        const bool loaded = LoadSnapshot(_filePath);
+        _unsaved &= !loaded;
+        return loaded;
     }
 
-    bool KeyValueStore::Save() const {
-        return _filePath.empty() ? false : SaveTo(_filePath);
+    bool KeyValueStore::Save() {
+        if (_filePath.empty()) {
+            return false;
+        }
+        PollSnapshot();
+        if (_mode == PersistMode::Journal) {
+            return SaveJournaled();
+        }
+        if (!_worker) {
+            const bool saved = WriteSnapshot(Entries());
+            _unsaved &= !saved;
+            return saved;
+        }
+        // Snapshot mode in the background: the copy is the only O(store) cost left on this thread.
+        // PollSnapshot maps the result once it is written.
+        _worker->Post([this, data = Entries(), path = _filePath, format = _format, seq = QueueSnapshot()]() {
+            return WriteQueuedSnapshot(data, path, format, seq, nullptr);
+        });
+        _unsaved = false;
+        return true;
+    }
+
+    bool KeyValueStore::Flush() {
+        const bool saved = Save();
+        return WaitForIdle() && saved;
+    }
+
+    void KeyValueStore::SetBackgroundFlush(bool enabled) {
+        if (enabled == (_worker != nullptr)) {
+            return;
+        }
+        SetFlushWorker(enabled ? std::make_shared<FlushWorker>() : nullptr);
+    }
+
+    void KeyValueStore::SetFlushWorker(std::shared_ptr<FlushWorker> worker) {
+        if (worker == _worker) {
+            return;
+        }
+        WaitForIdle();
+        _journal.Close(); // reopened by whichever thread appends next
+        _worker = std::move(worker);
+    }
+
+    void KeyValueStore::SetPersistMode(PersistMode mode) {
+        if (mode == _mode) {
+            return;
+        }
+        if (_mode == PersistMode::Journal) {
+            // Leaving Journal mode: fold the log into the snapshot so the plain file is complete on its own.
+            Compact();
+            _dirty.clear();
+            _dirtyExpiry.clear();
+            _dirtyClear = false;
+        }
+        _mode = mode;
+    }
+
+    void KeyValueStore::MarkDirty(const std::string &key, std::optional<std::string> value) {
+        _dirty[key] = std::move(value);
+    }
+
+    bool KeyValueStore::LoadJournaled() {
+        WaitForIdle();
+        AdoptStagedSnapshot();
+
+        std::error_code ec;
+        const bool hasSnapshot = std::filesystem::exists(_filePath, ec);
+        if (!hasSnapshot && !std::filesystem::exists(_journal.Path(), ec) && !std::filesystem::exists(_journal.RotatedPath(), ec)) {
+            return false; // nothing on disk: leave the store as it was
+        }
+        if (hasSnapshot) {
+            if (!LoadSnapshot(_filePath)) {
+                return false; // corrupt snapshot: don't replay a log over the wrong base
+            }
+            _snapshotBytes = static_cast<uint64_t>(std::filesystem::file_size(_filePath, ec));
+        }
+        else {
+            ClearEntries();
+            _snapshotBytes = 0;
+        }
+
+        // Replayed changes land in the overlay on top of the (possibly mapped) snapshot.
+        const auto apply = [this](Journal::Op op, std::string &&key, std::string &&value) {
+            switch (op) {
+            case Journal::Op::Set: SetEntry(key, std::move(value)); break;
+            case Journal::Op::Erase: EraseEntry(key); break;
+            case Journal::Op::Clear: ClearEntries(); break;
+            case Journal::Op::Expire: {
+                uint64_t deadline = 0;
+                std::from_chars(value.data(), value.data() + value.size(), deadline);
+                if (deadline == 0) {
+                    _expiry.erase(key);
+                }
+                else if (_data.find(key) != _data.end() || FindInBase(key)) {
+                    SetDeadline(key, deadline);
+                }
+                break;
+            }
+            case Journal::Op::Batch: break; // Replay unpacks batches into their records
+            }
+        };
+        // A rotated log exists only if a compaction was interrupted; its records predate the live log's.
+        const auto rotated = Journal::Replay(_journal.RotatedPath(), apply);
+        const auto live    = Journal::Replay(_journal.Path(), apply);
+
+        _dirty.clear();
+        _dirtyExpiry.clear();
+        _dirtyClear = false;
+        _unsaved    = false;
+        _logBytes   = live.validBytes;
+
+        // Cut a torn tail (crash mid-append) off the live log so new records don't land behind it, and
+        // finish an interrupted compaction now.
+        if (!live.clean) {
+            _journal.Close();
+            std::filesystem::resize_file(_journal.Path(), live.validBytes, ec);
+        }
+        if (rotated.found) {
+            Compact();
+        }
+        return true;
+    }
+
+    bool KeyValueStore::SaveJournaled() {
+        if (_dirty.empty() && !_dirtyClear && _dirtyExpiry.empty()) {
+            return true;
+        }
+
+        std::string records;
+        size_t count = 0;
+        if (_dirtyClear) {
+            Journal::Encode(records, Journal::Op::Clear, {});
+            ++count;
+        }
+        for (const auto &[key, value] : _dirty) {
+            if (value) {
+                Journal::Encode(records, Journal::Op::Set, key, *value);
+            }
+            else {
+                Journal::Encode(records, Journal::Op::Erase, key);
+            }
+            ++count;
+        }
+        // Deadlines go after the values they apply to.
+        for (const auto &[key, deadline] : _dirtyExpiry) {
+            if (deadline == 0) {
+                const auto it = _dirty.find(key);
+                if (it != _dirty.end() && !it->second) {
+                    continue; // erased: the Erase record drops the deadline too
+                }
+            }
+            Journal::Encode(records, Journal::Op::Expire, key, deadline ? std::to_string(deadline) : std::string());
+            ++count;
+        }
+        // One Batch record per commit, so everything changed together (an Apply, a script transaction)
+        // replays together. A commit too large for one record falls back to plain records.
+        std::string batch;
+        if (count > 1 && records.size() < Journal::kMaxPayload - 64) {
+            Journal::EncodeBatch(batch, records);
+        }
+        else {
+            batch = std::move(records);
+        }
+        const size_t batchBytes = batch.size();
+        if (_worker) {
+            // Group commit: everything dirtied since the last Save goes down as one append, on the flush
+            // thread. A failed append is retried ahead of the next batch (see AppendBacklogged).
+            _worker->Post([this, batch = std::move(batch)]() mutable {
+                return AppendBacklogged(std::move(batch));
+            });
+        }
+        else if (!_journal.Append(batch)) {
+            return false; // keep the dirty set; the next Save retries it
+        }
+        _dirty.clear();
+        _dirtyExpiry.clear();
+        _dirtyClear = false;
+        _unsaved    = false;
+        _logBytes += batchBytes;
+
+        MaybeCompact();
+        return true;
+    }
+
+    bool KeyValueStore::AppendBacklogged(std::string batch) {
+        if (_backlog.empty()) {
+            _backlog = std::move(batch);
+        }
+        else {
+            _backlog += batch;
+        }
+        if (!_journal.Append(_backlog)) {
+            return false;
+        }
+        _backlog.clear();
+        return true;
+    }
+
+    void KeyValueStore::MaybeCompact() {
+        if (_logBytes < std::max(_compactMinBytes, _snapshotBytes.load())) {
+            return;
+        }
+
+        if (_worker) {
+            _logBytes = 0;
+            // Queued behind every append posted so far, so the copy taken here covers all of them; appends
+            // posted later land in the fresh log. If the rotate fails (a rotated log survived an earlier
+            // failed compaction) the snapshot still covers both logs, so both go once it commits. Where
+            // the snapshot is only staged beside the mapped file, the logs stay until PollSnapshot renames
+            // it in (replaying records the snapshot already holds is harmless).
+            _worker->Post([this, data = Entries(), path = _filePath, format = _format, seq = QueueSnapshot()]() {
+                const bool rotated = _journal.Rotate();
+                uint64_t bytes     = 0;
+                if (!WriteQueuedSnapshot(data, path, format, seq, &bytes)) {
+                    return false;
+                }
+                _snapshotBytes = bytes;
+                if (!SnapshotFile::kReplaceableWhileMapped) {
+                    return true;
+                }
+                std::error_code ec;
+                if (rotated) {
+                    std::filesystem::remove(_journal.RotatedPath(), ec);
+                }
+                else {
+                    _journal.Remove();
+                }
+                _backlog.clear(); // already covered by the snapshot
+                return true;
+            });
+            RelogExpiries();
+            return;
+        }
+
+        if (_compaction.valid() && _compaction.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+            return; // previous compaction still writing; the log just grows a little longer
+        }
+        WaitForCompaction();
+        PollSnapshot();
+
+        // Move the current log aside and write the snapshot from a copy of the map on a worker thread;
+        // new records keep appending to a fresh log meanwhile. Until the snapshot's rename commits, the
+        // old snapshot + rotated log + live log still replay to the current state, so a crash at any
+        // point loses nothing. A leftover rotated log (a previous compaction failed) forces the
+        // synchronous path instead.
+        if (!_journal.Rotate()) {
+            Compact();
+            return;
+        }
+        _logBytes   = 0;
+        _compaction = std::async(std::launch::async, [this, data = Entries(), path = _filePath, format = _format, rotated = _journal.RotatedPath(), seq = QueueSnapshot()]() -> std::optional<uint64_t> {
+            uint64_t bytes = 0;
+            if (!WriteQueuedSnapshot(data, path, format, seq, &bytes)) {
+                return std::nullopt;
+            }
+            if (SnapshotFile::kReplaceableWhileMapped) {
+                std::error_code ec;
+                std::filesystem::remove(rotated, ec); // else PollSnapshot does once the snapshot is renamed in
+            }
+            return bytes;
+        });
+        RelogExpiries();
+    }
+
+    void KeyValueStore::RelogExpiries() {
+        std::string records;
+        for (const auto &[key, deadline] : _expiry) {
+            if (!IsExpired(key)) {
+                Journal::Encode(records, Journal::Op::Expire, key, std::to_string(deadline));
+            }
+        }
+        if (records.empty()) {
+            return;
+        }
+        _logBytes += records.size();
+        if (_worker) {
+            _worker->Post([this, records = std::move(records)]() mutable {
+                return AppendBacklogged(std::move(records));
+            });
+        }
+        else if (!_journal.Append(records)) {
+            // Leave them for the next Save instead.
+            for (const auto &[key, deadline] : _expiry) {
+                _dirtyExpiry[key] = deadline;
+            }
+            _unsaved = true;
+        }
+    }
+
+    bool KeyValueStore::WaitForCompaction() {
+        if (!_compaction.valid()) {
+            return true;
+        }
+        const auto bytes = _compaction.get();
+        if (bytes) {
+            _snapshotBytes = *bytes;
+        }
+        return bytes.has_value();
+    }
+
+    bool KeyValueStore::WaitForIdle() {
+        const bool flushed   = _worker ? _worker->Drain() : true;
+        const bool compacted = WaitForCompaction();
+        PollSnapshot();
+        return compacted && flushed;
+    }
+
+    bool KeyValueStore::Compact() {
+        if (_filePath.empty()) {
+            return false;
+        }
+        WaitForIdle();
+        if (_mode != PersistMode::Journal) {
+            const bool saved = WriteSnapshot(Entries());
+            _unsaved &= !saved;
+            return saved;
+        }
+        uint64_t bytes = 0;
+        if (!WriteSnapshot(Entries(), &bytes)) {
+            return false;
+        }
+        _journal.Remove();
+        _backlog.clear();
+        _dirty.clear();
+        _dirtyExpiry.clear();
+        _dirtyClear    = false;
+        _unsaved       = false;
+        _snapshotBytes = bytes;
+        _logBytes      = 0;
+        RelogExpiries();
+        return true;
     }
 
     bool KeyValueStore::LoadFrom(const std::string &path) {
@@ -70,45 +948,34 @@ namespace HogwartsMP::Core::Storage {
         }
 
         // Only commit to the live map once parsing fully succeeds.
-        std::unordered_map<std::string, std::string> loaded;
+        Map loaded;
         for (auto it = doc.begin(); it != doc.end(); ++it) {
             // Values are stored as strings; coerce non-string JSON (e.g. a hand-edited file) via dump
             // so a stray number/bool doesn't drop the whole entry.
             loaded[it.key()] = it->is_string() ? it->get<std::string>() : it->dump();
         }
+        ClearEntries();
         _data = std::move(loaded);
+        RebuildIndex();
         return true;
     }
 
-    bool KeyValueStore::SaveTo(const std::string &path) const {
-        nlohmann::json doc = nlohmann::json::object();
-        for (const auto &[key, value] : _data) {
-            doc[key] = value;
-        }
-
-        // Write to a temp file, then atomically rename it over the target. A crash, full disk, or
-        // power loss mid-write then leaves the previous file fully intact instead of a truncated or
-        // empty one — the old open-with-trunc approach could wipe the whole store on a failed write.
-        const std::string tmpPath = path + ".tmp";
-        {
-            std::ofstream out(tmpPath, std::ios::trunc | std::ios::binary);
-            if (!out.is_open()) {
-                return false;
-            }
-            out << doc.dump(2);
-            out.flush();
-            if (!out.good()) {
-                return false;
-            }
-        } // close the stream before renaming
-
-        std::error_code ec;
-        std::filesystem::rename(tmpPath, path, ec); // atomic on the same filesystem; replaces target
-        if (ec) {
-            std::filesystem::remove(tmpPath, ec); // best-effort cleanup; ignore failure
+    bool KeyValueStore::LoadSnapshot(const std::string &path) {
+        if (!SnapshotFile::IsSnapshot(path)) {
+            return LoadFrom(path); // JSON, e.g. written before the binary format was enabled
+        }
+        SnapshotFile mapped;
+        if (!mapped.Open(path)) {
             return false;
         }
+        ClearEntries();
+        _base = std::move(mapped);
+        _size = _base.Count();
         return true;
     }
 
+    bool KeyValueStore::SaveTo(const std::string &path) const {
+        return WriteJsonFile(Entries(), path);
+    }
+
 } // namespace HogwartsMP::Core::Storage
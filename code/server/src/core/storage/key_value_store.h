@@ -1,21 +1,75 @@
 #pragma once
 
+#include "flush_worker.h"
+#include "journal.h"
+#include "snapshot_file.h"
+#include "timer_wheel.h"
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
 #include <optional>
+#include <set>
 #include <string>
+#include <string_view>
 #include <unordered_map>
+#include <unordered_set>
+#include <utility>
 #include <vector>
 
 namespace HogwartsMP::Core::Storage {
+    class WriteBatch;
+
+    // How Save() persists the store.
+    //   Snapshot — rewrite the whole JSON file via temp+rename on every Save (O(store) per write).
+    //   Journal  — append only the keys changed since the last Save to a checksummed log beside the file
+    //              (<path>.log), and fold the log back into the JSON snapshot on a background thread once
+    //              it outgrows the snapshot. Load() replays snapshot + log.
+    enum class PersistMode : uint8_t {
+        Snapshot,
+        Journal,
+    };
+
+    // What Save / compaction write the snapshot as. Load reads either (it sniffs the file), so switching
+    // format takes effect at the next snapshot write.
+    //   Json   — a flat, hand-editable JSON object; Load parses it entirely into memory.
+    //   Binary — a sorted key table + value heap (SnapshotFile) that Load maps read-only instead of
+    //            parsing: cold start is O(1), Get/Has read straight from the mapping, and only keys changed
+    //            since the last snapshot are copied into memory.
+    enum class SnapshotFormat : uint8_t {
+        Json,
+        Binary,
+    };
+
     // A small persistent key/value store for server scripts. Values are opaque strings; callers that
     // want structured data store JSON text (the JS Storage builtin pairs this with JSON.stringify /
-    // JSON.parse). Backed by a flat JSON object on disk ({ "key": "value", ... }). Pure C++ with no
-    // V8 dependency so it is unit-testable in isolation; the scripting binding wraps a process-wide
-    // instance of it.
+    // JSON.parse). Backed by a snapshot file on disk — a flat JSON object ({ "key": "value", ... }) or a
+    // mapped binary table (SnapshotFormat). Pure C++ with no V8 dependency so it is unit-testable in
+    // isolation; the scripting binding wraps a process-wide instance of it.
     class KeyValueStore final {
       public:
+        // Transparent hash, so lookups by string_view (e.g. from the ordered index) don't allocate.
+        struct KeyHash {
+            using is_transparent = void;
+            size_t operator()(std::string_view key) const noexcept {
+                return std::hash<std::string_view> {}(key);
+            }
+        };
+        using Map = std::unordered_map<std::string, std::string, KeyHash, std::equal_to<>>;
+
+        // A journal smaller than this is never compacted, however small the snapshot is.
+        static constexpr uint64_t kCompactMinBytes = 4ull * 1024 * 1024;
+
         KeyValueStore() = default;
         // Sets the backing file path but does not read it; call Load() to populate from disk.
-        explicit KeyValueStore(std::string filePath): _filePath(std::move(filePath)) {}
+        explicit KeyValueStore(std::string filePath): _filePath(std::move(filePath)), _journal(_filePath + ".log") {}
+        // Pending background writes reference the store, so it stays put (no copy/move). Destruction
+        // finishes them first.
+        KeyValueStore(const KeyValueStore &)            = delete;
+        KeyValueStore &operator=(const KeyValueStore &) = delete;
+        ~KeyValueStore();
 
         // --- In-memory access ---
         void Set(const std::string &key, std::string value);
@@ -24,28 +78,280 @@ namespace HogwartsMP::Core::Storage {
         // Removes a key; returns true if it existed.
         bool Erase(const std::string &key);
         void Clear();
-        std::vector<std::string> Keys() const;
+        // Includes expired keys that haven't been reaped yet.
         size_t Size() const;
+        // Keys held in memory rather than read from a mapped binary snapshot: everything changed since it
+        // was written (all of them without one), counting erased ones.
+        size_t OverlaySize() const {
+            return _data.size() + _erased.size();
+        }
+        // Apply every change in the batch, in order, as one unit: nothing else runs in between, all of
+        // them are in the same Save, and in Journal mode that Save is one record that replays whole or
+        // not at all.
+        void Apply(const WriteBatch &batch);
+
+        // --- Numbers ---
+        // Counters are stored as ordinary string values (so Get, scans and exports see "42"), but Incr
+        // does the arithmetic here instead of making the caller Get, parse, format and Set. Repeated
+        // increments between Saves coalesce into one journal record like any other write.
+        //
+        // Add delta to key's value (a missing key counts as 0) and return the result; nullopt, with the
+        // store unchanged, if the current value isn't a number or the result isn't finite.
+        std::optional<double> Incr(const std::string &key, double delta);
+        // A whole-string decimal number ("12", "-3.5", "1e+21"), or nullopt.
+        static std::optional<double> ParseNumber(std::string_view text);
+        // Shortest text that parses back to value — integers without a fraction, as JS's String() does.
+        static std::string FormatNumber(double value);
+
+        // --- Expiry ---
+        // A key can carry a deadline, in ms since the Unix epoch on the store's clock (so it means the
+        // same after a restart). From its deadline on the key reads as missing — Get, Has, scans and
+        // snapshots skip it — and ReapExpired erases it for good. Due keys are found with a timer wheel
+        // rather than by scanning the store, and the caller bounds how many are erased per call, so a
+        // burst of expiries is spread over several calls. Set replaces a key's deadline (with none);
+        // Incr keeps it.
+        //
+        // Journal mode persists deadlines as journal records, and re-logs the live ones whenever a
+        // compaction starts a fresh log, so they survive restarts. Snapshot mode and LoadFrom / SaveTo
+        // keep values only.
+        using Clock = std::function<uint64_t()>;
+
+        // Give an existing key a deadline ttlMs from now; false if the key doesn't exist.
+        bool Expire(const std::string &key, uint64_t ttlMs);
+        // Remove key's deadline; true if it had one.
+        bool ClearExpiry(const std::string &key);
+        // ms left before key expires; nullopt if it doesn't exist or has no deadline.
+        std::optional<uint64_t> TimeToLive(const std::string &key) const;
+        // Erase up to `budget` keys whose deadline has passed, calling onReaped for each; returns how
+        // many were erased.
+        size_t ReapExpired(size_t budget, const std::function<void(const std::string &key)> &onReaped = {});
+        // The default clock is the system clock; tests substitute their own.
+        void SetClock(Clock clock) {
+            _clock = std::move(clock);
+        }
+        uint64_t Now() const;
+
+        // --- Ordered scans ---
+        // Served from an ordered index kept beside the hash map, so a namespace listing costs
+        // O(log n + matches) rather than O(store). Results are in lexicographic key order; limit 0 means
+        // no limit.
+        using Entry = std::pair<std::string, std::string>;
+        // Keys starting with prefix (every key when prefix is empty).
+        std::vector<std::string> Keys(std::string_view prefix = {}, size_t limit = 0) const;
+        // Key/value pairs whose key starts with prefix.
+        std::vector<Entry> Entries(std::string_view prefix = {}, size_t limit = 0) const;
+        // Key/value pairs with start <= key < end; an empty end means no upper bound.
+        std::vector<Entry> Range(std::string_view start, std::string_view end = {}, size_t limit = 0) const;
 
         // --- Persistence ---
         // Load()/Save() use the path set at construction (or via SetFilePath); they no-op and return
-        // false when no path is set. LoadFrom/SaveTo take an explicit path. Load replaces the current
-        // contents on success and leaves them untouched on a missing file or parse error (returns
-        // false). Save returns false on any I/O error.
+        // false when no path is set. LoadFrom/SaveTo take an explicit path and always speak plain JSON
+        // (import/export), whatever the snapshot format. Load replaces the current contents on success and leaves them untouched on a
+        // missing file or parse error (returns false). Save returns false on any I/O error; in Journal
+        // mode the unsaved changes are kept and retried by the next Save.
+        //
+        // With background flush enabled, Save only encodes the changes and queues them for the flush
+        // thread — it never touches disk on the caller's thread and returns true once queued; write
+        // errors surface from Flush() instead.
         bool Load();
-        bool Save() const;
+        bool Save();
+        // Save, then (with background flush) block until everything queued so far is on disk. Returns
+        // false if any queued write failed since the previous Flush.
+        bool Flush();
+        // True if the store changed since the last Save.
+        bool HasUnsavedChanges() const {
+            return _unsaved;
+        }
+        // Non-blocking: true (once) if a background write failed since the last Flush / call. The failed
+        // journal batch is kept and retried ahead of the next one.
+        bool TakeWriteError() {
+            return _worker && _worker->TakeFailure();
+        }
+        // A snapshot written in the background (Save with background flush, or a compaction) only becomes
+        // the mapped base on the store's own thread: once the newest one is on disk, this maps it and drops
+        // the overlay it covers, keeping whatever changed after its copy was taken. Non-blocking and cheap
+        // when nothing finished; call it once per tick. Flush, Compact and Load do it too.
+        void PollSnapshot();
         bool LoadFrom(const std::string &path);
         bool SaveTo(const std::string &path) const;
 
+        // Journal mode: write a full snapshot now (waiting out any background compaction) and drop the
+        // log. Equivalent to Save() in Snapshot mode.
+        bool Compact();
+
+        PersistMode GetPersistMode() const {
+            return _mode;
+        }
+        void SetPersistMode(PersistMode mode);
+
+        SnapshotFormat GetSnapshotFormat() const {
+            return _format;
+        }
+        void SetSnapshotFormat(SnapshotFormat format) {
+            _format = format;
+        }
+
+        // Journal mode: compact once the log exceeds max(minBytes, current snapshot size).
+        void SetCompactMinBytes(uint64_t minBytes) {
+            _compactMinBytes = minBytes;
+        }
+
+        // Move Save's disk writes (journal appends, snapshot rewrites, compactions) onto a dedicated
+        // flush thread. Disabling drains the thread first.
+        void SetBackgroundFlush(bool enabled);
+        // Same, but on a flush thread shared with other stores (nullptr = write on the caller's thread).
+        // Waits (Load, Flush, ...) then drain every store's queued writes, and write errors are reported
+        // to whichever store asks first. A store may be destroyed from a task on its own worker — its
+        // earlier writes have already run by then — but must not Load or Flush from one.
+        void SetFlushWorker(std::shared_ptr<FlushWorker> worker);
+        bool IsBackgroundFlush() const {
+            return _worker != nullptr;
+        }
+
         const std::string &FilePath() const {
             return _filePath;
         }
         void SetFilePath(std::string path) {
+            WaitForIdle();
+            _journal.SetPath(path + ".log");
             _filePath = std::move(path);
         }
 
       private:
-        std::unordered_map<std::string, std::string> _data;
+        // The layered view (mapped base + overlay + tombstones), without dirty tracking — shared by the
+        // public mutators and journal replay.
+        void SetEntry(const std::string &key, std::string value);
+        bool EraseEntry(const std::string &key);
+        void ClearEntries();
+        void SetDeadline(const std::string &key, uint64_t deadlineMs);
+        // Set's write, leaving the key's deadline alone (Incr).
+        void Write(const std::string &key, std::string value);
+        // Drop key's deadline and record that for the journal; true if it had one.
+        bool DropExpiry(const std::string &key);
+        bool IsExpired(std::string_view key) const;
+        // The current value without copying it (overlay or mapped base); valid until the next write.
+        std::optional<std::string_view> Peek(std::string_view key) const;
+        // Row of a live (not erased) key in the mapped base.
+        std::optional<size_t> FindInBase(std::string_view key) const;
+        // Visit entries in key order from `from` until fn(key, value) returns false.
+        template <typename Fn>
+        void Scan(std::string_view from, Fn &&fn) const;
+        // Index maintenance: views into _data's node keys, which stay put across rehashes. Also recounts
+        // _size.
+        void RebuildIndex();
+
+        // Load `path` as whichever snapshot format it is in (mapping a binary one).
+        bool LoadSnapshot(const std::string &path);
+        // Write `entries` as the snapshot at _filePath on this thread; a binary one then becomes the base.
+        bool WriteSnapshot(std::vector<Entry> entries, uint64_t *bytesOut = nullptr);
+        // Copy every live base entry into the overlay and unmap (before the mapped file is replaced where
+        // the OS won't allow that while mapped).
+        void PromoteBase();
+        // Map the snapshot just written at _filePath as the new base and drop the overlay it covers.
+        bool Rebase();
+        // Number a background snapshot about to be copied, and start recording what changes after it.
+        uint64_t QueueSnapshot();
+        // Writer-thread side: write that copy where PollSnapshot will pick it up, and publish the outcome.
+        bool WriteQueuedSnapshot(const std::vector<Entry> &data, const std::string &path, SnapshotFormat format, uint64_t seq, uint64_t *bytesOut);
+        // Take over a background snapshot a previous run wrote but never swapped in (see StagedPath).
+        void AdoptStagedSnapshot();
+
+        void MarkDirty(const std::string &key, std::optional<std::string> value);
+        bool LoadJournaled();
+        bool SaveJournaled();
+        void MaybeCompact();
+        bool WaitForCompaction();
+        // Finish every in-flight background write (flush thread and compaction) before touching the
+        // journal or files from the calling thread.
+        bool WaitForIdle();
+        // Flush-thread side of a journal append: retries earlier failed batches first.
+        bool AppendBacklogged(std::string batch);
+        // Snapshots hold values only: after a compaction starts a fresh log, write every live deadline
+        // into it (queued behind the compaction on the flush thread).
+        void RelogExpiries();
+
+        // Binary snapshots: the mapped base, read in place. _data is the overlay of keys set since it was
+        // mapped (shadowing the base), _erased the base keys deleted since. With no base, _data is
+        // everything.
+        SnapshotFile _base;
+        Map _data;
+        std::unordered_set<std::string, KeyHash, std::equal_to<>> _erased;
+        std::set<std::string_view, std::less<>> _index; // overlay keys only; scans merge it with the base
+        size_t _size = 0;
+        // Deadlines of the keys that have one (see Expiry above). Timers aren't cancelled: _due holds fired
+        // ones, from _dueNext on, not yet checked against _expiry and reaped.
+        std::unordered_map<std::string, uint64_t, KeyHash, std::equal_to<>> _expiry;
+        TimerWheel _timers;
+        std::vector<TimerWheel::Timer> _due;
+        size_t _dueNext = 0;
+        Clock _clock;
         std::string _filePath;
+        SnapshotFormat _format = SnapshotFormat::Json;
+        bool _unsaved = false;
+
+        PersistMode _mode = PersistMode::Snapshot;
+        Journal _journal;
+        // Journal mode: keys changed since the last Save -> their new value (nullopt = erased). Coalesced
+        // per key, so setting one key ten times between Saves logs one record. _dirtyClear orders a Clear
+        // record ahead of them.
+        std::unordered_map<std::string, std::optional<std::string>> _dirty;
+        bool _dirtyClear = false;
+        // Journal mode: deadlines changed since the last Save (0 = removed), logged after _dirty's records.
+        std::unordered_map<std::string, uint64_t> _dirtyExpiry;
+        uint64_t _compactMinBytes = kCompactMinBytes;
+        // Size of the last snapshot written (set by the flush thread when it compacts) and of the live
+        // journal as of the last queued append (caller thread only) — the compaction trigger.
+        std::atomic<uint64_t> _snapshotBytes {0};
+        uint64_t _logBytes = 0;
+        // In-flight background compaction (writes the snapshot, then deletes the rotated log); yields the
+        // new snapshot's size, or nullopt if it failed (the rotated log then survives for the next Load).
+        // Used without a flush thread; with one, compactions are queued on it instead.
+        std::future<std::optional<uint64_t>> _compaction;
+
+        // Background snapshots are numbered as they are queued; the writing thread publishes the number
+        // once it is done, and again in _snapshotWritten if it succeeded. Until PollSnapshot catches up
+        // with the newest, every key changed since its copy was taken is recorded (_changedSinceCopy,
+        // or _clearedSinceCopy for a Clear or reload), so rebasing onto the copy keeps those changes.
+        uint64_t _snapshotQueued  = 0;
+        uint64_t _snapshotApplied = 0;
+        std::atomic<uint64_t> _snapshotDone {0};
+        std::atomic<uint64_t> _snapshotWritten {0};
+        std::unordered_set<std::string, KeyHash, std::equal_to<>> _changedSinceCopy;
+        bool _clearedSinceCopy = false;
+
+        // Flush-thread only: encoded journal batches whose append failed, written ahead of the next one.
+        std::string _backlog;
+        // Declared last so it is destroyed first: its destructor runs every queued task, and those use
+        // the members above. Shared when the store was given someone else's worker.
+        std::shared_ptr<FlushWorker> _worker;
+    };
+
+    // Changes staged for KeyValueStore::Apply. Staging a key again replaces its earlier change, so a
+    // batch holds at most one change per key (in first-staged order) and can answer reads of what it
+    // will write — see Find.
+    class WriteBatch final {
+      public:
+        // Key -> new value, or nullopt for an erase.
+        using Change = std::pair<std::string, std::optional<std::string>>;
+
+        void Set(std::string key, std::string value);
+        void Erase(std::string key);
+        // The staged change for key: nullptr if the batch doesn't touch it, else a pointer to the new
+        // value (nullopt = erased).
+        const std::optional<std::string> *Find(std::string_view key) const;
+
+        const std::vector<Change> &Changes() const {
+            return _changes;
+        }
+        bool Empty() const {
+            return _changes.empty();
+        }
+        void Clear();
+
+      private:
+        void Stage(std::string key, std::optional<std::string> value);
+
+        std::vector<Change> _changes;
+        std::unordered_map<std::string, size_t, KeyValueStore::KeyHash, std::equal_to<>> _slots;
     };
 } // namespace HogwartsMP::Core::Storage
@@ -0,0 +1,118 @@
+#include "player_shards.h"
+
+#include <chrono>
+#include <filesystem>
+
+namespace HogwartsMP::Core::Storage {
+
+    PlayerShards::PlayerShards(std::string directory): _directory(std::move(directory)), _io(std::make_shared<FlushWorker>()) {}
+
+    PlayerShards::~PlayerShards() {
+        FlushAll();
+        // Resident stores drain and let go of _io here; the final Drain makes sure no queued eviction
+        // still holds one of them, so _io's destructor runs on this thread rather than its own.
+        _shards.clear();
+        _io->Drain();
+    }
+
+    std::string PlayerShards::ShardPath(const std::string &identity) const {
+        static constexpr char kHex[] = "0123456789abcdef";
+        std::string name;
+        name.reserve(identity.size());
+        for (const unsigned char c : identity) {
+            if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '-') {
+                name.push_back(static_cast<char>(c));
+            }
+            else {
+                name.push_back('_');
+                name.push_back(kHex[c >> 4]);
+                name.push_back(kHex[c & 0xF]);
+            }
+        }
+        return (std::filesystem::path(_directory) / (name + ".json")).string();
+    }
+
+    void PlayerShards::Acquire(const std::string &identity) {
+        if (identity.empty()) {
+            return;
+        }
+        Shard &shard = _shards[identity];
+        if (shard.refs++ > 0) {
+            return;
+        }
+
+        auto promise  = std::make_shared<std::promise<std::unique_ptr<KeyValueStore>>>();
+        shard.pending = promise->get_future();
+        _io->Post([promise, directory = _directory, path = ShardPath(identity)]() {
+            std::error_code ec;
+            std::filesystem::create_directories(directory, ec);
+            auto store = std::make_unique<KeyValueStore>(path);
+            store->SetPersistMode(PersistMode::Journal);
+            store->Load(); // missing file is fine — a new player starts empty
+            promise->set_value(std::move(store));
+            return !ec;
+        });
+    }
+
+    void PlayerShards::Release(const std::string &identity) {
+        const auto it = _shards.find(identity);
+        if (it == _shards.end() || --it->second.refs > 0) {
+            return;
+        }
+        Shard &shard = it->second;
+
+        if (shard.pending.valid()) {
+            // Never handed out, so nothing to save: drop the store once its load has run.
+            auto pending = std::make_shared<std::future<std::unique_ptr<KeyValueStore>>>(std::move(shard.pending));
+            _io->Post([pending]() {
+                pending->get();
+                return true;
+            });
+        }
+        else {
+            // Save queues the last changes on _io; the store is destroyed on _io right after them.
+            shard.store->Save();
+            std::shared_ptr<KeyValueStore> evicted(std::move(shard.store));
+            _io->Post([evicted = std::move(evicted)]() mutable {
+                evicted.reset();
+                return true;
+            });
+        }
+        _shards.erase(it);
+    }
+
+    KeyValueStore *PlayerShards::Find(const std::string &identity) {
+        const auto it = _shards.find(identity);
+        return it != _shards.end() ? Resolve(it->first, it->second) : nullptr;
+    }
+
+    bool PlayerShards::IsLoading(const std::string &identity) const {
+        const auto it = _shards.find(identity);
+        return it != _shards.end() && it->second.pending.valid() && it->second.pending.wait_for(std::chrono::seconds(0)) != std::future_status::ready;
+    }
+
+    KeyValueStore *PlayerShards::Resolve(const std::string &identity, Shard &shard) {
+        if (shard.pending.valid()) {
+            shard.store = shard.pending.get();
+            shard.store->SetFlushWorker(_io);
+            if (_onLoaded) {
+                _onLoaded(identity, *shard.store);
+            }
+        }
+        return shard.store.get();
+    }
+
+    void PlayerShards::SaveAll() {
+        for (auto &[identity, shard] : _shards) {
+            if (shard.store && shard.store->HasUnsavedChanges()) {
+                shard.store->Save();
+            }
+        }
+    }
+
+    bool PlayerShards::FlushAll() {
+        SaveAll();
+        return _io->Drain();
+    }
+
+} // namespace HogwartsMP::Core::Storage
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "flush_worker.h"
+#include "key_value_store.h"
+
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+namespace HogwartsMP::Core::Storage {
+    // Per-player storage, one journaled KeyValueStore per identity under a directory, resident only while
+    // the player is online. Acquire (on connect) queues the shard's load on a shared I/O thread and
+    // returns at once; Find hands out the store, waiting for that load only if it hasn't finished yet.
+    // Release (on disconnect) queues the shard's last changes and its eviction behind them. Every shard's
+    // disk work runs on the one I/O thread in posting order, so a player who reconnects before their
+    // eviction is written still loads what they left behind.
+    //
+    // Resident memory and load time follow who is online, not everyone who ever joined. Not thread-safe:
+    // call from the scripting thread only.
+    class PlayerShards final {
+      public:
+        // Called on the calling thread the first time a freshly loaded shard is handed out by Find.
+        using LoadedFn = std::function<void(const std::string &identity, KeyValueStore &store)>;
+
+        explicit PlayerShards(std::string directory);
+        // Commits every resident shard and waits for the I/O thread to write it.
+        ~PlayerShards();
+
+        PlayerShards(const PlayerShards &)            = delete;
+        PlayerShards &operator=(const PlayerShards &) = delete;
+
+        // Reference-counted, so two sessions sharing an identity keep the shard until both leave.
+        void Acquire(const std::string &identity);
+        void Release(const std::string &identity);
+
+        // The identity's store, or nullptr if it isn't acquired.
+        KeyValueStore *Find(const std::string &identity);
+        // True while the identity's shard is acquired but still loading, i.e. Find would wait.
+        bool IsLoading(const std::string &identity) const;
+
+        void SetOnLoaded(LoadedFn fn) {
+            _onLoaded = std::move(fn);
+        }
+
+        // Queue a commit of every resident shard with unsaved changes (non-blocking).
+        void SaveAll();
+        // SaveAll, then wait until the I/O thread has written everything queued. False if a write failed.
+        bool FlushAll();
+        // Non-blocking: true (once) if a background load/write failed since the last call / FlushAll.
+        bool TakeWriteError() {
+            return _io->TakeFailure();
+        }
+
+        size_t ResidentCount() const {
+            return _shards.size();
+        }
+
+        // <directory>/<identity>.json, with anything outside [A-Za-z0-9-] escaped as _XX so a hostile
+        // identity can't name a path outside the directory.
+        std::string ShardPath(const std::string &identity) const;
+
+      private:
+        struct Shard {
+            std::unique_ptr<KeyValueStore> store;
+            std::future<std::unique_ptr<KeyValueStore>> pending; // valid until the load is claimed
+            uint32_t refs = 0;
+        };
+
+        KeyValueStore *Resolve(const std::string &identity, Shard &shard);
+
+        std::string _directory;
+        std::unordered_map<std::string, Shard> _shards;
+        LoadedFn _onLoaded;
+        // Shared by every resident shard; evicted shards are destroyed on it, after their last write.
+        std::shared_ptr<FlushWorker> _io;
+    };
+} // namespace HogwartsMP::Core::Storage
@@ -0,0 +1,256 @@
+#include "snapshot_file.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace HogwartsMP::Core::Storage {
+
+    namespace {
+        constexpr char kMagic[4]         = {'H', 'K', 'V', '1'};
+        constexpr uint32_t kVersion      = 1;
+        constexpr size_t kHeaderBytes    = 32;
+        constexpr size_t kTableEntrySize = 16;
+
+        void PutU32(std::string &out, uint32_t v) {
+            for (int i = 0; i < 4; ++i) {
+                out.push_back(static_cast<char>((v >> (8 * i)) & 0xFFu));
+            }
+        }
+
+        void PutU64(std::string &out, uint64_t v) {
+            for (int i = 0; i < 8; ++i) {
+                out.push_back(static_cast<char>((v >> (8 * i)) & 0xFFu));
+            }
+        }
+
+        uint32_t GetU32(const char *p) {
+            const auto *u = reinterpret_cast<const unsigned char *>(p);
+            return static_cast<uint32_t>(u[0]) | (static_cast<uint32_t>(u[1]) << 8) | (static_cast<uint32_t>(u[2]) << 16) |
+                   (static_cast<uint32_t>(u[3]) << 24);
+        }
+
+        uint64_t GetU64(const char *p) {
+            return static_cast<uint64_t>(GetU32(p)) | (static_cast<uint64_t>(GetU32(p + 4)) << 32);
+        }
+
+        // Map a whole file read-only; nullptr on failure (including an empty file).
+        const char *MapFile(const std::string &path, size_t &bytes) {
+#ifdef _WIN32
+            // FILE_SHARE_DELETE so the file can still be deleted or renamed aside while mapped.
+            HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+            if (file == INVALID_HANDLE_VALUE) {
+                return nullptr;
+            }
+            LARGE_INTEGER size {};
+            const char *view = nullptr;
+            if (GetFileSizeEx(file, &size) && size.QuadPart > 0) {
+                HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+                if (mapping) {
+                    view = static_cast<const char *>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+                    CloseHandle(mapping); // the view keeps the mapping alive
+                }
+            }
+            CloseHandle(file);
+            bytes = view ? static_cast<size_t>(size.QuadPart) : 0;
+            return view;
+#else
+            const int fd = ::open(path.c_str(), O_RDONLY);
+            if (fd < 0) {
+                return nullptr;
+            }
+            struct stat st {};
+            void *view = MAP_FAILED;
+            if (::fstat(fd, &st) == 0 && st.st_size > 0) {
+                view = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            }
+            ::close(fd); // the mapping keeps the file alive
+            if (view == MAP_FAILED) {
+                bytes = 0;
+                return nullptr;
+            }
+            bytes = static_cast<size_t>(st.st_size);
+            return static_cast<const char *>(view);
+#endif
+        }
+
+        void UnmapFile(const char *view, size_t bytes) {
+#ifdef _WIN32
+            (void)bytes;
+            UnmapViewOfFile(view);
+#else
+            ::munmap(const_cast<char *>(view), bytes);
+#endif
+        }
+    } // namespace
+
+    SnapshotFile::~SnapshotFile() {
+        Close();
+    }
+
+    SnapshotFile::SnapshotFile(SnapshotFile &&other) noexcept {
+        *this = std::move(other);
+    }
+
+    SnapshotFile &SnapshotFile::operator=(SnapshotFile &&other) noexcept {
+        if (this != &other) {
+            Close();
+            std::swap(_view, other._view);
+            std::swap(_viewBytes, other._viewBytes);
+            std::swap(_count, other._count);
+            std::swap(_heapBytes, other._heapBytes);
+        }
+        return *this;
+    }
+
+    bool SnapshotFile::IsSnapshot(const std::string &path) {
+        std::ifstream in(path, std::ios::binary);
+        char magic[sizeof(kMagic)] {};
+        return in.read(magic, sizeof(magic)) && std::memcmp(magic, kMagic, sizeof(kMagic)) == 0;
+    }
+
+    bool SnapshotFile::Write(const std::string &path, const std::vector<Entry> &entries, uint64_t *bytesOut) {
+        std::string head;
+        head.reserve(kHeaderBytes + entries.size() * kTableEntrySize);
+        uint64_t heapBytes = 0;
+        for (const auto &[key, value] : entries) {
+            heapBytes += key.size() + value.size();
+        }
+        head.append(kMagic, sizeof(kMagic));
+        PutU32(head, kVersion);
+        PutU64(head, entries.size());
+        PutU64(head, heapBytes);
+        PutU64(head, 0);
+
+        uint64_t offset = 0;
+        for (const auto &[key, value] : entries) {
+            PutU64(head, offset);
+            PutU32(head, static_cast<uint32_t>(key.size()));
+            PutU32(head, static_cast<uint32_t>(value.size()));
+            offset += key.size() + value.size();
+        }
+
+        // Same temp + rename as the JSON snapshot: a failed write leaves the previous file intact.
+        const std::string tmpPath = path + ".tmp";
+        {
+            std::ofstream out(tmpPath, std::ios::trunc | std::ios::binary);
+            if (!out.is_open()) {
+                return false;
+            }
+            out.write(head.data(), static_cast<std::streamsize>(head.size()));
+            for (const auto &[key, value] : entries) {
+                out.write(key.data(), static_cast<std::streamsize>(key.size()));
+                out.write(value.data(), static_cast<std::streamsize>(value.size()));
+            }
+            out.flush();
+            if (!out.good()) {
+                return false;
+            }
+        }
+
+        std::error_code ec;
+        std::filesystem::rename(tmpPath, path, ec);
+        if (ec) {
+            std::filesystem::remove(tmpPath, ec);
+            return false;
+        }
+        if (bytesOut) {
+            *bytesOut = head.size() + heapBytes;
+        }
+        return true;
+    }
+
+    bool SnapshotFile::Open(const std::string &path) {
+        Close();
+        size_t bytes     = 0;
+        const char *view = MapFile(path, bytes);
+        if (!view) {
+            return false;
+        }
+        if (bytes < kHeaderBytes || std::memcmp(view, kMagic, sizeof(kMagic)) != 0 || GetU32(view + 4) != kVersion) {
+            UnmapFile(view, bytes);
+            return false;
+        }
+        const uint64_t count     = GetU64(view + 8);
+        const uint64_t heapBytes = GetU64(view + 16);
+        // The sizes must account for the file exactly; this also rules out overflowing counts.
+        const uint64_t body = bytes - kHeaderBytes;
+        if (count > body / kTableEntrySize || heapBytes != body - count * kTableEntrySize) {
+            UnmapFile(view, bytes);
+            return false;
+        }
+        _view      = view;
+        _viewBytes = bytes;
+        _count     = count;
+        _heapBytes = heapBytes;
+        return true;
+    }
+
+    void SnapshotFile::Close() {
+        if (_view) {
+            UnmapFile(_view, _viewBytes);
+        }
+        _view      = nullptr;
+        _viewBytes = 0;
+        _count     = 0;
+        _heapBytes = 0;
+    }
+
+    SnapshotFile::Extent SnapshotFile::ExtentAt(size_t i) const {
+        const char *row = _view + kHeaderBytes + i * kTableEntrySize;
+        Extent e {GetU64(row), GetU32(row + 8), GetU32(row + 12)};
+        if (e.offset > _heapBytes || e.keyLen > _heapBytes - e.offset || e.valueLen > _heapBytes - e.offset - e.keyLen) {
+            return {_heapBytes, 0, 0};
+        }
+        return e;
+    }
+
+    std::string_view SnapshotFile::KeyAt(size_t i) const {
+        const Extent e   = ExtentAt(i);
+        const char *heap = _view + kHeaderBytes + _count * kTableEntrySize;
+        return {heap + e.offset, e.keyLen};
+    }
+
+    std::string_view SnapshotFile::ValueAt(size_t i) const {
+        const Extent e   = ExtentAt(i);
+        const char *heap = _view + kHeaderBytes + _count * kTableEntrySize;
+        return {heap + e.offset + e.keyLen, e.valueLen};
+    }
+
+    size_t SnapshotFile::LowerBound(std::string_view key) const {
+        size_t lo = 0;
+        size_t hi = Count();
+        while (lo < hi) {
+            const size_t mid = lo + (hi - lo) / 2;
+            if (KeyAt(mid) < key) {
+                lo = mid + 1;
+            }
+            else {
+                hi = mid;
+            }
+        }
+        return lo;
+    }
+
+    std::optional<size_t> SnapshotFile::Find(std::string_view key) const {
+        const size_t i = LowerBound(key);
+        if (i < Count() && KeyAt(i) == key) {
+            return i;
+        }
+        return std::nullopt;
+    }
+
+} // namespace HogwartsMP::Core::Storage
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace HogwartsMP::Core::Storage {
+    // Read-only, memory-mapped binary snapshot of a KeyValueStore:
+    //
+    //   header  [4 magic "HKV1"][u32 version][u64 count][u64 heapBytes][u64 reserved]     (32 bytes)
+    //   table   count x [u64 offset][u32 keyLen][u32 valueLen], sorted by key bytes       (16 bytes each)
+    //   heap    key bytes immediately followed by value bytes, at table[i].offset
+    //
+    // (all integers little-endian). Opening maps the file and checks the header against the file size —
+    // O(1), nothing is parsed or copied — and Get is a binary search over the table. Each entry's extent
+    // is checked on access, so a corrupt file reads as missing keys rather than outside the mapping.
+    class SnapshotFile final {
+      public:
+        using Entry = std::pair<std::string, std::string>;
+
+        // Whether a file can be renamed over while mapped. Windows refuses, so a store rewriting its own
+        // snapshot there must let go of the mapping first.
+#ifdef _WIN32
+        static constexpr bool kReplaceableWhileMapped = false;
+#else
+        static constexpr bool kReplaceableWhileMapped = true;
+#endif
+
+        SnapshotFile() = default;
+        ~SnapshotFile();
+        SnapshotFile(SnapshotFile &&other) noexcept;
+        SnapshotFile &operator=(SnapshotFile &&other) noexcept;
+        SnapshotFile(const SnapshotFile &)            = delete;
+        SnapshotFile &operator=(const SnapshotFile &) = delete;
+
+        // True if `path` starts with the snapshot magic (anything else is treated as JSON).
+        static bool IsSnapshot(const std::string &path);
+
+        // Write `entries` (sorted by key, no duplicates) to a temp file and rename it over `path`.
+        static bool Write(const std::string &path, const std::vector<Entry> &entries, uint64_t *bytesOut = nullptr);
+
+        // Map `path`. False (and closed) if it can't be mapped or isn't a well-formed snapshot.
+        bool Open(const std::string &path);
+        void Close();
+        bool IsOpen() const {
+            return _view != nullptr;
+        }
+
+        size_t Count() const {
+            return static_cast<size_t>(_count);
+        }
+        std::string_view KeyAt(size_t i) const;
+        std::string_view ValueAt(size_t i) const;
+        // First entry whose key is >= key (Count() if none).
+        size_t LowerBound(std::string_view key) const;
+        std::optional<size_t> Find(std::string_view key) const;
+
+      private:
+        // Bounds-checked location of entry i's key in the heap; keyLen 0 / heapBytes on a bad entry.
+        struct Extent {
+            uint64_t offset;
+            uint32_t keyLen;
+            uint32_t valueLen;
+        };
+        Extent ExtentAt(size_t i) const;
+
+        const char *_view   = nullptr;
+        size_t _viewBytes   = 0;
+        uint64_t _count     = 0;
+        uint64_t _heapBytes = 0;
+    };
+} // namespace HogwartsMP::Core::Storage
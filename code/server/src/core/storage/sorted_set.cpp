@@ -0,0 +1,260 @@
+#include "sorted_set.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace HogwartsMP::Core::Storage {
+
+    SortedSet::SortedSet() {
+        _head.links.resize(kMaxLevel);
+    }
+
+    SortedSet::~SortedSet() {
+        Clear();
+    }
+
+    bool SortedSet::Before(const Node &node, double score, std::string_view member) {
+        return node.score < score || (node.score == score && std::string_view(node.member) < member);
+    }
+
+    int SortedSet::RandomLevel() {
+        // Each level holds about a quarter of the one below it.
+        int level = 1;
+        while (level < kMaxLevel && (_rng() & 3u) == 0) {
+            ++level;
+        }
+        return level;
+    }
+
+    bool SortedSet::Add(const std::string &member, double score) {
+        const auto it = _scores.find(member);
+        if (it != _scores.end()) {
+            if (it->second == score) {
+                return false;
+            }
+            Unlink(member, it->second);
+            it->second = score;
+            Insert(member, score);
+            return false;
+        }
+        _scores.emplace(member, score);
+        Insert(member, score);
+        return true;
+    }
+
+    bool SortedSet::Remove(std::string_view member) {
+        const auto it = _scores.find(member);
+        if (it == _scores.end()) {
+            return false;
+        }
+        Unlink(member, it->second);
+        _scores.erase(it);
+        return true;
+    }
+
+    void SortedSet::Clear() {
+        Node *node = _head.links[0].next;
+        while (node) {
+            Node *next = node->links[0].next;
+            delete node;
+            node = next;
+        }
+        for (auto &link : _head.links) {
+            link = {};
+        }
+        _level = 1;
+        _size  = 0;
+        _scores.clear();
+    }
+
+    void SortedSet::Insert(const std::string &member, double score) {
+        Node *update[kMaxLevel];
+        size_t rank[kMaxLevel]; // position of update[i]
+        Node *x = &_head;
+        for (int i = _level - 1; i >= 0; --i) {
+            rank[i] = i == _level - 1 ? 0 : rank[i + 1];
+            while (x->links[i].next && Before(*x->links[i].next, score, member)) {
+                rank[i] += x->links[i].span;
+                x = x->links[i].next;
+            }
+            update[i] = x;
+        }
+
+        const int level = RandomLevel();
+        for (int i = _level; i < level; ++i) {
+            rank[i]             = 0;
+            update[i]           = &_head;
+            _head.links[i].span = _size;
+        }
+        _level = std::max(_level, level);
+
+        auto *node = new Node {member, score, std::vector<Link>(level)};
+        for (int i = 0; i < level; ++i) {
+            Link &prev          = update[i]->links[i];
+            node->links[i].next = prev.next;
+            node->links[i].span = prev.span - (rank[0] - rank[i]);
+            prev.next           = node;
+            prev.span           = rank[0] - rank[i] + 1;
+        }
+        for (int i = level; i < _level; ++i) {
+            ++update[i]->links[i].span;
+        }
+        ++_size;
+    }
+
+    void SortedSet::Unlink(std::string_view member, double score) {
+        Node *update[kMaxLevel];
+        Node *x = &_head;
+        for (int i = _level - 1; i >= 0; --i) {
+            while (x->links[i].next && Before(*x->links[i].next, score, member)) {
+                x = x->links[i].next;
+            }
+            update[i] = x;
+        }
+        Node *node = x->links[0].next; // the member's node: _scores says it is here
+
+        for (int i = 0; i < _level; ++i) {
+            Link &prev = update[i]->links[i];
+            if (prev.next == node) {
+                prev.span += node->links[i].span - 1;
+                prev.next = node->links[i].next;
+            }
+            else {
+                --prev.span;
+            }
+        }
+        while (_level > 1 && !_head.links[_level - 1].next) {
+            --_level;
+        }
+        delete node;
+        --_size;
+    }
+
+    std::optional<double> SortedSet::Score(std::string_view member) const {
+        const auto it = _scores.find(member);
+        if (it == _scores.end()) {
+            return std::nullopt;
+        }
+        return it->second;
+    }
+
+    std::optional<size_t> SortedSet::Rank(std::string_view member) const {
+        const auto it = _scores.find(member);
+        if (it == _scores.end()) {
+            return std::nullopt;
+        }
+        // Advance to the last node not after the member, counting positions: that node is the member.
+        const double score = it->second;
+        const Node *x      = &_head;
+        size_t rank        = 0;
+        for (int i = _level - 1; i >= 0; --i) {
+            while (x->links[i].next && (Before(*x->links[i].next, score, member) || x->links[i].next->member == member)) {
+                rank += x->links[i].span;
+                x = x->links[i].next;
+            }
+        }
+        return rank - 1;
+    }
+
+    const SortedSet::Node *SortedSet::AtRank(size_t rank) const {
+        const Node *x    = &_head;
+        size_t traversed = 0;
+        for (int i = _level - 1; i >= 0; --i) {
+            while (x->links[i].next && traversed + x->links[i].span <= rank) {
+                traversed += x->links[i].span;
+                x = x->links[i].next;
+            }
+            if (traversed == rank) {
+                return x;
+            }
+        }
+        return nullptr;
+    }
+
+    std::vector<SortedSet::Item> SortedSet::RangeByRank(size_t start, size_t stop) const {
+        std::vector<Item> items;
+        if (start >= _size || start > stop) {
+            return items;
+        }
+        stop = std::min(stop, _size - 1);
+        items.reserve(stop - start + 1);
+        for (const Node *x = AtRank(start + 1); x && items.size() < stop - start + 1; x = x->links[0].next) {
+            items.emplace_back(x->member, x->score);
+        }
+        return items;
+    }
+
+    std::vector<SortedSet::Item> SortedSet::RangeByScore(double min, double max, size_t limit) const {
+        std::vector<Item> items;
+        const Node *x = &_head;
+        for (int i = _level - 1; i >= 0; --i) {
+            while (x->links[i].next && x->links[i].next->score < min) {
+                x = x->links[i].next;
+            }
+        }
+        for (x = x->links[0].next; x && x->score <= max && (limit == 0 || items.size() < limit); x = x->links[0].next) {
+            items.emplace_back(x->member, x->score);
+        }
+        return items;
+    }
+
+    bool SortedSets::IsValidName(std::string_view set) {
+        return !set.empty() && set.find(':') == std::string_view::npos;
+    }
+
+    std::string SortedSets::Key(std::string_view set, std::string_view member) {
+        std::string key;
+        key.reserve(kPrefix.size() + set.size() + 1 + member.size());
+        key.append(kPrefix).append(set).append(1, ':').append(member);
+        return key;
+    }
+
+    bool SortedSets::Add(const std::string &set, const std::string &member, double score) {
+        const bool added = Index(set).Add(member, score);
+        _store.Set(Key(set, member), KeyValueStore::FormatNumber(score));
+        return added;
+    }
+
+    std::optional<double> SortedSets::IncrBy(const std::string &set, const std::string &member, double delta) {
+        const double score = Index(set).Score(member).value_or(0.0) + delta;
+        if (!std::isfinite(score)) {
+            return std::nullopt;
+        }
+        Add(set, member, score);
+        return score;
+    }
+
+    bool SortedSets::Remove(const std::string &set, const std::string &member) {
+        if (!Index(set).Remove(member)) {
+            return false;
+        }
+        _store.Erase(Key(set, member));
+        return true;
+    }
+
+    SortedSet &SortedSets::Index(const std::string &set) {
+        auto [it, inserted] = _sets.try_emplace(set);
+        if (inserted) {
+            const std::string prefix = Key(set, {});
+            for (const auto &[key, value] : _store.Entries(prefix)) {
+                // A value that isn't a number was not written through here; it isn't a member.
+                if (const auto score = KeyValueStore::ParseNumber(value)) {
+                    it->second.Add(key.substr(prefix.size()), *score);
+                }
+            }
+        }
+        return it->second;
+    }
+
+    void SortedSets::Invalidate(std::string_view key) {
+        if (key.substr(0, kPrefix.size()) != kPrefix) {
+            return;
+        }
+        key.remove_prefix(kPrefix.size());
+        const auto it = _sets.find(key.substr(0, key.find(':')));
+        if (it != _sets.end()) {
+            _sets.erase(it);
+        }
+    }
+
+} // namespace HogwartsMP::Core::Storage
@@ -0,0 +1,117 @@
+#pragma once
+
+#include "key_value_store.h"
+
+#include <cstdint>
+#include <optional>
+#include <random>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace HogwartsMP::Core::Storage {
+    // An in-memory sorted set: unique members ordered by (score, member bytes), with rank queries. A skip
+    // list whose links also record how many elements they pass over, so a member's rank and the element
+    // at a rank are found in O(log n) expected, and a run of k elements in O(log n + k). A hash map
+    // beside it answers "what is this member's score" in O(1).
+    class SortedSet final {
+      public:
+        using Item = std::pair<std::string, double>;
+
+        SortedSet();
+        ~SortedSet();
+        SortedSet(const SortedSet &)            = delete;
+        SortedSet &operator=(const SortedSet &) = delete;
+
+        // Set member's score (finite); true if the member is new.
+        bool Add(const std::string &member, double score);
+        // True if the member existed.
+        bool Remove(std::string_view member);
+        void Clear();
+
+        std::optional<double> Score(std::string_view member) const;
+        // 0-based position in ascending order.
+        std::optional<size_t> Rank(std::string_view member) const;
+        size_t Size() const {
+            return _size;
+        }
+
+        // Items at ascending positions start..stop inclusive, clamped to the set.
+        std::vector<Item> RangeByRank(size_t start, size_t stop) const;
+        // Items with min <= score <= max, ascending; limit 0 means no limit.
+        std::vector<Item> RangeByScore(double min, double max, size_t limit = 0) const;
+
+      private:
+        static constexpr int kMaxLevel = 32;
+
+        struct Node;
+        // A forward link and the number of positions it advances (1 = the next node).
+        struct Link {
+            Node *next  = nullptr;
+            size_t span = 0;
+        };
+        struct Node {
+            std::string member;
+            double score = 0.0;
+            std::vector<Link> links;
+        };
+
+        // Whether node sorts strictly before (score, member).
+        static bool Before(const Node &node, double score, std::string_view member);
+        int RandomLevel();
+        void Insert(const std::string &member, double score);
+        void Unlink(std::string_view member, double score);
+        // Node at 1-based position rank, or nullptr.
+        const Node *AtRank(size_t rank) const;
+
+        Node _head;
+        int _level   = 1;
+        size_t _size = 0;
+        std::unordered_map<std::string, double, KeyValueStore::KeyHash, std::equal_to<>> _scores;
+        std::minstd_rand _rng;
+    };
+
+    // Named sorted sets stored in a KeyValueStore. Member m of set s is the ordinary key "zset:s:m"
+    // holding the score as a number string, so sets are saved, journaled, compacted and exported with
+    // everything else. Each set's SortedSet index is built from a prefix scan the first time the set is
+    // used and then kept in step by every change made through here; a change to a "zset:" key made
+    // directly on the store must be reported with Invalidate, which drops the index to be rebuilt.
+    //
+    // Set names can't contain ':' (it ends the name in the key). Not thread-safe.
+    class SortedSets final {
+      public:
+        static constexpr std::string_view kPrefix = "zset:";
+
+        explicit SortedSets(KeyValueStore &store): _store(store) {}
+
+        // Non-empty and free of ':'.
+        static bool IsValidName(std::string_view set);
+        static std::string Key(std::string_view set, std::string_view member);
+
+        // Set member's score; true if the member is new. The score must be finite.
+        bool Add(const std::string &set, const std::string &member, double score);
+        // Add delta to member's score (a missing member counts as 0) and return it; nullopt, with nothing
+        // changed, if the result isn't finite.
+        std::optional<double> IncrBy(const std::string &set, const std::string &member, double delta);
+        bool Remove(const std::string &set, const std::string &member);
+
+        // The set's index (empty if the set has no members).
+        const SortedSet &Get(const std::string &set) {
+            return Index(set);
+        }
+
+        // Forget the index of the set `key` belongs to, if it is a sorted-set key.
+        void Invalidate(std::string_view key);
+        void InvalidateAll() {
+            _sets.clear();
+        }
+
+      private:
+        SortedSet &Index(const std::string &set);
+
+        KeyValueStore &_store;
+        std::unordered_map<std::string, SortedSet, KeyValueStore::KeyHash, std::equal_to<>> _sets;
+    };
+} // namespace HogwartsMP::Core::Storage
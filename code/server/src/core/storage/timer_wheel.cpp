@@ -0,0 +1,90 @@
+#include "timer_wheel.h"
+
+#include <utility>
+
+namespace HogwartsMP::Core::Storage {
+
+    void TimerWheel::Schedule(std::string key, uint64_t deadlineMs, uint64_t nowMs) {
+        if (_count == 0) {
+            _tick = TickOf(nowMs);
+        }
+        ++_count;
+        Place({std::move(key), deadlineMs});
+    }
+
+    void TimerWheel::Place(Timer timer) {
+        // Round up, so a timer never fires before its deadline.
+        const uint64_t due = TickOf(timer.deadlineMs) + (timer.deadlineMs % _resolutionMs != 0 ? 1 : 0);
+        if (due <= _tick) {
+            _overdue.push_back(std::move(timer));
+            return;
+        }
+        const uint64_t delta = due - _tick;
+        for (int level = 0; level < kLevels; ++level) {
+            const int shift = kSlotBits * level;
+            if (level == kLevels - 1 || delta < (uint64_t {1} << (shift + kSlotBits))) {
+                // Past the top level's span: the slot just behind the current one, visited last.
+                const uint64_t at = level == kLevels - 1 && delta >= (uint64_t {1} << (shift + kSlotBits)) ? (_tick >> shift) - 1 : due >> shift;
+                _slots[level][at & (kSlots - 1)].push_back(std::move(timer));
+                return;
+            }
+        }
+    }
+
+    void TimerWheel::Advance(uint64_t nowMs, std::vector<Timer> &due) {
+        const uint64_t target = TickOf(nowMs);
+        if (!_overdue.empty()) {
+            _count -= _overdue.size();
+            for (auto &timer : _overdue) {
+                due.push_back(std::move(timer));
+            }
+            _overdue.clear();
+        }
+        while (_tick < target) {
+            if (_count == 0) {
+                _tick = target; // nothing to fire or re-file on the way
+                return;
+            }
+            ++_tick;
+            // Entering a new span at level L (every lower index wrapped to 0) re-files that level's slot
+            // into the levels below, highest first.
+            int top = 0;
+            while (top + 1 < kLevels && ((_tick >> (kSlotBits * top)) & (kSlots - 1)) == 0) {
+                ++top;
+            }
+            for (int level = top; level >= 1; --level) {
+                auto &slot  = _slots[level][(_tick >> (kSlotBits * level)) & (kSlots - 1)];
+                auto timers = std::move(slot);
+                slot.clear();
+                for (auto &timer : timers) {
+                    Place(std::move(timer));
+                }
+            }
+            auto &slot = _slots[0][_tick & (kSlots - 1)];
+            _count -= slot.size();
+            for (auto &timer : slot) {
+                due.push_back(std::move(timer));
+            }
+            slot.clear();
+            if (!_overdue.empty()) {
+                // Re-filed timers that were already due (only possible for the top level's parked ones).
+                _count -= _overdue.size();
+                for (auto &timer : _overdue) {
+                    due.push_back(std::move(timer));
+                }
+                _overdue.clear();
+            }
+        }
+    }
+
+    void TimerWheel::Clear() {
+        for (auto &level : _slots) {
+            for (auto &slot : level) {
+                slot.clear();
+            }
+        }
+        _overdue.clear();
+        _count = 0;
+    }
+
+} // namespace HogwartsMP::Core::Storage
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace HogwartsMP::Core::Storage {
+    // Hierarchical timer wheel for key expiry. KLevels levels of kSlots slots: level 0 holds timers due
+    // within kSlots ticks, one slot per tick; each level above covers kSlots times the span of the one
+    // below. Scheduling is O(1). Advancing one tick fires a level-0 slot, and every kSlots^L ticks it
+    // re-files one level-L slot into the levels below. A timer is therefore touched at most once per
+    // level over its lifetime, however many timers there are, instead of every timer being scanned
+    // every tick.
+    //
+    // There is no cancellation: a timer whose key was re-set or deleted still fires, and the caller
+    // checks it against the key's current deadline. Deadlines are in ms on the caller's clock and fire
+    // on the first Advance at or after them (rounded up to the resolution). Not thread-safe.
+    class TimerWheel final {
+      public:
+        struct Timer {
+            std::string key;
+            uint64_t deadlineMs = 0;
+        };
+
+        static constexpr int kSlotBits = 6;
+        static constexpr int kSlots    = 1 << kSlotBits;
+        // 64^6 ticks: about 35 years at 16 ms. Later deadlines wait in the last slot and are re-filed.
+        static constexpr int kLevels = 6;
+
+        explicit TimerWheel(uint64_t resolutionMs = 16): _resolutionMs(resolutionMs ? resolutionMs : 1) {}
+
+        // Add a timer. nowMs is where an empty wheel starts counting from; a timer already due fires on
+        // the next Advance.
+        void Schedule(std::string key, uint64_t deadlineMs, uint64_t nowMs);
+        // Move the wheel up to nowMs, appending every timer that came due to `due`.
+        void Advance(uint64_t nowMs, std::vector<Timer> &due);
+        void Clear();
+
+        size_t Size() const {
+            return _count;
+        }
+
+      private:
+        uint64_t TickOf(uint64_t ms) const {
+            return ms / _resolutionMs;
+        }
+        // File a timer relative to the current tick.
+        void Place(Timer timer);
+
+        uint64_t _resolutionMs;
+        uint64_t _tick = 0; // last tick processed
+        size_t _count  = 0;
+        std::array<std::array<std::vector<Timer>, kSlots>, kLevels> _slots;
+        std::vector<Timer> _overdue; // scheduled at or before the current tick
+    };
+} // namespace HogwartsMP::Core::Storage
@@ -1,8 +1,60 @@
+#include "core/builtins/profiler.h"
 #include "core/server.h"
+#include "core/replay/replayer.h"
 
 #include "shared/version.h"
 
+#include <fmt/format.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+namespace {
+    // Our own command-line options, taken out of argv before the framework sees the rest.
+    struct ServerArgs {
+        std::string capturePath;       // --capture <file>: record the session for replay
+        std::string replayPath;        // --replay <file>: replay a capture instead of serving
+        uint64_t replayUntil  = 0;     // --replay-until <tick>: stop the replay after this tick
+        int64_t slowHandlerMs = 50;    // --slow-handler-ms <ms>: log script handlers slower than this (0 = off)
+        bool loadTest         = false; // --load-test: answer load-test bots' LoadProbe round trips
+    };
+
+    ServerArgs TakeServerArgs(int &argc, char **argv) {
+        ServerArgs args;
+        int kept = 1;
+        for (int i = 1; i < argc; ++i) {
+            const std::string arg = argv[i];
+            const bool hasValue   = i + 1 < argc;
+            if (arg == "--capture" && hasValue) {
+                args.capturePath = argv[++i];
+            }
+            else if (arg == "--replay" && hasValue) {
+                args.replayPath = argv[++i];
+            }
+            else if (arg == "--replay-until" && hasValue) {
+                args.replayUntil = std::strtoull(argv[++i], nullptr, 10);
+            }
+            else if (arg == "--slow-handler-ms" && hasValue) {
+                args.slowHandlerMs = std::strtoll(argv[++i], nullptr, 10);
+            }
+            else if (arg == "--load-test") {
+                args.loadTest = true;
+            }
+            else {
+                argv[kept++] = argv[i];
+            }
+        }
+        argc = kept;
+        return args;
+    }
+} // namespace
+
 int main(int argc, char **argv) {
+    const ServerArgs args = TakeServerArgs(argc, argv);
+    const bool replaying  = !args.replayPath.empty();
+
     Framework::Integrations::Server::InstanceOptions opts;
     opts.bindHost      = "0.0.0.0";
     opts.bindPort      = 27015;
@@ -17,6 +69,14 @@ int main(int argc, char **argv) {
     opts.bindPassword  = "";
     opts.enableSignals = true;
 
+    if (replaying) {
+        // Nothing connects to a replay: loopback on ephemeral ports, so it can run beside a live server.
+        opts.bindHost    = "127.0.0.1";
+        opts.bindPort    = 0;
+        opts.webBindHost = "127.0.0.1";
+        opts.webBindPort = 0;
+    }
+
     // Hogwarts is cm-scale (coords in the hundreds of thousands); size the interest grid to ~±20 km
     // with 100 m cells so culling is meaningful at the player's 500 m range (the ±10k default clamps).
     opts.worldConfig.streamWorldMin = -2000000.0f;
@@ -27,9 +87,37 @@ int main(int argc, char **argv) {
     opts.argv = argv;
 
     HogwartsMP::Server server;
+    // Group-commit script Storage writes every 250 ms from the server tick: a crash loses at most that
+    // window, and a burst of writes (per-player counters on connect) costs a single journal append.
+    server.SetStorageDurability({HogwartsMP::Core::Storage::Durability::Mode::Interval, std::chrono::milliseconds(250)});
+    server.SetLoadTest(args.loadTest);
     if (!server.Init(opts)) {
         return 1;
     }
+    HogwartsMP::Scripting::Profiler::SetSlowThreshold(std::chrono::milliseconds(args.slowHandlerMs));
+
+    if (replaying) {
+        // Scripts and storage are the real ones, so run a replay from a copy of the server directory.
+        HogwartsMP::Core::Replay::ReplayReport report;
+        HogwartsMP::Core::Replay::Replayer replayer(server);
+        const bool ok = replayer.Run(args.replayPath, args.replayUntil, 10, report);
+        server.Shutdown();
+        if (!ok) {
+            return 2;
+        }
+        fmt::print("Replayed {} ticks ({} records, {:.1f} s of session) in {:.1f} ms{}\n", report.ticks, report.records, report.sessionMs / 1000.0,
+                   report.wallMs, report.clean ? "" : " — capture truncated, replayed up to the cut");
+        fmt::print("Tick p50 {:.3f} ms, p99 {:.3f} ms, max {:.3f} ms. Slowest:\n", report.tickP50Ms, report.tickP99Ms, report.tickMaxMs);
+        for (const auto &tick : report.slowest) {
+            fmt::print("  tick {:>8} at {:>10.3f} s  {:.3f} ms\n", tick.tick, static_cast<double>(tick.atUs) / 1e6, tick.ms);
+        }
+        return 0;
+    }
+
+    if (!args.capturePath.empty() && !server.StartCapture(args.capturePath)) {
+        server.Shutdown();
+        return 1;
+    }
     server.Run();
     server.Shutdown();
     return 0;
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace HogwartsMP::Shared {
+    // Per-connection script event name table limits. Names past either limit still go out, just spelled
+    // in full every time (id 0) instead of interned.
+    constexpr uint32_t kMaxEventNames    = 1024;
+    constexpr size_t kMaxEventNameLength = 128;
+
+    /**
+     * Sender half of one connection's event name table. The first event under a name assigns it the next
+     * id (from 1) and carries the string along; every later one carries only the id. Ids are only ever
+     * added, so the table has to be reset together with the receiving side — at (re)connect.
+     */
+    class EventNameEncoder final {
+      public:
+        // The id to send eventName under, 0 = not interned (send the name). firstUse: the name has to
+        // go along this time to define the id.
+        uint32_t Encode(const std::string &eventName, bool &firstUse) {
+            firstUse      = false;
+            const auto it = _ids.find(eventName);
+            if (it != _ids.end()) {
+                return it->second;
+            }
+            if (eventName.empty() || eventName.size() > kMaxEventNameLength || _ids.size() >= kMaxEventNames) {
+                return 0;
+            }
+            const auto id = static_cast<uint32_t>(_ids.size() + 1);
+            _ids.emplace(eventName, id);
+            firstUse = true;
+            return id;
+        }
+
+        void Reset() {
+            _ids.clear();
+        }
+
+      private:
+        std::unordered_map<std::string, uint32_t> _ids;
+    };
+
+    /**
+     * Receiver half: ids resolve by index, with no string hashing per event. The peer on the other side
+     * is untrusted, so a definition must take the next free id and stay within the limits, and an id
+     * that was never defined resolves to nothing.
+     */
+    class EventNameDecoder final {
+      public:
+        // The name an event carrying (id, name) stands for; name is the string sent along with it ("" when
+        // only the id was sent). nullptr for an undefined id or an out-of-order definition. Valid until the
+        // next Resolve.
+        const std::string *Resolve(uint32_t id, const std::string &name) {
+            if (id == 0) {
+                return &name;
+            }
+            if (name.empty()) {
+                return id <= _names.size() ? &_names[id - 1] : nullptr;
+            }
+            if (id <= _names.size()) {
+                // A definition repeated for a known id must agree with it.
+                return _names[id - 1] == name ? &_names[id - 1] : nullptr;
+            }
+            if (id != _names.size() + 1 || id > kMaxEventNames || name.size() > kMaxEventNameLength) {
+                return nullptr;
+            }
+            _names.push_back(name);
+            return &_names.back();
+        }
+
+        size_t Size() const {
+            return _names.size();
+        }
+
+        void Reset() {
+            _names.clear();
+        }
+
+      private:
+        std::vector<std::string> _names;
+    };
+} // namespace HogwartsMP::Shared
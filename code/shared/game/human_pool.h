@@ -0,0 +1,106 @@
+#pragma once
+
+#include "human.h"
+
+#include <cstddef>
+#include <new>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace HogwartsMP::Shared {
+    /**
+     * Recycles Human entities of type T (the server's ServerHuman, the client's ClientHuman) so NPC
+     * spawn/despawn churn stops hitting the heap. The framework's EntityRegistry constructs entities with
+     * new and they are deleted on destruction, so the pool hooks in underneath that:
+     *
+     *  - T's class operator new / delete take and return the object's memory through Allocate / Release,
+     *    a free list of sizeof(T) blocks;
+     *  - T's destructor hands the heap-backed members (nickname, ccd) to Retire, and its constructor takes
+     *    them back with Adopt: cleared, but with their buffers' capacity kept.
+     *
+     * At most kMaxPooled of each are kept; past that they are freed as before. Not thread-safe: entities
+     * are created and destroyed on one thread (the peer's) on both sides.
+     */
+    template <typename T>
+    class HumanPool final {
+      public:
+        static constexpr size_t kMaxPooled = 256;
+
+        static void *Allocate(size_t size) {
+            auto &blocks = Get()._blocks;
+            if (size != sizeof(T) || blocks.empty()) {
+                return ::operator new(size);
+            }
+            void *block = blocks.back();
+            blocks.pop_back();
+            return block;
+        }
+
+        static void Release(void *block, size_t size) {
+            auto &blocks = Get()._blocks;
+            if (size != sizeof(T) || blocks.size() >= kMaxPooled) {
+                ::operator delete(block);
+                return;
+            }
+            blocks.push_back(block);
+        }
+
+        // From T's constructor: reuse a retired entity's nickname and ccd buffers, if any.
+        static void Adopt(HumanEntity &human) {
+            auto &spares = Get()._spares;
+            if (spares.empty()) {
+                return;
+            }
+            Spare &spare   = spares.back();
+            human.nickname = std::move(spare.nickname);
+            human.ccd      = std::move(spare.ccd);
+            spares.pop_back();
+            human.nickname.clear();
+            Modules::ResetCcd(human.ccd);
+        }
+
+        // From T's destructor: keep the entity's nickname and ccd buffers for the next one.
+        static void Retire(HumanEntity &human) {
+            auto &spares = Get()._spares;
+            if (spares.size() < kMaxPooled) {
+                spares.push_back({std::move(human.nickname), std::move(human.ccd)});
+            }
+        }
+
+        // Free blocks waiting for reuse.
+        static size_t Pooled() {
+            return Get()._blocks.size();
+        }
+
+        // Give every pooled block and buffer back to the heap.
+        static void Trim() {
+            auto &pool = Get();
+            for (void *block : pool._blocks) {
+                ::operator delete(block);
+            }
+            pool._blocks.clear();
+            pool._spares.clear();
+        }
+
+      private:
+        struct Spare {
+            std::string nickname;
+            Modules::CcdProfile ccd;
+        };
+
+        HumanPool() {
+            _blocks.reserve(kMaxPooled);
+            _spares.reserve(kMaxPooled);
+        }
+
+        // Never destroyed: an entity freed during static teardown must still find its pool.
+        static HumanPool &Get() {
+            static auto *pool = new HumanPool;
+            return *pool;
+        }
+
+        std::vector<void *> _blocks;
+        std::vector<Spare> _spares;
+    };
+} // namespace HogwartsMP::Shared
@@ -128,6 +128,15 @@ namespace HogwartsMP::Shared::Modules {
         });
     }
 
+    // Back to a default profile, keeping the outer vectors' capacity (for reuse by a pooled entity).
+    inline void ResetCcd(CcdProfile &c) {
+        c.gender = 0;
+        c.scale  = 1.0f;
+        c.boneScales.clear();
+        c.characterItems.clear();
+        c.outfits.clear();
+    }
+
     // Server-side gate: drop any DA/texture path outside the allowlist (a peer can't make others
     // StaticLoadObject arbitrary assets). Counts are already clamped on read by the serializer.
     inline void SanitizeCcdPiece(CcdPiece &p) {
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <networking/rpc/rpc.h>
+
+#include <mafianet/BitStream.h>
+
+#include <cstdint>
+
+namespace HogwartsMP::Shared::RPC {
+    // Client -> server -> same client: a round-trip probe for load testing (the HogwartsMPBots tool).
+    // The client stamps seq/sentUs; the server echoes them back unchanged with its own tick timings
+    // filled in, so the client gets the RPC round trip and the server's load from one message.
+    struct LoadProbe {
+        static constexpr const char *kIdentifier = "HogwartsMP::LoadProbe";
+
+        uint32_t seq    = 0;
+        uint64_t sentUs = 0; // client clock, opaque to the server
+        // Server tick interval: smoothed average, and the longest one in the last full second (ms).
+        float tickMs    = 0.0f;
+        float tickMaxMs = 0.0f;
+
+        void Serialize(MafiaNet::BitStream *bs, bool write) {
+            bs->Serialize(write, seq);
+            bs->Serialize(write, sentUs);
+            bs->Serialize(write, tickMs);
+            bs->Serialize(write, tickMaxMs);
+        }
+    };
+} // namespace HogwartsMP::Shared::RPC
@@ -0,0 +1,87 @@
+#pragma once
+
+#include "shared/event_names.h"
+
+#include <networking/replication/network_entity.h>
+
+#include <mafianet/BitStream.h>
+
+#include <cstdint>
+#include <string>
+
+namespace HogwartsMP::Shared::RPC {
+    namespace Replication = Framework::Networking::Replication;
+
+    /**
+     * A named script event, either direction: player.emit / emitPacked and World.emitAllClients /
+     * emitAllClientsPacked down, Game.emitServer / emitServerPacked up. The payload is JSON text or a
+     * packed ScriptPayload value; the receiver turns either into the Core.Events handler argument.
+     *
+     * The name is interned per connection (Shared::EventNameEncoder/Decoder): the first event under a
+     * name sends it with a small id, later ones only the id, as a varint — one byte for the first 127
+     * names. SetName and ResolveName do the table work; the tables live with the connection.
+     */
+    struct ScriptEvent {
+        static constexpr const char *kIdentifier = "HogwartsMP::ScriptEvent";
+
+        enum Encoding : uint8_t { Json = 0, Packed = 1 };
+
+        uint8_t encoding = Json;
+        uint32_t nameId  = 0;  // 0 = name not interned
+        std::string name;      // "" when only nameId was sent
+        std::string payload;
+
+        void SetName(const std::string &eventName, EventNameEncoder &names) {
+            bool firstUse = false;
+            nameId        = names.Encode(eventName, firstUse);
+            name          = nameId == 0 || firstUse ? eventName : std::string();
+        }
+        // The event's name, defining its id on first use; nullptr when the sender's id is unknown or bogus.
+        const std::string *ResolveName(EventNameDecoder &names) const {
+            return names.Resolve(nameId, name);
+        }
+
+        void Serialize(MafiaNet::BitStream *bs, bool write) {
+            Replication::FieldSerializer fs(bs, write);
+            uint8_t flags = write ? static_cast<uint8_t>((encoding & kEncodingMask) | (HasName() ? kHasName : 0)) : 0;
+            fs.Field(flags);
+            encoding = flags & kEncodingMask;
+            SerializeVarint(fs, write);
+            if (flags & kHasName) {
+                fs.Field(name);
+            }
+            fs.Field(payload);
+        }
+
+      private:
+        static constexpr uint8_t kEncodingMask = 0x01;
+        static constexpr uint8_t kHasName      = 0x02;
+
+        bool HasName() const {
+            return nameId == 0 || !name.empty();
+        }
+        void SerializeVarint(Replication::FieldSerializer &fs, bool write) {
+            if (write) {
+                uint32_t value = nameId;
+                do {
+                    uint8_t byte = value & 0x7f;
+                    value >>= 7;
+                    if (value != 0) {
+                        byte |= 0x80;
+                    }
+                    fs.Field(byte);
+                } while (value != 0);
+                return;
+            }
+            nameId = 0;
+            for (int shift = 0; shift < 35; shift += 7) {
+                uint8_t byte = 0;
+                fs.Field(byte);
+                nameId |= static_cast<uint32_t>(byte & 0x7f) << shift;
+                if ((byte & 0x80) == 0) {
+                    break;
+                }
+            }
+        }
+    };
+} // namespace HogwartsMP::Shared::RPC
@@ -0,0 +1,305 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+namespace HogwartsMP::Shared::ScriptPayload {
+    // Limits on a script event payload crossing the wire, in either encoding. Client payloads are
+    // attacker-controlled: the size cap bounds the parse, the depth cap the recursion.
+    constexpr size_t kMaxBytes = 64 * 1024;
+    constexpr int kMaxDepth    = 32;
+
+    /**
+     * Whether JSON text stays within maxDepth levels of array/object nesting. A byte scan that skips
+     * string contents, not a validation: the text is still parsed (once) by whoever consumes it. Unbalanced
+     * or malformed text passes here and fails there.
+     */
+    inline bool JsonDepthWithin(std::string_view text, int maxDepth) {
+        int depth     = 0;
+        bool inString = false;
+        for (size_t i = 0; i < text.size(); ++i) {
+            const char c = text[i];
+            if (inString) {
+                if (c == '\\') {
+                    ++i;
+                }
+                else if (c == '"') {
+                    inString = false;
+                }
+                continue;
+            }
+            switch (c) {
+            case '"': inString = true; break;
+            case '[':
+            case '{':
+                if (++depth > maxDepth) {
+                    return false;
+                }
+                break;
+            case ']':
+            case '}': --depth; break;
+            default: break;
+            }
+        }
+        return true;
+    }
+
+    // The packed (binary) payload encoding is a MessagePack subset: nil, bool, integers, float64 (float32
+    // is read too), str, bin, array and map, all big-endian. No extension types.
+    class Writer final {
+      public:
+        explicit Writer(std::string &out): _out(out) {}
+
+        void Nil() {
+            Byte(0xc0);
+        }
+        void Bool(bool value) {
+            Byte(value ? 0xc3 : 0xc2);
+        }
+        void Int(int64_t value) {
+            if (value >= 0 && value <= 0x7f) {
+                Byte(static_cast<uint8_t>(value));
+            }
+            else if (value < 0 && value >= -32) {
+                Byte(static_cast<uint8_t>(value));
+            }
+            else if (value >= INT8_MIN && value <= INT8_MAX) {
+                Byte(0xd0);
+                Be(static_cast<uint8_t>(value), 1);
+            }
+            else if (value >= INT16_MIN && value <= INT16_MAX) {
+                Byte(0xd1);
+                Be(static_cast<uint16_t>(value), 2);
+            }
+            else if (value >= INT32_MIN && value <= INT32_MAX) {
+                Byte(0xd2);
+                Be(static_cast<uint32_t>(value), 4);
+            }
+            else {
+                Byte(0xd3);
+                Be(static_cast<uint64_t>(value), 8);
+            }
+        }
+        void Double(double value) {
+            uint64_t bits;
+            std::memcpy(&bits, &value, sizeof(bits));
+            Byte(0xcb);
+            Be(bits, 8);
+        }
+        void Str(std::string_view value) {
+            const auto n = value.size();
+            if (n <= 31) {
+                Byte(static_cast<uint8_t>(0xa0 | n));
+            }
+            else {
+                Header(n, 0xd9, 0xda, 0xdb);
+            }
+            _out.append(value);
+        }
+        void Bin(std::string_view value) {
+            Header(value.size(), 0xc4, 0xc5, 0xc6);
+            _out.append(value);
+        }
+        void Array(uint32_t count) {
+            if (count <= 15) {
+                Byte(static_cast<uint8_t>(0x90 | count));
+            }
+            else {
+                Header(count, 0, 0xdc, 0xdd);
+            }
+        }
+        void Map(uint32_t count) {
+            if (count <= 15) {
+                Byte(static_cast<uint8_t>(0x80 | count));
+            }
+            else {
+                Header(count, 0, 0xde, 0xdf);
+            }
+        }
+
+      private:
+        void Byte(uint8_t b) {
+            _out.push_back(static_cast<char>(b));
+        }
+        void Be(uint64_t value, int bytes) {
+            for (int i = bytes - 1; i >= 0; --i) {
+                Byte(static_cast<uint8_t>(value >> (i * 8)));
+            }
+        }
+        // 8/16/32-bit length forms; op8 0 means the type has no 8-bit form.
+        void Header(size_t n, uint8_t op8, uint8_t op16, uint8_t op32) {
+            if (op8 != 0 && n <= 0xff) {
+                Byte(op8);
+                Be(n, 1);
+            }
+            else if (n <= 0xffff) {
+                Byte(op16);
+                Be(n, 2);
+            }
+            else {
+                Byte(op32);
+                Be(n, 4);
+            }
+        }
+
+        std::string &_out;
+    };
+
+    enum class Type : uint8_t { Nil, Bool, Int, UInt, Float, Str, Bin, Array, Map };
+
+    struct Token {
+        Type type    = Type::Nil;
+        bool boolean = false;
+        int64_t i    = 0;
+        uint64_t u   = 0;
+        double f     = 0.0;
+        std::string_view bytes; // Str, Bin
+        uint32_t count = 0;     // Array elements, Map pairs
+    };
+
+    /**
+     * Reads a packed payload one token at a time; containers give their count and their items follow.
+     * Next fails on truncated or unsupported input, and on a container claiming more items than there
+     * are bytes left (each needs at least one), so a forged count cannot drive a huge allocation.
+     */
+    class Reader final {
+      public:
+        explicit Reader(std::string_view data): _data(data) {}
+
+        bool AtEnd() const {
+            return _pos == _data.size();
+        }
+
+        bool Next(Token &token) {
+            uint8_t op;
+            if (!Byte(op)) {
+                return false;
+            }
+            token = Token {};
+            if (op <= 0x7f) {
+                token.type = Type::Int;
+                token.i    = op;
+                return true;
+            }
+            if (op >= 0xe0) {
+                token.type = Type::Int;
+                token.i    = static_cast<int8_t>(op);
+                return true;
+            }
+            if ((op & 0xe0) == 0xa0) {
+                return Bytes(Type::Str, op & 0x1f, token);
+            }
+            if ((op & 0xf0) == 0x90) {
+                return Container(Type::Array, op & 0x0f, token);
+            }
+            if ((op & 0xf0) == 0x80) {
+                return Container(Type::Map, op & 0x0f, token);
+            }
+            uint64_t v = 0;
+            switch (op) {
+            case 0xc0: token.type = Type::Nil; return true;
+            case 0xc2:
+            case 0xc3:
+                token.type    = Type::Bool;
+                token.boolean = op == 0xc3;
+                return true;
+            case 0xc4: return Be(v, 1) && Bytes(Type::Bin, v, token);
+            case 0xc5: return Be(v, 2) && Bytes(Type::Bin, v, token);
+            case 0xc6: return Be(v, 4) && Bytes(Type::Bin, v, token);
+            case 0xca: {
+                if (!Be(v, 4)) {
+                    return false;
+                }
+                const auto bits = static_cast<uint32_t>(v);
+                float f;
+                std::memcpy(&f, &bits, sizeof(f));
+                token.type = Type::Float;
+                token.f    = f;
+                return true;
+            }
+            case 0xcb:
+                if (!Be(v, 8)) {
+                    return false;
+                }
+                token.type = Type::Float;
+                std::memcpy(&token.f, &v, sizeof(token.f));
+                return true;
+            case 0xcc: return UInt(1, token);
+            case 0xcd: return UInt(2, token);
+            case 0xce: return UInt(4, token);
+            case 0xcf: return UInt(8, token);
+            case 0xd0: return Int<int8_t>(1, token);
+            case 0xd1: return Int<int16_t>(2, token);
+            case 0xd2: return Int<int32_t>(4, token);
+            case 0xd3: return Int<int64_t>(8, token);
+            case 0xd9: return Be(v, 1) && Bytes(Type::Str, v, token);
+            case 0xda: return Be(v, 2) && Bytes(Type::Str, v, token);
+            case 0xdb: return Be(v, 4) && Bytes(Type::Str, v, token);
+            case 0xdc: return Be(v, 2) && Container(Type::Array, v, token);
+            case 0xdd: return Be(v, 4) && Container(Type::Array, v, token);
+            case 0xde: return Be(v, 2) && Container(Type::Map, v, token);
+            case 0xdf: return Be(v, 4) && Container(Type::Map, v, token);
+            default: return false;
+            }
+        }
+
+      private:
+        size_t Remaining() const {
+            return _data.size() - _pos;
+        }
+        bool Byte(uint8_t &b) {
+            if (_pos >= _data.size()) {
+                return false;
+            }
+            b = static_cast<uint8_t>(_data[_pos++]);
+            return true;
+        }
+        bool Be(uint64_t &value, int bytes) {
+            if (Remaining() < static_cast<size_t>(bytes)) {
+                return false;
+            }
+            value = 0;
+            for (int i = 0; i < bytes; ++i) {
+                value = (value << 8) | static_cast<uint8_t>(_data[_pos++]);
+            }
+            return true;
+        }
+        bool UInt(int bytes, Token &token) {
+            token.type = Type::UInt;
+            return Be(token.u, bytes);
+        }
+        template <typename T>
+        bool Int(int bytes, Token &token) {
+            uint64_t v;
+            if (!Be(v, bytes)) {
+                return false;
+            }
+            token.type = Type::Int;
+            token.i    = static_cast<T>(v);
+            return true;
+        }
+        bool Bytes(Type type, uint64_t n, Token &token) {
+            if (Remaining() < n) {
+                return false;
+            }
+            token.type  = type;
+            token.bytes = _data.substr(_pos, n);
+            _pos += n;
+            return true;
+        }
+        bool Container(Type type, uint64_t count, Token &token) {
+            // A map pair needs two bytes, an array item one.
+            if (count * (type == Type::Map ? 2 : 1) > Remaining()) {
+                return false;
+            }
+            token.type  = type;
+            token.count = static_cast<uint32_t>(count);
+            return true;
+        }
+
+        std::string_view _data;
+        size_t _pos = 0;
+    };
+} // namespace HogwartsMP::Shared::ScriptPayload
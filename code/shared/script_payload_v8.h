@@ -0,0 +1,175 @@
+#pragma once
+
+#include "script_payload.h"
+
+#include <v8.h>
+
+#include <cmath>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+namespace HogwartsMP::Shared::ScriptPayload {
+    namespace Detail {
+        inline bool PackValue(v8::Isolate *isolate, v8::Local<v8::Context> context, v8::Local<v8::Value> value, Writer &out, int depth) {
+            if (value->IsNullOrUndefined()) {
+                out.Nil();
+                return true;
+            }
+            if (value->IsBoolean()) {
+                out.Bool(value->IsTrue());
+                return true;
+            }
+            if (value->IsNumber()) {
+                const double d = value.As<v8::Number>()->Value();
+                // Whole numbers in the exactly-representable range go as integers: 1-9 bytes, not 9.
+                if (std::trunc(d) == d && std::fabs(d) <= 9007199254740992.0 && !(d == 0.0 && std::signbit(d))) {
+                    out.Int(static_cast<int64_t>(d));
+                }
+                else {
+                    out.Double(d);
+                }
+                return true;
+            }
+            if (value->IsString()) {
+                const auto str = value.As<v8::String>();
+                std::string utf8(static_cast<size_t>(str->Utf8Length(isolate)), '\0');
+                str->WriteUtf8(isolate, utf8.data(), static_cast<int>(utf8.size()), nullptr, v8::String::NO_NULL_TERMINATION);
+                out.Str(utf8);
+                return true;
+            }
+            if (value->IsArrayBuffer() || value->IsArrayBufferView()) {
+                std::string bytes;
+                if (value->IsArrayBuffer()) {
+                    const auto store = value.As<v8::ArrayBuffer>()->GetBackingStore();
+                    bytes.assign(static_cast<const char *>(store->Data()), store->ByteLength());
+                }
+                else {
+                    const auto view = value.As<v8::ArrayBufferView>();
+                    bytes.resize(view->ByteLength());
+                    view->CopyContents(bytes.data(), bytes.size());
+                }
+                out.Bin(bytes);
+                return true;
+            }
+            if (depth >= kMaxDepth || value->IsFunction() || value->IsSymbol() || value->IsBigInt() || !value->IsObject()) {
+                return false;
+            }
+            if (value->IsArray()) {
+                const auto array = value.As<v8::Array>();
+                out.Array(array->Length());
+                for (uint32_t i = 0; i < array->Length(); ++i) {
+                    v8::Local<v8::Value> item;
+                    if (!array->Get(context, i).ToLocal(&item) || !PackValue(isolate, context, item, out, depth + 1)) {
+                        return false;
+                    }
+                }
+                return true;
+            }
+            const auto object = value.As<v8::Object>();
+            v8::Local<v8::Array> keys;
+            if (!object->GetOwnPropertyNames(context).ToLocal(&keys)) {
+                return false;
+            }
+            out.Map(keys->Length());
+            for (uint32_t i = 0; i < keys->Length(); ++i) {
+                v8::Local<v8::Value> key;
+                v8::Local<v8::Value> item;
+                if (!keys->Get(context, i).ToLocal(&key) || !object->Get(context, key).ToLocal(&item)) {
+                    return false;
+                }
+                // Index keys come back as numbers; object keys are always strings on the wire.
+                v8::Local<v8::String> keyString;
+                if (!key->ToString(context).ToLocal(&keyString) || !PackValue(isolate, context, keyString, out, depth + 1) ||
+                    !PackValue(isolate, context, item, out, depth + 1)) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        inline bool UnpackValue(v8::Isolate *isolate, v8::Local<v8::Context> context, Reader &in, int depth, v8::Local<v8::Value> &result) {
+            Token token;
+            if (depth > kMaxDepth || !in.Next(token)) {
+                return false;
+            }
+            switch (token.type) {
+            case Type::Nil: result = v8::Null(isolate); return true;
+            case Type::Bool: result = v8::Boolean::New(isolate, token.boolean); return true;
+            case Type::Int: result = v8::Number::New(isolate, static_cast<double>(token.i)); return true;
+            case Type::UInt: result = v8::Number::New(isolate, static_cast<double>(token.u)); return true;
+            case Type::Float: result = v8::Number::New(isolate, token.f); return true;
+            case Type::Str: {
+                v8::Local<v8::String> str;
+                if (!v8::String::NewFromUtf8(isolate, token.bytes.data(), v8::NewStringType::kNormal, static_cast<int>(token.bytes.size())).ToLocal(&str)) {
+                    return false;
+                }
+                result = str;
+                return true;
+            }
+            case Type::Bin: {
+                auto buffer = v8::ArrayBuffer::New(isolate, token.bytes.size());
+                if (!token.bytes.empty()) {
+                    std::memcpy(buffer->GetBackingStore()->Data(), token.bytes.data(), token.bytes.size());
+                }
+                result = buffer;
+                return true;
+            }
+            case Type::Array: {
+                auto array = v8::Array::New(isolate, static_cast<int>(token.count));
+                for (uint32_t i = 0; i < token.count; ++i) {
+                    v8::Local<v8::Value> item;
+                    if (!UnpackValue(isolate, context, in, depth + 1, item) || array->Set(context, i, item).IsNothing()) {
+                        return false;
+                    }
+                }
+                result = array;
+                return true;
+            }
+            case Type::Map: {
+                auto object = v8::Object::New(isolate);
+                for (uint32_t i = 0; i < token.count; ++i) {
+                    v8::Local<v8::Value> key;
+                    v8::Local<v8::Value> item;
+                    if (!UnpackValue(isolate, context, in, depth + 1, key) || !(key->IsString() || key->IsNumber()) ||
+                        !UnpackValue(isolate, context, in, depth + 1, item)) {
+                        return false;
+                    }
+                    // Data properties only: a "__proto__" key is an own property, never a prototype swap.
+                    v8::Local<v8::String> name;
+                    if (!key->ToString(context).ToLocal(&name) || object->CreateDataProperty(context, name, item).IsNothing()) {
+                        return false;
+                    }
+                }
+                result = object;
+                return true;
+            }
+            default: return false;
+            }
+        }
+    } // namespace Detail
+
+    /**
+     * Pack a JS value (null/undefined, booleans, numbers, strings, ArrayBuffers and typed arrays, arrays
+     * and plain objects, nested up to kMaxDepth) into out. Returns false for anything else — functions,
+     * symbols, BigInts, deeper nesting — or when a getter throws; out is then unspecified.
+     */
+    inline bool Pack(v8::Isolate *isolate, v8::Local<v8::Context> context, v8::Local<v8::Value> value, std::string &out) {
+        Writer writer(out);
+        return Detail::PackValue(isolate, context, value, writer, 0);
+    }
+
+    // The JS value a packed payload holds (undefined stays null; binary comes back as an ArrayBuffer).
+    // Empty on malformed or trailing input, or past the depth and size limits.
+    inline v8::MaybeLocal<v8::Value> Unpack(v8::Isolate *isolate, v8::Local<v8::Context> context, std::string_view data) {
+        if (data.empty() || data.size() > kMaxBytes) {
+            return {};
+        }
+        Reader reader(data);
+        v8::Local<v8::Value> result;
+        if (!Detail::UnpackValue(isolate, context, reader, 0, result) || !reader.AtEnd()) {
+            return {};
+        }
+        return result;
+    }
+} // namespace HogwartsMP::Shared::ScriptPayload
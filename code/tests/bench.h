@@ -0,0 +1,198 @@
+#pragma once
+
+// Minimal micro-benchmark harness for HogwartsMPBench. A benchmark is registered with BENCH(name, fn);
+// fn does its setup, then hands the code under test to State::Run, which calibrates the number of
+// iterations per sample, times kSamples samples and keeps the median. Results print as a table and,
+// with --json, as machine-readable JSON that a later run compares against with --baseline.
+
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace HogwartsMP::Bench {
+    // Keep the compiler from discarding a result the benchmark never reads.
+    template <typename T>
+    inline void DoNotOptimize(const T &value) {
+#if defined(_MSC_VER)
+        static const void *volatile sink;
+        sink = &value;
+        _ReadWriteBarrier();
+#else
+        asm volatile("" : : "r,m"(value) : "memory");
+#endif
+    }
+
+    struct Options {
+        double sampleMs = 50.0;   // calibrate each sample to at least this long
+        double maxMs    = 5000.0; // stop sampling a benchmark once it has run this long
+        std::string filter;       // run only names containing this
+    };
+
+    struct Result {
+        std::string name;
+        uint64_t iterations = 0; // per sample
+        size_t samples      = 0;
+        double nsPerOp      = 0; // median over the samples
+        double minNsPerOp   = 0;
+        uint64_t bytesPerOp = 0; // 0 = not a throughput benchmark
+    };
+
+    class State final {
+      public:
+        static constexpr size_t kSamples = 5;
+
+        explicit State(const Options &options): _options(options) {}
+
+        // Time body(n), which must run the operation n times. Called once per benchmark; a benchmark that
+        // can't run here (say, no scripting engine) returns without calling it and is reported skipped.
+        void Run(const std::function<void(uint64_t n)> &body) {
+            using Clock = std::chrono::steady_clock;
+            const auto timeBatch = [&](uint64_t n) {
+                const auto start = Clock::now();
+                body(n);
+                return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+            };
+
+            // Grow the batch until it takes a sample's worth of time (a slow operation stops at 1).
+            const double sampleNs = _options.sampleMs * 1e6;
+            uint64_t n            = 1;
+            double ns             = timeBatch(n);
+            double totalNs        = ns;
+            while (ns < sampleNs) {
+                const double perOp = std::max(ns / static_cast<double>(n), 1.0);
+                n                  = std::max(n * 2, static_cast<uint64_t>(sampleNs * 1.2 / perOp));
+                ns                 = timeBatch(n);
+                totalNs += ns;
+            }
+
+            std::vector<double> perOp {ns / static_cast<double>(n)};
+            while (perOp.size() < kSamples && totalNs < _options.maxMs * 1e6) {
+                ns = timeBatch(n);
+                totalNs += ns;
+                perOp.push_back(ns / static_cast<double>(n));
+            }
+            std::sort(perOp.begin(), perOp.end());
+            _result.iterations = n;
+            _result.samples    = perOp.size();
+            _result.nsPerOp    = perOp[perOp.size() / 2];
+            _result.minNsPerOp = perOp.front();
+        }
+
+        // Bytes one operation processes, to report throughput.
+        void SetBytesPerOp(uint64_t bytes) {
+            _result.bytesPerOp = bytes;
+        }
+
+        Result &GetResult() {
+            return _result;
+        }
+
+      private:
+        const Options &_options;
+        Result _result;
+    };
+
+    struct Benchmark {
+        const char *name;
+        std::function<void(State &)> fn;
+    };
+
+    inline std::vector<Benchmark> &Registry() {
+        static std::vector<Benchmark> benchmarks;
+        return benchmarks;
+    }
+
+    inline std::vector<Result> RunAll(const Options &options) {
+        std::vector<Result> results;
+        for (const auto &bench : Registry()) {
+            if (!options.filter.empty() && std::string(bench.name).find(options.filter) == std::string::npos) {
+                continue;
+            }
+            State state(options);
+            bench.fn(state);
+            auto &result = state.GetResult();
+            result.name  = bench.name;
+            if (result.samples == 0) {
+                std::printf("%-48s skipped\n", result.name.c_str());
+                continue;
+            }
+            if (result.bytesPerOp != 0) {
+                std::printf("%-48s %14.1f ns/op %10.1f MB/s  (%llu x %zu)\n", result.name.c_str(), result.nsPerOp, result.bytesPerOp / result.nsPerOp * 1e3,
+                            static_cast<unsigned long long>(result.iterations), result.samples);
+            }
+            else {
+                std::printf("%-48s %14.1f ns/op               (%llu x %zu)\n", result.name.c_str(), result.nsPerOp, static_cast<unsigned long long>(result.iterations),
+                            result.samples);
+            }
+            std::fflush(stdout);
+            results.push_back(std::move(result));
+        }
+        return results;
+    }
+
+    inline nlohmann::json ToJson(const std::vector<Result> &results) {
+        nlohmann::json list = nlohmann::json::array();
+        for (const auto &result : results) {
+            list.push_back({
+                {"name", result.name},
+                {"iterations", result.iterations},
+                {"samples", result.samples},
+                {"ns_per_op", result.nsPerOp},
+                {"min_ns_per_op", result.minNsPerOp},
+                {"bytes_per_op", result.bytesPerOp},
+            });
+        }
+        return {{"benchmarks", std::move(list)}};
+    }
+
+    // Compare against a baseline written by --json. A benchmark regresses when its median is more than
+    // thresholdPct slower than the baseline's; benchmarks missing from either side are skipped. Returns
+    // the number of regressions, or -1 if the baseline can't be read.
+    inline int CompareToBaseline(const std::vector<Result> &results, const std::string &path, double thresholdPct) {
+        std::ifstream in(path);
+        nlohmann::json baseline;
+        try {
+            baseline = nlohmann::json::parse(in);
+        }
+        catch (const nlohmann::json::exception &) {
+            std::fprintf(stderr, "Cannot read baseline %s\n", path.c_str());
+            return -1;
+        }
+        if (!baseline.contains("benchmarks") || !baseline["benchmarks"].is_array()) {
+            std::fprintf(stderr, "Baseline %s has no \"benchmarks\" array\n", path.c_str());
+            return -1;
+        }
+
+        int regressions = 0;
+        std::printf("\nAgainst %s (threshold +%.1f%%):\n", path.c_str(), thresholdPct);
+        for (const auto &result : results) {
+            const auto it = std::find_if(baseline["benchmarks"].begin(), baseline["benchmarks"].end(), [&](const nlohmann::json &entry) {
+                return entry.value("name", "") == result.name;
+            });
+            if (it == baseline["benchmarks"].end() || it->value("ns_per_op", 0.0) <= 0.0) {
+                continue;
+            }
+            const double change  = (result.nsPerOp / it->value("ns_per_op", 0.0) - 1.0) * 100.0;
+            const bool regressed = change > thresholdPct;
+            regressions += regressed ? 1 : 0;
+            std::printf("%-48s %+8.1f%%%s\n", result.name.c_str(), change, regressed ? "  REGRESSION" : "");
+        }
+        return regressions;
+    }
+} // namespace HogwartsMP::Bench
+
+#define BENCH_CONCAT_(a, b) a##b
+#define BENCH_CONCAT(a, b)  BENCH_CONCAT_(a, b)
+#define BENCH(name, ...)                                                                                                     \
+    inline const bool BENCH_CONCAT(bench_, __COUNTER__) = (HogwartsMP::Bench::Registry().push_back({name, __VA_ARGS__}), true);
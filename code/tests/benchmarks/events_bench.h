@@ -0,0 +1,119 @@
+#pragma once
+
+#include "bench.h"
+
+#include "scripting/node_engine.h"
+
+#include "core/builtins/events.h"
+
+#include <algorithm>
+#include <memory>
+#include <string>
+
+// EmitServerEvent reaches JS through the running Server's scripting module, which can't be stood up
+// here. So emit/no_server measures what a native hook pays when no scripting is running (the early
+// out), and dispatch/* does what EmitServerEvent does once it has an engine — lock and enter the
+// isolate and context, build the args, call into JS — against a NodeEngine with plain JS listeners.
+// The batched variants enter the isolate once per 64 events, as the server's per-tick drain does.
+namespace HogwartsMP::Bench::Events {
+    using Framework::Scripting::NodeEngine;
+    using Framework::Scripting::ScriptingError;
+
+    inline std::unique_ptr<NodeEngine> &EngineSlot() {
+        static std::unique_ptr<NodeEngine> engine;
+        return engine;
+    }
+
+    // One engine for every dispatch benchmark, started on first use (Node can't be brought up twice in
+    // a process); nullptr if it fails to start.
+    inline NodeEngine *Engine() {
+        static const bool started = [] {
+            auto &engine = EngineSlot();
+            engine.reset(new NodeEngine({}));
+            if (engine->Init() != ScriptingError::SCRIPTING_NONE) {
+                engine.reset();
+            }
+            return true;
+        }();
+        (void)started;
+        return EngineSlot().get();
+    }
+
+    inline void Shutdown() {
+        if (auto &engine = EngineSlot()) {
+            engine->Shutdown();
+            engine.reset();
+        }
+    }
+
+    inline void Dispatch(State &state, int listeners, uint64_t batch = 1) {
+        auto *engine = Engine();
+        if (!engine) {
+            return;
+        }
+        v8::Isolate *isolate = engine->GetIsolate();
+        v8::Global<v8::Function> emit;
+        {
+            v8::Locker locker(isolate);
+            v8::Isolate::Scope isolateScope(isolate);
+            v8::HandleScope handleScope(isolate);
+            v8::Local<v8::Context> context = engine->GetContext();
+            v8::Context::Scope contextScope(context);
+            const std::string src = "(() => { const handlers = []; for (let i = 0; i < " + std::to_string(listeners) +
+                                    "; ++i) handlers.push((name, id) => { globalThis.bench_last = id; });"
+                                    " return (name, ...args) => { for (const h of handlers) h(name, ...args); }; })()";
+            auto script = v8::Script::Compile(context, v8::String::NewFromUtf8(isolate, src.c_str()).ToLocalChecked()).ToLocalChecked();
+            emit.Reset(isolate, script->Run(context).ToLocalChecked().As<v8::Function>());
+        }
+
+        state.Run([&](uint64_t n) {
+            for (uint64_t i = 0; i < n; i += batch) {
+                v8::Locker locker(isolate);
+                v8::Isolate::Scope isolateScope(isolate);
+                v8::HandleScope handleScope(isolate);
+                v8::Local<v8::Context> context = engine->GetContext();
+                v8::Context::Scope contextScope(context);
+
+                for (uint64_t j = i; j < std::min(n, i + batch); ++j) {
+                    v8::HandleScope eventScope(isolate);
+                    v8::Local<v8::Value> args[] = {v8::String::NewFromUtf8Literal(isolate, "playerConnect"), v8::Number::New(isolate, static_cast<double>(j))};
+                    DoNotOptimize(emit.Get(isolate)->Call(context, v8::Undefined(isolate), 2, args).IsEmpty());
+                }
+            }
+        });
+        emit.Reset();
+    }
+} // namespace HogwartsMP::Bench::Events
+
+BENCH("events/emit/no_server", [](HogwartsMP::Bench::State &state) {
+    const HogwartsMP::Scripting::EventArgsBuilder build = [](v8::Isolate *, v8::Local<v8::Context>, std::vector<v8::Local<v8::Value>> &) {};
+    state.Run([&](uint64_t n) {
+        for (uint64_t i = 0; i < n; ++i) {
+            HogwartsMP::Scripting::EmitServerEvent("playerConnect", build);
+        }
+    });
+});
+BENCH("events/dispatch/0_listeners", [](HogwartsMP::Bench::State &state) {
+    HogwartsMP::Bench::Events::Dispatch(state, 0);
+});
+BENCH("events/dispatch/1_listener", [](HogwartsMP::Bench::State &state) {
+    HogwartsMP::Bench::Events::Dispatch(state, 1);
+});
+BENCH("events/dispatch/8_listeners", [](HogwartsMP::Bench::State &state) {
+    HogwartsMP::Bench::Events::Dispatch(state, 8);
+});
+BENCH("events/dispatch/1_listener_batch_64", [](HogwartsMP::Bench::State &state) {
+    HogwartsMP::Bench::Events::Dispatch(state, 1, 64);
+});
+BENCH("events/queue/push_chat_and_clear_64", [](HogwartsMP::Bench::State &state) {
+    HogwartsMP::Core::Events::EventQueue queue;
+    const std::string message = "hello from a load-test bot";
+    state.Run([&](uint64_t n) {
+        for (uint64_t i = 0; i < n; ++i) {
+            queue.PushChatMessage(i, message);
+            if (queue.Size() == 64) {
+                queue.Clear();
+            }
+        }
+    });
+});
@@ -0,0 +1,114 @@
+#pragma once
+
+#include "bench.h"
+
+#include "core/storage/key_value_store.h"
+
+#include <filesystem>
+#include <string>
+
+namespace HogwartsMP::Bench::Storage {
+    using HogwartsMP::Core::Storage::KeyValueStore;
+    using HogwartsMP::Core::Storage::SnapshotFormat;
+
+    inline const std::string kDir = "bench_kv";
+
+    // A store shaped like a live one: namespaced keys, short JSON values.
+    inline void Fill(KeyValueStore &store, size_t keys) {
+        for (size_t i = 0; i < keys; ++i) {
+            store.Set("player:" + std::to_string(i) + ":stats", R"({"gold":)" + std::to_string(i * 7 % 1000) + R"(,"house":"Ravenclaw"})");
+        }
+    }
+
+    inline uint64_t FileBytes(const std::string &path) {
+        std::error_code ec;
+        const auto size = std::filesystem::file_size(path, ec);
+        return ec ? 0 : size;
+    }
+
+    // SaveTo: the JSON export, whatever the snapshot format.
+    inline void SaveJson(State &state, size_t keys) {
+        std::filesystem::create_directories(kDir);
+        const std::string path = kDir + "/save.json";
+        KeyValueStore store;
+        Fill(store, keys);
+        state.Run([&](uint64_t n) {
+            for (uint64_t i = 0; i < n; ++i) {
+                DoNotOptimize(store.SaveTo(path));
+            }
+        });
+        state.SetBytesPerOp(FileBytes(path));
+        std::filesystem::remove(path);
+    }
+
+    inline void LoadJson(State &state, size_t keys) {
+        std::filesystem::create_directories(kDir);
+        const std::string path = kDir + "/load.json";
+        {
+            KeyValueStore source;
+            Fill(source, keys);
+            source.SaveTo(path);
+        }
+        KeyValueStore store;
+        state.Run([&](uint64_t n) {
+            for (uint64_t i = 0; i < n; ++i) {
+                DoNotOptimize(store.LoadFrom(path));
+            }
+        });
+        state.SetBytesPerOp(FileBytes(path));
+        std::filesystem::remove(path);
+    }
+
+    // Save / Load of the binary snapshot (Snapshot mode, so every Save writes the whole table).
+    inline void SaveBinary(State &state, size_t keys) {
+        std::filesystem::create_directories(kDir);
+        const std::string path = kDir + "/save.kvs";
+        KeyValueStore store(path);
+        store.SetSnapshotFormat(SnapshotFormat::Binary);
+        Fill(store, keys);
+        state.Run([&](uint64_t n) {
+            for (uint64_t i = 0; i < n; ++i) {
+                DoNotOptimize(store.Save());
+            }
+        });
+        state.SetBytesPerOp(FileBytes(path));
+        std::filesystem::remove(path);
+    }
+
+    inline void LoadBinary(State &state, size_t keys) {
+        std::filesystem::create_directories(kDir);
+        const std::string path = kDir + "/load.kvs";
+        {
+            KeyValueStore source(path);
+            source.SetSnapshotFormat(SnapshotFormat::Binary);
+            Fill(source, keys);
+            source.Save();
+        }
+        KeyValueStore store(path);
+        state.Run([&](uint64_t n) {
+            for (uint64_t i = 0; i < n; ++i) {
+                DoNotOptimize(store.Load());
+            }
+        });
+        // No throughput: Load maps the file rather than reading it.
+        std::filesystem::remove(path);
+    }
+} // namespace HogwartsMP::Bench::Storage
+
+#define STORAGE_BENCH(label, keys)                                                                                         \
+    BENCH("kvs/save_to/json/" label, [](HogwartsMP::Bench::State &state) {                                               \
+        HogwartsMP::Bench::Storage::SaveJson(state, keys);                                                                 \
+    });                                                                                                                    \
+    BENCH("kvs/load_from/json/" label, [](HogwartsMP::Bench::State &state) {                                             \
+        HogwartsMP::Bench::Storage::LoadJson(state, keys);                                                                 \
+    });                                                                                                                    \
+    BENCH("kvs/save/binary/" label, [](HogwartsMP::Bench::State &state) {                                                \
+        HogwartsMP::Bench::Storage::SaveBinary(state, keys);                                                               \
+    });                                                                                                                    \
+    BENCH("kvs/load/binary/" label, [](HogwartsMP::Bench::State &state) {                                                \
+        HogwartsMP::Bench::Storage::LoadBinary(state, keys);                                                               \
+    });
+
+STORAGE_BENCH("1k", 1'000)
+STORAGE_BENCH("100k", 100'000)
+STORAGE_BENCH("1m", 1'000'000)
@@ -0,0 +1,179 @@
+#pragma once
+
+#include "bench.h"
+
+#include "shared/chat_command.h"
+#include "shared/modules/appearance.hpp"
+#include "shared/modules/mount_records.hpp"
+#include "shared/modules/spell_records.hpp"
+
+#include <mafianet/BitStream.h>
+
+#include <array>
+#include <string>
+#include <vector>
+
+namespace HogwartsMP::Bench::Wire {
+    using namespace HogwartsMP::Shared::Modules;
+    namespace Replication = Framework::Networking::Replication;
+
+    inline CcdPiece MakePiece(const std::string &name, size_t scalars, size_t vectors, size_t textures) {
+        CcdPiece piece;
+        piece.characterPiece = "/Game/Data/CC/CharacterPieces/" + name + "/DA_" + name + ".DA_" + name;
+        for (size_t i = 0; i < scalars; ++i) {
+            piece.scalars.emplace_back("Scalar_" + std::to_string(i), 0.25f * static_cast<float>(i));
+        }
+        for (size_t i = 0; i < vectors; ++i) {
+            piece.vectors.emplace_back("Tint_" + std::to_string(i), std::array<float, 4> {0.8f, 0.6f, 0.5f, 1.0f});
+        }
+        for (size_t i = 0; i < textures; ++i) {
+            piece.textures.emplace_back("Texture_" + std::to_string(i), "/Game/RiggedObjects/Characters/Human/Textures/T_" + name + "_" + std::to_string(i));
+        }
+        return piece;
+    }
+
+    // A typical player: a handful of bone scales, the four body slots with a realistic set of identity
+    // overrides, and one eight-piece outfit.
+    inline CcdProfile RealisticProfile() {
+        CcdProfile ccd;
+        ccd.gender = 1;
+        ccd.scale  = 1.02f;
+        for (size_t i = 0; i < 12; ++i) {
+            ccd.boneScales.emplace_back("bone_" + std::to_string(i), 1.0f);
+        }
+        for (const char *slot : {"Head", "Hair", "Arms", "Legs"}) {
+            ccd.characterItems.emplace_back(slot, MakePiece(slot, 6, 5, 4));
+        }
+        CcdPieceMap outfit;
+        for (size_t i = 0; i < 8; ++i) {
+            outfit.emplace_back("Slot" + std::to_string(i), MakePiece("Robe" + std::to_string(i), 1, 2, 1));
+        }
+        ccd.outfits.emplace_back("Default", std::move(outfit));
+        return ccd;
+    }
+
+    // Every count at its cap: the largest profile a peer can make the server read, store and relay.
+    inline CcdProfile MaxCapProfile() {
+        CcdProfile ccd;
+        for (uint32_t i = 0; i < kMaxCcdBoneScales; ++i) {
+            ccd.boneScales.emplace_back("bone_" + std::to_string(i), 1.0f);
+        }
+        const auto fullMap = [](const std::string &prefix) {
+            CcdPieceMap map;
+            for (uint32_t i = 0; i < kMaxCcdPieces; ++i) {
+                map.emplace_back(prefix + std::to_string(i), MakePiece(prefix + std::to_string(i), kMaxCcdOverrides, kMaxCcdOverrides, kMaxCcdOverrides));
+            }
+            return map;
+        };
+        ccd.characterItems = fullMap("Body");
+        for (uint32_t i = 0; i < kMaxCcdOutfits; ++i) {
+            ccd.outfits.emplace_back("Outfit" + std::to_string(i), fullMap("Outfit" + std::to_string(i) + "_"));
+        }
+        return ccd;
+    }
+
+    inline void SerializeWrite(State &state, CcdProfile ccd) {
+        MafiaNet::BitStream bs;
+        state.Run([&](uint64_t n) {
+            for (uint64_t i = 0; i < n; ++i) {
+                bs.Reset();
+                Replication::FieldSerializer fs(&bs, true);
+                SerializeCcd(fs, ccd);
+                DoNotOptimize(bs.GetNumberOfBitsUsed());
+            }
+        });
+        state.SetBytesPerOp(bs.GetNumberOfBytesUsed());
+    }
+
+    inline void SerializeRead(State &state, CcdProfile ccd) {
+        MafiaNet::BitStream bs;
+        {
+            Replication::FieldSerializer fs(&bs, true);
+            SerializeCcd(fs, ccd);
+        }
+        state.Run([&](uint64_t n) {
+            for (uint64_t i = 0; i < n; ++i) {
+                bs.ResetReadPointer();
+                CcdProfile in;
+                Replication::FieldSerializer fs(&bs, false);
+                SerializeCcd(fs, in);
+                DoNotOptimize(in);
+            }
+        });
+        state.SetBytesPerOp(bs.GetNumberOfBytesUsed());
+    }
+
+    inline void Sanitize(State &state, const CcdProfile &ccd) {
+        // Every path is allowlisted, so each run checks the whole profile and changes nothing.
+        CcdProfile profile = ccd;
+        state.Run([&](uint64_t n) {
+            for (uint64_t i = 0; i < n; ++i) {
+                SanitizeCcd(profile);
+                DoNotOptimize(profile);
+            }
+        });
+    }
+
+    inline void ParseChat(State &state, const std::string &text) {
+        state.Run([&](uint64_t n) {
+            for (uint64_t i = 0; i < n; ++i) {
+                const auto parsed = HogwartsMP::Shared::ParseChatCommand(text);
+                DoNotOptimize(parsed);
+            }
+        });
+    }
+
+    // Looks up each name in turn, so hits across the whole table and a miss are all measured.
+    template <typename Lookup>
+    inline void RecordIds(State &state, std::vector<std::string> names, Lookup lookup) {
+        state.Run([&](uint64_t n) {
+            for (uint64_t i = 0; i < n; ++i) {
+                for (const auto &name : names) {
+                    DoNotOptimize(lookup(name));
+                }
+            }
+        });
+    }
+
+    inline std::vector<std::string> Sampled(const auto &table, std::string miss) {
+        std::vector<std::string> names {std::string(table.front()), std::string(table[table.size() / 2]), std::string(table.back()), std::move(miss)};
+        return names;
+    }
+} // namespace HogwartsMP::Bench::Wire
+
+BENCH("ccd/write/realistic", [](HogwartsMP::Bench::State &state) {
+    HogwartsMP::Bench::Wire::SerializeWrite(state, HogwartsMP::Bench::Wire::RealisticProfile());
+});
+BENCH("ccd/write/max_cap", [](HogwartsMP::Bench::State &state) {
+    HogwartsMP::Bench::Wire::SerializeWrite(state, HogwartsMP::Bench::Wire::MaxCapProfile());
+});
+BENCH("ccd/read/realistic", [](HogwartsMP::Bench::State &state) {
+    HogwartsMP::Bench::Wire::SerializeRead(state, HogwartsMP::Bench::Wire::RealisticProfile());
+});
+BENCH("ccd/read/max_cap", [](HogwartsMP::Bench::State &state) {
+    HogwartsMP::Bench::Wire::SerializeRead(state, HogwartsMP::Bench::Wire::MaxCapProfile());
+});
+BENCH("ccd/sanitize/realistic", [](HogwartsMP::Bench::State &state) {
+    HogwartsMP::Bench::Wire::Sanitize(state, HogwartsMP::Bench::Wire::RealisticProfile());
+});
+BENCH("ccd/sanitize/max_cap", [](HogwartsMP::Bench::State &state) {
+    HogwartsMP::Bench::Wire::Sanitize(state, HogwartsMP::Bench::Wire::MaxCapProfile());
+});
+BENCH("chat/parse/message", [](HogwartsMP::Bench::State &state) {
+    HogwartsMP::Bench::Wire::ParseChat(state, "meet me at the Three Broomsticks after class");
+});
+BENCH("chat/parse/command", [](HogwartsMP::Bench::State &state) {
+    HogwartsMP::Bench::Wire::ParseChat(state, "/time 11 30");
+});
+BENCH("records/spell_id_x4", [](HogwartsMP::Bench::State &state) {
+    using namespace HogwartsMP::Shared::Modules;
+    HogwartsMP::Bench::Wire::RecordIds(state, HogwartsMP::Bench::Wire::Sampled(kSpellRecords, "/Game/Gameplay/ToolSet/Spells/Unknown/DA_Unknown.DA_Unknown"), [](const std::string &path) {
+        return SpellRecordId(path);
+    });
+});
+BENCH("records/mount_id_x4", [](HogwartsMP::Bench::State &state) {
+    using namespace HogwartsMP::Shared::Modules;
+    HogwartsMP::Bench::Wire::RecordIds(state, HogwartsMP::Bench::Wire::Sampled(kMountClasses, "BP_FlyingBroomCapsule_Unknown_C"), [](const std::string &name) {
+        return MountClassId(name);
+    });
+});
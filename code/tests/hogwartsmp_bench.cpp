@@ -0,0 +1,77 @@
+#include "logging/logger.h"
+#include "bench.h"
+
+#include "benchmarks/events_bench.h"
+#include "benchmarks/storage_bench.h"
+#include "benchmarks/wire_bench.h"
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+// HogwartsMPBench [--filter <substring>] [--json <out.json>] [--baseline <in.json>] [--threshold <pct>]
+//                 [--sample-ms <ms>] [--max-ms <ms>]
+// Exits 1 when --baseline is given and a benchmark is more than --threshold percent (default 10)
+// slower than it, 2 on a usage or I/O error.
+int main(int argc, char **argv) {
+    HogwartsMP::Bench::Options options;
+    std::string jsonPath;
+    std::string baselinePath;
+    double thresholdPct = 10.0;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            std::fprintf(stderr, "Missing value for %s\n", arg.c_str());
+            return 2;
+        }
+        const char *value = argv[++i];
+        if (arg == "--filter") {
+            options.filter = value;
+        }
+        else if (arg == "--json") {
+            jsonPath = value;
+        }
+        else if (arg == "--baseline") {
+            baselinePath = value;
+        }
+        else if (arg == "--threshold") {
+            thresholdPct = std::atof(value);
+        }
+        else if (arg == "--sample-ms") {
+            options.sampleMs = std::atof(value);
+        }
+        else if (arg == "--max-ms") {
+            options.maxMs = std::atof(value);
+        }
+        else {
+            std::fprintf(stderr, "Unknown option %s\n", arg.c_str());
+            return 2;
+        }
+    }
+
+    Framework::Logging::GetInstance()->PauseLogging(true);
+
+    const auto results = HogwartsMP::Bench::RunAll(options);
+    HogwartsMP::Bench::Events::Shutdown();
+    std::error_code ec;
+    std::filesystem::remove_all(HogwartsMP::Bench::Storage::kDir, ec);
+
+    if (!jsonPath.empty()) {
+        std::ofstream out(jsonPath);
+        out << HogwartsMP::Bench::ToJson(results).dump(2) << '\n';
+        if (!out) {
+            std::fprintf(stderr, "Cannot write %s\n", jsonPath.c_str());
+            return 2;
+        }
+    }
+    if (!baselinePath.empty()) {
+        const int regressions = HogwartsMP::Bench::CompareToBaseline(results, baselinePath, thresholdPct);
+        if (regressions < 0) {
+            return 2;
+        }
+        return regressions == 0 ? 0 : 1;
+    }
+    return 0;
+}
@@ -1,10 +1,14 @@
-#define UNIT_MAX_MODULES 8
+#define UNIT_MAX_MODULES 9
 #include "logging/logger.h"
 #include "unit.h"
 
+#include "modules/capture_ut.h"
 #include "modules/chat_command_ut.h"
+#include "modules/crowd_ut.h"
+#include "modules/event_queue_ut.h"
 #include "modules/rpc_ut.h"
 #include "modules/js_builtins_ut.h"
+#include "modules/metrics_ut.h"
 #include "modules/storage_ut.h"
 #include "modules/world_players_ut.h"
 
@@ -13,9 +17,13 @@ int main() {
 
     Framework::Logging::GetInstance()->PauseLogging(true);
 
+    UNIT_MODULE(capture);
     UNIT_MODULE(chat_command);
+    UNIT_MODULE(crowd);
+    UNIT_MODULE(event_queue);
     UNIT_MODULE(rpc);
     UNIT_MODULE(js_builtins);
+    UNIT_MODULE(metrics);
     UNIT_MODULE(storage);
     UNIT_MODULE(world_players);
 
@@ -0,0 +1,233 @@
+#pragma once
+
+#include "core/replay/capture_file.h"
+#include "core/replay/recorder.h"
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+MODULE(capture, {
+    using HogwartsMP::Core::Replay::CaptureReader;
+    using HogwartsMP::Core::Replay::CaptureWriter;
+    using HogwartsMP::Core::Replay::Record;
+    using HogwartsMP::Core::Replay::RecordKind;
+    using HogwartsMP::Core::Replay::Recorder;
+    using HogwartsMP::Core::Replay::StateSample;
+
+    const std::string path = "capture_ut.hmpcap";
+
+    const auto readAll = [](const std::string &file, bool *clean = nullptr) {
+        std::vector<Record> records;
+        CaptureReader reader;
+        if (reader.Open(file)) {
+            Record r;
+            while (reader.Next(r)) {
+                records.push_back(r);
+            }
+            if (clean) {
+                *clean = reader.Clean();
+            }
+        }
+        return records;
+    };
+
+    IT("round-trips every record kind with its timestamps", {
+        CaptureWriter writer;
+        EQUALS(writer.Open(path, 1700000000123ull), true);
+
+        Record connect;
+        connect.kind      = RecordKind::Connect;
+        connect.atUs      = 10;
+        connect.peer      = 0xFEEDFACECAFEull;
+        connect.networkId = 42;
+        connect.name      = "Harry";
+        connect.text      = "hwid-1";
+        writer.Write(connect);
+
+        Record event;
+        event.kind = RecordKind::ClientEvent;
+        event.atUs = 2500;
+        event.peer = connect.peer;
+        event.name = "castSpell";
+        event.text = R"({"spell":"Lumos"})";
+        writer.Write(event);
+
+        Record command;
+        command.kind = RecordKind::ChatCommand;
+        command.atUs = 2500;
+        command.peer = connect.peer;
+        command.text = "/tp 1 2";
+        command.name = "tp";
+        command.args = {"1", "2"};
+        writer.Write(command);
+
+        Record state;
+        state.kind                = RecordKind::State;
+        state.atUs                = 33000;
+        state.peer                = connect.peer;
+        state.state.position      = {1.5f, -2.25f, 3000.0f};
+        state.state.rotation      = {0.7071f, 0.0f, 0.0f, 0.7071f};
+        state.state.velocity      = {0.0f, 350.0f, 0.0f};
+        state.state.stateFlags    = 0x0A;
+        state.state.data.spellId  = 7;
+        state.state.data.aimPitch = -20;
+        writer.Write(state);
+
+        Record tick;
+        tick.kind = RecordKind::Tick;
+        tick.atUs = 33100;
+        writer.Write(tick);
+        writer.Close();
+
+        CaptureReader reader;
+        EQUALS(reader.Open(path), true);
+        EQUALS(reader.StartUnixMs(), 1700000000123ull);
+        std::vector<Record> records;
+        Record r;
+        while (reader.Next(r)) {
+            records.push_back(r);
+        }
+        EQUALS(reader.Clean(), true);
+        EQUALS(records.size(), (size_t)5);
+
+        EQUALS(records[0].kind, RecordKind::Connect);
+        EQUALS(records[0].atUs, (uint64_t)10);
+        EQUALS(records[0].peer, connect.peer);
+        EQUALS(records[0].networkId, (uint64_t)42);
+        STREQUALS(records[0].name.c_str(), "Harry");
+        STREQUALS(records[0].text.c_str(), "hwid-1");
+
+        EQUALS(records[1].atUs, (uint64_t)2500);
+        STREQUALS(records[1].name.c_str(), "castSpell");
+        STREQUALS(records[1].text.c_str(), R"({"spell":"Lumos"})");
+
+        EQUALS(records[2].kind, RecordKind::ChatCommand);
+        STREQUALS(records[2].name.c_str(), "tp");
+        EQUALS(records[2].args.size(), (size_t)2);
+        STREQUALS(records[2].args[1].c_str(), "2");
+
+        EQUALS(records[3].kind, RecordKind::State);
+        EQUALS(records[3].state == state.state, true);
+
+        EQUALS(records[4].kind, RecordKind::Tick);
+        EQUALS(records[4].atUs, (uint64_t)33100);
+        std::remove(path.c_str());
+    });
+
+    IT("replays a truncated capture up to its last complete record", {
+        CaptureWriter writer;
+        writer.Open(path, 0);
+        for (int i = 0; i < 3; ++i) {
+            Record chat;
+            chat.kind = RecordKind::Chat;
+            chat.atUs = static_cast<uint64_t>(i) * 1000;
+            chat.peer = 7;
+            chat.text = "line " + std::to_string(i);
+            writer.Write(chat);
+        }
+        writer.Close();
+
+        std::string bytes;
+        {
+            std::ifstream in(path, std::ios::binary);
+            bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        }
+        {
+            std::ofstream out(path, std::ios::binary | std::ios::trunc);
+            out.write(bytes.data(), static_cast<std::streamsize>(bytes.size() - 3));
+        }
+
+        bool clean = true;
+        const auto records = readAll(path, &clean);
+        EQUALS(records.size(), (size_t)2);
+        EQUALS(clean, false);
+        STREQUALS(records[1].text.c_str(), "line 1");
+        std::remove(path.c_str());
+    });
+
+    IT("skips record kinds it does not know", {
+        std::string bytes;
+        {
+            CaptureWriter writer;
+            writer.Open(path, 0);
+            writer.Close();
+            std::ifstream in(path, std::ios::binary);
+            bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        }
+        // kind 200, dt 5, a 3-byte body; then a Tick.
+        bytes += std::string("\xC8\x05\x03xyz", 6);
+        Record tick;
+        tick.kind = RecordKind::Tick;
+        tick.atUs = 9;
+        CaptureWriter::Encode(bytes, tick, 5);
+        {
+            std::ofstream out(path, std::ios::binary | std::ios::trunc);
+            out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+        }
+
+        bool clean = false;
+        const auto records = readAll(path, &clean);
+        EQUALS(records.size(), (size_t)1);
+        EQUALS(records[0].kind, RecordKind::Tick);
+        EQUALS(records[0].atUs, (uint64_t)9);
+        EQUALS(clean, true);
+        std::remove(path.c_str());
+    });
+
+    IT("rejects a file that is not a capture", {
+        {
+            std::ofstream out(path, std::ios::binary | std::ios::trunc);
+            out << "{\"not\":\"a capture\"}";
+        }
+        CaptureReader reader;
+        EQUALS(reader.Open(path), false);
+        EQUALS(reader.Open("missing_capture.hmpcap"), false);
+        std::remove(path.c_str());
+    });
+
+    IT("records avatar state only when it changes", {
+        uint64_t nowUs = 5000;
+        Recorder recorder;
+        recorder.SetClock([&] {
+            return nowUs;
+        });
+        EQUALS(recorder.IsActive(), false);
+        recorder.Tick(); // inactive: a no-op
+        EQUALS(recorder.Start(path), true);
+
+        StateSample still;
+        still.position = {100.0f, 200.0f, 0.0f};
+        recorder.Connect(1, 11, "Ron", "hwid-r");
+        for (int i = 0; i < 3; ++i) {
+            nowUs += 33000;
+            recorder.State(1, still);
+            recorder.Tick();
+        }
+        StateSample moved = still;
+        moved.position[0] = 150.0f;
+        nowUs += 33000;
+        recorder.State(1, moved);
+        recorder.Tick();
+        recorder.Disconnect(1);
+        recorder.Stop();
+        EQUALS(recorder.Healthy(), true);
+
+        const auto records = readAll(path);
+        std::vector<RecordKind> kinds;
+        for (const auto &r : records) {
+            kinds.push_back(r.kind);
+        }
+        const std::vector<RecordKind> expected = {
+            RecordKind::Connect, RecordKind::State, RecordKind::Tick, RecordKind::Tick, RecordKind::Tick,
+            RecordKind::State,   RecordKind::Tick,  RecordKind::Disconnect,
+        };
+        EQUALS(kinds == expected, true);
+        EQUALS(records[0].atUs, (uint64_t)0);
+        EQUALS(records[1].atUs, (uint64_t)33000);
+        EQUALS(records[5].state.position[0], 150.0f);
+        EQUALS(records[7].atUs, (uint64_t)132000);
+        std::remove(path.c_str());
+    });
+});
@@ -0,0 +1,130 @@
+#pragma once
+
+#include "core/modules/crowd.h"
+
+#include "shared/modules/appearance.hpp"
+
+#include <cmath>
+#include <memory>
+#include <vector>
+
+MODULE(crowd, {
+    using HogwartsMP::Core::Modules::Crowd;
+    using HogwartsMP::Shared::Modules::CcdProfile;
+
+    // Pairs of agents standing closer than distance, by brute force.
+    const auto closePairs = [](const Crowd &crowd, float distance) {
+        size_t pairs = 0;
+        for (uint32_t i = 0; i < crowd.Size(); ++i) {
+            for (uint32_t j = i + 1; j < crowd.Size(); ++j) {
+                const glm::vec3 d = crowd.Position(i) - crowd.Position(j);
+                pairs += d.x * d.x + d.y * d.y < distance * distance ? 1 : 0;
+            }
+        }
+        return pairs;
+    };
+
+    IT("wanders around its area at walking speed and keeps agents apart", {
+        Crowd::Params packed;
+        packed.separateWeight = 0.0f;
+        Crowd::Params spaced;
+
+        // The same dense crowd (one agent per 50 cm square) with and without separation. Crowding pushes
+        // some agents a little past the edge of the area; their goals stay inside it.
+        Crowd without;
+        Crowd with;
+        EQUALS(without.Spawn(400, {0.0f, 0.0f}, {1000.0f, 1000.0f}, 50.0f, {}, packed), (size_t)400);
+        EQUALS(with.Spawn(400, {0.0f, 0.0f}, {1000.0f, 1000.0f}, 50.0f, {}, spaced), (size_t)400);
+        for (int i = 0; i < 200; ++i) {
+            without.Advance(Crowd::kStepSeconds);
+            with.Advance(Crowd::kStepSeconds);
+        }
+
+        bool sane = true;
+        for (uint32_t i = 0; i < with.Size(); ++i) {
+            const glm::vec3 p = with.Position(i);
+            const glm::vec3 v = with.Velocity(i);
+            sane              = sane && std::isfinite(p.x) && std::isfinite(p.y) && p.z == 50.0f;
+            sane              = sane && p.x > -500.0f && p.x < 1500.0f && p.y > -500.0f && p.y < 1500.0f;
+            sane              = sane && std::sqrt(v.x * v.x + v.y * v.y) <= spaced.maxSpeed + 0.01f;
+        }
+        EQUALS(sane, true);
+        EQUALS(closePairs(with, 30.0f) < closePairs(without, 30.0f), true);
+    });
+
+    IT("promotes agents a viewer can see and demotes them once it leaves", {
+        Crowd crowd;
+        crowd.Spawn(200, {0.0f, 0.0f}, {1000.0f, 1000.0f}, 0.0f, {}, {});
+        std::vector<uint32_t> promote;
+        std::vector<uint32_t> demote;
+        const std::vector<Crowd::Viewer> here {{{500.0f, 500.0f, 0.0f}, 250.0f}};
+        crowd.UpdateStreaming(here, promote, demote);
+        EQUALS(promote.empty(), false);
+        EQUALS(demote.empty(), true);
+
+        bool inRange = true;
+        for (const uint32_t agent : promote) {
+            const glm::vec3 d = crowd.Position(agent) - here[0].position;
+            inRange           = inRange && d.x * d.x + d.y * d.y < 250.0f * 250.0f;
+            crowd.Bind(agent, 1000 + agent);
+        }
+        EQUALS(inRange, true);
+        EQUALS(crowd.PromotedCount(), promote.size());
+        EQUALS(crowd.NetworkId(promote[0]), (uint64_t)(1000 + promote[0]));
+
+        // Already promoted: nothing new to do while the viewer stays.
+        const size_t promoted = promote.size();
+        promote.clear();
+        crowd.UpdateStreaming(here, promote, demote);
+        EQUALS(promote.empty(), true);
+        EQUALS(demote.empty(), true);
+
+        // The viewer walks off: every promoted agent is handed back.
+        const std::vector<Crowd::Viewer> away {{{50000.0f, 0.0f, 0.0f}, 250.0f}};
+        crowd.UpdateStreaming(away, promote, demote);
+        EQUALS(demote.size(), promoted);
+        for (const uint32_t agent : demote) {
+            crowd.Unbind(agent);
+        }
+        EQUALS(crowd.PromotedCount(), (size_t)0);
+        EQUALS(crowd.NetworkId(demote[0]), Crowd::kNotPromoted);
+
+        // An entity destroyed behind the crowd's back hands its agent back by network id.
+        crowd.Bind(3, 500);
+        crowd.Bind(4, 501);
+        crowd.UnbindEntity(500);
+        crowd.UnbindEntity(999);
+        EQUALS(crowd.PromotedCount(), (size_t)1);
+        EQUALS(crowd.NetworkId(3), Crowd::kNotPromoted);
+        EQUALS(crowd.NetworkId(4), (uint64_t)501);
+        crowd.Unbind(4);
+
+        // However much is in view, at most kMaxPromoted entities exist at once.
+        promote.clear();
+        const std::vector<Crowd::Viewer> everything {{{500.0f, 500.0f, 0.0f}, 100000.0f}};
+        crowd.Spawn(1000, {0.0f, 0.0f}, {1000.0f, 1000.0f}, 0.0f, {}, {});
+        crowd.UpdateStreaming(everything, promote, demote);
+        EQUALS(promote.size(), Crowd::kMaxPromoted);
+    });
+
+    IT("shares appearance profiles between agents and clears them with the crowd", {
+        const auto first  = std::make_shared<const CcdProfile>();
+        const auto second = std::make_shared<const CcdProfile>();
+
+        Crowd crowd;
+        crowd.Spawn(2, {0.0f, 0.0f}, {100.0f, 100.0f}, 0.0f, {}, {});
+        crowd.Spawn(4, {0.0f, 0.0f}, {100.0f, 100.0f}, 0.0f, {first, second}, {});
+        EQUALS(crowd.Profile(0), (const CcdProfile *)nullptr);
+        EQUALS(crowd.Profile(2), first.get());
+        EQUALS(crowd.Profile(3), second.get());
+        EQUALS(crowd.Profile(4), first.get());
+        EQUALS(first.use_count(), (long)2);
+
+        crowd.Bind(5, 77);
+        const auto ids = crowd.Clear();
+        EQUALS(ids.size(), (size_t)1);
+        EQUALS(ids[0], (uint64_t)77);
+        EQUALS(crowd.Size(), (size_t)0);
+        EQUALS(first.use_count(), (long)1);
+    });
+});
@@ -0,0 +1,131 @@
+#pragma once
+
+#include "core/events/event_queue.h"
+#include "shared/script_payload.h"
+
+#include <string>
+#include <vector>
+
+MODULE(event_queue, {
+    using HogwartsMP::Core::Events::EventQueue;
+    using HogwartsMP::Core::Events::Kind;
+
+    IT("keeps events in arrival order with their strings intact", {
+        EventQueue queue;
+        queue.PushPlayerConnect(7);
+        queue.PushChatMessage(7, "hello");
+        queue.PushChatCommand(7, "/tp 1 2", "tp", {"1", "2"});
+        queue.PushClientEvent(8, "shop:buy", "{\"item\":3}");
+        queue.PushPlayerDied(8);
+        queue.PushNpcArrived(9);
+
+        EQUALS(queue.Size(), (size_t)6);
+        EQUALS(queue.At(0).kind == Kind::PlayerConnect, true);
+        EQUALS(queue.At(0).networkId, (uint64_t)7);
+        EQUALS(queue.At(1).kind == Kind::ChatMessage, true);
+        EQUALS(std::string(queue.At(1).text), std::string("hello"));
+
+        const auto command = queue.At(2);
+        EQUALS(command.kind == Kind::ChatCommand, true);
+        EQUALS(std::string(command.name), std::string("tp"));
+        EQUALS(std::string(command.text), std::string("/tp 1 2"));
+        EQUALS(command.argCount, (size_t)2);
+        EQUALS(std::string(queue.Arg(2, 0)), std::string("1"));
+        EQUALS(std::string(queue.Arg(2, 1)), std::string("2"));
+
+        EQUALS(std::string(queue.At(3).name), std::string("shop:buy"));
+        EQUALS(std::string(queue.At(3).text), std::string("{\"item\":3}"));
+        EQUALS(queue.At(4).kind == Kind::PlayerDied, true);
+        EQUALS(queue.At(4).networkId, (uint64_t)8);
+        EQUALS(queue.At(5).kind == Kind::NpcArrived, true);
+        EQUALS(queue.At(5).networkId, (uint64_t)9);
+    });
+
+    IT("coalesces only the client events marked for it, per sender", {
+        EventQueue queue;
+        queue.SetCoalesced("aim", true);
+        EQUALS(queue.PushClientEvent(1, "aim", "1"), true);
+        EQUALS(queue.PushClientEvent(1, "shoot", "{}"), true);
+        EQUALS(queue.PushClientEvent(2, "aim", "10"), true);
+        EQUALS(queue.PushClientEvent(1, "aim", "2"), false);
+        EQUALS(queue.PushClientEvent(1, "aim", "3"), false);
+        EQUALS(queue.PushClientEvent(1, "shoot", "{}"), true);
+
+        // The first "aim" keeps its place ahead of "shoot" and carries the latest payload.
+        EQUALS(queue.Size(), (size_t)4);
+        EQUALS(std::string(queue.At(0).name), std::string("aim"));
+        EQUALS(std::string(queue.At(0).text), std::string("3"));
+        EQUALS(std::string(queue.At(2).text), std::string("10"));
+
+        // After a drain the next one queues afresh.
+        queue.Clear();
+        EQUALS(queue.PushClientEvent(1, "aim", "4"), true);
+
+        queue.SetCoalesced("aim", false);
+        EQUALS(queue.IsCoalesced("aim"), false);
+        EQUALS(queue.PushClientEvent(1, "aim", "5"), true);
+        EQUALS(queue.Size(), (size_t)2);
+    });
+
+    IT("empties on clear and is reusable", {
+        EventQueue queue;
+        for (int tick = 0; tick < 3; ++tick) {
+            for (uint64_t i = 0; i < 100; ++i) {
+                queue.PushChatMessage(i, std::string(64, 'x'));
+            }
+            EQUALS(queue.Size(), (size_t)100);
+            EQUALS(queue.At(99).networkId, (uint64_t)99);
+            queue.Clear();
+            EQUALS(queue.Empty(), true);
+        }
+        queue.PushChatCommand(1, "/me", "me", {});
+        EQUALS(queue.At(0).argCount, (size_t)0);
+    });
+
+    IT("bounds JSON nesting without being fooled by brackets in strings", {
+        using HogwartsMP::Shared::ScriptPayload::JsonDepthWithin;
+        EQUALS(JsonDepthWithin("{\"a\":[1,{\"b\":2}]}", 3), true);
+        EQUALS(JsonDepthWithin("{\"a\":[1,{\"b\":2}]}", 2), false);
+        EQUALS(JsonDepthWithin("[\"[[[[\\\"[[[\"]", 1), true);
+        EQUALS(JsonDepthWithin(std::string(100, '[') + std::string(100, ']'), 32), false);
+    });
+
+    IT("round-trips packed payload tokens and rejects forged or truncated input", {
+        using namespace HogwartsMP::Shared::ScriptPayload;
+        std::string data;
+        Writer writer(data);
+        writer.Map(2);
+        writer.Str("pos");
+        writer.Array(3);
+        writer.Int(-5);
+        writer.Int(300);
+        writer.Double(1.5);
+        writer.Str("name");
+        writer.Str(std::string(40, 'n'));
+
+        Reader reader(data);
+        Token token;
+        EQUALS(reader.Next(token) && token.type == Type::Map && token.count == 2, true);
+        EQUALS(reader.Next(token) && token.type == Type::Str && token.bytes == "pos", true);
+        EQUALS(reader.Next(token) && token.type == Type::Array && token.count == 3, true);
+        EQUALS(reader.Next(token) && token.type == Type::Int && token.i == -5, true);
+        EQUALS(reader.Next(token) && token.type == Type::Int && token.i == 300, true);
+        EQUALS(reader.Next(token) && token.type == Type::Float && token.f == 1.5, true);
+        EQUALS(reader.Next(token) && token.bytes == "name", true);
+        EQUALS(reader.Next(token) && token.bytes.size() == 40, true);
+        EQUALS(reader.AtEnd(), true);
+        EQUALS(reader.Next(token), false);
+
+        // An array header claiming 4 billion items in a five-byte payload.
+        const std::string forged("\xdd\xff\xff\xff\xff", 5);
+        Reader forgedReader(forged);
+        EQUALS(forgedReader.Next(token), false);
+
+        Reader truncated(std::string_view(data).substr(0, data.size() - 1));
+        bool ok = true;
+        while (ok && !truncated.AtEnd()) {
+            ok = truncated.Next(token);
+        }
+        EQUALS(ok, false);
+    });
+});
@@ -3,6 +3,8 @@
 #include "scripting/node_engine.h"
 
 #include "core/builtins/builtins.h"
+#include "core/metrics/tick_profiler.h"
+#include "shared/script_payload_v8.h"
 
 #include <cstdio>
 
@@ -13,6 +15,7 @@ MODULE(js_builtins, {
         // Start clean: a storage.json left by a previous run (or aborted test) would make the Storage
         // assertions below (e.g. get('ut_missing') === undefined) flaky.
         std::remove(HogwartsMP::Scripting::Storage::STORAGE_FILE);
+        std::remove(HogwartsMP::Scripting::Storage::STORAGE_LOG_FILE);
 
         NodeEngine engine({});
         EQUALS(engine.Init(), ScriptingError::SCRIPTING_NONE);
@@ -55,6 +58,22 @@ MODULE(js_builtins, {
             EQUALS(evalBool("typeof World.broadcastMessage === 'function'"), true);
             EQUALS(evalBool("typeof World.sendChatMessage === 'function'"), true);
             EQUALS(evalBool("typeof World.emitAllClients === 'function'"), true);
+            EQUALS(evalBool("typeof World.setClientEventCoalescing === 'function'"), true);
+            EQUALS(evalBool("typeof World.emitAllClientsPacked === 'function'"), true);
+            EQUALS(evalBool("try { World.emitAllClientsPacked('ev', { f() {} }); false } catch (e) { e instanceof TypeError }"), true);
+
+            // A packed payload unpacks to an equal value; trailing bytes make it malformed.
+            {
+                const char *src = "({ a: [1, -2, 3.5, 'zaubér', null, true], b: { c: { d: 'deep' } }, n: 4294967296 })";
+                v8::Local<v8::Value> value = v8::Script::Compile(context, v8pp::to_v8(isolate, src)).ToLocalChecked()->Run(context).ToLocalChecked();
+                std::string packed;
+                EQUALS(HogwartsMP::Shared::ScriptPayload::Pack(isolate, context, value, packed), true);
+                v8::Local<v8::Value> back;
+                EQUALS(HogwartsMP::Shared::ScriptPayload::Unpack(isolate, context, packed).ToLocal(&back), true);
+                global->Set(context, v8pp::to_v8(isolate, "ut_payload"), back).Check();
+                EQUALS(evalBool("JSON.stringify(ut_payload) === JSON.stringify({ a: [1, -2, 3.5, 'zaubér', null, true], b: { c: { d: 'deep' } }, n: 4294967296 })"), true);
+                EQUALS(HogwartsMP::Shared::ScriptPayload::Unpack(isolate, context, packed + "x").IsEmpty(), true);
+            }
 
             // Player query surface + graceful behaviour with no networking running in the test harness:
             // getPlayers() is an empty array, getPlayerCount() is 0, getPlayer() is undefined.
@@ -64,6 +83,17 @@ MODULE(js_builtins, {
             EQUALS(evalBool("Array.isArray(World.getPlayers()) && World.getPlayers().length === 0"), true);
             EQUALS(evalBool("World.getPlayerCount() === 0"), true);
             EQUALS(evalBool("World.getPlayer(1) === undefined"), true);
+            EQUALS(evalBool("typeof World.setTransforms === 'function'"), true);
+            EQUALS(evalBool("typeof World.spawnHumans === 'function'"), true);
+            EQUALS(evalBool("try { World.spawnHumans([{x: 0, y: 0}]); false } catch (e) { e instanceof TypeError }"), true);
+            EQUALS(evalBool("try { World.spawnHumans(new Float32Array(4)); false } catch (e) { e instanceof TypeError }"), true);
+            EQUALS(evalBool("typeof World.spawnCrowd === 'function'"), true);
+            EQUALS(evalBool("World.spawnCrowd(50, 0, 0, 1000, 1000, 0, {speed: 200}) === 50 && World.getCrowdSize() === 50"), true);
+            EQUALS(evalBool("try { World.spawnCrowd(10, 0, 0); false } catch (e) { e instanceof TypeError }"), true);
+            EQUALS(evalBool("World.clearCrowd() === 50 && World.getCrowdSize() === 0"), true);
+            EQUALS(evalBool("World.setTransforms(new Float64Array([1, 2]), new Float32Array(18)) === 0"), true);
+            EQUALS(evalBool("try { World.setTransforms([1], new Float32Array(9)); false } catch (e) { e instanceof TypeError }"), true);
+            EQUALS(evalBool("try { World.setTransforms(new Uint32Array(2), new Float32Array(9)); false } catch (e) { e instanceof RangeError }"), true);
             EQUALS(evalBool("typeof Environment.setWeather === 'function'"), true);
             EQUALS(evalBool("typeof Environment.setTime === 'function'"), true);
             EQUALS(evalBool("typeof Environment.setDate === 'function'"), true);
@@ -75,12 +105,75 @@ MODULE(js_builtins, {
             EQUALS(evalBool("typeof Storage.has === 'function'"), true);
             EQUALS(evalBool("typeof Storage.delete === 'function'"), true);
             EQUALS(evalBool("typeof Storage.keys === 'function'"), true);
+            EQUALS(evalBool("typeof Storage.entries === 'function'"), true);
+            EQUALS(evalBool("typeof Storage.range === 'function'"), true);
+            EQUALS(evalBool("typeof Storage.exportJson === 'function'"), true);
             EQUALS(evalBool("Storage.set('ut_key', 'ut_val'); Storage.get('ut_key') === 'ut_val'"), true);
             EQUALS(evalBool("Storage.has('ut_key') === true"), true);
             EQUALS(evalBool("Storage.get('ut_missing') === undefined"), true);
             EQUALS(evalBool("Storage.keys().includes('ut_key')"), true);
+            EQUALS(evalBool("Storage.keys('ut_').includes('ut_key') && Storage.keys('zz_').length === 0"), true);
+            EQUALS(evalBool("JSON.stringify(Storage.entries('ut_', 1)) === '[[\\"ut_key\\",\\"ut_val\\"]]'"), true);
+            EQUALS(evalBool("Storage.range('ut_', 'ut_l').length === 1"), true);
             EQUALS(evalBool("Storage.delete('ut_key') === true && Storage.has('ut_key') === false"), true);
 
+            // Batches and transactions
+            EQUALS(evalBool("Storage.setMany({ ut_a: '1', ut_b: '2' }); Storage.getMany(['ut_a', 'ut_b', 'ut_c']).join() === '1,2,'"), true);
+            EQUALS(evalBool("(() => { try { Storage.setMany({ ut_c: '3', ut_d: 4 }); } catch (e) { return !Storage.has('ut_c'); } return false; })()"), true);
+            EQUALS(evalBool("Storage.transaction(() => { Storage.set('ut_a', '10'); return Storage.get('ut_a'); }) === '10'"), true);
+            EQUALS(evalBool("(() => { try { Storage.transaction(() => { Storage.set('ut_a', '99'); Storage.delete('ut_b'); throw new Error('abort'); }); } catch (e) {} return Storage.get('ut_a') === '10' && Storage.has('ut_b'); })()"), true);
+            EQUALS(evalBool("(() => { Storage.transaction(() => { Storage.set('ut_outer', '1'); try { Storage.transaction(() => { Storage.set('ut_inner', 'x'); Storage.set('ut_outer', '2'); throw new Error('inner'); }); } catch (e) {} }); const ok = Storage.get('ut_outer') === '1' && !Storage.has('ut_inner'); Storage.delete('ut_outer'); return ok; })()"), true);
+            EQUALS(evalBool("(() => { try { Storage.transaction(() => Storage.keys()); } catch (e) { return true; } return false; })()"), true);
+            EQUALS(evalBool("Storage.deleteMany(['ut_a', 'ut_b', 'ut_a', 'ut_missing']) === 2 && !Storage.has('ut_a')"), true);
+
+            // Counters
+            EQUALS(evalBool("Storage.incr('ut_n') === 1 && Storage.incr('ut_n', 4) === 5 && Storage.get('ut_n') === '5'"), true);
+            EQUALS(evalBool("Storage.transaction(() => Storage.incr('ut_n', -2)) === 3 && Storage.get('ut_n') === '3'"), true);
+            EQUALS(evalBool("Storage.set('ut_s', 'abc'); (() => { try { Storage.incr('ut_s'); } catch (e) { return Storage.get('ut_s') === 'abc'; } return false; })()"), true);
+            EQUALS(evalBool("Storage.deleteMany(['ut_n', 'ut_s']) === 2"), true);
+
+            // Expiry
+            EQUALS(evalBool("typeof Storage.ttl === 'function'"), true);
+            EQUALS(evalBool("Storage.set('ut_t', 'x', { ttlMs: 60000 }); Storage.ttl('ut_t') > 59000 && Storage.get('ut_t') === 'x'"), true);
+            EQUALS(evalBool("Storage.set('ut_t', 'y'); Storage.ttl('ut_t') === undefined"), true);
+            EQUALS(evalBool("Storage.set('ut_t', 'z', { ttlMs: 0 }); Storage.has('ut_t') === false"), true);
+            EQUALS(evalBool("(() => { try { Storage.set('ut_t', 'x', { ttlMs: -1 }); } catch (e) { return true; } return false; })()"), true);
+            EQUALS(evalBool("(() => { try { Storage.transaction(() => Storage.set('ut_t', 'x', { ttlMs: 5 })); } catch (e) { return true; } return false; })()"), true);
+
+            // Promise API: nothing settles until the deferred work runs (a server tick)
+            EQUALS(evalBool("['get', 'set', 'delete', 'keys'].every((f) => typeof Storage.async[f] === 'function')"), true);
+            EQUALS(evalBool("globalThis.ut_async = []; Storage.async.set('ut_as', 'v').then(() => ut_async.push('set')); Storage.async.get('ut_as').then((v) => ut_async.push(v)); ut_async.length === 0 && !Storage.has('ut_as')"), true);
+            HogwartsMP::Scripting::Storage::RunDeferred(isolate, context);
+            EQUALS(evalBool("ut_async.join() === 'set,v'"), true);
+            EQUALS(evalBool("Storage.async.keys('ut_a').then((k) => ut_async.push(k.join())); Storage.async.delete('ut_as').then((d) => ut_async.push(d)); true"), true);
+            HogwartsMP::Scripting::Storage::RunDeferred(isolate, context);
+            EQUALS(evalBool("ut_async.slice(2).join() === 'ut_as,true' && !Storage.has('ut_as')"), true);
+            EQUALS(evalBool("(() => { try { Storage.async.set('ut_as'); } catch (e) { return true; } return false; })()"), true);
+
+            // Sorted sets
+            EQUALS(evalBool("Storage.zadd('ut_z', 'a', 5) === true && Storage.zadd('ut_z', 'b', 9) === true && Storage.zincr('ut_z', 'c', 7) === 7"), true);
+            EQUALS(evalBool("Storage.zcard('ut_z') === 3 && Storage.zrank('ut_z', 'c') === 1 && Storage.zrevrank('ut_z', 'b') === 0"), true);
+            EQUALS(evalBool("JSON.stringify(Storage.zrevrange('ut_z', 0, 1)) === '[[\"b\",9],[\"c\",7]]'"), true);
+            EQUALS(evalBool("Storage.zrange('ut_z', -1).map(([m]) => m).join() === 'b' && Storage.zrangeByScore('ut_z', 6, Infinity).length === 2"), true);
+            EQUALS(evalBool("Storage.get('zset:ut_z:a') === '5' && Storage.zscore('ut_z', 'missing') === undefined"), true);
+            EQUALS(evalBool("Storage.set('zset:ut_z:a', '10'); Storage.zrevrank('ut_z', 'a') === 0"), true);
+            EQUALS(evalBool("(() => { try { Storage.zadd('ut:z', 'a', 1); } catch (e) { return true; } return false; })()"), true);
+            EQUALS(evalBool("Storage.zrem('ut_z', 'a') && Storage.zrem('ut_z', 'b') && Storage.zrem('ut_z', 'c') && Storage.zcard('ut_z') === 0"), true);
+
+            // Profiler: a timed dispatch shows up in eventStats, with its heap growth
+            EQUALS(evalBool("['eventStats', 'setSlowHandlerThreshold', 'captureCpuProfile'].every((f) => typeof Profiler[f] === 'function')"), true);
+            HogwartsMP::Core::Metrics::TickProfiler::Get().Events().Reset();
+            {
+                const std::string eventName = "ut_event";
+                HogwartsMP::Scripting::Profiler::Dispatch dispatch(isolate, eventName);
+                evalBool("globalThis.ut_garbage = new Array(10000).fill(0).map((_, i) => ({ i })); true");
+            }
+            EQUALS(evalBool("(() => { const s = Profiler.eventStats(); return s.length === 1 && s[0].event === 'ut_event' && s[0].calls === 1 && s[0].allocatedBytes > 0 && s[0].slow === 0; })()"), true);
+            EQUALS(evalBool("Profiler.eventStats(0).length === 1"), true);
+            EQUALS(evalBool("(() => { try { Profiler.setSlowHandlerThreshold(-1); } catch (e) { return true; } return false; })()"), true);
+            EQUALS(evalBool("(() => { try { Profiler.captureCpuProfile(0); } catch (e) { return true; } return false; })()"), true);
+            HogwartsMP::Core::Metrics::TickProfiler::Get().Events().Reset();
+
             // Entity classes on the Framework object, with the inherit chain intact
             EQUALS(evalBool("typeof Framework.Entity === 'function'"), true);
             EQUALS(evalBool("typeof Framework.Human === 'function'"), true);
@@ -93,17 +186,36 @@ MODULE(js_builtins, {
             EQUALS(evalBool("typeof HumanImpl.prototype.sendChat === 'function'"), true);
             EQUALS(evalBool("typeof HumanImpl.prototype.emit === 'function'"), true);
             EQUALS(evalBool("typeof HumanImpl.prototype.getData === 'function'"), true);
+            EQUALS(evalBool("typeof HumanImpl.prototype.incrData === 'function'"), true);
+            EQUALS(evalBool("typeof HumanImpl.prototype.getDataAsync === 'function'"), true);
+            EQUALS(evalBool("typeof HumanImpl.prototype.setDataAsync === 'function'"), true);
             EQUALS(evalBool("typeof HumanImpl.prototype.setData === 'function'"), true);
             EQUALS(evalBool("typeof HumanImpl.prototype.hasData === 'function'"), true);
             EQUALS(evalBool("typeof HumanImpl.prototype.deleteData === 'function'"), true);
             EQUALS(evalBool("typeof HumanImpl.prototype.destroy === 'function'"), true);
+            EQUALS(evalBool("typeof HumanImpl.prototype.emitPacked === 'function'"), true);
+            EQUALS(evalBool("typeof HumanImpl.prototype.moveAlong === 'function'"), true);
+            EQUALS(evalBool("typeof HumanImpl.prototype.stopMoving === 'function'"), true);
+            EQUALS(evalBool("typeof HumanImpl.prototype.isMoving === 'function'"), true);
             EQUALS(evalBool("Object.getOwnPropertyNames(HumanImpl.prototype).includes('nickname')"), true);
+
+            // One wrapper per network id until it is forgotten (disconnect / destroy).
+            {
+                using HogwartsMP::Scripting::Human;
+                v8::Local<v8::Object> first = Human::Wrap(isolate, 42);
+                EQUALS(first->StrictEquals(Human::Wrap(isolate, 42)), true);
+                EQUALS(first->StrictEquals(Human::Wrap(isolate, 43)), false);
+                Human::ForgetWrapper(42);
+                EQUALS(first->StrictEquals(Human::Wrap(isolate, 42)), false);
+                Human::ForgetWrappers(isolate);
+            }
         }
 
         engine.Shutdown();
 
-        // The Storage round-trip above flushes to the process-wide store's backing file; remove it so
+        // The Storage round-trip above flushes to the process-wide store's backing files; remove them so
         // the test leaves no artifact behind.
         std::remove(HogwartsMP::Scripting::Storage::STORAGE_FILE);
+        std::remove(HogwartsMP::Scripting::Storage::STORAGE_LOG_FILE);
     });
 });
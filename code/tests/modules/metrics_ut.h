@@ -0,0 +1,151 @@
+#pragma once
+
+#include "core/metrics/event_stats.h"
+#include "core/metrics/histogram.h"
+#include "core/metrics/tick_profiler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+MODULE(metrics, {
+    using HogwartsMP::Core::Metrics::EventStats;
+    using HogwartsMP::Core::Metrics::LatencyHistogram;
+    using HogwartsMP::Core::Metrics::Phase;
+    using HogwartsMP::Core::Metrics::ScopedPhase;
+    using HogwartsMP::Core::Metrics::TickProfiler;
+
+    IT("maps every value into a bucket that contains it, within 1/16", {
+        bool contained = true;
+        bool tight     = true;
+        for (uint64_t v : {0ull, 1ull, 31ull, 32ull, 33ull, 1000ull, 16666666ull, 33333333ull, 999999999ull, (1ull << 40) + 12345}) {
+            const size_t b   = LatencyHistogram::BucketOf(v);
+            contained        = contained && LatencyHistogram::BucketLow(b) <= v && v <= LatencyHistogram::BucketHigh(b);
+            const auto width = LatencyHistogram::BucketHigh(b) - LatencyHistogram::BucketLow(b);
+            tight            = tight && width * 16 <= std::max<uint64_t>(v, 16);
+        }
+        EQUALS(contained, true);
+        EQUALS(tight, true);
+        EQUALS(LatencyHistogram::BucketOf(UINT64_MAX), LatencyHistogram::kBuckets - 1);
+
+        // Buckets tile the range with no gaps.
+        bool contiguous = true;
+        for (size_t b = 0; b + 2 < LatencyHistogram::kBuckets; ++b) {
+            contiguous = contiguous && LatencyHistogram::BucketHigh(b) + 1 == LatencyHistogram::BucketLow(b + 1);
+        }
+        EQUALS(contiguous, true);
+    });
+
+    IT("reports percentiles within bucket precision", {
+        LatencyHistogram h;
+        for (uint64_t ms = 1; ms <= 100; ++ms) {
+            h.Record(ms * 1000000);
+        }
+        const auto snap = h.Take();
+        EQUALS(snap.count, (uint64_t)100);
+        EQUALS(snap.maxNs, (uint64_t)100000000);
+        EQUALS(snap.sumNs, (uint64_t)5050000000ull);
+
+        const auto near = [](uint64_t got, uint64_t want) {
+            return got >= want && got <= want + want / 16;
+        };
+        EQUALS(near(snap.Percentile(50.0), 50000000), true);
+        EQUALS(near(snap.Percentile(99.0), 99000000), true);
+        EQUALS(snap.Percentile(100.0), (uint64_t)100000000);
+        EQUALS(LatencyHistogram().Take().Percentile(99.0), (uint64_t)0);
+
+        h.Reset();
+        EQUALS(h.Take().count, (uint64_t)0);
+    });
+
+    IT("counts samples recorded from several threads", {
+        LatencyHistogram h;
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t) {
+            threads.emplace_back([&h, t] {
+                for (uint64_t i = 0; i < 10000; ++i) {
+                    h.Record(i * 100 + static_cast<uint64_t>(t));
+                }
+            });
+        }
+        for (auto &t : threads) {
+            t.join();
+        }
+        const auto snap = h.Take();
+        EQUALS(snap.count, (uint64_t)40000);
+        EQUALS(snap.maxNs, (uint64_t)999903);
+    });
+
+    IT("renders phases and gauges as Prometheus text and JSON", {
+        auto &profiler = TickProfiler::Get();
+        profiler.Reset();
+        profiler.Record(Phase::Tick, std::chrono::milliseconds(20));
+        profiler.Record(Phase::Tick, std::chrono::milliseconds(40));
+        {
+            ScopedPhase phase(Phase::Storage);
+        }
+        profiler.SetPlayers(3);
+        profiler.SetEntities(7);
+        profiler.SetNetworkBytes(1234, 5678);
+
+        const std::string text = profiler.RenderPrometheus();
+        EQUALS(text.find("# TYPE hogwartsmp_phase_seconds histogram") != std::string::npos, true);
+        EQUALS(text.find("hogwartsmp_phase_seconds_bucket{phase=\"tick\",le=\"0.025\"} 1\n") != std::string::npos, true);
+        EQUALS(text.find("hogwartsmp_phase_seconds_bucket{phase=\"tick\",le=\"0.05\"} 2\n") != std::string::npos, true);
+        EQUALS(text.find("hogwartsmp_phase_seconds_bucket{phase=\"tick\",le=\"+Inf\"} 2\n") != std::string::npos, true);
+        EQUALS(text.find("hogwartsmp_phase_seconds_count{phase=\"tick\"} 2\n") != std::string::npos, true);
+        EQUALS(text.find("hogwartsmp_phase_seconds_count{phase=\"storage\"} 1\n") != std::string::npos, true);
+        EQUALS(text.find("hogwartsmp_players 3\n") != std::string::npos, true);
+        EQUALS(text.find("hogwartsmp_entities 7\n") != std::string::npos, true);
+        EQUALS(text.find("hogwartsmp_network_received_bytes_total 1234\n") != std::string::npos, true);
+        EQUALS(text.find("hogwartsmp_network_sent_bytes_total 5678\n") != std::string::npos, true);
+
+        const std::string json = profiler.RenderJson();
+        EQUALS(json.find("\"tick\":{\"count\":2") != std::string::npos, true);
+        EQUALS(json.find("\"maxMs\":40.0") != std::string::npos, true);
+        EQUALS(json.find("\"players\":3") != std::string::npos, true);
+        profiler.Reset();
+    });
+
+    IT("accounts script events by name, capped against unbounded client event names", {
+        EventStats stats;
+        stats.Record("chat", 2000000, 512, false);
+        stats.Record("chat", 6000000, 0, true);
+        stats.Record("tick", 1000000, 128, false);
+        stats.RecordSlowResource("gamemode");
+
+        const auto top = stats.Top();
+        EQUALS(top.size(), (size_t)2);
+        EQUALS(top[0].first, std::string("chat"));
+        EQUALS(top[0].second.calls, (uint64_t)2);
+        EQUALS(top[0].second.totalNs, (uint64_t)8000000);
+        EQUALS(top[0].second.maxNs, (uint64_t)6000000);
+        EQUALS(top[0].second.allocatedBytes, (uint64_t)512);
+        EQUALS(top[0].second.slow, (uint64_t)1);
+        EQUALS(stats.Top(1).size(), (size_t)1);
+
+        std::string text;
+        stats.RenderPrometheus(text);
+        EQUALS(text.find("hogwartsmp_script_event_calls_total{event=\"chat\"} 2\n") != std::string::npos, true);
+        EQUALS(text.find("hogwartsmp_script_event_slow_total{event=\"chat\"} 1\n") != std::string::npos, true);
+        EQUALS(text.find("hogwartsmp_script_resource_slow_total{resource=\"gamemode\"} 1\n") != std::string::npos, true);
+
+        // Names past the cap share one entry; quotes in a name cannot break the exposition format.
+        stats.Reset();
+        for (size_t i = 0; i < EventStats::kMaxEvents + 10; ++i) {
+            stats.Record("ev" + std::to_string(i), 1, 0, false);
+        }
+        stats.Record("a\"b", 1, 0, false);
+        const auto capped = stats.Top();
+        EQUALS(capped.size(), EventStats::kMaxEvents + 1);
+        const auto other = std::find_if(capped.begin(), capped.end(), [](const auto &e) {
+            return e.first == EventStats::kOtherEvent;
+        });
+        EQUALS(other != capped.end() && other->second.calls == 11, true);
+        text.clear();
+        stats.RenderPrometheus(text);
+        EQUALS(text.find("a\"b") == std::string::npos, true);
+    });
+});
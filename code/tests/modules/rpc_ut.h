@@ -1,6 +1,7 @@
 #pragma once
 
 #include "shared/game/weather.h"
+#include "shared/rpc/script_event.h"
 #include "shared/rpc/set_weather.h"
 
 #include <mafianet/BitStream.h>
@@ -31,4 +32,56 @@ MODULE(rpc, {
         EQUALS(in.data.dateMonth, 10);
         EQUALS(in.data.season, static_cast<uint8_t>(SEASON_AUTUMN));
     });
+
+    IT("sends a script event name once, then only its interned id", {
+        EventNameEncoder sender;
+        EventNameDecoder receiver;
+        const std::string payload = "{\"x\":1}";
+
+        const auto roundTrip = [&](const std::string &name, size_t &bytes) {
+            RPC::ScriptEvent out;
+            out.payload = payload;
+            out.SetName(name, sender);
+            MafiaNet::BitStream bs;
+            out.Serialize(&bs, true);
+            bytes = bs.GetNumberOfBytesUsed();
+
+            RPC::ScriptEvent in;
+            in.Serialize(&bs, false);
+            EQUALS(in.encoding == RPC::ScriptEvent::Json, true);
+            EQUALS(in.payload, payload);
+            const std::string *resolved = in.ResolveName(receiver);
+            return resolved ? *resolved : std::string("<unresolved>");
+        };
+
+        size_t first  = 0;
+        size_t second = 0;
+        size_t other  = 0;
+        EQUALS(roundTrip("inventory:update", first), std::string("inventory:update"));
+        EQUALS(roundTrip("inventory:update", second), std::string("inventory:update"));
+        EQUALS(roundTrip("aim", other), std::string("aim"));
+        EQUALS(second < first, true);
+        EQUALS(receiver.Size(), (size_t)2);
+    });
+
+    IT("rejects script event name ids the sender never defined", {
+        EventNameDecoder receiver;
+        EQUALS(receiver.Resolve(1, "") == nullptr, true);
+        EQUALS(receiver.Resolve(2, "skipped") == nullptr, true);
+        EQUALS(*receiver.Resolve(1, "a"), std::string("a"));
+        EQUALS(receiver.Resolve(1, "b") == nullptr, true);
+        EQUALS(*receiver.Resolve(1, ""), std::string("a"));
+        EQUALS(*receiver.Resolve(0, "plain"), std::string("plain"));
+        EQUALS(receiver.Resolve(2, std::string(kMaxEventNameLength + 1, 'n')) == nullptr, true);
+
+        // Past the table limit names are still sent, uninterned.
+        EventNameEncoder sender;
+        bool firstUse = false;
+        for (uint32_t i = 0; i < kMaxEventNames; ++i) {
+            EQUALS(sender.Encode("event" + std::to_string(i), firstUse), i + 1);
+        }
+        EQUALS(sender.Encode("one_too_many", firstUse), (uint32_t)0);
+        EQUALS(sender.Encode("event0", firstUse), (uint32_t)1);
+        EQUALS(firstUse, false);
+    });
 });
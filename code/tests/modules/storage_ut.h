@@ -1,11 +1,35 @@
 #pragma once
 
 #include "core/storage/key_value_store.h"
+#include "core/storage/player_shards.h"
+#include "core/storage/sorted_set.h"
+#include "core/storage/timer_wheel.h"
 
 #include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 MODULE(storage, {
     using HogwartsMP::Core::Storage::KeyValueStore;
+    using HogwartsMP::Core::Storage::PersistMode;
+    using HogwartsMP::Core::Storage::PlayerShards;
+    using HogwartsMP::Core::Storage::SnapshotFile;
+    using HogwartsMP::Core::Storage::SnapshotFormat;
+    using HogwartsMP::Core::Storage::SortedSet;
+    using HogwartsMP::Core::Storage::SortedSets;
+    using HogwartsMP::Core::Storage::TimerWheel;
+    using HogwartsMP::Core::Storage::WriteBatch;
+
+    const auto removeJournaled = [](const std::string &path) {
+        std::remove(path.c_str());
+        std::remove((path + ".log").c_str());
+        std::remove((path + ".log.old").c_str());
+    };
 
     IT("returns nullopt for a missing key", {
         KeyValueStore store;
@@ -92,4 +116,743 @@ MODULE(storage, {
 
         std::remove(path);
     });
+
+    IT("journal mode appends changes and replays them on load", {
+        const std::string path = "test_kv_journal.json";
+        removeJournaled(path);
+
+        KeyValueStore store(path);
+        store.SetPersistMode(PersistMode::Journal);
+        store.Set("house", "Hufflepuff");
+        store.Set("points", "10");
+        EQUALS(store.Save(), true);
+        store.Set("points", "15");
+        EQUALS(store.Erase("house"), true);
+        EQUALS(store.Save(), true);
+
+        // Only the log was written — no snapshot rewrite per Save.
+        EQUALS(std::filesystem::exists(path), false);
+        EQUALS(std::filesystem::exists(path + ".log"), true);
+
+        KeyValueStore reload(path);
+        reload.SetPersistMode(PersistMode::Journal);
+        EQUALS(reload.Load(), true);
+        EQUALS(reload.Size(), (size_t)1);
+        EQUALS(reload.Has("house"), false);
+        STREQUALS(reload.Get("points").value().c_str(), "15");
+
+        removeJournaled(path);
+    });
+
+    IT("journal replay drops a torn tail and keeps appending after it", {
+        const std::string path = "test_kv_journal_torn.json";
+        removeJournaled(path);
+        {
+            KeyValueStore store(path);
+            store.SetPersistMode(PersistMode::Journal);
+            store.Set("a", "1");
+            EQUALS(store.Save(), true);
+        }
+        {
+            // Simulate a crash mid-append: a partial header + garbage after the intact record.
+            std::ofstream out(path + ".log", std::ios::binary | std::ios::app);
+            out.write("\x20\x00\x00\x00\xde\xad", 6);
+        }
+
+        KeyValueStore store(path);
+        store.SetPersistMode(PersistMode::Journal);
+        EQUALS(store.Load(), true);
+        STREQUALS(store.Get("a").value().c_str(), "1");
+        store.Set("b", "2");
+        EQUALS(store.Save(), true);
+
+        KeyValueStore reload(path);
+        reload.SetPersistMode(PersistMode::Journal);
+        EQUALS(reload.Load(), true);
+        EQUALS(reload.Size(), (size_t)2);
+        STREQUALS(reload.Get("b").value().c_str(), "2");
+
+        removeJournaled(path);
+    });
+
+    IT("compaction folds the journal into a plain JSON snapshot", {
+        const std::string path = "test_kv_journal_compact.json";
+        removeJournaled(path);
+
+        KeyValueStore store(path);
+        store.SetPersistMode(PersistMode::Journal);
+        store.SetCompactMinBytes(0); // compact on every Save once the log outgrows the snapshot
+        for (int i = 0; i < 50; ++i) {
+            store.Set("k" + std::to_string(i), std::to_string(i));
+            EQUALS(store.Save(), true);
+        }
+        EQUALS(store.Compact(), true);
+        EQUALS(std::filesystem::exists(path + ".log"), false);
+        EQUALS(std::filesystem::exists(path + ".log.old"), false);
+
+        // The snapshot alone is a complete plain-JSON export.
+        KeyValueStore plain;
+        EQUALS(plain.LoadFrom(path), true);
+        EQUALS(plain.Size(), (size_t)50);
+        STREQUALS(plain.Get("k49").value().c_str(), "49");
+
+        removeJournaled(path);
+    });
+
+    IT("background flush groups queued writes and commits them on Flush", {
+        const std::string path = "test_kv_journal_bg.json";
+        removeJournaled(path);
+        {
+            KeyValueStore store(path);
+            store.SetPersistMode(PersistMode::Journal);
+            store.SetBackgroundFlush(true);
+            store.SetCompactMinBytes(0);
+            for (int i = 0; i < 200; ++i) {
+                store.Set("counter", std::to_string(i));
+                store.Set("k" + std::to_string(i % 10), std::to_string(i));
+                if (i % 20 == 0) {
+                    EQUALS(store.Save(), true); // queued, not written on this thread
+                }
+            }
+            EQUALS(store.HasUnsavedChanges(), true);
+            EQUALS(store.Flush(), true);
+            EQUALS(store.HasUnsavedChanges(), false);
+        }
+
+        KeyValueStore reload(path);
+        reload.SetPersistMode(PersistMode::Journal);
+        EQUALS(reload.Load(), true);
+        EQUALS(reload.Size(), (size_t)11);
+        STREQUALS(reload.Get("counter").value().c_str(), "199");
+        STREQUALS(reload.Get("k9").value().c_str(), "199");
+
+        removeJournaled(path);
+    });
+
+    IT("background compactions become the mapped base and empty the overlay", {
+        const std::string path = "test_kv_binary_bg.kvs";
+        removeJournaled(path);
+        {
+            KeyValueStore store(path);
+            store.SetPersistMode(PersistMode::Journal);
+            store.SetSnapshotFormat(SnapshotFormat::Binary);
+            store.SetBackgroundFlush(true);
+            store.SetCompactMinBytes(1000);
+
+            for (int i = 0; i < 50; ++i) {
+                store.Set("a" + std::to_string(i), std::string(40, 'a'));
+            }
+            EQUALS(store.Save(), true); // compaction queued on the flush thread
+            store.Set("late", "1");     // after the copy: must survive the rebase
+            EQUALS(store.Erase("a0"), true);
+            EQUALS(store.Flush(), true);
+            EQUALS(store.OverlaySize(), (size_t)2);
+            STREQUALS(store.Get("late").value().c_str(), "1");
+            EQUALS(store.Has("a0"), false);
+            EQUALS(store.Size(), (size_t)50);
+
+            for (int i = 0; i < 50; ++i) {
+                store.Set("b" + std::to_string(i), std::string(200, 'b'));
+            }
+            EQUALS(store.Save(), true);
+            EQUALS(store.Flush(), true);
+            EQUALS(store.OverlaySize(), (size_t)0);
+            EQUALS(store.Size(), (size_t)100);
+            STREQUALS(store.Get("late").value().c_str(), "1");
+            EQUALS(store.Get("b49").value().size(), (size_t)200);
+        }
+
+        KeyValueStore reload(path);
+        reload.SetPersistMode(PersistMode::Journal);
+        EQUALS(reload.Load(), true);
+        EQUALS(reload.Size(), (size_t)100);
+        EQUALS(reload.Has("a0"), false);
+        STREQUALS(reload.Get("late").value().c_str(), "1");
+
+        removeJournaled(path);
+    });
+
+    IT("scans keys by prefix in sorted order with an optional limit", {
+        KeyValueStore store;
+        store.Set("player:2:gold", "20");
+        store.Set("player:10:gold", "100");
+        store.Set("player:1:gold", "10");
+        store.Set("player:1:xp", "5");
+        store.Set("points:gryffindor", "3");
+        store.Set("player", "bare");
+
+        const auto keys = store.Keys("player:");
+        EQUALS(keys.size(), (size_t)4);
+        STREQUALS(keys[0].c_str(), "player:10:gold");
+        STREQUALS(keys[1].c_str(), "player:1:gold");
+        STREQUALS(keys[2].c_str(), "player:1:xp");
+        STREQUALS(keys[3].c_str(), "player:2:gold");
+
+        EQUALS(store.Keys().size(), (size_t)6);
+        STREQUALS(store.Keys()[0].c_str(), "player");
+        EQUALS(store.Keys("player:1:", 1).size(), (size_t)1);
+        EQUALS(store.Keys("nope").empty(), true);
+
+        const auto entries = store.Entries("player:1:");
+        EQUALS(entries.size(), (size_t)2);
+        STREQUALS(entries[1].first.c_str(), "player:1:xp");
+        STREQUALS(entries[1].second.c_str(), "5");
+
+        // The index follows erases, overwrites and clears.
+        EQUALS(store.Erase("player:1:xp"), true);
+        store.Set("player:1:gold", "11");
+        EQUALS(store.Entries("player:1:").size(), (size_t)1);
+        STREQUALS(store.Entries("player:1:")[0].second.c_str(), "11");
+        store.Clear();
+        EQUALS(store.Keys().empty(), true);
+    });
+
+    IT("returns a half-open key range and rebuilds the index on load", {
+        const std::string path = "test_kv_range.json";
+        std::remove(path.c_str());
+        {
+            KeyValueStore store;
+            for (char c = 'a'; c <= 'f'; ++c) {
+                store.Set(std::string(1, c), std::string(1, c));
+            }
+            const auto range = store.Range("b", "e");
+            EQUALS(range.size(), (size_t)3);
+            STREQUALS(range[0].first.c_str(), "b");
+            STREQUALS(range[2].first.c_str(), "d");
+            EQUALS(store.Range("d").size(), (size_t)3); // no upper bound
+            EQUALS(store.Range("b", "e", 2).size(), (size_t)2);
+            EQUALS(store.Range("e", "b").empty(), true);
+            EQUALS(store.SaveTo(path), true);
+        }
+
+        KeyValueStore reload;
+        EQUALS(reload.LoadFrom(path), true);
+        EQUALS(reload.Keys("c").size(), (size_t)1);
+        STREQUALS(reload.Range("e")[1].first.c_str(), "f");
+
+        std::remove(path.c_str());
+    });
+
+    IT("player shards load on acquire, persist on release and reload after eviction", {
+        const std::string dir = "test_kv_players";
+        std::error_code ec;
+        std::filesystem::remove_all(dir, ec);
+        {
+            PlayerShards shards(dir);
+            EQUALS(shards.Find("hwid-1") == nullptr, true);
+
+            shards.Acquire("hwid-1");
+            shards.Acquire("hwid-2");
+            EQUALS(shards.ResidentCount(), (size_t)2);
+            shards.Find("hwid-1")->Set("gold", "5");
+            shards.Find("hwid-2")->Set("gold", "7");
+
+            // Released and immediately re-acquired: the reload is queued behind the eviction's write.
+            shards.Release("hwid-1");
+            EQUALS(shards.Find("hwid-1") == nullptr, true);
+            EQUALS(shards.ResidentCount(), (size_t)1);
+            shards.Acquire("hwid-1");
+            STREQUALS(shards.Find("hwid-1")->Get("gold").value().c_str(), "5");
+
+            // Reference-counted: a second session with the same identity keeps the shard resident.
+            shards.Acquire("hwid-1");
+            shards.Release("hwid-1");
+            EQUALS(shards.Find("hwid-1") != nullptr, true);
+            shards.Release("hwid-1");
+            shards.Release("hwid-2"); // still unsaved: committed by the eviction
+            EQUALS(shards.ResidentCount(), (size_t)0);
+        }
+
+        PlayerShards reopened(dir);
+        std::vector<std::string> loaded;
+        reopened.SetOnLoaded([&](const std::string &identity, KeyValueStore &) {
+            loaded.push_back(identity);
+        });
+        reopened.Acquire("hwid-2");
+        STREQUALS(reopened.Find("hwid-2")->Get("gold").value().c_str(), "7");
+        EQUALS(reopened.IsLoading("hwid-2"), false); // Find waited for the load
+        EQUALS(reopened.IsLoading("nobody"), false);
+        reopened.Find("hwid-2");
+        EQUALS(loaded.size(), (size_t)1); // only on the first hand-out
+        reopened.Acquire("nobody");
+        EQUALS(reopened.Find("nobody")->Size(), (size_t)0);
+        EQUALS(loaded.size(), (size_t)2);
+        reopened.Acquire("");
+        EQUALS(reopened.ResidentCount(), (size_t)2);
+
+        std::filesystem::remove_all(dir, ec);
+    });
+
+    IT("player shard file names can't escape the shard directory", {
+        PlayerShards shards("players");
+        const std::filesystem::path path(shards.ShardPath("../a/b_c"));
+        STREQUALS(path.parent_path().string().c_str(), "players");
+        STREQUALS(path.filename().string().c_str(), "_2e_2e_2fa_2fb_5fc.json");
+        STREQUALS(std::filesystem::path(shards.ShardPath("AB-12")).filename().string().c_str(), "AB-12.json");
+    });
+
+    IT("binary snapshots map back in and serve reads from the mapping", {
+        const std::string path = "test_kv_binary.kvs";
+        std::remove(path.c_str());
+        {
+            KeyValueStore store(path);
+            store.SetSnapshotFormat(SnapshotFormat::Binary);
+            for (int i = 0; i < 100; ++i) {
+                store.Set("k" + std::to_string(i), std::string(i, 'v'));
+            }
+            store.Set("empty", "");
+            EQUALS(store.Save(), true);
+        }
+        EQUALS(SnapshotFile::IsSnapshot(path), true);
+
+        KeyValueStore reload(path);
+        EQUALS(reload.Load(), true);
+        EQUALS(reload.Size(), (size_t)101);
+        EQUALS(reload.Get("k42").value().size(), (size_t)42);
+        STREQUALS(reload.Get("empty").value().c_str(), "");
+        EQUALS(reload.Has("k100"), false);
+        EQUALS(reload.Keys("k9").size(), (size_t)11); // k9, k90..k99
+
+        // Changes overlay the mapping; scans merge both in key order.
+        reload.Set("k10", "changed");
+        reload.Set("k0a", "new");
+        EQUALS(reload.Erase("k11"), true);
+        EQUALS(reload.Erase("k11"), false);
+        EQUALS(reload.Size(), (size_t)101);
+        STREQUALS(reload.Get("k10").value().c_str(), "changed");
+        EQUALS(reload.Has("k11"), false);
+        const auto keys = reload.Keys("k", 5);
+        EQUALS(keys.size(), (size_t)5);
+        STREQUALS(keys[0].c_str(), "k0");
+        STREQUALS(keys[1].c_str(), "k0a");
+        STREQUALS(keys[2].c_str(), "k1");
+        STREQUALS(keys[3].c_str(), "k10");
+        STREQUALS(keys[4].c_str(), "k12");
+        STREQUALS(reload.Entries("k10")[0].second.c_str(), "changed");
+        reload.Set("k11", "back");
+        EQUALS(reload.Size(), (size_t)102);
+
+        // JSON export stays available, and a JSON export imports back.
+        const std::string exported = "test_kv_binary_export.json";
+        EQUALS(reload.SaveTo(exported), true);
+        EQUALS(SnapshotFile::IsSnapshot(exported), false);
+        KeyValueStore imported;
+        EQUALS(imported.LoadFrom(exported), true);
+        EQUALS(imported.Size(), (size_t)102);
+        STREQUALS(imported.Get("k11").value().c_str(), "back");
+
+        reload.Clear();
+        EQUALS(reload.Size(), (size_t)0);
+        EQUALS(reload.Has("k42"), false);
+        EQUALS(reload.Keys().empty(), true);
+
+        std::remove(exported.c_str());
+        std::remove(path.c_str());
+    });
+
+    IT("binary journaled store replays onto the mapping and compacts into a new one", {
+        const std::string path = "test_kv_binary_journal.kvs";
+        removeJournaled(path);
+        {
+            // Starts out as a JSON snapshot; the first compaction switches the file to binary.
+            KeyValueStore store(path);
+            for (int i = 0; i < 20; ++i) {
+                store.Set("k" + std::to_string(i), std::to_string(i));
+            }
+            EQUALS(store.Save(), true);
+        }
+        EQUALS(SnapshotFile::IsSnapshot(path), false);
+        {
+            KeyValueStore store(path);
+            store.SetPersistMode(PersistMode::Journal);
+            store.SetSnapshotFormat(SnapshotFormat::Binary);
+            EQUALS(store.Load(), true);
+            store.Set("k0", "zero");
+            EQUALS(store.Erase("k1"), true);
+            EQUALS(store.Save(), true);
+            EQUALS(store.Compact(), true);
+            EQUALS(SnapshotFile::IsSnapshot(path), true);
+            // Served from the freshly mapped snapshot after compaction.
+            STREQUALS(store.Get("k0").value().c_str(), "zero");
+            store.Set("k2", "two");
+            store.Erase("k3");
+            EQUALS(store.Save(), true);
+        }
+
+        KeyValueStore reload(path);
+        reload.SetPersistMode(PersistMode::Journal);
+        EQUALS(reload.Load(), true);
+        EQUALS(reload.Size(), (size_t)18);
+        STREQUALS(reload.Get("k0").value().c_str(), "zero");
+        STREQUALS(reload.Get("k2").value().c_str(), "two");
+        EQUALS(reload.Has("k1"), false);
+        EQUALS(reload.Has("k3"), false);
+
+        removeJournaled(path);
+    });
+
+    IT("rejects malformed binary snapshots instead of reading past them", {
+        const std::string path = "test_kv_binary_bad.kvs";
+        {
+            KeyValueStore store(path);
+            store.SetSnapshotFormat(SnapshotFormat::Binary);
+            store.Set("a", "1");
+            store.Set("b", "2");
+            EQUALS(store.Save(), true);
+        }
+        std::filesystem::resize_file(path, std::filesystem::file_size(path) - 1);
+        SnapshotFile file;
+        EQUALS(file.Open(path), false);
+        KeyValueStore reload(path);
+        reload.Set("keep", "me");
+        EQUALS(reload.Load(), false);
+        STREQUALS(reload.Get("keep").value().c_str(), "me");
+        std::remove(path.c_str());
+    });
+
+    IT("applies a write batch in order with one change per key", {
+        KeyValueStore store;
+        store.Set("gone", "x");
+        store.Set("kept", "y");
+
+        WriteBatch batch;
+        batch.Set("a", "1");
+        batch.Set("b", "2");
+        batch.Set("a", "3"); // replaces the earlier change to a
+        batch.Erase("gone");
+        batch.Erase("b");
+        EQUALS(batch.Changes().size(), (size_t)3);
+        STREQUALS(batch.Find("a")->value().c_str(), "3");
+        EQUALS(batch.Find("b")->has_value(), false);
+        EQUALS(batch.Find("kept") == nullptr, true);
+
+        store.Apply(batch);
+        EQUALS(store.Size(), (size_t)2);
+        STREQUALS(store.Get("a").value().c_str(), "3");
+        EQUALS(store.Has("b"), false);
+        EQUALS(store.Has("gone"), false);
+        EQUALS(store.HasUnsavedChanges(), true);
+    });
+
+    IT("journals a batch as one record that replays whole or not at all", {
+        const std::string path = "test_kv_journal_batch.json";
+        removeJournaled(path);
+        {
+            KeyValueStore store(path);
+            store.SetPersistMode(PersistMode::Journal);
+            store.Set("before", "1");
+            EQUALS(store.Save(), true);
+
+            WriteBatch batch;
+            batch.Set("points:gryffindor", "50");
+            batch.Set("contrib:harry", "50");
+            batch.Erase("before");
+            store.Apply(batch);
+            EQUALS(store.Save(), true);
+        }
+        {
+            KeyValueStore reload(path);
+            reload.SetPersistMode(PersistMode::Journal);
+            EQUALS(reload.Load(), true);
+            EQUALS(reload.Size(), (size_t)2);
+            STREQUALS(reload.Get("contrib:harry").value().c_str(), "50");
+        }
+
+        // Tear the batch record: none of its changes may come back.
+        std::filesystem::resize_file(path + ".log", std::filesystem::file_size(path + ".log") - 3);
+        KeyValueStore torn(path);
+        torn.SetPersistMode(PersistMode::Journal);
+        EQUALS(torn.Load(), true);
+        EQUALS(torn.Size(), (size_t)1);
+        STREQUALS(torn.Get("before").value().c_str(), "1");
+        EQUALS(torn.Has("points:gryffindor"), false);
+
+        removeJournaled(path);
+    });
+
+    IT("increments numeric values in place and refuses non-numbers", {
+        KeyValueStore store;
+        EQUALS(store.Incr("visits", 1).value(), 1.0);
+        EQUALS(store.Incr("visits", 41).value(), 42.0);
+        STREQUALS(store.Get("visits").value().c_str(), "42");
+        EQUALS(store.Incr("visits", -42.5).value(), -0.5);
+        STREQUALS(store.Get("visits").value().c_str(), "-0.5");
+        EQUALS(store.Incr("visits", 0.5).value(), 0.0);
+        STREQUALS(store.Get("visits").value().c_str(), "0");
+
+        store.Set("name", "Hedwig");
+        EQUALS(store.Incr("name", 1).has_value(), false);
+        STREQUALS(store.Get("name").value().c_str(), "Hedwig");
+        store.Set("big", "1e308");
+        EQUALS(store.Incr("big", 1e308).has_value(), false);
+
+        EQUALS(KeyValueStore::ParseNumber("12").value(), 12.0);
+        EQUALS(KeyValueStore::ParseNumber("12 ").has_value(), false);
+        EQUALS(KeyValueStore::ParseNumber("").has_value(), false);
+        EQUALS(KeyValueStore::ParseNumber("nan").has_value(), false);
+        STREQUALS(KeyValueStore::FormatNumber(1e21).c_str(), "1e+21");
+        STREQUALS(KeyValueStore::FormatNumber(9007199254740991.0).c_str(), "9007199254740991");
+    });
+
+    IT("coalesces repeated increments into one journal record per commit", {
+        const std::string path = "test_kv_journal_incr.json";
+        removeJournaled(path);
+        {
+            KeyValueStore store(path);
+            store.SetPersistMode(PersistMode::Journal);
+            for (int i = 0; i < 1000; ++i) {
+                store.Incr("points:ravenclaw", 1);
+            }
+            EQUALS(store.Save(), true);
+            EQUALS(std::filesystem::file_size(path + ".log") < 64, true);
+        }
+        KeyValueStore reload(path);
+        reload.SetPersistMode(PersistMode::Journal);
+        EQUALS(reload.Load(), true);
+        STREQUALS(reload.Get("points:ravenclaw").value().c_str(), "1000");
+        removeJournaled(path);
+    });
+
+    IT("sorted set orders by score then member and answers rank queries", {
+        SortedSet set;
+        EQUALS(set.Add("harry", 30), true);
+        EQUALS(set.Add("ron", 10), true);
+        EQUALS(set.Add("hermione", 50), true);
+        EQUALS(set.Add("neville", 30), true);
+        EQUALS(set.Add("ron", 60), false); // moves ron to the top
+        EQUALS(set.Size(), (size_t)4);
+
+        EQUALS(set.Rank("harry").value(), (size_t)0);
+        EQUALS(set.Rank("neville").value(), (size_t)1);
+        EQUALS(set.Rank("ron").value(), (size_t)3);
+        EQUALS(set.Rank("draco").has_value(), false);
+        EQUALS(set.Score("hermione").value(), 50.0);
+
+        const auto middle = set.RangeByRank(1, 2);
+        EQUALS(middle.size(), (size_t)2);
+        STREQUALS(middle[0].first.c_str(), "neville");
+        STREQUALS(middle[1].first.c_str(), "hermione");
+        EQUALS(set.RangeByRank(2, 100).size(), (size_t)2);
+        EQUALS(set.RangeByRank(4, 5).empty(), true);
+
+        const auto scored = set.RangeByScore(30, 50);
+        EQUALS(scored.size(), (size_t)3);
+        STREQUALS(scored[2].first.c_str(), "hermione");
+        EQUALS(set.RangeByScore(30, 50, 1).size(), (size_t)1);
+
+        EQUALS(set.Remove("harry"), true);
+        EQUALS(set.Remove("harry"), false);
+        EQUALS(set.Rank("neville").value(), (size_t)0);
+    });
+
+    IT("sorted set ranks stay consistent through random updates", {
+        SortedSet set;
+        std::set<std::pair<double, std::string>> reference;
+        std::unordered_map<std::string, double> scores;
+        std::mt19937 rng(1234);
+        for (int step = 0; step < 5000; ++step) {
+            const std::string member = "m" + std::to_string(rng() % 300);
+            if (rng() % 4 == 0) {
+                if (scores.count(member)) {
+                    reference.erase({scores[member], member});
+                    scores.erase(member);
+                }
+                set.Remove(member);
+                continue;
+            }
+            const double score = static_cast<double>(rng() % 50);
+            if (scores.count(member)) {
+                reference.erase({scores[member], member});
+            }
+            scores[member] = score;
+            reference.insert({score, member});
+            set.Add(member, score);
+        }
+        EQUALS(set.Size(), reference.size());
+        size_t rank = 0;
+        bool ranksMatch = true;
+        for (const auto &[score, member] : reference) {
+            ranksMatch = ranksMatch && set.Rank(member) == rank++;
+        }
+        EQUALS(ranksMatch, true);
+        const auto all = set.RangeByRank(0, set.Size());
+        bool orderMatches = all.size() == reference.size();
+        auto it = reference.begin();
+        for (size_t i = 0; orderMatches && i < all.size(); ++i, ++it) {
+            orderMatches = all[i].first == it->second && all[i].second == it->first;
+        }
+        EQUALS(orderMatches, true);
+    });
+
+    IT("sorted sets persist as store keys and rebuild from them", {
+        const std::string path = "test_kv_zset.json";
+        removeJournaled(path);
+        {
+            KeyValueStore store(path);
+            store.SetPersistMode(PersistMode::Journal);
+            SortedSets boards(store);
+            EQUALS(boards.Add("kills", "harry", 3), true);
+            EQUALS(boards.IncrBy("kills", "draco", 5).value(), 5.0);
+            EQUALS(boards.IncrBy("kills", "harry", 4).value(), 7.0);
+            EQUALS(boards.IncrBy("kills", "harry", 1e308 * 10).has_value(), false);
+            STREQUALS(store.Get("zset:kills:harry").value().c_str(), "7");
+            EQUALS(boards.Remove("kills", "nobody"), false);
+            EQUALS(store.Save(), true);
+        }
+        KeyValueStore store(path);
+        store.SetPersistMode(PersistMode::Journal);
+        EQUALS(store.Load(), true);
+        SortedSets boards(store);
+        EQUALS(boards.Get("kills").Size(), (size_t)2);
+        EQUALS(boards.Get("kills").Rank("harry").value(), (size_t)1);
+        EQUALS(boards.Get("other").Size(), (size_t)0);
+
+        // A direct write to a member key is picked up once reported.
+        store.Set("zset:kills:ron", "100");
+        boards.Invalidate("zset:kills:ron");
+        EQUALS(boards.Get("kills").Rank("ron").value(), (size_t)2);
+        EQUALS(boards.Remove("kills", "ron"), true);
+        EQUALS(store.Has("zset:kills:ron"), false);
+
+        EQUALS(SortedSets::IsValidName("kills"), true);
+        EQUALS(SortedSets::IsValidName("a:b"), false);
+        EQUALS(SortedSets::IsValidName(""), false);
+        removeJournaled(path);
+    });
+
+    IT("timer wheel fires every timer on the first advance at or after its deadline", {
+        TimerWheel wheel(10);
+        std::mt19937_64 rng(42);
+        const uint64_t start = 1'000'000;
+        std::unordered_map<std::string, uint64_t> deadlines;
+        for (int i = 0; i < 2000; ++i) {
+            // Spread over every level the test reaches: up to ~64^3 ticks out.
+            const uint64_t deadline = start + rng() % (i % 2 ? 5'000 : 3'000'000);
+            deadlines["t" + std::to_string(i)] = deadline;
+            wheel.Schedule("t" + std::to_string(i), deadline, start);
+        }
+        std::vector<TimerWheel::Timer> due;
+        bool onTime = true;
+        size_t fired = 0;
+        for (uint64_t now = start; now <= start + 3'000'000; now += 1 + rng() % 997) {
+            due.clear();
+            wheel.Advance(now, due);
+            for (const auto &timer : due) {
+                // Never early; and nothing still pending is overdue by more than one resolution step.
+                onTime = onTime && timer.deadlineMs <= now && deadlines[timer.key] == timer.deadlineMs;
+                deadlines.erase(timer.key);
+                ++fired;
+            }
+            for (const auto &[key, deadline] : deadlines) {
+                onTime = onTime && deadline + 10 > now;
+            }
+        }
+        due.clear();
+        wheel.Advance(start + 3'000'010, due);
+        fired += due.size();
+        EQUALS(onTime, true);
+        EQUALS(fired, (size_t)2000);
+        EQUALS(wheel.Size(), (size_t)0);
+
+        // Already due, and far beyond the top level's span.
+        wheel.Schedule("late", start, start + 5'000'000);
+        wheel.Schedule("far", UINT64_MAX / 2, start + 5'000'000);
+        due.clear();
+        wheel.Advance(start + 5'000'000, due);
+        EQUALS(due.size(), (size_t)1);
+        EQUALS(wheel.Size(), (size_t)1);
+    });
+
+    IT("expired keys read as missing and are reaped within the budget", {
+        uint64_t now = 5'000;
+        KeyValueStore store;
+        store.SetClock([&] {
+            return now;
+        });
+        for (int i = 0; i < 10; ++i) {
+            store.Set("cooldown:" + std::to_string(i), "1");
+            EQUALS(store.Expire("cooldown:" + std::to_string(i), 1'000), true);
+        }
+        store.Set("keep", "1");
+        EQUALS(store.Expire("missing", 1'000), false);
+        EQUALS(store.TimeToLive("cooldown:3").value(), (uint64_t)1'000);
+        EQUALS(store.TimeToLive("keep").has_value(), false);
+
+        now += 999;
+        EQUALS(store.ReapExpired(100), (size_t)0);
+        EQUALS(store.Has("cooldown:0"), true);
+
+        now += 1;
+        EQUALS(store.Has("cooldown:0"), false);
+        EQUALS(store.Get("cooldown:0").has_value(), false);
+        EQUALS(store.Keys("cooldown:").empty(), true);
+        EQUALS(store.Size(), (size_t)11); // not reaped yet
+        std::vector<std::string> reaped;
+        EQUALS(store.ReapExpired(4, [&](const std::string &key) {
+            reaped.push_back(key);
+        }),
+               (size_t)4);
+        EQUALS(reaped.size(), (size_t)4);
+        EQUALS(store.ReapExpired(100), (size_t)6);
+        EQUALS(store.Size(), (size_t)1);
+
+        // Set drops the deadline; Incr keeps it; an expired counter starts over.
+        store.Set("a", "1");
+        store.Expire("a", 50);
+        store.Set("a", "2");
+        EQUALS(store.TimeToLive("a").has_value(), false);
+        store.Set("hits", "1");
+        store.Expire("hits", 50);
+        EQUALS(store.Incr("hits", 1).value(), 2.0);
+        EQUALS(store.TimeToLive("hits").value(), (uint64_t)50);
+        now += 50;
+        EQUALS(store.Incr("hits", 1).value(), 1.0);
+        EQUALS(store.TimeToLive("hits").has_value(), false);
+        EQUALS(store.ReapExpired(100), (size_t)0); // the stale timer finds nothing to do
+        EQUALS(store.Get("hits").value(), std::string("1"));
+    });
+
+    IT("journals deadlines, re-logs them on compaction and drops expired keys from snapshots", {
+        const std::string path = "test_kv_journal_ttl.json";
+        removeJournaled(path);
+        uint64_t now           = 1'000'000;
+        const auto clock       = [&] {
+            return now;
+        };
+        {
+            KeyValueStore store(path);
+            store.SetClock(clock);
+            store.SetPersistMode(PersistMode::Journal);
+            store.Set("session", "token");
+            store.Expire("session", 60'000);
+            store.Set("ban", "yes");
+            store.Expire("ban", 10);
+            store.Set("forever", "1");
+            store.Expire("forever", 10);
+            store.ClearExpiry("forever");
+            EQUALS(store.Save(), true);
+        }
+        {
+            KeyValueStore store(path);
+            store.SetClock(clock);
+            store.SetPersistMode(PersistMode::Journal);
+            EQUALS(store.Load(), true);
+            EQUALS(store.TimeToLive("session").value(), (uint64_t)60'000);
+            EQUALS(store.TimeToLive("forever").has_value(), false);
+            now += 10;
+            EQUALS(store.Has("ban"), false);
+            // The snapshot skips the expired key; the fresh log gets the live deadline back.
+            EQUALS(store.Compact(), true);
+        }
+        KeyValueStore store(path);
+        store.SetClock(clock);
+        store.SetPersistMode(PersistMode::Journal);
+        EQUALS(store.Load(), true);
+        EQUALS(store.Size(), (size_t)2);
+        EQUALS(store.TimeToLive("session").value(), (uint64_t)59'990);
+        now += 60'000;
+        EQUALS(store.ReapExpired(10), (size_t)1);
+        EQUALS(store.Keys().size(), (size_t)1);
+        removeJournaled(path);
+    });
 });
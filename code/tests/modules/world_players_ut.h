@@ -14,7 +14,9 @@
 
 #include <mafianet/types.h>
 
+#include <cstdint>
 #include <string>
+#include <vector>
 
 // Integration test for the World player-query builtins. Stands up a real NetworkServer (binds a
 // loopback UDP socket) populated with human entities, then queries them from JavaScript exactly as a
@@ -28,8 +30,68 @@ MODULE(world_players, {
     using Framework::Networking::Replication::EntityRegistry;
     using Framework::Networking::Replication::NetworkEntity;
     using Framework::Networking::Replication::ReplicationManager;
+    using HogwartsMP::Core::Modules::HumanRegistry;
     using HogwartsMP::Shared::HumanEntity;
 
+    IT("keeps the human registry dense through adds and removals", {
+        // The registry never dereferences its entries, so stand-ins will do.
+        HumanEntity *const a = reinterpret_cast<HumanEntity *>(0x10);
+        HumanEntity *const b = reinterpret_cast<HumanEntity *>(0x20);
+        HumanEntity *const c = reinterpret_cast<HumanEntity *>(0x30);
+
+        HumanRegistry registry;
+        registry.Add(1, a, true);
+        registry.Add(2, b, false);
+        registry.Add(3, c, true);
+        EQUALS(registry.Size(), (size_t)3);
+        EQUALS(registry.PlayerCount(), (size_t)2);
+        EQUALS(registry.Find(2), b);
+        EQUALS(registry.FindPlayer(2), (HumanEntity *)nullptr);
+        EQUALS(registry.FindPlayer(3), c);
+
+        // Removing the first player moves the last one into its slot; lookups follow it.
+        registry.Remove(1, a);
+        EQUALS(registry.Find(1), (HumanEntity *)nullptr);
+        EQUALS(registry.PlayerCount(), (size_t)1);
+        EQUALS(registry.Players()[0], c);
+        EQUALS(registry.Find(3), c);
+        EQUALS(registry.FindPlayer(3), c);
+
+        // A stale pointer does not evict the entity that now holds the id.
+        registry.Add(2, a, true);
+        registry.Remove(2, b);
+        EQUALS(registry.Find(2), a);
+        EQUALS(registry.Size(), (size_t)2);
+        EQUALS(registry.PlayerCount(), (size_t)2);
+
+        registry.Clear();
+        EQUALS(registry.Size(), (size_t)0);
+        EQUALS(registry.Find(3), (HumanEntity *)nullptr);
+    });
+
+    IT("recycles server humans' memory and buffers across despawn and spawn", {
+        using HogwartsMP::Core::Modules::ServerHuman;
+        ServerHuman::Pool::Trim();
+
+        HumanEntity *first = new ServerHuman;
+        first->nickname    = std::string(64, 'n');
+        first->ccd.boneScales.resize(8);
+        const void *block = first;
+        delete first;
+        EQUALS(ServerHuman::Pool::Pooled(), (size_t)1);
+
+        // The next one lands in the same block, with the old nickname and ccd buffers cleared but kept.
+        auto *second = new ServerHuman;
+        EQUALS(static_cast<const void *>(second), block);
+        EQUALS(ServerHuman::Pool::Pooled(), (size_t)0);
+        EQUALS(second->nickname.empty(), true);
+        EQUALS(second->nickname.capacity() >= 64, true);
+        EQUALS(second->ccd.boneScales.empty(), true);
+        EQUALS(second->ccd.boneScales.capacity() >= 8, true);
+        delete second;
+        ServerHuman::Pool::Trim();
+    });
+
     IT("World queries reflect the server's connected players and exclude NPCs", {
         HogwartsMP::Core::Modules::Human::Register();
 
@@ -60,9 +122,11 @@ MODULE(world_players, {
         const auto makeHuman = [&](MafiaNet::PeerGuid owner, const char *nick) -> HumanEntity * {
             auto *h = static_cast<HumanEntity *>(repl->CreateEntity(typeId));
             if (h) {
-                // Set ownership directly rather than via SetOwner, which would RPC a non-connected peer.
+                // Set ownership directly rather than via SetOwner, which would RPC a non-connected peer,
+                // and register the entity as Core::Modules::Human::CreatePlayer / Spawn would.
                 h->ownerGUID = owner;
                 h->nickname  = nick;
+                HumanRegistry::Get().Add(h->GetNetworkID(), h, owner != MafiaNet::UNASSIGNED_PEER_GUID);
             }
             return h;
         };
@@ -75,9 +139,18 @@ MODULE(world_players, {
         NEQUALS(p2, (HumanEntity *)nullptr);
         NEQUALS(npc, (HumanEntity *)nullptr);
 
+        // A batch of NPCs lands in the registry in one pass, unowned, each at its own position.
+        const auto batch = HogwartsMP::Core::Modules::Human::SpawnMany(repl, {{10.0f, 0.0f, 0.0f}, {20.0f, 0.0f, 0.0f}, {30.0f, 0.0f, 0.0f}}, nullptr);
+        EQUALS(batch.size(), (size_t)3);
+        EQUALS(HumanRegistry::Get().Size(), (size_t)6);
+        EQUALS(HumanRegistry::Get().PlayerCount(), (size_t)2);
+        EQUALS(batch[2]->position == glm::vec3(30.0f, 0.0f, 0.0f), true);
+        EQUALS(HogwartsMP::Core::Modules::Human::Find(batch[1]->GetNetworkID()), batch[1]);
+
         // Resolution must work before the JS layer leans on it (getPlayers builds Human handles, which
         // resolve by NetworkID); assert it here so a resolution gap fails cleanly instead of throwing.
         EQUALS(repl->GetEntity<HumanEntity>(p1->GetNetworkID()), p1);
+        EQUALS(HogwartsMP::Core::Modules::Human::Find(p1->GetNetworkID()), p1);
 
         NodeEngine engine({});
         EQUALS(engine.Init(), ScriptingError::SCRIPTING_NONE);
@@ -120,6 +193,46 @@ MODULE(world_players, {
             EQUALS(evalBool("World.getPlayer(" + p1Id + ").nickname === 'Alice'"), true);
             EQUALS(evalBool("World.getPlayer(" + npcId + ") === undefined"), true);
             EQUALS(evalBool("World.getPlayer(999999) === undefined"), true);
+
+            // setTransforms moves the entities it finds in one call and skips unknown ids.
+            EQUALS(evalInt("World.setTransforms(new Float64Array([" + npcId + ", 999999]), new Float32Array([1, 2, 3, 0, 0, 90, 4, 5, 6, 0, 0, 0, 0, 0, 0, 0, 0, 0]), "
+                           "new Uint8Array([2, 0]))"),
+                   1);
+            EQUALS(npc->position == glm::vec3(1.0f, 2.0f, 3.0f), true);
+            EQUALS(npc->velocity == glm::vec3(4.0f, 5.0f, 6.0f), true);
+            EQUALS(npc->IsInAir(), true);
+
+            // moveAlong hands an NPC to the native mover, which walks it to the end of the path (in the
+            // air, hopping) and reports the arrival. Players are left to their client.
+            using HogwartsMP::Core::Modules::NpcMovement;
+            std::vector<uint64_t> arrived;
+            EQUALS(evalBool("World.getPlayer(" + p1Id + ").moveAlong([{x: 0, y: 0, z: 0}], 100) === false"), true);
+            EQUALS(evalBool("try { World.getPlayer(" + p1Id + ").moveAlong([], 100); false } catch (e) { e instanceof TypeError }"), true);
+            EQUALS(evalBool("new Framework.Human(" + npcId + ").moveAlong([{x: 1, y: 2, z: 3}, {x: 1, y: 102, z: 3}], 100, {arc: 20})"), true);
+            EQUALS(evalBool("new Framework.Human(" + npcId + ").isMoving()"), true);
+            for (int i = 0; i < 60 && arrived.empty(); ++i) {
+                NpcMovement::Get().Advance(NpcMovement::kStepSeconds, arrived);
+            }
+            EQUALS(arrived.size(), (size_t)1);
+            EQUALS(arrived[0], static_cast<uint64_t>(npc->GetNetworkID()));
+            EQUALS(npc->position == glm::vec3(1.0f, 102.0f, 3.0f), true);
+            EQUALS(npc->velocity == glm::vec3(0.0f, 0.0f, 0.0f), true);
+            EQUALS(npc->IsInAir(), false);
+            EQUALS(evalBool("new Framework.Human(" + npcId + ").isMoving()"), false);
+
+            // An NPC already on a broom rides the trip's broom and is back on its own when it arrives.
+            using HogwartsMP::Shared::Modules::HumanSync;
+            npc->SetFlag(HumanSync::Mounted, true);
+            npc->data.mountId = 3;
+            arrived.clear();
+            EQUALS(evalBool("new Framework.Human(" + npcId + ").moveAlong([{x: 1, y: 2, z: 3}], 100, {mount: 5})"), true);
+            EQUALS(npc->data.mountId, (uint8_t)5);
+            for (int i = 0; i < 60 && arrived.empty(); ++i) {
+                NpcMovement::Get().Advance(NpcMovement::kStepSeconds, arrived);
+            }
+            EQUALS(arrived.size(), (size_t)1);
+            EQUALS(npc->IsMounted(), true);
+            EQUALS(npc->data.mountId, (uint8_t)3);
         }
         engine.Shutdown();
 
@@ -128,5 +241,10 @@ MODULE(world_players, {
         repl->DestroyEntity(p1);
         repl->DestroyEntity(p2);
         repl->DestroyEntity(npc);
+        for (auto *human : batch) {
+            repl->DestroyEntity(human);
+        }
+        // Destroyed entities leave the registry on their own.
+        EQUALS(HumanRegistry::Get().Size(), (size_t)0);
     });
 });
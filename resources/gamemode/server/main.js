@@ -7,7 +7,7 @@
  *   World.sendChatMessage(human, message)
  *   Environment.setWeather(name) / setTime(h, m) / setDate(d, m) / setSeason(0-3)
  *   Framework.Human - player entity class (nickname, position, rotation, sendChat)
- *   Storage.get(key) / set(key, value) / has(key) / delete(key) / keys()
+ *   Storage.get(key) / set(key, value) / has(key) / delete(key) / keys() / incr(key, delta)
  *     - persistent key/value store; values are strings (use JSON.stringify/parse for objects).
  */
 
@@ -16,12 +16,10 @@ console.log("[GAMEMODE] Script loading...");
 // The framework exposes the event bus on the Core global
 const Events = Core.Events;
 
-// Persistent across restarts via the Storage builtin (storage.json). Demonstrates the persistence
+// Persistent across restarts via the Storage builtin (storage.kvs). Demonstrates the persistence
 // layer the server-concept ideas (House Points, leaderboards, NPC memory) build on.
 function bumpVisitCount() {
-    const next = (parseInt(Storage.get("visits") ?? "0", 10) || 0) + 1;
-    Storage.set("visits", String(next));
-    return next;
+    return Storage.incr("visits");
 }
 
 const SEASONS = { spring: 0, summer: 1, autumn: 2, winter: 3 };
@@ -81,13 +79,14 @@ let npcBroomTimer = null;
 let npcCastTimer = null;
 let npcLumosOn = false;
 let npcDodgeTimer = null;
+// /patrolnpcs: the loop every NPC walks natively (npc.moveAlong), restarted on each npcArrived.
+let npcPatrol = null;
 
 Events.on("playerConnect", (player) => {
     const visits = bumpVisitCount();
     // Per-player persistent count — keyed to the player's stable identity, so it survives reconnect
-    // (unlike the global counter, which is total connections). Demonstrates Human.getData/setData.
-    const mine = (parseInt(player.getData("visits") ?? "0", 10) || 0) + 1;
-    player.setData("visits", String(mine));
+    // (unlike the global counter, which is total connections). Demonstrates Human.incrData.
+    const mine = player.incrData("visits");
 
     console.log(`[GAMEMODE] ${player.nickname} connected (server visit #${visits}, their visit #${mine})`);
     player.sendChat("[SERVER] Welcome to HogwartsMP! Commands: /weather /time /date /season");
@@ -98,6 +97,13 @@ Events.on("playerDisconnect", (player) => {
     console.log(`[GAMEMODE] ${player.nickname} disconnected`);
 });
 
+Events.on("npcArrived", (npc) => {
+    // Same object as the one in npcs (one wrapper per entity), so includes() finds it.
+    if (npcPatrol && npcs.includes(npc)) {
+        npc.moveAlong(npcPatrol.points, npcPatrol.speed, { spline: true });
+    }
+});
+
 Events.on("chatMessage", (player, message) => {
     World.broadcastMessage(`${player.nickname}: ${message}`);
 });
@@ -188,6 +194,24 @@ Events.on("chatCommand", (player, message, command, args) => {
             break;
         }
 
+        case "spawnnpcs": {
+            // Fill up to MAX_NPCS in one World.spawnHumans call, in a row beside the player, already
+            // wearing the player's look (no per-NPC mirrorAppearanceFrom).
+            const count = Math.min(parseInt(args[0] ?? "5", 10) || 0, MAX_NPCS - npcs.length);
+            if (count <= 0) {
+                player.sendChat(`[DEV] NPC limit reached (${MAX_NPCS}) — /clearnpcs first`);
+                break;
+            }
+            const p = player.position;
+            const positions = new Float32Array(count * 3);
+            for (let i = 0; i < count; i++) {
+                positions.set([p.x + 100, p.y + (i - (count - 1) / 2) * 100, p.z], i * 3);
+            }
+            npcs.push(...World.spawnHumans(positions, { appearanceFrom: player.id }));
+            player.sendChat(`[DEV] Spawned ${count} NPC(s) wearing your appearance`);
+            break;
+        }
+
         case "mirrornpcs": {
             if (npcs.length === 0) {
                 player.sendChat("[DEV] No NPCs to mirror — use /spawnnpc first");
@@ -234,6 +258,11 @@ Events.on("chatCommand", (player, message, command, args) => {
             let angle = 0;
             let phase = 0;
             let phaseT = 0;
+            // One World.setTransforms call per tick for the whole crowd (9 floats each: position,
+            // Euler rotation, velocity), instead of several property writes per NPC.
+            const ids = Float64Array.from(npcs, (npc) => npc.id);
+            const transforms = new Float32Array(npcs.length * 9);
+            const flags = new Uint8Array(npcs.length);
             npcWalkTimer = setInterval(() => {
                 const { speed, dur, inAir } = PHASES[phase];
                 phaseT += DT;
@@ -245,18 +274,15 @@ Events.on("chatCommand", (player, message, command, args) => {
                 const hop = inAir ? Math.sin(Math.PI * (phaseT / dur)) * 120 : 0; // little jump arc
                 for (let i = 0; i < npcs.length; i++) {
                     const a = angle + (i * 2 * Math.PI) / npcs.length;
-                    // Vector3.set() — assigning pos.x/.y/.z directly only writes a JS shadow
-                    // (SetNativeDataProperty), leaving the C++ vector unchanged → the move is a no-op.
-                    const pos = npcs[i].position;
-                    pos.set(center.x + Math.cos(a) * RADIUS, center.y + Math.sin(a) * RADIUS, center.z + hop);
-                    npcs[i].position = pos;
+                    const t = transforms.subarray(i * 9, i * 9 + 9);
+                    t[0] = center.x + Math.cos(a) * RADIUS;
+                    t[1] = center.y + Math.sin(a) * RADIUS;
+                    t[2] = center.z + hop;
                     // Face the movement tangent (Euler yaw about Z); the client reads it back as facing.
-                    const yawDeg = (Math.atan2(Math.cos(a), -Math.sin(a)) * 180) / Math.PI;
-                    const rot = npcs[i].rotation;
-                    rot.set(0, 0, yawDeg);
-                    npcs[i].rotation = rot;
-                    npcs[i].setInAir(inAir); // re-asserted each tick → clears itself when the jump ends
+                    t[5] = (Math.atan2(Math.cos(a), -Math.sin(a)) * 180) / Math.PI;
+                    flags[i] = inAir ? 2 : 0; // InAir, re-asserted each tick → clears itself when the jump ends
                 }
+                World.setTransforms(ids, transforms, flags);
             }, 50);
             player.sendChat(`[DEV] Walking ${npcs.length} NPC(s): idle→walk→run→sprint→jump (run /walknpcs again to stop)`);
             break;
@@ -284,24 +310,58 @@ Events.on("chatCommand", (player, message, command, args) => {
             const DT = 0.05; // 50 ms tick, in seconds
             const SPEED = 1500; // flight speed cm/s
             let angle = 0;
+            // No flags argument: setTransforms leaves the Mounted state set above alone.
+            const ids = Float64Array.from(npcs, (npc) => npc.id);
+            const transforms = new Float32Array(npcs.length * 9);
             npcBroomTimer = setInterval(() => {
                 angle += (SPEED / RADIUS) * DT; // linear -> angular
                 for (let i = 0; i < npcs.length; i++) {
                     const a = angle + (i * 2 * Math.PI) / npcs.length;
-                    const pos = npcs[i].position;
-                    pos.set(center.x + Math.cos(a) * RADIUS, center.y + Math.sin(a) * RADIUS, center.z + 300);
-                    npcs[i].position = pos;
-                    const rot = npcs[i].rotation;
-                    rot.set(0, 0, (Math.atan2(Math.cos(a), -Math.sin(a)) * 180) / Math.PI);
-                    npcs[i].rotation = rot;
+                    const t = transforms.subarray(i * 9, i * 9 + 9);
+                    t[0] = center.x + Math.cos(a) * RADIUS;
+                    t[1] = center.y + Math.sin(a) * RADIUS;
+                    t[2] = center.z + 300;
+                    t[5] = (Math.atan2(Math.cos(a), -Math.sin(a)) * 180) / Math.PI;
                     // Orbit tangent velocity (cm/s): d/dt of the position above.
-                    npcs[i].setVelocity(-Math.sin(a) * SPEED, Math.cos(a) * SPEED, 0);
+                    t[6] = -Math.sin(a) * SPEED;
+                    t[7] = Math.cos(a) * SPEED;
                 }
+                World.setTransforms(ids, transforms);
             }, 50);
             player.sendChat(`[DEV] ${npcs.length} NPC(s) on brooms, orbiting (run /broomnpcs again to dismount)`);
             break;
         }
 
+        case "patrolnpcs": {
+            if (npcPatrol) {
+                npcPatrol = null;
+                for (const npc of npcs) npc.stopMoving();
+                player.sendChat("[DEV] NPC patrol stopped");
+                break;
+            }
+            if (npcs.length === 0) {
+                player.sendChat("[DEV] No NPCs to patrol — use /spawnnpc first");
+                break;
+            }
+            // Hand each NPC a smooth loop around you once; the server moves them from there and only
+            // calls back (npcArrived) when a lap ends — no per-tick script work.
+            const c = player.position;
+            const SIDE = 600; // ~6 m square
+            npcPatrol = {
+                points: [
+                    { x: c.x + SIDE, y: c.y, z: c.z },
+                    { x: c.x + SIDE, y: c.y + SIDE, z: c.z },
+                    { x: c.x - SIDE, y: c.y + SIDE, z: c.z },
+                    { x: c.x - SIDE, y: c.y - SIDE, z: c.z },
+                    { x: c.x + SIDE, y: c.y - SIDE, z: c.z },
+                ],
+                speed: 350, // run, cm/s
+            };
+            for (const npc of npcs) npc.moveAlong(npcPatrol.points, npcPatrol.speed, { spline: true });
+            player.sendChat(`[DEV] ${npcs.length} NPC(s) patrolling around you (run /patrolnpcs again to stop)`);
+            break;
+        }
+
         case "castnpcs": {
             if (npcCastTimer) {
                 clearInterval(npcCastTimer);
@@ -362,8 +422,27 @@ Events.on("chatCommand", (player, message, command, args) => {
             break;
         }
 
+        case "crowd": {
+            if (World.getCrowdSize() > 0) {
+                const n = World.clearCrowd();
+                player.sendChat(`[DEV] Crowd of ${n} removed`);
+                break;
+            }
+            // A few thousand lightweight NPCs milling around a 100 m square centred on you, wearing your
+            // look. Only those near a player become real entities, so MAX_NPCS doesn't apply.
+            const count = Math.min(parseInt(args[0], 10) || 2000, 16384);
+            const c = player.position;
+            const HALF = 5000;
+            const added = World.spawnCrowd(count, c.x - HALF, c.y - HALF, c.x + HALF, c.y + HALF, c.z, {
+                appearanceFrom: [player.id],
+            });
+            player.sendChat(`[DEV] Crowd of ${added} spawned (run /crowd again to remove)`);
+            break;
+        }
+
         case "clearnpcs": {
             npcLumosOn = false;
+            npcPatrol = null;
             if (npcDodgeTimer) {
                 clearInterval(npcDodgeTimer);
                 npcDodgeTimer = null;
@@ -34,6 +34,12 @@ declare const Game: {
      * (e.g. JSON.stringify(obj)).
      */
     emitServer(eventName: string, payloadJson: string): void;
+    /**
+     * emitServer without the JSON text: `value` (plain data, ArrayBuffers, nested up to 32 levels,
+     * 64 KiB packed) is packed natively and arrives as the server handler's payload. Throws a
+     * TypeError for anything unpackable.
+     */
+    emitServerPacked(eventName: string, value: any): void;
 };
 
 /** The local player's world position (cm). */
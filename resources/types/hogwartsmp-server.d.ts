@@ -57,21 +57,54 @@ interface Human extends Entity {
      * (e.g. JSON.stringify(obj)). Empty -> the client handler is called with no argument.
      */
     emit(eventName: string, payloadJson: string): void;
+    /**
+     * emit without the JSON text: `value` (plain data, ArrayBuffers, nested up to 32 levels, 64 KiB
+     * packed) is packed natively and arrives as the client handler's payload. Throws a TypeError for
+     * anything unpackable.
+     */
+    emitPacked(eventName: string, value: any): void;
     /**
      * Per-player persistent data, keyed to the player's stable identity (survives reconnect — unlike
-     * `id` or `nickname`). Backed by the same store as `Storage`, namespaced per player. Values are
-     * strings (use JSON.stringify/parse). On an entity with no identity (a server NPC), `getData`
-     * returns `undefined` and the setters are no-ops.
+     * `id` or `nickname`). Stored in the player's own file, resident while they are connected
+     * (including during `playerDisconnect`); separate from `Storage`. Values are strings (use
+     * JSON.stringify/parse). On an entity with no identity (a server NPC), `getData` returns
+     * `undefined` and the setters are no-ops.
      */
     getData(key: string): string | undefined;
     setData(key: string, value: string): void;
     hasData(key: string): boolean;
     /** Returns true if a key was removed. */
     deleteData(key: string): boolean;
+    /** Like `Storage.incr`, on this player's data; `undefined` on an entity with no identity. */
+    incrData(key: string, delta?: number): number | undefined;
+    /**
+     * Like `getData` / `setData`, but settle on a later server tick once the player's data has loaded
+     * from disk, instead of blocking the server until it has (as `getData` does right after connect).
+     */
+    getDataAsync(key: string): Promise<string | undefined>;
+    setDataAsync(key: string, value: string): Promise<void>;
     /** Despawn. Affects only server-owned NPCs; real players are managed by the network layer. */
     destroy(): void;
     /** Copy another human's worn appearance (by network id) onto this one and broadcast it. */
     mirrorAppearanceFrom(sourceId: number): void;
+    /**
+     * Walk a server NPC along `points` at `speed` cm/s, moved natively every tick; "npcArrived" fires at
+     * the last point. Replaces any current path. Throws a TypeError for an empty / over-1024-point path or
+     * a non-positive speed; returns false for a real player.
+     */
+    moveAlong(points: { x: number; y: number; z: number }[] | Float32Array, speed: number, options?: MoveAlongOptions): boolean;
+    /** Stop a moveAlong where the NPC stands (no npcArrived). False if it was not moving. */
+    stopMoving(): boolean;
+    isMoving(): boolean;
+}
+
+interface MoveAlongOptions {
+    /** Curve smoothly through the points (Catmull-Rom) instead of straight lines. */
+    spline?: boolean;
+    /** Hop over each leg in an arc this high (cm), in the air. */
+    arc?: number;
+    /** Ride this broom (mount id) for the trip; on arrival the NPC's earlier mount state comes back. */
+    mount?: number;
 }
 
 // --- Global modules ---
@@ -86,16 +119,53 @@ declare const World: {
      * on the client, so pass JSON text. Empty -> handler called with no argument.
      */
     emitAllClients(eventName: string, payloadJson: string): void;
+    /** emitAllClients with a natively packed payload; see Human.emitPacked. */
+    emitAllClientsPacked(eventName: string, value: any): void;
     /** Every connected player. Server-owned NPCs are excluded. */
     getPlayers(): Human[];
     /** The connected player with the given network id, or undefined. */
     getPlayer(id: number): Human | undefined;
     /** Number of connected players (cheaper than getPlayers().length). */
     getPlayerCount(): number;
+    /**
+     * While a client event of this name is queued for the next tick, a newer one from the same player
+     * replaces its payload instead of dispatching twice. For "latest value wins" events.
+     */
+    setClientEventCoalescing(eventName: string, enabled: boolean): void;
     /** Spawn a server-owned NPC at a world position; despawn with the returned handle's destroy(). */
     spawnHuman(x: number, y: number, z: number): Human;
+    /**
+     * Spawn one NPC per position (an array of points or a Float32Array of xyz triples, 4096 at most) in
+     * a single pass. `appearanceFrom` gives them all that human's current look from the start.
+     */
+    spawnHumans(positions: { x: number; y: number; z: number }[] | Float32Array, options?: { appearanceFrom?: number }): Human[];
+    /**
+     * Move many humans in one native call. `transforms` holds 9 floats per id: position xyz, rotation
+     * (Euler degrees) xyz, velocity xyz. `flags`, if given, replaces each entity's state byte
+     * (Mounted 1, InAir 2, Dodge 4, Cast 8, Lumos 16). Unknown ids are skipped; returns how many were
+     * updated.
+     */
+    setTransforms(ids: Float64Array | Uint32Array | Int32Array, transforms: Float32Array, flags?: Uint8Array): number;
+    /**
+     * Add up to `count` ambient NPCs wandering the rectangle at height `z`. They are simulated natively
+     * (16384 at most) and only become entities (256 at most) while a player can see them; those entities
+     * are not handed to scripts. Returns how many were added.
+     */
+    spawnCrowd(count: number, minX: number, minY: number, maxX: number, maxY: number, z: number, options?: CrowdOptions): number;
+    /** Remove every crowd agent; returns how many there were. */
+    clearCrowd(): number;
+    getCrowdSize(): number;
 };
 
+interface CrowdOptions {
+    /** Walking speed, cm/s (default 140). */
+    speed?: number;
+    /** Distance (cm) agents keep from each other (default 120). */
+    separation?: number;
+    /** Humans whose current looks the agents share, in turn. */
+    appearanceFrom?: number[];
+}
+
 declare const Environment: {
     setWeather(name: string): void;
     setTime(hour: number, minute: number): void;
@@ -105,16 +175,84 @@ declare const Environment: {
 };
 
 /**
- * Persistent key/value store (backed by storage.json, flushed on every write). Values are strings —
+ * Persistent key/value store (backed by storage.kvs, committed by a background thread every ~250 ms
+ * and on shutdown). Values are strings —
  * wrap structured data with JSON.stringify / JSON.parse. Single global namespace (no per-player yet).
  */
 declare const Storage: {
     get(key: string): string | undefined;
-    set(key: string, value: string): void;
+    /**
+     * Store `value` at `key`, replacing any value and expiry. With `ttlMs` the key expires that many ms
+     * from now: it reads as missing from then on and is deleted (also from disk) shortly after.
+     * `ttlMs` can't be used inside `transaction`.
+     */
+    set(key: string, value: string, options?: { ttlMs?: number }): void;
+    /** ms until `key` expires; `undefined` if it doesn't exist or never expires. */
+    ttl(key: string): number | undefined;
     has(key: string): boolean;
     /** Returns true if a key was removed. */
     delete(key: string): boolean;
-    keys(): string[];
+    /** Keys starting with `prefix` (all keys when omitted), in sorted order; at most `limit` (0 = no limit). */
+    keys(prefix?: string, limit?: number): string[];
+    /** `[key, value]` pairs whose key starts with `prefix`, in sorted key order; at most `limit`. */
+    entries(prefix?: string, limit?: number): [string, string][];
+    /** `[key, value]` pairs with `start <= key < end` (no upper bound when `end` is omitted or ""), sorted. */
+    range(start: string, end?: string, limit?: number): [string, string][];
+    /** Write every key to `path` as a JSON object (for backups / hand editing). Returns false on an I/O error. */
+    exportJson(path: string): boolean;
+    /** Set several keys as one change (one commit; all or nothing if a value isn't a string). */
+    setMany(values: Record<string, string>): void;
+    /** Values for `keys`, in the same order (`undefined` for a missing key). */
+    getMany(keys: string[]): (string | undefined)[];
+    /** Delete several keys as one change; returns how many existed. */
+    deleteMany(keys: string[]): number;
+    /**
+     * Add `delta` (default 1) to the number stored at `key` — a missing key counts as 0 — and return
+     * the new value. The value stays a string (`get` returns "42"). Throws if the stored value isn't a
+     * number.
+     */
+    incr(key: string, delta?: number): number;
+    /**
+     * Run `fn` and apply the `Storage` writes it makes together when it returns — or none of them if it
+     * throws. Reads inside `fn` see its own writes; `keys` / `entries` / `range` throw inside it. `fn`
+     * must be synchronous. Player data (`setData`) isn't part of the transaction.
+     */
+    transaction<T>(fn: () => T): T;
+
+    // Sorted sets (leaderboards). Member `m` of set `s` is stored as the key "zset:s:m"; set names
+    // can't contain ':'. None of these can be used inside `transaction`.
+
+    /** Set `member`'s score; true if the member is new. */
+    zadd(set: string, member: string, score: number): boolean;
+    /** Add `delta` (default 1) to `member`'s score (a missing member counts as 0); returns the new score. */
+    zincr(set: string, member: string, delta?: number): number;
+    zscore(set: string, member: string): number | undefined;
+    /** True if the member was removed. */
+    zrem(set: string, member: string): boolean;
+    /** Number of members. */
+    zcard(set: string): number;
+    /** 0-based position by ascending score (ties by member name). */
+    zrank(set: string, member: string): number | undefined;
+    /** 0-based position by descending score — 0 is the top of the leaderboard. */
+    zrevrank(set: string, member: string): number | undefined;
+    /** Members at ascending positions `start..stop` inclusive (`stop` defaults to -1, the last); negative positions count from the end. */
+    zrange(set: string, start: number, stop?: number): [member: string, score: number][];
+    /** Like `zrange`, by descending score: `zrevrange(set, 0, 9)` is the top ten. */
+    zrevrange(set: string, start: number, stop?: number): [member: string, score: number][];
+    /** Members with `min <= score <= max`, ascending (use -Infinity / Infinity for an open end). */
+    zrangeByScore(set: string, min: number, max: number, limit?: number): [member: string, score: number][];
+
+    /**
+     * Promise versions of the basic operations, run in call order on the next server tick (outside any
+     * `transaction`).
+     */
+    async: {
+        get(key: string): Promise<string | undefined>;
+        set(key: string, value: string, options?: { ttlMs?: number }): Promise<void>;
+        /** Resolves true if a key was removed. */
+        delete(key: string): Promise<boolean>;
+        keys(prefix?: string, limit?: number): Promise<string[]>;
+    };
 };
 
 // --- Event bus ---
@@ -126,18 +264,43 @@ interface ServerEvents {
     // handler registered here is dispatchable but will never fire until that lands.
     on(event: "playerDied", handler: (player: Human) => void): void;
     on(event: "chatMessage", handler: (player: Human, message: string) => void): void;
+    /** An NPC reached the end of its Human.moveAlong path. */
+    on(event: "npcArrived", handler: (npc: Human) => void): void;
     on(
         event: "chatCommand",
         handler: (player: Human, message: string, command: string, args: string[]) => void,
     ): void;
     /**
-     * A custom event sent up from a client (via the client's Game.emitServer). `payload` is the
-     * JSON-parsed body (undefined when the client sent none). NOTE: event name + payload are
+     * A custom event sent up from a client (via the client's Game.emitServer / emitServerPacked).
+     * `payload` is the JSON-parsed or unpacked body (undefined when the client sent none). NOTE: event name + payload are
      * attacker-controlled — validate them, and don't reuse reserved names for client-driven logic.
      */
     on(event: string, handler: (player: Human, payload?: any) => void): void;
 }
 
+interface EventStat {
+    event: string;
+    calls: number;
+    totalMs: number;
+    maxMs: number;
+    /** JS heap growth across the dispatches, summed (memory collected during them is not counted). */
+    allocatedBytes: number;
+    /** Dispatches that ran past the slow-handler threshold. */
+    slow: number;
+}
+
+declare const Profiler: {
+    /** Per-event dispatch totals since start, costliest first; at most `limit` of them. */
+    eventStats(limit?: number): EventStat[];
+    /** Log handlers slower than `ms` (with their JS stack); 0 turns it off. Default 50. */
+    setSlowHandlerThreshold(ms: number): void;
+    /**
+     * CPU-profile the scripts for `seconds` (at most 60) into a Chrome DevTools `.cpuprofile` file.
+     * Returns the file it will be written to, or null while another capture is running.
+     */
+    captureCpuProfile(seconds: number): string | null;
+};
+
 declare const Core: {
     Events: ServerEvents;
 };